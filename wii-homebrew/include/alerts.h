@@ -0,0 +1,40 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include "common.h"
+#include "quote.h"
+#include "indicators.h"
+
+#define MAX_ALERT_RULES 32
+
+typedef enum {
+    ALERT_PRICE_ABOVE,   // price rises to threshold or beyond
+    ALERT_PRICE_BELOW,   // price falls to threshold or below
+    ALERT_PERCENT_MOVE,  // day change reaches +/- threshold percent
+    ALERT_EMA_CROSS_UP,  // EMA crosses above the SMA (threshold unused)
+    ALERT_EMA_CROSS_DOWN // EMA crosses below the SMA (threshold unused)
+} AlertType;
+
+// Slice of the compiled rule table belonging to one symbol
+typedef struct {
+    u16 first;
+    u16 count;
+} AlertRange;
+
+// Read sd:/apps/wii-dashboard/alerts.txt, one rule per line:
+//   AAPL above 200
+//   TSLA move 5          (percent, either direction)
+//   MSFT ema-cross-up    (or ema-cross-down)
+// and compile it into a table grouped by symbol
+void initAlerts();
+int getAlertRuleCount();
+
+// Resolve once per symbol (e.g. when the watchlist loads); empty if none
+AlertRange alertsForSymbol(const char* symbol);
+
+// Check one symbol's rules after its quote changed. Rules fire when their
+// condition becomes true and re-arm once it is false again.
+void alertsEvaluate(AlertRange range, const char* symbol, const Quote* quote,
+                    const IndicatorValues* values);
+
+#endif // ALERTS_H
@@ -0,0 +1,73 @@
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include "common.h"
+
+// Arbitrary-precision integers for the calculator's exact mode, as 32-bit
+// limbs, least significant first. Values of up to BIG_INLINE_LIMBS limbs
+// live inside the struct; longer ones take their limbs from a bump arena
+// that is reset before each evaluation, so nothing is freed one by one.
+// The arena is allocated by the first bigReset, not kept in .bss, so it
+// only costs memory once exact mode is used.
+// Operations never write into an operand's limbs, so any output may also
+// be an input.
+
+#define BIG_INLINE_LIMBS 2        // 64 bits without touching the arena
+#define BIG_ARENA_LIMBS (1 << 19) // 2 MB
+#define BIG_MAX_LIMBS 4096        // 131072 bits, about 39000 digits
+#define BIG_KARATSUBA_LIMBS 24    // schoolbook multiplication below this
+
+typedef struct {
+    u32 small[BIG_INLINE_LIMBS];
+    u32* heap;     // arena limbs, or NULL when the value fits in small
+    int length;    // limbs in use; 0 is zero
+    bool negative;
+} BigInt;
+
+// Start an evaluation with an empty arena, allocating it if needed; on
+// failure bigError() is set
+void bigReset();
+
+// Free the arena; BigInts using it are invalid until the next bigReset
+void bigFreeArena();
+
+// NULL, or why a result could not be stored ("Out of memory",
+// "Number too large"); results after a failure are meaningless
+const char* bigError();
+
+// Loops that make garbage every step release it, keeping the values
+// they carry over (any BigInt from before the mark stays valid)
+int bigMark();
+void bigRelease(int mark, BigInt* const* keep, int count);
+
+void bigSet(BigInt* out, s64 value);
+bool bigFromDecimal(BigInt* out, const char* digits, int count); // digits only
+bool bigToInt(const BigInt* a, s64* value); // false if it does not fit
+double bigFrexp(const BigInt* a, int* exponent); // |a| ~ result * 2^exponent
+
+bool bigIsZero(const BigInt* a);
+int bigBits(const BigInt* a); // of the magnitude
+int bigCompare(const BigInt* a, const BigInt* b);
+int bigCompareAbs(const BigInt* a, const BigInt* b);
+void bigNegate(BigInt* a);
+
+void bigAdd(const BigInt* a, const BigInt* b, BigInt* out);
+void bigSub(const BigInt* a, const BigInt* b, BigInt* out);
+void bigMul(const BigInt* a, const BigInt* b, BigInt* out);
+void bigMulSmall(const BigInt* a, u32 m, BigInt* out);
+
+// Truncating division; q or r may be NULL. Returns |a| mod d for the
+// single-limb form.
+void bigDivMod(const BigInt* a, const BigInt* b, BigInt* q, BigInt* r);
+u32 bigDivSmall(const BigInt* a, u32 d, BigInt* q);
+
+void bigShift(const BigInt* a, int bits, BigInt* out); // left if > 0, else right toward zero
+void bigGcd(const BigInt* a, const BigInt* b, BigInt* out);
+void bigPow(const BigInt* a, u32 n, BigInt* out);
+void bigSqrt(const BigInt* a, BigInt* out); // floor, for a >= 0
+
+// Decimal digits with a leading '-', cut to size - 1 characters; returns
+// the length of the whole text
+int bigToDecimal(const BigInt* a, char* out, int size);
+
+#endif // BIGNUM_H
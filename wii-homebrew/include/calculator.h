@@ -18,9 +18,6 @@ void updateCalculator();
 void renderCalculator();
 
 // Math functions
-double calcSin(double x);
-double calcCos(double x);
-double calcTan(double x);
 double calcLog(double x);
 double calcLn(double x);
 double calcSqrt(double x);
@@ -0,0 +1,39 @@
+#ifndef CALCULUS_H
+#define CALCULUS_H
+
+#include "common.h"
+#include "expr.h"
+
+// Values for the ∫ and Σ operators of a compiled expression, computed a
+// time-sliced share per frame on the batch evaluator. Integrals use
+// adaptive 15-point Gauss-Kronrod, always splitting the panels with the
+// largest error estimates; sums add terms with Neumaier's compensated
+// summation. Each value is written back with exprResolve, inner operators
+// first, so the program evaluates normally once calculusBusy() is false.
+
+#define CALCULUS_MAX_PANELS 1024
+#define CALCULUS_REL_TOL 1e-10
+#define CALCULUS_ABS_TOL 1e-12
+#define CALCULUS_MAX_TERMS 1e12
+
+// Start on prog, which must stay alive until done; false with a message in
+// error if the bounds are unusable
+bool calculusStart(ExprProgram* prog, char* error, int errorSize);
+void calculusCancel();
+
+void calculusStep();  // this frame's share of the work
+bool calculusBusy();
+
+// Set when the last run failed (a non-finite value), else NULL
+const char* calculusError();
+
+// Sum of the error bounds of every operator, and integrand or term
+// evaluations, for the last run
+double calculusErrorBound();
+double calculusEvaluations();
+
+// Progress line while busy, then "±bound, N evaluations", noting when an
+// integral stopped at CALCULUS_MAX_PANELS short of the tolerance
+void calculusStatus(char* out, int size);
+
+#endif // CALCULUS_H
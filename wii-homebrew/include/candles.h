@@ -0,0 +1,64 @@
+#ifndef CANDLES_H
+#define CANDLES_H
+
+#include "common.h"
+
+#define CHART_MAX_POINTS 1024 // a full day of 1-minute bars with room to spare
+
+// Raw intraday series in columnar form, as delivered by the chart endpoint
+typedef struct {
+    u32 time[CHART_MAX_POINTS]; // Unix seconds, ascending
+    float open[CHART_MAX_POINTS];
+    float high[CHART_MAX_POINTS];
+    float low[CHART_MAX_POINTS];
+    float close[CHART_MAX_POINTS];
+    float volume[CHART_MAX_POINTS];
+    int count;
+    int gmtOffset;              // exchange local time = UTC + gmtOffset
+} ChartSeries;
+
+typedef enum {
+    CANDLE_1M,
+    CANDLE_5M,
+    CANDLE_15M,
+    CANDLE_1H,
+    CANDLE_1D,   // built from the on-SD history rather than the intraday series
+    CANDLE_INTERVAL_COUNT
+} CandleInterval;
+
+// OHLC candles for one interval, built incrementally from a ChartSeries
+typedef struct {
+    int intervalSec;
+    u32 start[CHART_MAX_POINTS];
+    float open[CHART_MAX_POINTS];
+    float high[CHART_MAX_POINTS];
+    float low[CHART_MAX_POINTS];
+    float close[CHART_MAX_POINTS];
+    float volume[CHART_MAX_POINTS];
+    int count;
+    int consumed;               // series points already folded in
+    bool dirty;                 // points before consumed changed
+    int changedFrom;            // first candle modified since candlesAcknowledge
+} CandleSet;
+
+// Parse the timestamp and indicators.quote arrays of a Yahoo chart response.
+// Points with a null field are skipped.
+bool parseChartSeries(const char* json, ChartSeries* out);
+
+// Copy a fresh fetch over the current series. Returns the index of the
+// first point that changed (== count when nothing did).
+int chartMerge(ChartSeries* series, const ChartSeries* fresh);
+
+void candlesInit(CandleSet* set, CandleInterval interval);
+void candlesInvalidate(CandleSet* set, int fromPoint);   // series changed from here on
+void candlesSync(CandleSet* set, const ChartSeries* series); // fold in pending points
+void candlesAcknowledge(CandleSet* set); // consumers have seen every change
+
+// Fold one bar (or a single price, o = h = l = c) into a set directly;
+// times must not go backwards
+void candlesAppend(CandleSet* set, u32 time, float open, float high, float low, float close, float volume);
+
+int candleIntervalSeconds(CandleInterval interval);
+const char* candleIntervalName(CandleInterval interval);
+
+#endif // CANDLES_H
@@ -3,12 +3,16 @@
 
 #include "common.h"
 
-// Configuration structure
+// Configuration structure. config.dat stores it after a versioned header;
+// add new fields at the end only, so older files keep loading.
 typedef struct {
     bool networkEnabled;
     bool ntpEnabled;
     int stockUpdateInterval; // seconds
     char customApiKey[128];
+    char quoteStreamUrl[128]; // SSE tick feed, empty = poll only
+    int metricsPort;          // monitoring endpoint, 0 = disabled
+    bool tlsAllowUnverified;  // HTTPS without a CA bundle, unauthenticated
 } AppConfig;
 
 // Config functions
@@ -0,0 +1,36 @@
+#ifndef EXACT_H
+#define EXACT_H
+
+#include "common.h"
+#include "expr.h"
+
+// Exact evaluation of a compiled expression on big numbers (bignum.h).
+// Integers and fractions stay exact through + - * /, integer and rational
+// powers, exact roots and n!; number literals are read again from the
+// source, so 0.1 is 1/10. Anything irrational (π, e, ln, trig away from
+// the angles with rational values, ...) is carried as a binary float with
+// enough bits for the requested decimal digits and rounded once at the end.
+// Variables are 0, as in the double evaluator.
+
+#define EXACT_MAX_DIGITS 1000  // decimal precision for irrational results
+#define EXACT_MAX_TEXT 8192    // longer integers are shown rounded
+#define EXACT_RANGE_BITS 65536 // approximate values within 2^-65536..2^65536
+
+typedef struct {
+    bool exact;       // text is the value itself, not rounded
+    bool fraction;    // text is "p/q"; decimal holds its value rounded
+    int integerDigits; // of an exact integer (also when text is rounded)
+    char text[EXACT_MAX_TEXT];
+    char decimal[EXACT_MAX_DIGITS + 32];
+    char summary[32]; // 12 significant digits, for one line
+} ExactResult;
+
+// Evaluate prog (compiled from source, without ∫ or Σ) to digits
+// significant digits where it is not exact; false with a message in error
+bool exactEvaluate(const ExprProgram* prog, const char* source, int digits,
+                   ExactResult* result, char* error, int errorSize);
+
+// Free the big number arena; the next exactEvaluate takes it again
+void cleanupExact();
+
+#endif // EXACT_H
@@ -0,0 +1,193 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "common.h"
+
+// Compile-once expression engine: text -> AST -> stack bytecode.
+// A compiled program is plain data and can be evaluated any number of
+// times without allocating.
+
+#define EXPR_MAX_NODES 128
+#define EXPR_MAX_CODE 256
+#define EXPR_MAX_CONSTS 64
+#define EXPR_MAX_STACK 32
+#define EXPR_MAX_DEPTH 32   // nesting of parentheses and operators
+#define EXPR_MAX_TEMPS 16   // shared and hoisted subexpressions
+#define EXPR_MAX_POWI 16    // x^n with |n| up to this becomes multiplies
+#define EXPR_LANES 64       // batch evaluation block
+#define EXPR_MAX_CALCULUS 4 // ∫ and Σ operators per expression
+
+// Variable slots
+typedef enum {
+    EXPR_VAR_X,
+    EXPR_VAR_Y,
+    EXPR_VAR_T,
+    EXPR_VAR_THETA,
+    EXPR_VAR_COUNT
+} ExprVar;
+
+// Shared by AST nodes and bytecode
+typedef enum {
+    EXPR_OP_CONST,   // arg: constant index (node: value)
+    EXPR_OP_VAR,     // arg: variable slot
+
+    // Unary
+    EXPR_OP_NEG,
+    EXPR_OP_SQRT,
+    EXPR_OP_SIN,     // arg: 1 for degrees, else radians (node: value); the
+    EXPR_OP_COS,     // parser scales degree input by π/180 in the AST and
+    EXPR_OP_TAN,     // code generation turns that back into arg 1
+    EXPR_OP_ASIN,
+    EXPR_OP_ACOS,
+    EXPR_OP_ATAN,
+    EXPR_OP_LN,
+    EXPR_OP_LOG,
+    EXPR_OP_EXP,
+    EXPR_OP_ABS,
+    EXPR_OP_FACT,
+
+    // Binary
+    EXPR_OP_ADD,
+    EXPR_OP_SUB,
+    EXPR_OP_MUL,
+    EXPR_OP_DIV,
+    EXPR_OP_POW,
+
+    // Produced by exprOptimize
+    EXPR_OP_SQR,     // x*x
+    EXPR_OP_POWI,    // arg: signed integer exponent (node: value)
+    EXPR_OP_LOAD,    // arg: temp; push
+    EXPR_OP_STORE,   // arg: temp; pop into it
+    EXPR_OP_TEE,     // arg: temp; copy the top into it
+
+    EXPR_OP_COUNT
+} ExprOp;
+
+typedef enum {
+    EXPR_DEGREES,
+    EXPR_RADIANS
+} ExprAngleMode;
+
+// Precise evaluates in double with libm, for displayed results; fast uses
+// the float kernels from fastmath.h for sqrt, trig, exp, log and pow, for
+// plotting. Constant folding is always precise.
+typedef enum {
+    EXPR_PRECISE,
+    EXPR_FAST
+} ExprPrecision;
+
+// ∫(f, a, b) integrates f over x from a to b; Σ(f, a, b) sums f for the
+// integers x = a..b. x inside f is the operator's own; a and b may not
+// use variables. Their values come from an iterative computation (see
+// calculus.h), so the parser leaves a constant node holding NAN and
+// records the operator for exprResolve.
+typedef enum {
+    EXPR_INTEGRAL,
+    EXPR_SUM
+} ExprCalculusOp;
+
+typedef struct {
+    u8 op;        // ExprCalculusOp
+    s16 body;     // subtree in x
+    s16 lower;
+    s16 upper;
+    s16 node;     // placeholder constant
+} ExprCalculus;
+
+// Where a parsed constant came from, for evaluators that do not work in
+// double (see exact.h); the optimizer drops it
+typedef enum {
+    EXPR_CONST_NUMBER, // a literal, or a value the parser made up
+    EXPR_CONST_PI,
+    EXPR_CONST_E,
+    EXPR_CONST_DEGREE, // π/180 before trig in degree mode
+    EXPR_CONST_RADIAN  // 180/π after inverse trig
+} ExprConstKind;
+
+typedef struct {
+    u8 op;        // ExprOp
+    u8 slot;      // EXPR_OP_VAR: ExprVar; EXPR_OP_CONST: ExprConstKind
+    s16 left;     // operand nodes, -1 if unused
+    s16 right;
+    s16 text;     // byte offset of a number literal in the source, else -1
+    double value; // EXPR_OP_CONST; the arg of POWI and trig
+} ExprNode;
+
+typedef struct {
+    u8 op;
+    u8 arg;
+} ExprInstr;
+
+typedef struct {
+    ExprNode nodes[EXPR_MAX_NODES];
+    int nodeCount;
+    int root;
+
+    ExprInstr code[EXPR_MAX_CODE];
+    int codeLength;
+    double consts[EXPR_MAX_CONSTS];
+    int constCount;
+    int maxStack;
+    int bodyStart;  // code before this is the prologue run by exprBind
+    int tempCount;
+    double bound[EXPR_MAX_TEMPS]; // temps left by the last exprBind
+    u8 precision;   // ExprPrecision; exprCompile sets EXPR_PRECISE
+
+    u32 varMask;    // bit per ExprVar referenced, outside ∫ and Σ bodies
+    ExprCalculus calculus[EXPR_MAX_CALCULUS]; // inner operators first
+    int calculusCount;
+    char error[48]; // set when compilation fails
+    int errorPos;   // byte offset into the source
+} ExprProgram;
+
+// Parse and compile; on failure returns false with error/errorPos set
+bool exprCompile(ExprProgram* prog, const char* source, ExprAngleMode angles);
+
+// Evaluate with vars[EXPR_VAR_COUNT] (only referenced slots are read)
+double exprEval(const ExprProgram* prog, const double* vars);
+
+bool exprUsesVar(const ExprProgram* prog, ExprVar var);
+
+// A program for the subtree at node of prog, such as a ∫ body or bound
+bool exprCompileSubtree(const ExprProgram* prog, int node, ExprProgram* out);
+
+// Give ∫/Σ operator k its value and regenerate the code
+bool exprResolve(ExprProgram* prog, int k, double value);
+
+// Rewrite a compiled program: fold constant subtrees, turn x^2 and small
+// integer powers into multiplies, and compute repeated subexpressions once.
+// With loopVar < EXPR_VAR_COUNT, work that does not depend on it moves to a
+// prologue, so exprBind + exprEvalBound skip it on every call. Operators
+// still unresolved are dropped and stay NAN.
+void exprOptimize(ExprProgram* prog, int loopVar);
+
+// Run the prologue for the current values of the other variables
+void exprBind(ExprProgram* prog, const double* vars);
+double exprEvalBound(const ExprProgram* prog, const double* vars);
+
+// out[i] = f(vars with vars[lane] = xs[i]) for count values, evaluated a
+// block of EXPR_LANES at a time with each op running as one loop over the
+// block. Needs no exprBind: work not involving the lane variable is done
+// once per block (always precisely). With EXPR_PRECISE the results match
+// exprEval exactly.
+void exprEvalBatch(const ExprProgram* prog, const double* vars, ExprVar lane,
+                   const double* xs, double* out, int count);
+
+// Value and derivative in one pass, by forward-mode automatic
+// differentiation: each value carries d/d var alongside it. Derivatives are
+// always computed precisely; values follow the program's precision in the
+// batch form.
+double exprEvalDual(const ExprProgram* prog, const double* vars, ExprVar var, double* derivative);
+void exprEvalBatchDual(const ExprProgram* prog, const double* vars, ExprVar lane,
+                       const double* xs, double* out, double* derivs, int count);
+
+// Bounds of f for var over [lo, hi] by interval arithmetic. False where f
+// is unbounded or partly undefined on the range (a pole or a domain edge).
+bool exprEvalInterval(const ExprProgram* prog, const double* vars, ExprVar var,
+                      double lo, double hi, double* outLo, double* outHi);
+
+// The same with every variable ranging over [lo[v], hi[v]]
+bool exprEvalBox(const ExprProgram* prog, const double* lo, const double* hi,
+                 double* outLo, double* outHi);
+
+#endif // EXPR_H
@@ -10,6 +10,7 @@ void cleanupGraphics();
 // Drawing functions
 void clearScreen(u32 color);
 void drawRectangle(float x, float y, float width, float height, u32 color);
+void drawLine(float x1, float y1, float x2, float y2, u32 color);
 void drawCircle(float x, float y, float radius, u32 color);
 void drawGlassRectangle(float x, float y, float width, float height, u32 baseColor);
 void drawGlassCircle(float x, float y, float radius, u32 baseColor);
@@ -0,0 +1,27 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include "common.h"
+#include "expr.h"
+
+// Function plot for the calculator's graphing mode. Screen columns sit on a
+// fixed grid x = k * step, so a pan only evaluates the columns it exposes and
+// a 2x zoom keeps the columns that still line up. Sampling, pole checks and
+// refinement run under a per-frame time budget and carry on over later
+// frames.
+
+#define GRAPH_X 40
+#define GRAPH_Y 130
+#define GRAPH_WIDTH 560
+#define GRAPH_HEIGHT 280
+
+// Compile and start plotting over the default view; false with a message
+// in error if the expression does not compile
+bool graphPlot(const char* function, ExprAngleMode angles, char* error, int errorSize);
+void graphClear();
+bool graphIsValid();
+
+void graphUpdate(); // pan/zoom input, then this frame's share of the work
+void graphRender();
+
+#endif // GRAPHVIEW_H
@@ -0,0 +1,82 @@
+#ifndef HISTSTORE_H
+#define HISTSTORE_H
+
+#include "common.h"
+#include "pricehistory.h"
+
+// Append-only price history on SD, one file per symbol.
+//
+// The file is a sequence of blocks of up to HIST_BLOCK_POINTS points. Each
+// block header carries the time range, the first/last/low/high price and a
+// CRC; the payload holds two columns, time deltas (ms) and price deltas
+// (1/10000ths), as zigzag varints. Headers alone answer coarse queries, so
+// long-range charts decode only the blocks that straddle a bucket edge.
+
+#define HIST_BLOCK_POINTS 255
+#define HIST_COLUMN_BYTES 256
+
+// Pending block for one symbol, encoded as points arrive
+typedef struct {
+    char symbol[16];
+    bool checked;           // file tail validated this session
+    u16 count;
+    u16 timeBytes;
+    u16 priceBytes;
+    s64 firstMs;
+    s64 lastMs;
+    s32 firstPrice;
+    s32 lastPrice;
+    s32 lowPrice;
+    s32 highPrice;
+    u64 openedMs;           // monotonic, for age-based flushes
+    u8 timeColumn[HIST_COLUMN_BYTES];
+    u8 priceColumn[HIST_COLUMN_BYTES];
+} HistWriter;
+
+// Index entry, built from the block headers when a file is opened
+typedef struct {
+    u32 offset;
+    u16 count;
+    u16 payloadBytes;
+    s64 firstMs;
+    s64 lastMs;
+    float first;
+    float last;
+    float low;
+    float high;
+} HistBlock;
+
+typedef struct {
+    HistBlock* blocks;
+    int blockCount;
+#ifdef GEKKO
+    FILE* file;
+#else
+    int fd;                 // host builds read through a mapping
+    const u8* map;
+    size_t mapSize;         // readable bytes, less than mapped after a truncate
+    size_t mapLength;       // bytes mapped, for munmap
+#endif
+} HistFile;
+
+void initHistStore(); // create the history directory
+
+void histWriterInit(HistWriter* writer, const char* symbol);
+void histAppend(HistWriter* writer, s64 timeUs, float price); // buffered, no SD access
+bool histFlush(HistWriter* writer);                             // write the pending block
+
+// Open a symbol's file and index it. A damaged block mid-file is skipped;
+// damage running to the end (an interrupted write) is truncated away.
+bool histOpen(HistFile* file, const char* symbol);
+void histClose(HistFile* file);
+
+int histFindBlock(const HistFile* file, s64 timeMs); // first block ending at or after timeMs
+
+// Decode one block into out (HIST_BLOCK_POINTS entries); -1 if it fails its CRC
+int histReadBlock(HistFile* file, int block, PricePoint* out);
+
+// The newest max points of the writer's symbol, oldest first. Also checks
+// the file tail so later appends continue from it.
+int histLoadRecent(HistWriter* writer, PricePoint* out, int max);
+
+#endif // HISTSTORE_H
@@ -0,0 +1,61 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include "common.h"
+
+// Standard periods
+#define IND_SMA_PERIOD 20     // also the Bollinger window
+#define IND_EMA_PERIOD 12
+#define IND_RSI_PERIOD 14
+#define IND_BOLLINGER_K 2.0
+
+// Latest values, cached for the renderer
+typedef struct {
+    bool smaValid;
+    float sma;
+    bool emaValid;
+    float ema;
+    bool rsiValid;
+    float rsi;
+    bool bandsValid;
+    float upperBand;
+    float lowerBand;
+    bool vwapValid;  // needs volume
+    float vwap;
+} IndicatorValues;
+
+// Streaming state; every indicator advances in O(1) per sample
+typedef struct {
+    // Sliding window for the SMA and Bollinger bands (Welford add/remove)
+    float window[IND_SMA_PERIOD];
+    int windowCount;
+    int windowHead;
+    double mean;
+    double m2;
+
+    double ema;
+    int emaSamples;
+
+    // Wilder-smoothed RSI
+    bool hasLastPrice;
+    float lastPrice;
+    double avgGain;
+    double avgLoss;
+    int rsiSamples;
+
+    // Session VWAP
+    double priceVolume;
+    double volume;
+
+    IndicatorValues values;
+} IndicatorState;
+
+void indicatorsInit(IndicatorState* state);
+
+// price: last trade (or a candle's close); typical: price used for VWAP
+// (e.g. (high + low + close) / 3); volume 0 leaves VWAP untouched
+void indicatorsAdd(IndicatorState* state, float price, float typical, float volume);
+
+const IndicatorValues* indicatorsGet(const IndicatorState* state);
+
+#endif // INDICATORS_H
@@ -14,6 +14,8 @@ typedef struct {
     bool homeButton;
     bool plusButton;
     bool minusButton;
+    bool oneButton;
+    bool twoButton;
     int dpadX; // -1 left, 0 center, 1 right
     int dpadY; // -1 up, 0 center, 1 down
 } InputState;
@@ -0,0 +1,19 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "common.h"
+
+// Embedded HTTP endpoint for remote monitoring:
+//   GET /metrics       Prometheus text format
+//   GET /metrics.json  JSON
+// served from a thread of its own. Opt-in: port 0 serves nothing.
+bool initMetrics(int port);
+void cleanupMetrics();
+
+// Main thread, once per frame: frame timing and clock snapshot
+void updateMetrics();
+
+// Main thread: a data source (e.g. a stock symbol) just received fresh data
+void metricsMarkFresh(const char* source);
+
+#endif // METRICS_H
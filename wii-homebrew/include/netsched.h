@@ -0,0 +1,48 @@
+#ifndef NETSCHED_H
+#define NETSCHED_H
+
+#include "common.h"
+
+// Request priorities (the visible scene is boosted above these)
+typedef enum {
+    NET_PRIORITY_LOW,
+    NET_PRIORITY_NORMAL,
+    NET_PRIORITY_HIGH
+} NetPriority;
+
+// Delivered on the main thread from updateNetScheduler().
+// body is only valid for the duration of the call.
+typedef void (*NetDataCallback)(const char* body, bool ok, void* userData);
+
+// Scheduler lifecycle; fetches run on a background thread
+void initNetScheduler();
+void cleanupNetScheduler();
+void updateNetScheduler(); // delivers results, call once per frame
+
+// Periodic data subscriptions. Returns an id, or -1 if the table is full.
+int netSubscribe(const char* url, Scene owner, NetPriority priority,
+                 int intervalSec, NetDataCallback callback, void* userData);
+void netUnsubscribe(int id);
+void netSetInterval(int id, int intervalSec);
+void netSetPaused(int id, bool paused);
+void netSetPriority(int id, NetPriority priority); // applies from the next fetch
+
+// Fetch now instead of waiting for the interval
+void netRefresh(int id);
+void netRefreshScene(Scene owner);
+
+// Speculative low-priority refresh of a scene's stale data, e.g. while the
+// dashboard pointer rests on its bubble: at most limit subscriptions, the
+// highest priority first. Cancelling drops whatever is still queued and
+// restores the normal schedule; requests in flight still land.
+void netPrefetchScene(Scene owner, int limit);
+void netCancelPrefetch(Scene owner);
+
+// Status for the scenes
+int netSecondsUntilRefresh(int id);
+bool netSceneBusy(Scene owner);
+
+// Minimum spacing between requests to one host (default 1000 ms)
+void netSetHostRateLimit(const char* host, int minIntervalMs);
+
+#endif // NETSCHED_H
@@ -0,0 +1,76 @@
+#ifndef NETSTATS_H
+#define NETSTATS_H
+
+#include "common.h"
+
+typedef enum {
+    NET_OUTCOME_OK,
+    NET_OUTCOME_DNS_FAILED,
+    NET_OUTCOME_CONNECT_FAILED,
+    NET_OUTCOME_TLS_FAILED,
+    NET_OUTCOME_SEND_FAILED,
+    NET_OUTCOME_NO_DATA,
+    NET_OUTCOME_HTTP_ERROR,
+    NET_OUTCOME_COUNT
+} NetOutcome;
+
+// Request phases, in the order they happen
+typedef enum {
+    NET_PHASE_DNS,
+    NET_PHASE_CONNECT,
+    NET_PHASE_TLS,
+    NET_PHASE_TTFB,     // request sent until first response byte
+    NET_PHASE_TRANSFER, // first byte until the body is complete
+    NET_PHASE_TOTAL,
+    NET_PHASE_COUNT
+} NetPhase;
+
+// One request, filled in by the HTTP client
+typedef struct {
+    char host[64];
+    u32 phaseUs[NET_PHASE_COUNT];
+    u32 bytesOut;
+    u32 bytesIn;
+    int httpStatus;
+    bool connectionReused; // keep-alive hit, no DNS/connect/TLS
+    bool tlsResumed;       // abbreviated handshake from a cached session
+    NetOutcome outcome;
+} NetTiming;
+
+typedef struct {
+    u32 count;
+    u32 p50Us;
+    u32 p95Us;
+    u32 p99Us;
+    u32 maxUs;
+} NetLatency;
+
+// Aggregated per host
+typedef struct {
+    char host[64];
+    u32 requests;
+    u32 outcomes[NET_OUTCOME_COUNT];
+    u64 bytesIn;
+    u64 bytesOut;
+    u32 reusedConnections;
+    u32 fullHandshakes;
+    u32 resumedHandshakes;
+    u32 fullHandshakeAvgUs;
+    u32 resumedHandshakeAvgUs;
+    NetLatency phases[NET_PHASE_COUNT];
+} NetHostStats;
+
+void initNetStats();
+void cleanupNetStats();
+void updateNetStats(); // periodic SD log, call once per frame
+
+// Thread-safe; called from the network thread
+void netStatsRecord(const NetTiming* timing);
+
+int netStatsHostCount();
+bool netStatsGetHost(int index, NetHostStats* out);
+
+const char* netOutcomeName(NetOutcome outcome);
+const char* netPhaseName(NetPhase phase);
+
+#endif // NETSTATS_H
@@ -8,14 +8,17 @@ bool initNetwork();
 void cleanupNetwork();
 bool isNetworkConnected();
 
+// Blocking DNS lookup, safe from any thread; IPv4 address in network order
+bool resolveHost(const char* host, u32* outAddr);
+
 // HTTP requests
 char* httpGet(const char* url);
 bool httpPost(const char* url, const char* data);
 
 // API functions
-bool fetchStockData(const char* symbol, char* outPrice, char* outChange);
-bool fetchWorldTime(const char* timezone, char* outTime);
-bool syncNTPTime();
+void stockQuoteUrl(const char* symbol, char* outUrl, int size);
+void stockChartUrl(const char* symbol, char* outUrl, int size);
+bool parseStockQuote(const char* response, float* outPrice, float* outPrevClose);
 
 // JSON helpers
 const char* jsonGetString(const char* json, const char* key);
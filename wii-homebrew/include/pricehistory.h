@@ -0,0 +1,36 @@
+#ifndef PRICEHISTORY_H
+#define PRICEHISTORY_H
+
+#include "common.h"
+
+#define PRICE_HISTORY_CAPACITY 512
+
+typedef struct {
+    s64 timeUs;  // application clock (sntpTimeUs)
+    float price;
+} PricePoint;
+
+// Fixed-size ring of the most recent points. Min/max over the ring are kept
+// in monotonic deques, so appends and queries are amortised O(1).
+typedef struct {
+    PricePoint points[PRICE_HISTORY_CAPACITY];
+    u32 appended;                         // total points ever appended
+    u32 minQueue[PRICE_HISTORY_CAPACITY]; // sequence numbers, prices ascending
+    u32 maxQueue[PRICE_HISTORY_CAPACITY]; // sequence numbers, prices descending
+    u32 minHead, minTail;
+    u32 maxHead, maxTail;
+} PriceHistory;
+
+void historyInit(PriceHistory* history);
+void historyAppend(PriceHistory* history, s64 timeUs, float price);
+
+int historyCount(const PriceHistory* history);
+const PricePoint* historyAt(const PriceHistory* history, int index); // 0 = oldest
+float historyMin(const PriceHistory* history);
+float historyMax(const PriceHistory* history);
+
+// Largest-Triangle-Three-Buckets downsampling to at most maxPoints points,
+// keeping the visual shape (peaks and troughs) of the series
+int historyDownsample(const PriceHistory* history, PricePoint* out, int maxPoints);
+
+#endif // PRICEHISTORY_H
@@ -0,0 +1,41 @@
+#ifndef QUOTE_H
+#define QUOTE_H
+
+#include "common.h"
+
+typedef enum {
+    QUOTE_SOURCE_NONE,
+    QUOTE_SOURCE_POLL,        // scheduler fetch of the chart endpoint
+    QUOTE_SOURCE_STREAM,      // server-sent events tick
+    QUOTE_SOURCE_PLACEHOLDER  // made up until real data arrives
+} QuoteSource;
+
+// Numeric quote; everything that computes (sorting, alerts, charts) reads
+// these fields. Display strings are derived lazily and cached.
+typedef struct {
+    double price;
+    double prevClose;     // 0 until a quote carried it
+    double change;        // price - prevClose
+    double changePercent;
+    s64 timeUs;           // application clock when received
+    QuoteSource source;
+
+    // Render cache, rebuilt only after the numbers change
+    bool textDirty;
+    char priceText[24];
+    char changeText[16];
+} Quote;
+
+void quoteInit(Quote* quote);
+
+// prevClose <= 0 keeps the previously known close. Returns true when the
+// price or close changed.
+bool quoteUpdate(Quote* quote, double price, double prevClose, QuoteSource source, s64 timeUs);
+
+bool quoteHasData(const Quote* quote); // real (non-placeholder) data received
+bool quoteIsUp(const Quote* quote);
+
+const char* quotePriceText(Quote* quote);  // "$189.32"
+const char* quoteChangeText(Quote* quote); // "+1.19%"
+
+#endif // QUOTE_H
@@ -0,0 +1,23 @@
+#ifndef QUOTESTREAM_H
+#define QUOTESTREAM_H
+
+#include "common.h"
+
+// Called for every tick received on the stream
+typedef void (*QuoteTickHandler)(const char* symbol, float price, float prevClose);
+
+// Stream lifecycle (url is an http:// server-sent events endpoint)
+bool initQuoteStream(const char* url, QuoteTickHandler handler);
+void cleanupQuoteStream();
+
+// Symbols to request when the stream (re)connects. False when the stream
+// is full (64 symbols) or the symbol is too long; poll those instead.
+bool quoteStreamSubscribe(const char* symbol);
+
+// Non-blocking pump, call once per frame
+void updateQuoteStream();
+
+// True while ticks are flowing; callers should poll when this is false
+bool isQuoteStreamActive();
+
+#endif // QUOTESTREAM_H
@@ -0,0 +1,29 @@
+#ifndef SNTP_H
+#define SNTP_H
+
+#include "common.h"
+
+// Clock discipline statistics for the clock scenes
+typedef struct {
+    bool synced;
+    int rounds;        // completed sync rounds
+    double offsetMs;   // last measured offset (server - app clock)
+    double delayMs;    // round-trip delay of the chosen sample
+    double jitterMs;   // RMS spread of the round's sample offsets
+    double driftPpm;   // estimated local oscillator frequency error
+    time_t lastSync;   // app time of the last successful round
+} SntpStats;
+
+// Asynchronous SNTP client (server NULL = free-running app clock only)
+void initSntp(const char* server);
+void cleanupSntp();
+void updateSntp();       // non-blocking, call once per frame
+void sntpRequestSync();  // resync soon, e.g. when a clock scene opens
+
+// Monotonic, slewed application clock (Unix time)
+time_t sntpTime();
+s64 sntpTimeUs();
+
+const SntpStats* getSntpStats();
+
+#endif // SNTP_H
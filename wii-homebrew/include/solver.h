@@ -0,0 +1,31 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "common.h"
+#include "expr.h"
+
+// Equation mode. Accepts f(x) = g(x) (or f(x), meaning = 0), or two
+// equations in x and y separated by ';'. Polynomials get every real root
+// through Sturm sequences; other functions are scanned over
+// [-SOLVER_SCAN_RANGE, SOLVER_SCAN_RANGE] and bracketed roots are refined
+// with Brent's method; systems are searched over a square of half-width
+// SOLVER_SYSTEM_RANGE. The work runs a time-sliced share per frame.
+
+#define SOLVER_MAX_ROOTS 32
+#define SOLVER_SCAN_RANGE 100.0
+#define SOLVER_SYSTEM_RANGE 10.0
+
+// Parse and start solving; false with a message in error if the input
+// is not an equation the solver handles
+bool solverStart(const char* source, ExprAngleMode angles, char* error, int errorSize);
+void solverCancel();
+
+void solverStep();   // this frame's share of the work
+bool solverBusy();
+bool solverHasResult();
+
+// "x = 1, 2" or "x = 1, y = 2; ..." for the roots found so far
+void solverSummary(char* out, int size);
+void solverRender(float x, float y); // progress and roots so far
+
+#endif // SOLVER_H
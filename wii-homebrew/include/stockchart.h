@@ -0,0 +1,17 @@
+#ifndef STOCKCHART_H
+#define STOCKCHART_H
+
+#include "common.h"
+
+// Latest price carried by a chart response, for the owning tile
+typedef void (*ChartQuoteHandler)(const char* symbol, float price, float prevClose);
+
+// Intraday candlestick view for one symbol, shown inside the Stocks scene
+void openStockChart(const char* symbol, const char* name, ChartQuoteHandler handler);
+void closeStockChart();
+bool isStockChartOpen();
+
+void updateStockChart(); // B closes the view
+void renderStockChart();
+
+#endif // STOCKCHART_H
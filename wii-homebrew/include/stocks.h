@@ -6,6 +6,7 @@
 void initStocks();
 void cleanupStocks();
 void updateStocks();
+void serviceStocks(); // every frame in any scene: stream sync, trend restores
 void renderStocks();
 
 #endif // STOCKS_H
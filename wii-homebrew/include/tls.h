@@ -0,0 +1,21 @@
+#ifndef TLS_H
+#define TLS_H
+
+#include "common.h"
+#include <openssl/ssl.h>
+
+// TLS client on top of libogc sockets, with per-host session resumption
+bool initTls();
+void cleanupTls();
+
+// Handshake over a connected socket. Returns NULL on failure.
+// resumed reports whether a cached session was accepted by the server.
+SSL* tlsConnect(int sock, const char* host, bool* resumed);
+
+// >0 bytes transferred, 0 connection closed, <0 error
+int tlsRead(SSL* ssl, void* buffer, int length);
+int tlsWrite(SSL* ssl, const void* buffer, int length);
+
+void tlsClose(SSL* ssl);
+
+#endif // TLS_H
@@ -0,0 +1,13 @@
+#ifndef TOAST_H
+#define TOAST_H
+
+#include "common.h"
+
+// Short notifications drawn over whatever scene is showing. Posting never
+// blocks; when the queue is full the oldest toast gives way.
+void showToast(const char* text, u32 color);
+
+void updateToasts(); // expire old toasts
+void renderToasts(); // call after the scene, before endFrame
+
+#endif // TOAST_H
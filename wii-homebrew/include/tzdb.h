@@ -0,0 +1,22 @@
+#ifndef TZDB_H
+#define TZDB_H
+
+#include "common.h"
+
+// Embedded timezone rules (generated by tools/gentzdb.py)
+
+// Zone lookup by IANA name, e.g. "Australia/Sydney". Returns -1 if unknown.
+int tzFind(const char* name);
+int tzCount();
+const char* tzName(int zone);
+
+// Offset from UTC in seconds (east positive) at the given UTC instant
+int tzUtcOffset(int zone, time_t utc, bool* isDst);
+
+// Convert a UTC instant to local broken-down time for the zone
+void tzLocalTime(int zone, time_t utc, struct tm* out);
+
+// Abbreviation in effect at the given instant ("AEDT", "+04", ...)
+const char* tzAbbrev(int zone, time_t utc);
+
+#endif // TZDB_H
@@ -0,0 +1,196 @@
+#include "alerts.h"
+#include "toast.h"
+
+static const char* ALERTS_PATH = "sd:/apps/wii-dashboard/alerts.txt";
+
+typedef enum {
+    RULE_UNKNOWN,  // nothing seen yet
+    RULE_CLEAR,    // condition false (or EMA below SMA for crossovers)
+    RULE_MET       // condition true (or EMA above SMA)
+} RuleState;
+
+// Rule as read from the file
+typedef struct {
+    char symbol[16];
+    int type;            // AlertType
+    float threshold;
+} AlertRule;
+
+// Compiled rule: symbol resolved away, 8 bytes each
+typedef struct {
+    float threshold;
+    u8 type;
+    u8 state;
+} CompiledAlert;
+
+static const struct {
+    const char* name;
+    AlertType type;
+    bool needsThreshold;
+} ruleTypes[] = {
+    { "above", ALERT_PRICE_ABOVE, true },
+    { "below", ALERT_PRICE_BELOW, true },
+    { "move", ALERT_PERCENT_MOVE, true },
+    { "ema-cross-up", ALERT_EMA_CROSS_UP, false },
+    { "ema-cross-down", ALERT_EMA_CROSS_DOWN, false }
+};
+
+static CompiledAlert rules[MAX_ALERT_RULES];
+static char ruleSymbols[MAX_ALERT_RULES][16]; // only read while resolving
+static int ruleCount = 0;
+
+static int compareRules(const void* a, const void* b) {
+    return strcmp(((const AlertRule*)a)->symbol, ((const AlertRule*)b)->symbol);
+}
+
+// "SYMBOL TYPE [THRESHOLD]", separated by spaces, tabs or commas
+static bool parseRule(char* line, AlertRule* rule) {
+    const char* separators = " \t,";
+    char* symbol = strtok(line, separators);
+    char* type = strtok(NULL, separators);
+    char* threshold = strtok(NULL, separators);
+    if (!symbol || !type || strtok(NULL, separators)) return false;
+    if (strlen(symbol) >= sizeof(rule->symbol)) return false;
+
+    int count = sizeof(ruleTypes) / sizeof(ruleTypes[0]);
+    for (int i = 0; i < count; i++) {
+        if (strcasecmp(type, ruleTypes[i].name) != 0) continue;
+        if (ruleTypes[i].needsThreshold != (threshold != NULL)) return false;
+
+        char* end = NULL;
+        rule->threshold = threshold ? strtof(threshold, &end) : 0.0f;
+        if (threshold && (*end != '\0' || end == threshold)) return false;
+
+        snprintf(rule->symbol, sizeof(rule->symbol), "%s", symbol);
+        rule->type = ruleTypes[i].type;
+        return true;
+    }
+    return false;
+}
+
+// Blank lines and # comments are skipped; bad lines are reported and skipped
+static int loadRules(AlertRule* out) {
+    FILE* file = fopen(ALERTS_PATH, "r");
+    if (!file) return 0;
+
+    int count = 0, lineNumber = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0') continue;
+
+        if (count >= MAX_ALERT_RULES) {
+            printf("%s:%d: more than %d rules, ignoring the rest\n", ALERTS_PATH, lineNumber, MAX_ALERT_RULES);
+            break;
+        }
+        if (parseRule(line, &out[count])) count++;
+        else printf("%s:%d: not a rule, skipped\n", ALERTS_PATH, lineNumber);
+    }
+    fclose(file);
+    return count;
+}
+
+void initAlerts() {
+    // Group by symbol so each symbol's rules are one contiguous slice
+    AlertRule sorted[MAX_ALERT_RULES];
+    int count = loadRules(sorted);
+    qsort(sorted, count, sizeof(AlertRule), compareRules);
+
+    for (int i = 0; i < count; i++) {
+        CompiledAlert* compiled = &rules[i];
+        compiled->threshold = sorted[i].threshold;
+        compiled->type = (u8)sorted[i].type;
+        compiled->state = RULE_UNKNOWN;
+        memcpy(ruleSymbols[i], sorted[i].symbol, sizeof(ruleSymbols[i]));
+    }
+    ruleCount = count;
+
+    printf("Alerts: %d rule(s) loaded\n", ruleCount);
+}
+
+int getAlertRuleCount() {
+    return ruleCount;
+}
+
+AlertRange alertsForSymbol(const char* symbol) {
+    AlertRange range = { 0, 0 };
+
+    // Lower bound of the symbol's slice
+    int low = 0, high = ruleCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (strcmp(ruleSymbols[mid], symbol) < 0) low = mid + 1;
+        else high = mid;
+    }
+
+    range.first = (u16)low;
+    while (low < ruleCount && strcmp(ruleSymbols[low], symbol) == 0) low++;
+    range.count = (u16)(low - range.first);
+    return range;
+}
+
+static void fire(const char* symbol, const char* text, u32 color) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s %s", symbol, text);
+    printf("Alert: %s\n", message);
+    showToast(message, color);
+}
+
+void alertsEvaluate(AlertRange range, const char* symbol, const Quote* quote,
+                    const IndicatorValues* values) {
+    char text[48];
+
+    for (int i = range.first; i < range.first + range.count; i++) {
+        CompiledAlert* rule = &rules[i];
+        u8 previous = rule->state;
+        bool met;
+
+        switch (rule->type) {
+            case ALERT_PRICE_ABOVE:
+                met = quote->price >= rule->threshold;
+                if (met && previous != RULE_MET) {
+                    snprintf(text, sizeof(text), "above %.2f ($%.2f)", rule->threshold, quote->price);
+                    fire(symbol, text, COLOR_GREEN);
+                }
+                break;
+
+            case ALERT_PRICE_BELOW:
+                met = quote->price <= rule->threshold;
+                if (met && previous != RULE_MET) {
+                    snprintf(text, sizeof(text), "below %.2f ($%.2f)", rule->threshold, quote->price);
+                    fire(symbol, text, COLOR_RED);
+                }
+                break;
+
+            case ALERT_PERCENT_MOVE:
+                if (quote->prevClose <= 0.0) continue; // no reference yet
+                met = fabs(quote->changePercent) >= rule->threshold;
+                if (met && previous != RULE_MET) {
+                    snprintf(text, sizeof(text), "moved %+.2f%% today", quote->changePercent);
+                    fire(symbol, text, COLOR_ORANGE);
+                }
+                break;
+
+            case ALERT_EMA_CROSS_UP:
+            case ALERT_EMA_CROSS_DOWN:
+                // Only a change of side counts, so the first reading just primes the rule
+                if (!values || !values->emaValid || !values->smaValid) continue;
+                met = values->ema > values->sma;
+                if (previous != RULE_UNKNOWN && met != (previous == RULE_MET)) {
+                    bool up = rule->type == ALERT_EMA_CROSS_UP;
+                    if (met == up) {
+                        snprintf(text, sizeof(text), "EMA%d crossed %s SMA%d",
+                                 IND_EMA_PERIOD, up ? "above" : "below", IND_SMA_PERIOD);
+                        fire(symbol, text, up ? COLOR_GREEN : COLOR_RED);
+                    }
+                }
+                break;
+
+            default:
+                continue;
+        }
+
+        rule->state = met ? RULE_MET : RULE_CLEAR;
+    }
+}
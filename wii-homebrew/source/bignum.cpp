@@ -0,0 +1,669 @@
+#include "bignum.h"
+#include <math.h>
+
+static u32* arena = NULL; // taken by the first bigReset
+static int arenaTop = 0;
+static u32* lastBlock = NULL; // the latest take, which finish can shrink
+static const char* failure = NULL;
+
+void bigReset() {
+    if (!arena) arena = (u32*)malloc(BIG_ARENA_LIMBS * sizeof(u32));
+    arenaTop = 0;
+    lastBlock = NULL;
+    failure = arena ? NULL : "Out of memory";
+}
+
+void bigFreeArena() {
+    free(arena);
+    arena = NULL;
+    arenaTop = 0;
+    lastBlock = NULL;
+}
+
+const char* bigError() {
+    return failure;
+}
+
+int bigMark() {
+    return arenaTop;
+}
+
+static u32* take(int n) {
+    if (!arena || n > BIG_ARENA_LIMBS - arenaTop) {
+        if (!failure) failure = "Out of memory";
+        return NULL;
+    }
+    u32* p = arena + arenaTop;
+    arenaTop += n;
+    lastBlock = p;
+    return p;
+}
+
+static const u32* limbsOf(const BigInt* a) {
+    return a->heap ? a->heap : a->small;
+}
+
+static int trimmed(const u32* r, int n) {
+    while (n > 0 && r[n - 1] == 0) n--;
+    return n;
+}
+
+// Room for a result of up to n limbs: inline when it fits, else fresh
+// arena limbs so an operand that is also the output stays intact
+static u32* reserve(BigInt* out, int n) {
+    out->heap = NULL;
+    out->length = 0;
+    out->negative = false;
+    if (n <= BIG_INLINE_LIMBS) return out->small;
+    if (n > BIG_MAX_LIMBS + 2) {
+        if (!failure) failure = "Number too large";
+        return NULL;
+    }
+    out->heap = take(n);
+    return out->heap;
+}
+
+// Set the length, moving short values back inline. Room reserved for a
+// carry that did not happen goes back to the arena when nothing was
+// taken after it, so small results leave the arena as it was.
+static void finish(BigInt* r, int n, bool negative) {
+    n = trimmed(limbsOf(r), n);
+    if (r->heap && n <= BIG_INLINE_LIMBS) {
+        for (int i = 0; i < n; i++) r->small[i] = r->heap[i];
+        if (r->heap == lastBlock) arenaTop = r->heap - arena;
+        r->heap = NULL;
+    } else if (r->heap && r->heap == lastBlock) {
+        arenaTop = (r->heap - arena) + n;
+    }
+    r->length = n;
+    r->negative = n > 0 && negative;
+}
+
+// Kept values are compacted down to the mark, lowest address first, so
+// every move goes to an address no higher than its source. Copies of one
+// BigInt share limbs, so each alias is repointed.
+void bigRelease(int mark, BigInt* const* keep, int count) {
+    int top = mark;
+    while (true) {
+        BigInt* next = NULL;
+        for (int i = 0; i < count; i++) {
+            BigInt* v = keep[i];
+            if (v->heap && v->heap >= arena + top && (!next || v->heap < next->heap)) next = v;
+        }
+        if (!next) break;
+
+        u32* from = next->heap;
+        int length = next->length;
+        memmove(arena + top, from, length * sizeof(u32));
+        for (int i = 0; i < count; i++) {
+            if (keep[i]->heap == from) keep[i]->heap = arena + top;
+        }
+        top += length;
+    }
+    arenaTop = top;
+    lastBlock = NULL;
+}
+
+// ---- magnitudes ----
+
+static int compareMag(const u32* a, int na, const u32* b, int nb) {
+    if (na != nb) return na < nb ? -1 : 1;
+    for (int i = na - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r[0..na] = a + b with na >= nb
+static void addMag(const u32* a, int na, const u32* b, int nb, u32* r) {
+    u64 carry = 0;
+    for (int i = 0; i < na; i++) {
+        carry += (u64)a[i] + (i < nb ? b[i] : 0);
+        r[i] = (u32)carry;
+        carry >>= 32;
+    }
+    r[na] = (u32)carry;
+}
+
+// r[0..na) = a - b with a >= b
+static void subMag(const u32* a, int na, const u32* b, int nb, u32* r) {
+    s64 borrow = 0;
+    for (int i = 0; i < na; i++) {
+        s64 t = (s64)a[i] - (i < nb ? b[i] : 0) - borrow;
+        borrow = t < 0;
+        r[i] = (u32)(t + (borrow << 32));
+    }
+}
+
+// r[0..nr) += t[0..nt), nt <= nr; the sum fits
+static void addInto(u32* r, int nr, const u32* t, int nt) {
+    u64 carry = 0;
+    int i = 0;
+    for (; i < nt; i++) {
+        carry += (u64)r[i] + t[i];
+        r[i] = (u32)carry;
+        carry >>= 32;
+    }
+    for (; carry && i < nr; i++) {
+        carry += r[i];
+        r[i] = (u32)carry;
+        carry >>= 32;
+    }
+}
+
+// r[0..nr) -= t[0..nt), nt <= nr; r >= t
+static void subFrom(u32* r, int nr, const u32* t, int nt) {
+    s64 borrow = 0;
+    int i = 0;
+    for (; i < nt; i++) {
+        s64 d = (s64)r[i] - t[i] - borrow;
+        borrow = d < 0;
+        r[i] = (u32)(d + (borrow << 32));
+    }
+    for (; borrow && i < nr; i++) {
+        borrow = r[i] == 0;
+        r[i]--;
+    }
+}
+
+static void schoolbook(const u32* a, int na, const u32* b, int nb, u32* r) {
+    memset(r, 0, (na + nb) * sizeof(u32));
+    for (int i = 0; i < na; i++) {
+        u64 ai = a[i], carry = 0;
+        if (ai == 0) continue;
+        for (int j = 0; j < nb; j++) {
+            u64 t = ai * b[j] + r[i + j] + carry;
+            r[i + j] = (u32)t;
+            carry = t >> 32;
+        }
+        r[i + nb] = (u32)carry;
+    }
+}
+
+// r[0..na+nb) = a * b, r apart from a and b. Karatsuba splits both at m
+// limbs: a*b = z2 B^2m + z1 B^m + z0 with z1 = (a0 + a1)(b0 + b1) - z0 - z2,
+// three half-size products instead of four. Temporaries come from the
+// arena and are dropped on return.
+static void mulMag(const u32* a, int na, const u32* b, int nb, u32* r) {
+    if (na < nb) {
+        const u32* t = a; a = b; b = t;
+        int n = na; na = nb; nb = n;
+    }
+    if (nb < BIG_KARATSUBA_LIMBS) {
+        schoolbook(a, na, b, nb, r);
+        return;
+    }
+
+    int mark = arenaTop;
+    int m = (na + 1) / 2;
+    if (nb <= m) {
+        // b is short: a0 b + a1 b B^m
+        u32* t = take(na - m + nb);
+        if (!t) return;
+        mulMag(a, m, b, nb, r);
+        memset(r + m + nb, 0, (na - m) * sizeof(u32));
+        mulMag(a + m, na - m, b, nb, t);
+        addInto(r + m, na + nb - m, t, na - m + nb);
+        arenaTop = mark;
+        return;
+    }
+
+    int na1 = na - m, nb1 = nb - m;
+    mulMag(a, m, b, m, r);                  // z0
+    mulMag(a + m, na1, b + m, nb1, r + 2 * m); // z2
+
+    u32* sa = take(m + 1);
+    u32* sb = take(m + 1);
+    u32* z1 = take(2 * m + 2);
+    if (!sa || !sb || !z1) return;
+    addMag(a, m, a + m, na1, sa);
+    addMag(b, m, b + m, nb1, sb);
+    mulMag(sa, m + 1, sb, m + 1, z1);
+    subFrom(z1, 2 * m + 2, r, 2 * m);
+    subFrom(z1, 2 * m + 2, r + 2 * m, na1 + nb1);
+    addInto(r + m, na + nb - m, z1, trimmed(z1, 2 * m + 2));
+    arenaTop = mark;
+}
+
+static int leadingZeros(u32 x) {
+    int n = 0;
+    while (!(x & 0x80000000u)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+// Knuth's algorithm D for nb >= 2 (after Hacker's Delight): normalise so
+// the divisor's top bit is set, then each quotient limb estimated from the
+// top two limbs is off by at most 2 and fixed by an add-back
+static void divMag(const u32* a, int na, const u32* b, int nb, u32* q, u32* r) {
+    int mark = arenaTop;
+    u32* un = take(na + 1);
+    u32* vn = take(nb);
+    if (!un || !vn) return;
+
+    int s = leadingZeros(b[nb - 1]);
+    for (int i = nb - 1; i > 0; i--) vn[i] = (b[i] << s) | (u32)((u64)b[i - 1] >> (32 - s));
+    vn[0] = b[0] << s;
+    un[na] = (u32)((u64)a[na - 1] >> (32 - s));
+    for (int i = na - 1; i > 0; i--) un[i] = (a[i] << s) | (u32)((u64)a[i - 1] >> (32 - s));
+    un[0] = a[0] << s;
+
+    const u64 base = (u64)1 << 32;
+    for (int j = na - nb; j >= 0; j--) {
+        u64 num = ((u64)un[j + nb] << 32) | un[j + nb - 1];
+        u64 qhat = num / vn[nb - 1];
+        u64 rhat = num - qhat * vn[nb - 1];
+        while (qhat >= base || qhat * vn[nb - 2] > ((rhat << 32) | un[j + nb - 2])) {
+            qhat--;
+            rhat += vn[nb - 1];
+            if (rhat >= base) break;
+        }
+
+        s64 borrow = 0, t;
+        for (int i = 0; i < nb; i++) {
+            u64 p = qhat * vn[i];
+            t = (s64)un[i + j] - borrow - (s64)(p & 0xFFFFFFFFu);
+            un[i + j] = (u32)t;
+            borrow = (s64)(p >> 32) - (t >> 32);
+        }
+        t = (s64)un[j + nb] - borrow;
+        un[j + nb] = (u32)t;
+
+        if (q) q[j] = (u32)qhat;
+        if (t < 0) {
+            if (q) q[j]--;
+            u64 carry = 0;
+            for (int i = 0; i < nb; i++) {
+                carry += (u64)un[i + j] + vn[i];
+                un[i + j] = (u32)carry;
+                carry >>= 32;
+            }
+            un[j + nb] += (u32)carry;
+        }
+    }
+
+    if (r) {
+        for (int i = 0; i < nb; i++) r[i] = (un[i] >> s) | (u32)((u64)un[i + 1] << (32 - s));
+    }
+    arenaTop = mark;
+}
+
+// ---- integers ----
+
+void bigSet(BigInt* out, s64 value) {
+    u64 m = value < 0 ? (u64)0 - (u64)value : (u64)value;
+    out->heap = NULL;
+    out->small[0] = (u32)m;
+    out->small[1] = (u32)(m >> 32);
+    out->length = m == 0 ? 0 : (m >> 32) ? 2 : 1;
+    out->negative = value < 0;
+}
+
+// Nine digits at a time: r = r * 10^k + chunk, in place
+bool bigFromDecimal(BigInt* out, const char* digits, int count) {
+    BigInt r;
+    u32* limbs = reserve(&r, count / 9 + 2);
+    if (!limbs) {
+        bigSet(out, 0);
+        return false;
+    }
+    int length = 0;
+    for (int i = 0; i < count;) {
+        u32 chunk = 0, scale = 1;
+        for (int k = 0; k < 9 && i < count; k++, i++) {
+            if (digits[i] < '0' || digits[i] > '9') return false;
+            chunk = chunk * 10 + (digits[i] - '0');
+            scale *= 10;
+        }
+        u64 carry = chunk;
+        for (int j = 0; j < length; j++) {
+            carry += (u64)limbs[j] * scale;
+            limbs[j] = (u32)carry;
+            carry >>= 32;
+        }
+        if (carry) limbs[length++] = (u32)carry;
+    }
+    finish(&r, length, false);
+    *out = r;
+    return true;
+}
+
+bool bigToInt(const BigInt* a, s64* value) {
+    const u32* limbs = limbsOf(a);
+    if (a->length > 2 || (a->length == 2 && (limbs[1] & 0x80000000u))) return false;
+    u64 m = a->length == 0 ? 0 : a->length == 1 ? limbs[0] : ((u64)limbs[1] << 32) | limbs[0];
+    *value = a->negative ? -(s64)m : (s64)m;
+    return true;
+}
+
+double bigFrexp(const BigInt* a, int* exponent) {
+    const u32* limbs = limbsOf(a);
+    int n = a->length;
+    if (n == 0) {
+        *exponent = 0;
+        return 0.0;
+    }
+    // The top three limbs carry more than a double's 53 bits
+    double m = 0.0;
+    for (int i = n - 1; i >= 0 && i >= n - 3; i--) m = m * 4294967296.0 + limbs[i];
+    int low = n > 3 ? n - 3 : 0;
+    int e;
+    m = frexp(m, &e);
+    *exponent = e + 32 * low;
+    return a->negative ? -m : m;
+}
+
+bool bigIsZero(const BigInt* a) {
+    return a->length == 0;
+}
+
+int bigBits(const BigInt* a) {
+    if (a->length == 0) return 0;
+    return 32 * a->length - leadingZeros(limbsOf(a)[a->length - 1]);
+}
+
+int bigCompareAbs(const BigInt* a, const BigInt* b) {
+    return compareMag(limbsOf(a), a->length, limbsOf(b), b->length);
+}
+
+int bigCompare(const BigInt* a, const BigInt* b) {
+    if (a->negative != b->negative) return a->negative ? -1 : 1;
+    int c = bigCompareAbs(a, b);
+    return a->negative ? -c : c;
+}
+
+void bigNegate(BigInt* a) {
+    if (a->length) a->negative = !a->negative;
+}
+
+// |a| + |b| or |a| - |b| with the given sign for |a|'s side
+static void addSigned(const BigInt* a, const BigInt* b, bool bNegative, BigInt* out) {
+    const BigInt* big = a;
+    const BigInt* little = b;
+    bool bigNegative = a->negative, littleNegative = bNegative;
+    if (bigCompareAbs(a, b) < 0) {
+        big = b;
+        little = a;
+        bigNegative = bNegative;
+        littleNegative = a->negative;
+    }
+
+    BigInt r;
+    int n = big->length;
+    u32* limbs = reserve(&r, n + 1);
+    if (!limbs) {
+        bigSet(out, 0);
+        return;
+    }
+    if (bigNegative == littleNegative) {
+        addMag(limbsOf(big), n, limbsOf(little), little->length, limbs);
+        finish(&r, n + 1, bigNegative);
+    } else {
+        subMag(limbsOf(big), n, limbsOf(little), little->length, limbs);
+        finish(&r, n, bigNegative);
+    }
+    *out = r;
+}
+
+void bigAdd(const BigInt* a, const BigInt* b, BigInt* out) {
+    addSigned(a, b, b->negative, out);
+}
+
+void bigSub(const BigInt* a, const BigInt* b, BigInt* out) {
+    addSigned(a, b, b->length > 0 && !b->negative, out);
+}
+
+void bigMul(const BigInt* a, const BigInt* b, BigInt* out) {
+    if (a->length == 0 || b->length == 0) {
+        bigSet(out, 0);
+        return;
+    }
+    BigInt r;
+    int n = a->length + b->length;
+    u32* limbs = reserve(&r, n);
+    if (!limbs) {
+        bigSet(out, 0);
+        return;
+    }
+    mulMag(limbsOf(a), a->length, limbsOf(b), b->length, limbs);
+    finish(&r, n, a->negative != b->negative);
+    *out = r;
+}
+
+void bigMulSmall(const BigInt* a, u32 m, BigInt* out) {
+    BigInt r;
+    int n = a->length;
+    u32* limbs = reserve(&r, n + 1);
+    if (!limbs) {
+        bigSet(out, 0);
+        return;
+    }
+    const u32* src = limbsOf(a);
+    u64 carry = 0;
+    for (int i = 0; i < n; i++) {
+        carry += (u64)src[i] * m;
+        limbs[i] = (u32)carry;
+        carry >>= 32;
+    }
+    limbs[n] = (u32)carry;
+    finish(&r, n + 1, a->negative);
+    *out = r;
+}
+
+u32 bigDivSmall(const BigInt* a, u32 d, BigInt* q) {
+    BigInt r;
+    int n = a->length;
+    u32* limbs = q ? reserve(&r, n) : NULL;
+    if (q && !limbs && n > 0) {
+        bigSet(q, 0);
+        return 0;
+    }
+    const u32* src = limbsOf(a);
+    u64 rem = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        u64 cur = (rem << 32) | src[i];
+        if (limbs) limbs[i] = (u32)(cur / d);
+        rem = cur % d;
+    }
+    if (q) {
+        finish(&r, n, a->negative);
+        *q = r;
+    }
+    return (u32)rem;
+}
+
+void bigDivMod(const BigInt* a, const BigInt* b, BigInt* q, BigInt* r) {
+    if (b->length == 0) {
+        if (!failure) failure = "Division by zero";
+        if (q) bigSet(q, 0);
+        if (r) bigSet(r, 0);
+        return;
+    }
+    if (bigCompareAbs(a, b) < 0) {
+        if (r) *r = *a;
+        if (q) bigSet(q, 0);
+        return;
+    }
+    bool negative = a->negative != b->negative;
+    bool remNegative = a->negative;
+
+    if (b->length == 1) {
+        BigInt quotient;
+        u32 rem = bigDivSmall(a, limbsOf(b)[0], q ? &quotient : NULL);
+        if (q) {
+            quotient.negative = quotient.length > 0 && negative;
+            *q = quotient;
+        }
+        if (r) {
+            bigSet(r, rem);
+            r->negative = rem != 0 && remNegative;
+        }
+        return;
+    }
+
+    int na = a->length, nb = b->length;
+    BigInt quotient, remainder;
+    u32* ql = q ? reserve(&quotient, na - nb + 1) : NULL;
+    u32* rl = r ? reserve(&remainder, nb) : NULL;
+    if ((q && !ql) || (r && !rl)) {
+        if (q) bigSet(q, 0);
+        if (r) bigSet(r, 0);
+        return;
+    }
+    divMag(limbsOf(a), na, limbsOf(b), nb, ql, rl);
+    if (q) {
+        finish(&quotient, na - nb + 1, negative);
+        *q = quotient;
+    }
+    if (r) {
+        finish(&remainder, nb, remNegative);
+        *r = remainder;
+    }
+}
+
+void bigShift(const BigInt* a, int bits, BigInt* out) {
+    if (a->length == 0 || bits == 0) {
+        *out = *a;
+        return;
+    }
+    const u32* src = limbsOf(a);
+    int n = a->length;
+    BigInt r;
+
+    if (bits > 0) {
+        int limbShift = bits / 32, bitShift = bits % 32;
+        u32* limbs = reserve(&r, n + limbShift + 1);
+        if (!limbs) {
+            bigSet(out, 0);
+            return;
+        }
+        memset(limbs, 0, limbShift * sizeof(u32));
+        limbs[n + limbShift] = (u32)((u64)src[n - 1] >> (32 - bitShift));
+        for (int i = n - 1; i > 0; i--) {
+            limbs[i + limbShift] = (src[i] << bitShift) | (u32)((u64)src[i - 1] >> (32 - bitShift));
+        }
+        limbs[limbShift] = src[0] << bitShift;
+        finish(&r, n + limbShift + 1, a->negative);
+    } else {
+        int limbShift = -bits / 32, bitShift = -bits % 32;
+        if (limbShift >= n) {
+            bigSet(out, 0);
+            return;
+        }
+        int m = n - limbShift;
+        u32* limbs = reserve(&r, m);
+        if (!limbs) {
+            bigSet(out, 0);
+            return;
+        }
+        for (int i = 0; i < m; i++) {
+            u32 high = i + limbShift + 1 < n ? src[i + limbShift + 1] : 0;
+            limbs[i] = (src[i + limbShift] >> bitShift) | (u32)((u64)high << (32 - bitShift));
+        }
+        finish(&r, m, a->negative);
+    }
+    *out = r;
+}
+
+void bigGcd(const BigInt* a, const BigInt* b, BigInt* out) {
+    BigInt x = *a, y = *b;
+    x.negative = y.negative = false;
+    int mark = bigMark();
+    BigInt* keep[] = { &x, &y };
+    while (y.length > 0 && !failure) {
+        BigInt r;
+        bigDivMod(&x, &y, NULL, &r);
+        x = y;
+        y = r;
+        bigRelease(mark, keep, 2);
+    }
+    *out = x;
+}
+
+void bigPow(const BigInt* a, u32 n, BigInt* out) {
+    // The result has at least (bits - 1) n + 1 bits
+    if ((double)(bigBits(a) - 1) * n > 32.0 * BIG_MAX_LIMBS) {
+        if (!failure) failure = "Number too large";
+        bigSet(out, 0);
+        return;
+    }
+    BigInt result, base = *a;
+    bigSet(&result, 1);
+    while (n > 0 && !failure) {
+        if (n & 1) bigMul(&result, &base, &result);
+        n >>= 1;
+        if (n) bigMul(&base, &base, &base);
+    }
+    *out = result;
+}
+
+// Newton from above: x = (x + a / x) / 2 falls until it reaches floor(sqrt a)
+void bigSqrt(const BigInt* a, BigInt* out) {
+    if (a->length == 0) {
+        bigSet(out, 0);
+        return;
+    }
+    BigInt x, y;
+    bigSet(&x, 1);
+    bigShift(&x, (bigBits(a) + 1) / 2, &x);
+
+    int mark = bigMark();
+    BigInt* keep[] = { &x };
+    while (!failure) {
+        bigDivMod(a, &x, &y, NULL);
+        bigAdd(&y, &x, &y);
+        bigShift(&y, -1, &y);
+        if (bigCompare(&y, &x) >= 0) break;
+        x = y;
+        bigRelease(mark, keep, 1);
+    }
+    *out = x;
+}
+
+// Groups of nine digits by repeated division by 10^9, lowest first
+int bigToDecimal(const BigInt* a, char* out, int size) {
+    if (a->length == 0) {
+        if (size > 1) snprintf(out, size, "0");
+        return 1;
+    }
+
+    int mark = arenaTop;
+    int n = a->length;
+    u32* t = take(n);
+    u32* groups = take(n * 32 / 29 + 2);
+    if (!t || !groups) {
+        if (size > 0) out[0] = '\0';
+        return 0;
+    }
+    memcpy(t, limbsOf(a), n * sizeof(u32));
+
+    int count = 0;
+    while (n > 0) {
+        u64 rem = 0;
+        for (int i = n - 1; i >= 0; i--) {
+            u64 cur = (rem << 32) | t[i];
+            t[i] = (u32)(cur / 1000000000u);
+            rem = cur % 1000000000u;
+        }
+        groups[count++] = (u32)rem;
+        n = trimmed(t, n);
+    }
+
+    char group[16];
+    int length = 0;
+    if (a->negative) {
+        if (length < size - 1) out[length] = '-';
+        length++;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        int k = snprintf(group, sizeof(group), i == count - 1 ? "%u" : "%09u", (unsigned)groups[i]);
+        for (int j = 0; j < k; j++, length++) {
+            if (length < size - 1) out[length] = group[j];
+        }
+    }
+    if (size > 0) out[length < size - 1 ? length : size - 1] = '\0';
+    arenaTop = mark;
+    return length;
+}
@@ -1,15 +1,19 @@
 #include "calculator.h"
 #include "graphics.h"
 #include "input.h"
+#include "expr.h"
+#include "graphview.h"
+#include "solver.h"
+#include "calculus.h"
+#include "exact.h"
 #include <math.h>
 #include <ctype.h>
 
 #define MAX_INPUT 256
 #define MAX_HISTORY 10
-#define GRAPH_WIDTH 400
-#define GRAPH_HEIGHT 300
-#define GRAPH_X 120
-#define GRAPH_Y 120
+#define DISPLAY_CHARS 40    // of a result on the main display
+#define PANEL_CHARS 72      // per line of the exact result panel
+#define PANEL_LINES 6
 
 // Calculator state
 static CalculatorMode currentMode = CALC_MODE_BASIC;
@@ -19,14 +23,27 @@ static char historyBuffer[MAX_HISTORY][MAX_INPUT];
 static int historyCount = 0;
 static int cursorPos = 0;
 static bool shiftPressed = false;
+static ExprAngleMode angleMode = EXPR_DEGREES;
 
-// Graph data
-static double graphPoints[GRAPH_WIDTH];
-static bool graphValid = false;
-static double graphMinX = -10.0;
-static double graphMaxX = 10.0;
-static double graphMinY = -10.0;
-static double graphMaxY = 10.0;
+// Compiled once per "="
+static ExprProgram program;
+
+// Mode to return to when B leaves the graph
+static CalculatorMode keyboardMode = CALC_MODE_BASIC;
+static bool waitBRelease = false; // B that left the graph is still down
+
+// Input being solved or integrated, for its history entry
+static char pendingBuffer[MAX_INPUT];
+static char calculusNote[64]; // error bound and evaluations of the last ∫/Σ
+
+// Exact mode (Wiimote +): big integers and fractions, and irrational
+// results to a chosen number of digits (1 and 2 change it)
+static bool exactMode = false;
+static const int exactDigitChoices[] = {20, 50, 100, 200, 500, 1000};
+static int exactDigitIndex = 1;
+static ExactResult exactResult;
+static bool exactShown = false; // the panel holds the last result
+static int exactShownDigits;    // its precision
 
 // Virtual keyboard
 static const char* buttons[] = {
@@ -36,6 +53,19 @@ static const char* buttons[] = {
     "0", ".", "=", "+", "(", ")",
     "C", "DEL", "MODE", "GRAPH", "π", "e"
 };
+// Second layer, toggled by the Wiimote - button; NULL keeps the first
+// (";" separates plots; "y", "t", "θ", "," and "=" write the other kinds;
+// ∫ and Σ take "f, a, b")
+static const char* shiftButtons[] = {
+    NULL, NULL, NULL, ";", "asin", "acos",
+    NULL, NULL, NULL, ",", "atan", "ln",
+    NULL, NULL, NULL, "y", "abs", "!",
+    NULL, "θ", "=", "t", "∫", "Σ",
+    NULL, NULL, NULL, NULL, "x", "exp"
+};
+static const char* functionKeys[] = {
+    "sin", "cos", "tan", "asin", "acos", "atan", "log", "ln", "sqrt", "abs", "exp", "∫", "Σ"
+};
 static const int numButtons = 30;
 static int selectedButton = 0;
 
@@ -59,11 +89,11 @@ void initCalculator() {
     cursorPos = 0;
     historyCount = 0;
     currentMode = CALC_MODE_BASIC;
-    graphValid = false;
+    graphClear();
 }
 
 void cleanupCalculator() {
-    // Nothing to cleanup
+    cleanupExact();
 }
 
 // Helper function to append to input
@@ -83,13 +113,15 @@ void clearInput() {
     cursorPos = 0;
 }
 
-// Helper function to delete last character
+// Helper function to delete last character (a whole UTF-8 sequence, e.g. π)
 void deleteLastChar() {
     int len = strlen(inputBuffer);
     if (len > 0) {
-        inputBuffer[len - 1] = '\0';
-        cursorPos = len - 1;
-        if (len == 1) {
+        len--;
+        while (len > 0 && (inputBuffer[len] & 0xC0) == 0x80) len--;
+        inputBuffer[len] = '\0';
+        cursorPos = len;
+        if (len == 0) {
             strcpy(displayBuffer, "0");
         } else {
             strcpy(displayBuffer, inputBuffer);
@@ -98,18 +130,6 @@ void deleteLastChar() {
 }
 
 // Math functions implementation
-double calcSin(double x) {
-    return sin(x * M_PI / 180.0); // Convert degrees to radians
-}
-
-double calcCos(double x) {
-    return cos(x * M_PI / 180.0);
-}
-
-double calcTan(double x) {
-    return tan(x * M_PI / 180.0);
-}
-
 double calcLog(double x) {
     return log10(x);
 }
@@ -136,160 +156,130 @@ double calcFactorial(int n) {
     return result;
 }
 
-// Simple expression evaluator (supports basic operations and functions)
+// Compile and evaluate; NAN if the expression does not parse
 double evaluateExpression(const char* expr) {
-    // This is a simplified evaluator
-    // In a real implementation, you'd want a proper parser with operator precedence
-    
-    char tempExpr[MAX_INPUT];
-    strncpy(tempExpr, expr, MAX_INPUT - 1);
-    tempExpr[MAX_INPUT - 1] = '\0';
-    
-    // Replace constants
-    char* pi = strstr(tempExpr, "π");
-    if (pi) {
-        // Replace π with numeric value
-        // This is simplified - real implementation would be more robust
-    }
+    if (!exprCompile(&program, expr, angleMode)) return NAN;
     
-    // Try to evaluate as simple number first
-    char* endptr;
-    double result = strtod(tempExpr, &endptr);
-    
-    // If entire string was converted, return result
-    if (*endptr == '\0') {
-        return result;
-    }
-    
-    // Otherwise, try basic operations
-    // Look for operators in reverse order of precedence
-    
-    // Addition/Subtraction
-    for (int i = strlen(tempExpr) - 1; i >= 0; i--) {
-        if (tempExpr[i] == '+' && i > 0) {
-            tempExpr[i] = '\0';
-            return evaluateExpression(tempExpr) + evaluateExpression(tempExpr + i + 1);
-        }
-        if (tempExpr[i] == '-' && i > 0) {
-            tempExpr[i] = '\0';
-            return evaluateExpression(tempExpr) - evaluateExpression(tempExpr + i + 1);
+    double vars[EXPR_VAR_COUNT] = {0};
+    return exprEval(&program, vars);
+}
+
+// Graph plotting function
+void plotFunction(const char* function) {
+    graphPlot(function, angleMode, displayBuffer, sizeof(displayBuffer));
+}
+
+void clearGraph() {
+    graphClear();
+}
+
+static const char* buttonLabel(int index) {
+    return (shiftPressed && shiftButtons[index]) ? shiftButtons[index] : buttons[index];
+}
+
+// Log "expression = display"; a long expression is cut so the value shows
+static void addHistory(const char* expression, const char* note) {
+    if (historyCount < MAX_HISTORY) {
+        int noteChars = sizeof(calculusNote) - 1;
+        if (note[0]) {
+            snprintf(historyBuffer[historyCount], MAX_INPUT, "%.*s = %.*s (%.*s)",
+                     MAX_INPUT - 7 - DISPLAY_CHARS - noteChars, expression, DISPLAY_CHARS, displayBuffer,
+                     noteChars, note);
+        } else {
+            snprintf(historyBuffer[historyCount], MAX_INPUT, "%.*s = %.*s",
+                     MAX_INPUT - 4 - DISPLAY_CHARS, expression, DISPLAY_CHARS, displayBuffer);
         }
+        historyCount++;
     }
-    
-    // Multiplication/Division
-    for (int i = strlen(tempExpr) - 1; i >= 0; i--) {
-        if (tempExpr[i] == '*') {
-            tempExpr[i] = '\0';
-            return evaluateExpression(tempExpr) * evaluateExpression(tempExpr + i + 1);
-        }
-        if (tempExpr[i] == '/') {
-            tempExpr[i] = '\0';
-            double divisor = evaluateExpression(tempExpr + i + 1);
-            if (divisor == 0) return 0; // Division by zero
-            return evaluateExpression(tempExpr) / divisor;
-        }
+}
+
+// Show a result, log it and keep it as the input for the next calculation
+static void showResult(const char* expression, double result, const char* note) {
+    exactShown = false;
+    if (isinf(result)) {
+        snprintf(displayBuffer, sizeof(displayBuffer), "ERROR: Overflow (+ for exact mode)");
+        return;
     }
-    
-    // Power
-    char* powerOp = strrchr(tempExpr, '^');
-    if (powerOp) {
-        *powerOp = '\0';
-        return calcPower(evaluateExpression(tempExpr), evaluateExpression(powerOp + 1));
+    if (!isfinite(result)) {
+        snprintf(displayBuffer, sizeof(displayBuffer), "ERROR: Math error");
+        return;
     }
+    snprintf(displayBuffer, sizeof(displayBuffer), "%.8g", result);
+    addHistory(expression, note);
     
-    // Functions
-    if (strncmp(tempExpr, "sin(", 4) == 0) {
-        char* end = strchr(tempExpr, ')');
-        if (end) {
-            *end = '\0';
-            return calcSin(evaluateExpression(tempExpr + 4));
-        }
+    // Set input to result for continued calculation
+    snprintf(inputBuffer, MAX_INPUT, "%s", displayBuffer);
+    cursorPos = strlen(inputBuffer);
+}
+
+// The same for exact mode: all of the value goes to the panel, and to the
+// input when it fits there (a fraction in parentheses, so "^2" squares it)
+static void showExactResult(const char* expression) {
+    const ExactResult* r = &exactResult;
+    exactShown = true;
+    exactShownDigits = exactDigitChoices[exactDigitIndex];
+    snprintf(displayBuffer, sizeof(displayBuffer), "%.*s", MAX_INPUT - 1,
+             strlen(r->text) <= DISPLAY_CHARS ? r->text : r->summary);
+    addHistory(expression, "");
+
+    if (r->fraction && strlen(r->text) + 2 < MAX_INPUT) {
+        snprintf(inputBuffer, MAX_INPUT, "(%.*s)", MAX_INPUT - 3, r->text);
+    } else {
+        snprintf(inputBuffer, MAX_INPUT, "%.*s", MAX_INPUT - 1, strlen(r->text) < MAX_INPUT ? r->text : r->summary);
     }
-    
-    if (strncmp(tempExpr, "cos(", 4) == 0) {
-        char* end = strchr(tempExpr, ')');
-        if (end) {
-            *end = '\0';
-            return calcCos(evaluateExpression(tempExpr + 4));
-        }
+    cursorPos = strlen(inputBuffer);
+}
+
+static bool isFunctionKey(const char* btn) {
+    for (unsigned i = 0; i < sizeof(functionKeys) / sizeof(functionKeys[0]); i++) {
+        if (strcmp(btn, functionKeys[i]) == 0) return true;
     }
+    return false;
+}
+
+void updateCalculator() {
+    InputState* input = getInput();
     
-    if (strncmp(tempExpr, "tan(", 4) == 0) {
-        char* end = strchr(tempExpr, ')');
-        if (end) {
-            *end = '\0';
-            return calcTan(evaluateExpression(tempExpr + 4));
+    // B button to go back: from the graph to the keyboard, then out
+    if (!input->bButton) waitBRelease = false;
+    if (input->bButton && !waitBRelease) {
+        if (currentMode == CALC_MODE_GRAPHING && graphIsValid()) {
+            currentMode = keyboardMode;
+            waitBRelease = true;
+            return;
         }
+        solverCancel();
+        calculusCancel();
+        changeScene(SCENE_DASHBOARD);
+        return;
     }
     
-    if (strncmp(tempExpr, "sqrt(", 5) == 0) {
-        char* end = strchr(tempExpr, ')');
-        if (end) {
-            *end = '\0';
-            return calcSqrt(evaluateExpression(tempExpr + 5));
+    // The solver runs a share per frame until it is done
+    if (solverBusy()) {
+        solverStep();
+        if (!solverBusy() && historyCount < MAX_HISTORY) {
+            char roots[MAX_INPUT / 2];
+            solverSummary(roots, sizeof(roots));
+            snprintf(historyBuffer[historyCount], MAX_INPUT, "%.*s: %s", MAX_INPUT / 2 - 2, pendingBuffer, roots);
+            historyCount++;
         }
     }
     
-    if (strncmp(tempExpr, "log(", 4) == 0) {
-        char* end = strchr(tempExpr, ')');
-        if (end) {
-            *end = '\0';
-            return calcLog(evaluateExpression(tempExpr + 4));
+    // Integrals and sums too; their value replaces the input when done
+    if (calculusBusy()) {
+        calculusStep();
+        if (!calculusBusy() && calculusError()) {
+            snprintf(displayBuffer, sizeof(displayBuffer), "ERROR: %s", calculusError());
+        } else if (!calculusBusy()) {
+            double vars[EXPR_VAR_COUNT] = {0};
+            calculusStatus(calculusNote, sizeof(calculusNote));
+            showResult(pendingBuffer, exprEval(&program, vars), calculusNote);
         }
     }
     
-    return result;
-}
-
-// Graph plotting function
-void plotFunction(const char* function) {
-    graphValid = false;
-    
-    // Evaluate function at each x point
-    for (int i = 0; i < GRAPH_WIDTH; i++) {
-        double x = graphMinX + (graphMaxX - graphMinX) * i / GRAPH_WIDTH;
-        
-        // Replace 'x' in function with actual value
-        char expr[MAX_INPUT];
-        snprintf(expr, sizeof(expr), "%s", function);
-        
-        // Simple substitution (in real implementation, use proper parser)
-        char numStr[32];
-        snprintf(numStr, sizeof(numStr), "%.4f", x);
-        
-        // For now, evaluate y = x^2 as example
-        // In full implementation, parse and evaluate the function string
-        double y = x * x; // Placeholder
-        
-        graphPoints[i] = y;
-    }
-    
-    // Calculate Y range
-    graphMinY = graphPoints[0];
-    graphMaxY = graphPoints[0];
-    for (int i = 1; i < GRAPH_WIDTH; i++) {
-        if (graphPoints[i] < graphMinY) graphMinY = graphPoints[i];
-        if (graphPoints[i] > graphMaxY) graphMaxY = graphPoints[i];
-    }
-    
-    // Add padding
-    double range = graphMaxY - graphMinY;
-    graphMinY -= range * 0.1;
-    graphMaxY += range * 0.1;
-    
-    graphValid = true;
-}
-
-void clearGraph() {
-    graphValid = false;
-}
-
-void updateCalculator() {
-    InputState* input = getInput();
-    
-    // B button to go back
-    if (input->bButton) {
-        changeScene(SCENE_DASHBOARD);
+    // The plot takes over the screen and the Wiimote
+    if (currentMode == CALC_MODE_GRAPHING && graphIsValid()) {
+        graphUpdate();
         return;
     }
     
@@ -331,28 +321,66 @@ void updateCalculator() {
         }
     }
     
+    // Wiimote - toggles the shift layer
+    if (input->minusButton) {
+        shiftPressed = !shiftPressed;
+    }
+    
+    // + toggles exact mode, 1 and 2 step its digits
+    int digitCount = sizeof(exactDigitChoices) / sizeof(exactDigitChoices[0]);
+    if (input->plusButton) {
+        exactMode = !exactMode;
+        if (!exactMode) cleanupExact(); // 2 MB back until it is used again
+    }
+    if (exactMode && input->oneButton && exactDigitIndex > 0) exactDigitIndex--;
+    if (exactMode && input->twoButton && exactDigitIndex < digitCount - 1) exactDigitIndex++;
+    
     // A button to press selected button
     if (input->pressed) {
-        const char* btn = buttons[selectedButton];
+        const char* btn = buttonLabel(selectedButton);
+        bool shifted = (btn != buttons[selectedButton]);
+        shiftPressed = false; // shift applies to one key
         
-        if (strcmp(btn, "=") == 0) {
-            // Evaluate expression
-            double result = evaluateExpression(inputBuffer);
-            snprintf(displayBuffer, sizeof(displayBuffer), "%.8g", result);
-            
-            // Add to history
-            if (historyCount < MAX_HISTORY) {
-                snprintf(historyBuffer[historyCount], MAX_INPUT, "%s = %s", 
-                         inputBuffer, displayBuffer);
-                historyCount++;
+        // The input is replaced when an integral or sum finishes
+        if (calculusBusy() && strcmp(btn, "C") != 0) return;
+        
+        if (strcmp(btn, "=") == 0 && !shifted && currentMode == CALC_MODE_EQUATION) {
+            // Solve; the shifted key writes the "=" of the equation
+            if (solverStart(inputBuffer, angleMode, displayBuffer, sizeof(displayBuffer))) {
+                strcpy(pendingBuffer, inputBuffer);
             }
             
-            // Set input to result for continued calculation
-            strncpy(inputBuffer, displayBuffer, MAX_INPUT - 1);
-            cursorPos = strlen(inputBuffer);
+        } else if (strcmp(btn, "=") == 0 && !shifted) {
+            // Evaluate expression
+            if (!exprCompile(&program, inputBuffer, angleMode)) {
+                snprintf(displayBuffer, sizeof(displayBuffer), "ERROR: %s", program.error);
+                return;
+            }
+            calculusNote[0] = '\0';
+            if (program.calculusCount > 0) {
+                // Computed over the next frames
+                if (calculusStart(&program, displayBuffer, sizeof(displayBuffer))) {
+                    solverCancel();
+                    strcpy(pendingBuffer, inputBuffer);
+                }
+                return;
+            }
+            if (exactMode) {
+                if (exactEvaluate(&program, inputBuffer, exactDigitChoices[exactDigitIndex],
+                                  &exactResult, displayBuffer, sizeof(displayBuffer))) {
+                    showExactResult(inputBuffer);
+                }
+                return;
+            }
+            double vars[EXPR_VAR_COUNT] = {0};
+            showResult(inputBuffer, exprEval(&program, vars), "");
             
         } else if (strcmp(btn, "C") == 0) {
             clearInput();
+            solverCancel();
+            calculusCancel();
+            calculusNote[0] = '\0';
+            exactShown = false;
             
         } else if (strcmp(btn, "DEL") == 0) {
             deleteLastChar();
@@ -363,18 +391,11 @@ void updateCalculator() {
             
         } else if (strcmp(btn, "GRAPH") == 0) {
             // Switch to graph mode and plot current expression
+            if (currentMode != CALC_MODE_GRAPHING) keyboardMode = currentMode;
             currentMode = CALC_MODE_GRAPHING;
             plotFunction(inputBuffer);
             
-        } else if (strcmp(btn, "π") == 0) {
-            appendInput("3.14159265");
-            
-        } else if (strcmp(btn, "e") == 0) {
-            appendInput("2.71828183");
-            
-        } else if (strcmp(btn, "sin") == 0 || strcmp(btn, "cos") == 0 || 
-                   strcmp(btn, "tan") == 0 || strcmp(btn, "log") == 0 ||
-                   strcmp(btn, "sqrt") == 0) {
+        } else if (isFunctionKey(btn)) {
             appendInput(btn);
             appendInput("(");
             
@@ -384,12 +405,54 @@ void updateCalculator() {
     }
 }
 
+// The last exact result wrapped over the lines under the display. A
+// fraction is followed by its decimal value; text that does not fit keeps
+// its start and its last digits.
+static void renderExactPanel(float x, float y) {
+    const ExactResult* r = &exactResult;
+    char heading[64];
+    if (r->exact && r->fraction) {
+        snprintf(heading, sizeof(heading), "Exact fraction:");
+    } else if (r->exact && (int)strlen(r->text) < r->integerDigits) {
+        snprintf(heading, sizeof(heading), "Integer of %d digits, the first %d shown:",
+                 r->integerDigits, exactShownDigits);
+    } else if (r->exact) {
+        snprintf(heading, sizeof(heading), "Exact integer, %d digits:", r->integerDigits);
+    } else {
+        snprintf(heading, sizeof(heading), "Rounded to %d significant digits:", exactShownDigits);
+    }
+    drawText(x, y, heading, COLOR_CYAN, 0.8f);
+
+    static char text[EXACT_MAX_TEXT + EXACT_MAX_DIGITS + 40];
+    if (r->fraction) snprintf(text, sizeof(text), "%s \xE2\x89\x88 %s", r->text, r->decimal); // ≈
+    else snprintf(text, sizeof(text), "%s", r->text);
+
+    int length = strlen(text);
+    int lines = (length + PANEL_CHARS - 1) / PANEL_CHARS;
+    char line[PANEL_CHARS + 8];
+    for (int i = 0; i < lines && i < PANEL_LINES; i++) {
+        const char* start = text + i * PANEL_CHARS;
+        if (i == PANEL_LINES - 1 && lines > PANEL_LINES) {
+            // "... " and the end of the text
+            snprintf(line, sizeof(line), "... %s", text + length - (PANEL_CHARS - 4));
+        } else {
+            snprintf(line, sizeof(line), "%.*s", PANEL_CHARS, start);
+        }
+        drawText(x, y + 20 + i * 20, line, COLOR_WHITE, 0.8f);
+    }
+}
+
 void renderCalculator() {
     // Draw title
     const char* modeNames[] = {"Basic", "Scientific", "Graphing", "Equation"};
     char title[64];
     snprintf(title, sizeof(title), "Calculator - %s Mode", modeNames[currentMode]);
     drawText(200, 20, title, COLOR_WHITE, 1.5f);
+    if (exactMode) {
+        char note[32];
+        snprintf(note, sizeof(note), "Exact: %d digits", exactDigitChoices[exactDigitIndex]);
+        drawText(470, 44, note, COLOR_CYAN, 0.8f);
+    }
     
     // Draw display area
     drawGlassRectangle(40, 60, 560, 60, COLOR_GLASS_MEDIUM);
@@ -401,55 +464,32 @@ void renderCalculator() {
         drawRectangle(cursorX, 95, 2, 20, COLOR_CYAN);
     }
     
-    // Draw history
-    drawText(40, 130, "History:", COLOR_GRAY, 0.8f);
-    for (int i = 0; i < historyCount && i < 3; i++) {
-        drawText(120, 130 + i * 20, historyBuffer[historyCount - 1 - i], 
-                 COLOR_GRAY, 0.7f);
+    if (currentMode == CALC_MODE_GRAPHING && graphIsValid()) {
+        graphRender();
+        drawText(50, 455, "D-Pad/Drag: Pan | 1/2: Zoom | +: f' | B: Keys", COLOR_WHITE, 0.8f);
+        return;
     }
     
-    if (currentMode == CALC_MODE_GRAPHING && graphValid) {
-        // Draw graph area
-        drawGlassRectangle(GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT, 0x000000AA);
-        
-        // Draw axes
-        // X-axis
-        float yZero = GRAPH_Y + GRAPH_HEIGHT / 2;
-        drawRectangle(GRAPH_X, yZero, GRAPH_WIDTH, 1, COLOR_WHITE);
-        
-        // Y-axis
-        float xZero = GRAPH_X + GRAPH_WIDTH / 2;
-        drawRectangle(xZero, GRAPH_Y, 1, GRAPH_HEIGHT, COLOR_WHITE);
-        
-        // Draw function
-        for (int i = 0; i < GRAPH_WIDTH - 1; i++) {
-            float y1 = graphPoints[i];
-            float y2 = graphPoints[i + 1];
-            
-            // Convert to screen coordinates
-            float screenY1 = GRAPH_Y + GRAPH_HEIGHT - 
-                           (y1 - graphMinY) / (graphMaxY - graphMinY) * GRAPH_HEIGHT;
-            float screenY2 = GRAPH_Y + GRAPH_HEIGHT - 
-                           (y2 - graphMinY) / (graphMaxY - graphMinY) * GRAPH_HEIGHT;
-            
-            // Clamp to graph area
-            if (screenY1 < GRAPH_Y) screenY1 = GRAPH_Y;
-            if (screenY1 > GRAPH_Y + GRAPH_HEIGHT) screenY1 = GRAPH_Y + GRAPH_HEIGHT;
-            if (screenY2 < GRAPH_Y) screenY2 = GRAPH_Y;
-            if (screenY2 > GRAPH_Y + GRAPH_HEIGHT) screenY2 = GRAPH_Y + GRAPH_HEIGHT;
-            
-            // Draw line segment (approximate with rectangles)
-            float x = GRAPH_X + i;
-            drawRectangle(x, screenY1, 1, 2, COLOR_CYAN);
+    // Draw history, or the roots of the equation being solved
+    if (currentMode == CALC_MODE_EQUATION && solverHasResult()) {
+        solverRender(40, 130);
+    } else if (exactMode && exactShown) {
+        renderExactPanel(40, 130);
+    } else {
+        // Progress, then accuracy, of an integral or sum above the history
+        float historyY = 130;
+        if (calculusBusy() || calculusNote[0]) {
+            char status[96];
+            if (calculusBusy()) calculusStatus(status, sizeof(status));
+            else snprintf(status, sizeof(status), "%s", calculusNote);
+            drawText(40, 130, status, calculusBusy() ? COLOR_ORANGE : COLOR_CYAN, 0.8f);
+            historyY += 20;
+        }
+        drawText(40, historyY, "History:", COLOR_GRAY, 0.8f);
+        for (int i = 0; i < historyCount && i < 3; i++) {
+            drawText(120, historyY + i * 20, historyBuffer[historyCount - 1 - i], 
+                     COLOR_GRAY, 0.7f);
         }
-        
-        // Draw graph labels
-        char labelStr[32];
-        snprintf(labelStr, sizeof(labelStr), "X: %.2f to %.2f", graphMinX, graphMaxX);
-        drawText(GRAPH_X, GRAPH_Y + GRAPH_HEIGHT + 10, labelStr, COLOR_WHITE, 0.6f);
-        
-        snprintf(labelStr, sizeof(labelStr), "Y: %.2f to %.2f", graphMinY, graphMaxY);
-        drawText(GRAPH_X, GRAPH_Y + GRAPH_HEIGHT + 25, labelStr, COLOR_WHITE, 0.6f);
     }
     
     // Draw virtual keyboard
@@ -463,12 +503,20 @@ void renderCalculator() {
         
         drawGlassRectangle(x, y, buttonWidth, buttonHeight, btnColor);
         
-        // Center text in button
-        float textX = x + buttonWidth / 2 - strlen(buttons[i]) * 4;
+        // Center text in button; shifted labels in orange
+        const char* label = buttonLabel(i);
+        u32 textColor = (label != buttons[i]) ? COLOR_ORANGE : COLOR_WHITE;
+        float textX = x + buttonWidth / 2 - strlen(label) * 4;
         float textY = y + buttonHeight / 2 - 8;
-        drawText(textX, textY, buttons[i], COLOR_WHITE, 1.0f);
+        drawText(textX, textY, label, textColor, 1.0f);
     }
     
     // Instructions
-    drawText(50, 455, "IR/D-Pad: Select | A: Press Button | B: Back", COLOR_WHITE, 0.8f);
+    if (currentMode == CALC_MODE_EQUATION) {
+        drawText(50, 455, "A: Press | -: Shift (=, y, ;) | =: Solve | C: Clear | B: Back", COLOR_WHITE, 0.8f);
+    } else {
+        drawText(50, 455, exactMode ? "A: Press | -: Shift | +: Exact off | 1/2: Digits | B: Back"
+                                    : "IR/D-Pad: Select | A: Press | -: Shift | +: Exact | B: Back",
+                 COLOR_WHITE, 0.8f);
+    }
 }
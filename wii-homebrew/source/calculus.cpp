@@ -0,0 +1,347 @@
+#include "calculus.h"
+#include <ogc/lwp_watchdog.h>
+#include <math.h>
+#include <float.h>
+
+#define CALCULUS_BUDGET_US 4000 // work per frame
+#define PANEL_POINTS 15
+#define PANEL_SPLITS 2          // halved per batch: 4 new panels, 60 points
+
+// Integral over [a, b] from one 15-point rule
+typedef struct {
+    double a, b;
+    double value;
+    double error;
+    double magnitude; // integral of |f|, for the rounding floor
+} Panel;
+
+// Kronrod abscissae (the odd ones are the 7-point Gauss nodes) and weights
+static const double kronrodNodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0
+};
+static const double kronrodWeights[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+static const double gaussWeights[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+static ExprProgram* target = NULL;
+static int current;          // operator in progress
+static bool busy = false;
+static const char* failure = NULL;
+static ExprProgram body;     // its integrand or term, in x
+static double lower, upper;
+static double errorBound;
+static double evaluations;
+static bool limited;         // an integral ran out of panels
+
+// Integral
+static Panel panels[CALCULUS_MAX_PANELS];
+static int panelCount;
+
+// Sum
+static double nextTerm;
+static double sum, compensation, sumAbs;
+
+static bool overBudget(u64 start) {
+    return ticks_to_microsecs(gettime() - start) >= CALCULUS_BUDGET_US;
+}
+
+// One batch for up to 4 panels: the centre first, then the pairs
+// centre -+ h * node
+static bool evalPanels(const double* as, const double* bs, int count, Panel* out) {
+    double xs[EXPR_LANES], fs[EXPR_LANES];
+    double vars[EXPR_VAR_COUNT] = {0};
+
+    for (int k = 0; k < count; k++) {
+        double centre = 0.5 * (as[k] + bs[k]), half = 0.5 * (bs[k] - as[k]);
+        double* x = xs + k * PANEL_POINTS;
+        x[0] = centre;
+        for (int j = 0; j < 7; j++) {
+            x[1 + 2 * j] = centre - half * kronrodNodes[j];
+            x[2 + 2 * j] = centre + half * kronrodNodes[j];
+        }
+    }
+    int n = count * PANEL_POINTS;
+    exprEvalBatch(&body, vars, EXPR_VAR_X, xs, fs, n);
+    evaluations += n;
+
+    for (int k = 0; k < count; k++) {
+        const double* f = fs + k * PANEL_POINTS;
+        double half = 0.5 * (bs[k] - as[k]);
+        for (int j = 0; j < PANEL_POINTS; j++) {
+            if (!isfinite(f[j])) {
+                failure = "Integrand not finite";
+                return false;
+            }
+        }
+
+        double kronrod = f[0] * kronrodWeights[7];
+        double gauss = f[0] * gaussWeights[3];
+        double absolute = fabs(kronrod);
+        for (int j = 0; j < 7; j++) {
+            double pair = f[1 + 2 * j] + f[2 + 2 * j];
+            kronrod += kronrodWeights[j] * pair;
+            absolute += kronrodWeights[j] * (fabs(f[1 + 2 * j]) + fabs(f[2 + 2 * j]));
+            if (j & 1) gauss += gaussWeights[j / 2] * pair;
+        }
+
+        // QUADPACK's estimate: |K15 - G7| scaled by how smooth f looks
+        double mean = 0.5 * kronrod;
+        double spread = kronrodWeights[7] * fabs(f[0] - mean);
+        for (int j = 0; j < 7; j++) {
+            spread += kronrodWeights[j] * (fabs(f[1 + 2 * j] - mean) + fabs(f[2 + 2 * j] - mean));
+        }
+        double scale = fabs(half);
+        double error = fabs((kronrod - gauss) * half);
+        spread *= scale;
+        if (spread != 0.0 && error != 0.0) {
+            error = spread * fmin(1.0, pow(200.0 * error / spread, 1.5));
+        }
+        absolute *= scale;
+        if (absolute > DBL_MIN / (50.0 * DBL_EPSILON)) {
+            error = fmax(50.0 * DBL_EPSILON * absolute, error);
+        }
+
+        Panel* p = &out[k];
+        p->a = as[k];
+        p->b = bs[k];
+        p->value = kronrod * half;
+        p->error = error;
+        p->magnitude = absolute;
+    }
+    return true;
+}
+
+static bool startOperator();
+
+static void finishOperator(double value, double error) {
+    errorBound += error;
+    exprResolve(target, current, value);
+    if (++current == target->calculusCount || !startOperator()) busy = false;
+}
+
+// Stops when the summed estimates meet the tolerance, or fall to the
+// rounding in the panels themselves, or the panel table is full (the
+// bound shown is then larger)
+static void integralStep(u64 start) {
+    if (panelCount == 0) {
+        double as[4], bs[4];
+        for (int k = 0; k < 4; k++) {
+            as[k] = lower + (upper - lower) * k / 4.0;
+            bs[k] = k == 3 ? upper : lower + (upper - lower) * (k + 1) / 4.0;
+        }
+        if (!evalPanels(as, bs, 4, panels)) {
+            busy = false;
+            return;
+        }
+        panelCount = 4;
+    }
+
+    while (true) {
+        double total = 0.0, error = 0.0, magnitude = 0.0;
+        for (int i = 0; i < panelCount; i++) {
+            total += panels[i].value;
+            error += panels[i].error;
+            magnitude += panels[i].magnitude;
+        }
+        double tolerance = fmax(CALCULUS_ABS_TOL, CALCULUS_REL_TOL * fabs(total));
+        tolerance = fmax(tolerance, 50.0 * DBL_EPSILON * magnitude);
+        if (error <= tolerance || panelCount + PANEL_SPLITS > CALCULUS_MAX_PANELS) {
+            limited = limited || error > tolerance;
+            finishOperator(total, error);
+            return;
+        }
+
+        // Halve the panels with the largest estimates
+        int worst[PANEL_SPLITS];
+        for (int s = 0; s < PANEL_SPLITS; s++) {
+            worst[s] = -1;
+            for (int i = 0; i < panelCount; i++) {
+                bool taken = false;
+                for (int r = 0; r < s; r++) taken = taken || worst[r] == i;
+                if (taken) continue;
+                if (worst[s] < 0 || panels[i].error > panels[worst[s]].error) worst[s] = i;
+            }
+        }
+        double as[2 * PANEL_SPLITS], bs[2 * PANEL_SPLITS];
+        for (int s = 0; s < PANEL_SPLITS; s++) {
+            const Panel* p = &panels[worst[s]];
+            double mid = 0.5 * (p->a + p->b);
+            as[2 * s] = p->a;
+            bs[2 * s] = mid;
+            as[2 * s + 1] = mid;
+            bs[2 * s + 1] = p->b;
+        }
+        Panel halves[2 * PANEL_SPLITS];
+        if (!evalPanels(as, bs, 2 * PANEL_SPLITS, halves)) {
+            busy = false;
+            return;
+        }
+        for (int s = 0; s < PANEL_SPLITS; s++) {
+            panels[worst[s]] = halves[2 * s];
+            panels[panelCount++] = halves[2 * s + 1];
+        }
+
+        if (overBudget(start)) return;
+    }
+}
+
+// Neumaier's variant of Kahan summation: the compensation also catches
+// the low bits of the running sum when a term is larger than it
+static void sumStep(u64 start) {
+    double xs[EXPR_LANES], fs[EXPR_LANES];
+    double vars[EXPR_VAR_COUNT] = {0};
+
+    while (nextTerm <= upper) {
+        int n = 0;
+        while (n < EXPR_LANES && nextTerm + n <= upper) {
+            xs[n] = nextTerm + n;
+            n++;
+        }
+        exprEvalBatch(&body, vars, EXPR_VAR_X, xs, fs, n);
+        evaluations += n;
+
+        for (int i = 0; i < n; i++) {
+            double term = fs[i];
+            if (!isfinite(term)) {
+                failure = "Term not finite";
+                busy = false;
+                return;
+            }
+            double t = sum + term;
+            if (fabs(sum) >= fabs(term)) compensation += (sum - t) + term;
+            else compensation += (term - t) + sum;
+            sum = t;
+            sumAbs += fabs(term);
+        }
+        nextTerm += n;
+
+        if (nextTerm <= upper && overBudget(start)) return;
+    }
+
+    // Rounding of the summation: u |S| + 2 n u^2 sum |term|
+    double u = 0.5 * DBL_EPSILON;
+    double terms = upper >= lower ? upper - lower + 1.0 : 0.0;
+    double value = sum + compensation;
+    finishOperator(value, u * fabs(value) + 2.0 * terms * u * u * sumAbs);
+}
+
+// Bounds and body of the current operator; inner ones are resolved by now
+static bool startOperator() {
+    const ExprCalculus* c = &target->calculus[current];
+    double vars[EXPR_VAR_COUNT] = {0};
+    static ExprProgram bound;
+
+    if (!exprCompileSubtree(target, c->lower, &bound)) {
+        failure = "Expression too long";
+        return false;
+    }
+    lower = exprEval(&bound, vars);
+    if (!exprCompileSubtree(target, c->upper, &bound)) {
+        failure = "Expression too long";
+        return false;
+    }
+    upper = exprEval(&bound, vars);
+    if (!isfinite(lower) || !isfinite(upper)) {
+        failure = "Bounds not finite";
+        return false;
+    }
+
+    if (!exprCompileSubtree(target, c->body, &body)) {
+        failure = "Expression too long";
+        return false;
+    }
+    exprOptimize(&body, EXPR_VAR_X);
+
+    if (c->op == EXPR_SUM) {
+        if (lower != floor(lower) || upper != floor(upper)) {
+            failure = "Sum bounds must be integers";
+            return false;
+        }
+        if (upper - lower >= CALCULUS_MAX_TERMS) {
+            failure = "Too many terms";
+            return false;
+        }
+        nextTerm = lower;
+        sum = compensation = sumAbs = 0.0;
+    } else {
+        panelCount = 0;
+    }
+    return true;
+}
+
+bool calculusStart(ExprProgram* prog, char* error, int errorSize) {
+    target = prog;
+    current = 0;
+    errorBound = 0.0;
+    evaluations = 0.0;
+    limited = false;
+    failure = NULL;
+    busy = prog->calculusCount > 0;
+
+    if (busy && !startOperator()) {
+        snprintf(error, errorSize, "ERROR: %s", failure);
+        busy = false;
+        return false;
+    }
+    return true;
+}
+
+void calculusCancel() {
+    busy = false;
+}
+
+void calculusStep() {
+    if (!busy) return;
+
+    u64 start = gettime();
+    while (busy && !overBudget(start)) {
+        int op = current;
+        if (target->calculus[current].op == EXPR_SUM) sumStep(start);
+        else integralStep(start);
+        if (current == op) break; // out of time within the operator
+    }
+}
+
+bool calculusBusy() {
+    return busy;
+}
+
+const char* calculusError() {
+    return failure;
+}
+
+double calculusErrorBound() {
+    return errorBound;
+}
+
+double calculusEvaluations() {
+    return evaluations;
+}
+
+void calculusStatus(char* out, int size) {
+    if (!busy) {
+        snprintf(out, size, "\xC2\xB1%.2g, %.0f evaluations%s", errorBound, evaluations,
+                 limited ? " (panel limit)" : "");
+        return;
+    }
+
+    const char* name = target->calculus[current].op == EXPR_SUM ? "\xCE\xA3" : "\xE2\x88\xAB";
+    if (target->calculus[current].op == EXPR_SUM && upper >= lower) {
+        int percent = (int)(100.0 * (nextTerm - lower) / (upper - lower + 1.0));
+        snprintf(out, size, "%s %d of %d: %d%%, %.0f evaluations", name, current + 1,
+                 target->calculusCount, percent, evaluations);
+    } else {
+        snprintf(out, size, "%s %d of %d: %d panels, %.0f evaluations", name, current + 1,
+                 target->calculusCount, panelCount, evaluations);
+    }
+}
@@ -0,0 +1,175 @@
+#include "candles.h"
+#include "network.h"
+
+static const int intervalSeconds[CANDLE_INTERVAL_COUNT] = { 60, 5 * 60, 15 * 60, 60 * 60, 24 * 60 * 60 };
+static const char* intervalNames[CANDLE_INTERVAL_COUNT] = { "1m", "5m", "15m", "1h", "1d" };
+
+// Scratch columns for parsing, so a bad response never clobbers the series
+static double parsedTime[CHART_MAX_POINTS];
+static double parsedColumns[5][CHART_MAX_POINTS];
+static bool parsedValid[CHART_MAX_POINTS];
+
+// Parse "key":[n,n,null,...]; nulls clear valid[i]. Returns the element count.
+static int parseArray(const char* json, const char* key, double* out, bool* valid) {
+    char searchKey[32];
+    snprintf(searchKey, sizeof(searchKey), "\"%s\":[", key);
+
+    const char* p = strstr(json, searchKey);
+    if (!p) return -1;
+    p += strlen(searchKey);
+
+    int count = 0;
+    while (*p && *p != ']' && count < CHART_MAX_POINTS) {
+        if (strncmp(p, "null", 4) == 0) {
+            valid[count] = false;
+            out[count] = 0.0;
+            p += 4;
+        } else {
+            char* end;
+            out[count] = strtod(p, &end);
+            if (end == p) return -1;
+            p = end;
+        }
+        count++;
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return count;
+}
+
+bool parseChartSeries(const char* json, ChartSeries* out) {
+    static const char* columns[5] = { "open", "high", "low", "close", "volume" };
+
+    for (int i = 0; i < CHART_MAX_POINTS; i++) parsedValid[i] = true;
+
+    int count = parseArray(json, "timestamp", parsedTime, parsedValid);
+    if (count <= 0) return false;
+
+    // The OHLCV arrays live under indicators.quote[0]
+    const char* quote = strstr(json, "\"quote\":[");
+    if (!quote) return false;
+
+    for (int c = 0; c < 5; c++) {
+        if (parseArray(quote, columns[c], parsedColumns[c], parsedValid) != count) return false;
+    }
+
+    out->count = 0;
+    out->gmtOffset = (int)jsonGetFloat(json, "gmtoffset");
+    for (int i = 0; i < count; i++) {
+        if (!parsedValid[i]) continue;
+
+        int n = out->count++;
+        out->time[n] = (u32)parsedTime[i];
+        out->open[n] = (float)parsedColumns[0][i];
+        out->high[n] = (float)parsedColumns[1][i];
+        out->low[n] = (float)parsedColumns[2][i];
+        out->close[n] = (float)parsedColumns[3][i];
+        out->volume[n] = (float)parsedColumns[4][i];
+    }
+    return out->count > 0;
+}
+
+int chartMerge(ChartSeries* series, const ChartSeries* fresh) {
+    int same = 0;
+    while (same < series->count && same < fresh->count &&
+           series->time[same] == fresh->time[same] &&
+           series->open[same] == fresh->open[same] &&
+           series->high[same] == fresh->high[same] &&
+           series->low[same] == fresh->low[same] &&
+           series->close[same] == fresh->close[same] &&
+           series->volume[same] == fresh->volume[same]) {
+        same++;
+    }
+
+    // Usually only the last (still forming) bar and new ones differ
+    int tail = fresh->count - same;
+    memcpy(&series->time[same], &fresh->time[same], tail * sizeof(u32));
+    memcpy(&series->open[same], &fresh->open[same], tail * sizeof(float));
+    memcpy(&series->high[same], &fresh->high[same], tail * sizeof(float));
+    memcpy(&series->low[same], &fresh->low[same], tail * sizeof(float));
+    memcpy(&series->close[same], &fresh->close[same], tail * sizeof(float));
+    memcpy(&series->volume[same], &fresh->volume[same], tail * sizeof(float));
+
+    bool changed = same < series->count || same < fresh->count;
+    series->count = fresh->count;
+    series->gmtOffset = fresh->gmtOffset;
+    return changed ? same : series->count;
+}
+
+void candlesInit(CandleSet* set, CandleInterval interval) {
+    set->intervalSec = intervalSeconds[interval];
+    set->count = 0;
+    set->consumed = 0;
+    set->dirty = false;
+    set->changedFrom = 0;
+}
+
+void candlesInvalidate(CandleSet* set, int fromPoint) {
+    if (fromPoint < set->consumed) {
+        set->consumed = fromPoint;
+        set->dirty = true;
+    }
+}
+
+void candlesAcknowledge(CandleSet* set) {
+    set->changedFrom = set->count;
+}
+
+void candlesSync(CandleSet* set, const ChartSeries* series) {
+    if (set->consumed > series->count) set->consumed = series->count;
+    if (!set->dirty && set->consumed == series->count) return;
+
+    // Drop candles from the bucket of the first changed point (or the last
+    // point, if the series shrank) and rewind to that bucket's first point,
+    // so only the affected tail is rebuilt
+    if (series->count == 0) {
+        set->count = 0;
+        set->consumed = 0;
+    } else if (set->count > 0) {
+        int from = set->consumed < series->count ? set->consumed : series->count - 1;
+        u32 bucket = series->time[from] - series->time[from] % set->intervalSec;
+        while (set->count > 0 && set->start[set->count - 1] >= bucket) set->count--;
+        while (set->consumed > 0 && series->time[set->consumed - 1] >= bucket) set->consumed--;
+    }
+    set->dirty = false;
+
+    // The last surviving candle may still absorb points of its bucket
+    int touched = set->count > 0 ? set->count - 1 : 0;
+    if (touched < set->changedFrom) set->changedFrom = touched;
+
+    for (int i = set->consumed; i < series->count; i++) {
+        candlesAppend(set, series->time[i], series->open[i], series->high[i],
+                      series->low[i], series->close[i], series->volume[i]);
+    }
+    set->consumed = series->count;
+}
+
+void candlesAppend(CandleSet* set, u32 time, float open, float high, float low, float close, float volume) {
+    u32 bucket = time - time % set->intervalSec;
+    int n = set->count;
+
+    if (n > 0 && set->start[n - 1] == bucket) {
+        n--;
+        if (high > set->high[n]) set->high[n] = high;
+        if (low < set->low[n]) set->low[n] = low;
+        set->close[n] = close;
+        set->volume[n] += volume;
+        return;
+    }
+    if (n >= CHART_MAX_POINTS) return;
+
+    set->start[n] = bucket;
+    set->open[n] = open;
+    set->high[n] = high;
+    set->low[n] = low;
+    set->close[n] = close;
+    set->volume[n] = volume;
+    set->count++;
+}
+
+int candleIntervalSeconds(CandleInterval interval) {
+    return intervalSeconds[interval];
+}
+
+const char* candleIntervalName(CandleInterval interval) {
+    return intervalNames[interval];
+}
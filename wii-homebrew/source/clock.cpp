@@ -1,15 +1,18 @@
 #include "clock.h"
 #include "graphics.h"
 #include "input.h"
+#include "sntp.h"
+#include "fastmath.h"
 #include <time.h>
 
 static time_t currentTime;
 static struct tm* timeInfo;
 static char timeStr[64];
 static char dateStr[64];
+static char syncStr[64];
 
 void initClock() {
-    time(&currentTime);
+    currentTime = sntpTime();
     timeInfo = localtime(&currentTime);
 }
 
@@ -27,12 +30,21 @@ void updateClock() {
     }
     
     // Update time
-    time(&currentTime);
+    currentTime = sntpTime();
     timeInfo = localtime(&currentTime);
     
     // Format time
     strftime(timeStr, sizeof(timeStr), "%H:%M:%S", timeInfo);
     strftime(dateStr, sizeof(dateStr), "%A, %B %d, %Y", timeInfo);
+    
+    // Clock discipline status
+    const SntpStats* ntp = getSntpStats();
+    if (ntp->synced) {
+        snprintf(syncStr, sizeof(syncStr), "NTP offset %+.1f ms  jitter %.1f ms",
+                 ntp->offsetMs, ntp->jitterMs);
+    } else {
+        snprintf(syncStr, sizeof(syncStr), "NTP: not synced");
+    }
 }
 
 void renderClock() {
@@ -48,6 +60,9 @@ void renderClock() {
     // Draw date
     drawText(150, 280, dateStr, COLOR_WHITE, 1.2f);
     
+    // Draw sync status
+    drawText(150, 360, syncStr, COLOR_GRAY, 0.7f);
+    
     // Draw analog clock circle
     float centerX = 480;
     float centerY = 250;
@@ -62,20 +77,20 @@ void renderClock() {
     
     // Hour hand
     float hourAngle = (hour * 30 + minute * 0.5) * M_PI / 180 - M_PI / 2;
-    float hourX = centerX + cos(hourAngle) * (radius * 0.5);
-    float hourY = centerY + sin(hourAngle) * (radius * 0.5);
+    float hourX = centerX + fastCos(hourAngle) * (radius * 0.5);
+    float hourY = centerY + fastSin(hourAngle) * (radius * 0.5);
     drawRectangle(centerX, centerY, hourX - centerX, hourY - centerY, COLOR_WHITE);
     
     // Minute hand
     float minAngle = minute * 6 * M_PI / 180 - M_PI / 2;
-    float minX = centerX + cos(minAngle) * (radius * 0.7);
-    float minY = centerY + sin(minAngle) * (radius * 0.7);
+    float minX = centerX + fastCos(minAngle) * (radius * 0.7);
+    float minY = centerY + fastSin(minAngle) * (radius * 0.7);
     drawRectangle(centerX, centerY, minX - centerX, minY - centerY, COLOR_CYAN);
     
     // Second hand
     float secAngle = second * 6 * M_PI / 180 - M_PI / 2;
-    float secX = centerX + cos(secAngle) * (radius * 0.8);
-    float secY = centerY + sin(secAngle) * (radius * 0.8);
+    float secX = centerX + fastCos(secAngle) * (radius * 0.8);
+    float secY = centerY + fastSin(secAngle) * (radius * 0.8);
     drawRectangle(centerX, centerY, secX - centerX, secY - centerY, COLOR_RED);
     
     // Center dot
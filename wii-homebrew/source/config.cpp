@@ -1,6 +1,20 @@
 #include "config.h"
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
+
+#define CONFIG_MAGIC 0x57444346 // "WDCF"
+#define CONFIG_VERSION 1
+
+// Files written before the header existed are the original bare AppConfig,
+// which ended at customApiKey
+#define LEGACY_SIZE offsetof(AppConfig, quoteStreamUrl)
+
+typedef struct {
+    u32 magic;
+    u16 version;
+    u16 size; // bytes of AppConfig that follow
+} ConfigHeader;
 
 static AppConfig config;
 static const char* CONFIG_PATH = "sd:/apps/wii-dashboard/config.dat";
@@ -11,27 +25,50 @@ void initConfig() {
     config.ntpEnabled = true;
     config.stockUpdateInterval = 300; // 5 minutes
     config.customApiKey[0] = '\0';
+    config.quoteStreamUrl[0] = '\0';
+    config.metricsPort = 0; // opt-in, e.g. 9110
+    config.tlsAllowUnverified = false;
 }
 
 bool loadConfig() {
+    // Fields missing from an older file keep their defaults
+    initConfig();
+    
     FILE* file = fopen(CONFIG_PATH, "rb");
     if (!file) {
         printf("No config file found, using defaults\n");
-        initConfig();
         return false;
     }
     
-    size_t read = fread(&config, sizeof(AppConfig), 1, file);
+    ConfigHeader header;
+    bool ok;
+    int version = 0; // no header
+    if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == CONFIG_MAGIC) {
+        version = header.version;
+        // A newer build's extra fields are skipped
+        size_t size = header.size < sizeof(AppConfig) ? header.size : sizeof(AppConfig);
+        ok = fread(&config, 1, size, file) == size;
+    } else {
+        rewind(file);
+        ok = fread(&config, 1, LEGACY_SIZE, file) == LEGACY_SIZE;
+    }
     fclose(file);
     
-    if (read == 1) {
-        printf("Config loaded successfully\n");
-        return true;
+    if (!ok) {
+        printf("Failed to read config, using defaults\n");
+        initConfig();
+        return false;
     }
     
-    printf("Failed to read config, using defaults\n");
-    initConfig();
-    return false;
+    config.customApiKey[sizeof(config.customApiKey) - 1] = '\0';
+    config.quoteStreamUrl[sizeof(config.quoteStreamUrl) - 1] = '\0';
+    
+    printf("Config loaded successfully\n");
+    if (version < CONFIG_VERSION) {
+        printf("Config: converting to version %d\n", CONFIG_VERSION);
+        saveConfig();
+    }
+    return true;
 }
 
 bool saveConfig() {
@@ -41,10 +78,12 @@ bool saveConfig() {
         return false;
     }
     
-    size_t written = fwrite(&config, sizeof(AppConfig), 1, file);
+    ConfigHeader header = { CONFIG_MAGIC, CONFIG_VERSION, (u16)sizeof(AppConfig) };
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(&config, sizeof(AppConfig), 1, file) == 1;
     fclose(file);
     
-    if (written == 1) {
+    if (written) {
         printf("Config saved successfully\n");
         return true;
     }
@@ -1,12 +1,60 @@
 #include "dashboard.h"
 #include "graphics.h"
 #include "input.h"
+#include "netsched.h"
+#include "sntp.h"
+#include <ogc/lwp_watchdog.h>
 
 #define NUM_BUBBLES 8
 
+// Pointer must rest on a bubble this long before its data is prefetched
+#define PREFETCH_DWELL_MS 400
+#define PREFETCH_LIMIT 8 // a screen of stock tiles, not the whole watchlist
+#define CLOCK_RESYNC_AGE_SEC (5 * 60)
+
 static Bubble bubbles[NUM_BUBBLES];
 static int selectedBubble = 0;
-static float hoverTime = 0;
+static int dwellBubble = -1;
+static u64 dwellStartMs = 0;
+static int prefetchedBubble = -1;
+
+static void startPrefetch(int bubble) {
+    Scene scene = bubbles[bubble].targetScene;
+    if (scene == SCENE_DASHBOARD) return;
+
+    netPrefetchScene(scene, PREFETCH_LIMIT);
+
+    // The clock scenes have no feeds, but a stale clock is worth a resync
+    if (scene == SCENE_CLOCK || scene == SCENE_WORLD_CLOCK) {
+        const SntpStats* stats = getSntpStats();
+        if (!stats->synced || sntpTime() - stats->lastSync > CLOCK_RESYNC_AGE_SEC) {
+            sntpRequestSync();
+        }
+    }
+}
+
+static void stopPrefetch() {
+    if (prefetchedBubble < 0) return;
+    netCancelPrefetch(bubbles[prefetchedBubble].targetScene);
+    prefetchedBubble = -1;
+}
+
+// Prefetch the hovered bubble's data after a short dwell, cancel on leave
+static void updatePrefetch(int hoveredBubble) {
+    u64 now = ticks_to_millisecs(gettime());
+
+    if (hoveredBubble != dwellBubble) {
+        dwellBubble = hoveredBubble;
+        dwellStartMs = now;
+        if (prefetchedBubble != hoveredBubble) stopPrefetch();
+    }
+
+    if (hoveredBubble >= 0 && prefetchedBubble != hoveredBubble &&
+        now - dwellStartMs >= PREFETCH_DWELL_MS) {
+        startPrefetch(hoveredBubble);
+        prefetchedBubble = hoveredBubble;
+    }
+}
 
 void initDashboard() {
     // Initialize all bubbles with positions and properties
@@ -85,7 +133,7 @@ void initDashboard() {
 }
 
 void cleanupDashboard() {
-    // Nothing to cleanup
+    stopPrefetch();
 }
 
 void updateDashboard() {
@@ -117,9 +165,15 @@ void updateDashboard() {
         }
     }
     
+    updatePrefetch(hoveredBubble);
+    
     // A button to select
     if (input->pressed) {
         if (selectedBubble >= 0 && selectedBubble < NUM_BUBBLES) {
+            // A prefetch for the opened scene keeps running, now boosted
+            if (prefetchedBubble != selectedBubble) stopPrefetch();
+            prefetchedBubble = -1;
+            dwellBubble = -1;
             changeScene(bubbles[selectedBubble].targetScene);
         }
     }
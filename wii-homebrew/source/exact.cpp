@@ -0,0 +1,1136 @@
+#include "exact.h"
+#include "bignum.h"
+#include <math.h>
+#include <ctype.h>
+
+#define GUARD_BITS 32       // beyond the requested digits, and again inside functions
+#define EXP_HALVINGS 12     // e^r from e^(r/4096)
+#define TRIG_HALVINGS 10
+#define ATAN_HALVINGS 3     // down to |x| <= tan(π/32)
+#define TRIG_MAX_BITS 4096  // largest trig argument, as 2^this
+#define MAX_ROOT 64         // largest q tried for an exact x^(p/q)
+#define MAX_LITERAL_EXP 20000
+
+// Exact values are fractions in lowest terms; the rest are binary floats
+// of precision bits
+typedef struct {
+    bool exact;
+    BigInt num, den; // exact: num/den with den > 0
+    int exp;         // approximate: num * 2^exp
+} Number;
+
+static const char* failure;
+static int precision; // bits of approximate values
+static int working;   // fraction bits of the fixed point inside functions
+static Number values[EXPR_MAX_NODES];
+
+// Constants at the last precision asked for
+static BigInt piValue, ln2Value;
+static int piBits, ln2Bits;
+
+static void fail(const char* message) {
+    if (!failure) failure = message;
+}
+
+static bool failed() {
+    return failure != NULL || bigError() != NULL;
+}
+
+static bool isOne(const BigInt* a) {
+    s64 value;
+    return bigToInt(a, &value) && value == 1;
+}
+
+static void setInteger(Number* out, s64 value) {
+    out->exact = true;
+    bigSet(&out->num, value);
+    bigSet(&out->den, 1);
+    out->exp = 0;
+}
+
+static void setFraction(Number* out, s64 num, s64 den) {
+    setInteger(out, num);
+    bigSet(&out->den, den);
+}
+
+static bool isZero(const Number* a) {
+    return bigIsZero(&a->num);
+}
+
+static bool isNegative(const Number* a) {
+    return a->num.negative;
+}
+
+static bool isInteger(const Number* a) {
+    return a->exact && isOne(&a->den);
+}
+
+// Lowest terms with a positive denominator
+static void reduce(Number* a) {
+    if (bigIsZero(&a->den)) {
+        fail("Division by zero");
+        return;
+    }
+    if (a->den.negative) {
+        bigNegate(&a->num);
+        bigNegate(&a->den);
+    }
+    if (isOne(&a->den)) return;
+
+    BigInt g;
+    bigGcd(&a->num, &a->den, &g);
+    if (!isOne(&g)) {
+        bigDivMod(&a->num, &g, &a->num, NULL);
+        bigDivMod(&a->den, &g, &a->den, NULL);
+    }
+}
+
+// ---- approximate values ----
+
+// |a| is within a factor of 2 of 2^(top - 1)
+static int topBit(const Number* a) {
+    if (a->exact) return bigBits(&a->num) - bigBits(&a->den) + 1;
+    return bigBits(&a->num) + a->exp;
+}
+
+// log2 |a|, roughly
+static double log2Of(const Number* a) {
+    int e, ed = 0;
+    double m = fabs(bigFrexp(&a->num, &e));
+    double md = a->exact ? bigFrexp(&a->den, &ed) : 1.0;
+    return log2(m / md) + e - ed + (a->exact ? 0 : a->exp);
+}
+
+static double toDouble(const Number* a) {
+    double l = log2Of(a);
+    if (isZero(a)) return 0.0;
+    double magnitude = l > 2000.0 ? INFINITY : exp2(l);
+    return isNegative(a) ? -magnitude : magnitude;
+}
+
+// Truncate to precision bits
+static void roundFloat(Number* a) {
+    int excess = bigBits(&a->num) - precision;
+    if (excess > 0) {
+        bigShift(&a->num, -excess, &a->num);
+        a->exp += excess;
+    }
+    if (isZero(a)) {
+        a->exp = 0;
+        return;
+    }
+    int top = topBit(a);
+    if (top > EXACT_RANGE_BITS || top < -EXACT_RANGE_BITS) fail("Out of range");
+}
+
+static void makeFloat(Number* out, const BigInt* num, int exp) {
+    out->exact = false;
+    out->num = *num;
+    bigSet(&out->den, 1);
+    out->exp = exp;
+    roundFloat(out);
+}
+
+// a * 2^bits, truncated
+static void toFixed(const Number* a, int bits, BigInt* out) {
+    if (!a->exact) {
+        bigShift(&a->num, a->exp + bits, out);
+        return;
+    }
+    BigInt num = a->num, den = a->den;
+    if (bits >= 0) bigShift(&num, bits, &num);
+    else bigShift(&den, -bits, &den);
+    bigDivMod(&num, &den, out, NULL);
+}
+
+static void toFloat(const Number* a, Number* out) {
+    if (!a->exact) {
+        *out = *a;
+        return;
+    }
+    // Enough quotient bits for the precision
+    int bits = precision - bigBits(&a->num) + bigBits(&a->den) + 1;
+    if (bits < 0) bits = 0;
+    BigInt q;
+    toFixed(a, bits, &q);
+    makeFloat(out, &q, -bits);
+}
+
+// ---- fixed point, value * 2^bits ----
+
+static void fixedOne(int bits, BigInt* out) {
+    bigSet(out, 1);
+    bigShift(out, bits, out);
+}
+
+static void fixedMul(const BigInt* a, const BigInt* b, int bits, BigInt* out) {
+    bigMul(a, b, out);
+    bigShift(out, -bits, out);
+}
+
+static void fixedDiv(const BigInt* a, const BigInt* b, int bits, BigInt* out) {
+    BigInt t;
+    bigShift(a, bits, &t);
+    bigDivMod(&t, b, out, NULL);
+}
+
+static void fixedSqrt(const BigInt* a, int bits, BigInt* out) {
+    BigInt t;
+    bigShift(a, bits, &t);
+    bigSqrt(&t, out);
+}
+
+// atan(1/n), or atanh(1/n), by its series, with small n
+static void inverseSeries(u32 n, bool hyperbolic, int bits, BigInt* out) {
+    BigInt sum, power, term;
+    fixedOne(bits, &power);
+    bigDivSmall(&power, n, &power);
+    sum = power;
+
+    int mark = bigMark();
+    BigInt* keep[] = { &sum, &power };
+    for (u32 k = 1; !bigIsZero(&power) && !failed(); k++) {
+        bigDivSmall(&power, n * n, &power);
+        bigDivSmall(&power, 2 * k + 1, &term);
+        if (hyperbolic || !(k & 1)) bigAdd(&sum, &term, &sum);
+        else bigSub(&sum, &term, &sum);
+        bigRelease(mark, keep, 2);
+    }
+    *out = sum;
+}
+
+// Machin: π = 16 atan(1/5) - 4 atan(1/239). Each series term rounds, so
+// they run 16 bits finer.
+static const BigInt* pi(int bits) {
+    if (piBits != bits) {
+        BigInt a, b;
+        inverseSeries(5, false, bits + 16, &a);
+        inverseSeries(239, false, bits + 16, &b);
+        bigShift(&a, 4, &a);
+        bigShift(&b, 2, &b);
+        bigSub(&a, &b, &piValue);
+        bigShift(&piValue, -16, &piValue);
+        piBits = bits;
+    }
+    return &piValue;
+}
+
+// ln 2 = 2 atanh(1/3)
+static const BigInt* lnTwo(int bits) {
+    if (ln2Bits != bits) {
+        inverseSeries(3, true, bits + 16, &ln2Value);
+        bigShift(&ln2Value, -15, &ln2Value);
+        ln2Bits = bits;
+    }
+    return &ln2Value;
+}
+
+// ---- arithmetic ----
+
+static void numberAdd(const Number* a, const Number* b, bool subtract, Number* out) {
+    if (a->exact && b->exact) {
+        Number r;
+        BigInt left, right;
+        r.exact = true;
+        r.exp = 0;
+        bigMul(&a->num, &b->den, &left);
+        bigMul(&b->num, &a->den, &right);
+        if (subtract) bigSub(&left, &right, &r.num);
+        else bigAdd(&left, &right, &r.num);
+        bigMul(&a->den, &b->den, &r.den);
+        reduce(&r);
+        *out = r;
+        return;
+    }
+
+    Number x, y;
+    toFloat(a, &x);
+    toFloat(b, &y);
+    if (subtract) bigNegate(&y.num);
+    if (isZero(&y) || (!isZero(&x) && topBit(&y) < topBit(&x) - precision - 2)) {
+        *out = x;
+        return;
+    }
+    if (isZero(&x) || topBit(&x) < topBit(&y) - precision - 2) {
+        *out = y;
+        return;
+    }
+    int e = x.exp < y.exp ? x.exp : y.exp;
+    BigInt sum;
+    bigShift(&x.num, x.exp - e, &x.num);
+    bigShift(&y.num, y.exp - e, &y.num);
+    bigAdd(&x.num, &y.num, &sum);
+    makeFloat(out, &sum, e);
+}
+
+static void numberMul(const Number* a, const Number* b, Number* out) {
+    if (a->exact && b->exact) {
+        Number r;
+        r.exact = true;
+        r.exp = 0;
+        bigMul(&a->num, &b->num, &r.num);
+        bigMul(&a->den, &b->den, &r.den);
+        reduce(&r);
+        *out = r;
+        return;
+    }
+    Number x, y;
+    BigInt product;
+    toFloat(a, &x);
+    toFloat(b, &y);
+    bigMul(&x.num, &y.num, &product);
+    makeFloat(out, &product, x.exp + y.exp);
+}
+
+static void numberDiv(const Number* a, const Number* b, Number* out) {
+    if (isZero(b)) {
+        fail("Division by zero");
+        return;
+    }
+    if (a->exact && b->exact) {
+        Number r;
+        r.exact = true;
+        r.exp = 0;
+        bigMul(&a->num, &b->den, &r.num);
+        bigMul(&a->den, &b->num, &r.den);
+        reduce(&r);
+        *out = r;
+        return;
+    }
+    Number x, y;
+    BigInt q;
+    toFloat(a, &x);
+    toFloat(b, &y);
+    int bits = precision + bigBits(&y.num) - bigBits(&x.num) + 1;
+    if (bits < 0) bits = 0;
+    bigShift(&x.num, bits, &x.num);
+    bigDivMod(&x.num, &y.num, &q, NULL);
+    makeFloat(out, &q, x.exp - y.exp - bits);
+}
+
+static void numberSqrt(const Number* a, Number* out) {
+    if (isNegative(a)) {
+        fail("Not real");
+        return;
+    }
+    if (a->exact) {
+        Number r;
+        BigInt check;
+        r.exact = true;
+        r.exp = 0;
+        bigSqrt(&a->num, &r.num);
+        bigSqrt(&a->den, &r.den);
+        bigMul(&r.num, &r.num, &check);
+        bool square = bigCompare(&check, &a->num) == 0;
+        bigMul(&r.den, &r.den, &check);
+        if (square && bigCompare(&check, &a->den) == 0) {
+            *out = r;
+            return;
+        }
+    }
+
+    // Twice the precision under the root, with an even exponent
+    Number x;
+    BigInt root;
+    toFloat(a, &x);
+    int bits = 2 * precision - bigBits(&x.num) + 2;
+    if (bits < 0) bits = 0;
+    if ((x.exp - bits) & 1) bits++;
+    bigShift(&x.num, bits, &x.num);
+    bigSqrt(&x.num, &root);
+    makeFloat(out, &root, (x.exp - bits) / 2);
+}
+
+// floor(a^(1/q)) for a >= 0, by Newton's method from above
+static void integerRoot(const BigInt* a, u32 q, BigInt* out) {
+    if (q == 2 || bigIsZero(a)) {
+        bigSqrt(a, out);
+        return;
+    }
+    BigInt x, y, t;
+    bigSet(&x, 1);
+    bigShift(&x, (bigBits(a) + q - 1) / q, &x);
+
+    int mark = bigMark();
+    BigInt* keep[] = { &x };
+    while (!failed()) {
+        bigPow(&x, q - 1, &t);
+        bigDivMod(a, &t, &y, NULL);
+        bigMulSmall(&x, q - 1, &t);
+        bigAdd(&y, &t, &y);
+        bigDivSmall(&y, q, &y);
+        if (bigCompare(&y, &x) >= 0) break;
+        x = y;
+        bigRelease(mark, keep, 1);
+    }
+    *out = x;
+}
+
+static bool exactRoot(const BigInt* a, u32 q, BigInt* out) {
+    BigInt check;
+    integerRoot(a, q, out);
+    bigPow(out, q, &check);
+    return bigCompare(&check, a) == 0;
+}
+
+// ---- functions ----
+
+static void numberExp(const Number* x, Number* out) {
+    if (x->exact && isZero(x)) {
+        setInteger(out, 1);
+        return;
+    }
+    double estimate = toDouble(x);
+    if (!(fabs(estimate) < EXACT_RANGE_BITS * M_LN2)) {
+        fail("Out of range");
+        return;
+    }
+
+    // e^x = 2^n e^r with |r| <= ln2/2, and e^r = (e^(r/2^k))^(2^k)
+    int bits = working;
+    int n = (int)floor(estimate / M_LN2 + 0.5);
+    const BigInt* ln2 = lnTwo(bits);
+    BigInt r, shift;
+    toFixed(x, bits, &r);
+    bigMulSmall(ln2, (u32)abs(n), &shift);
+    if (n < 0) bigNegate(&shift);
+    bigSub(&r, &shift, &r);
+    bigShift(&r, -EXP_HALVINGS, &r);
+
+    BigInt sum, term;
+    fixedOne(bits, &sum);
+    term = sum;
+    int mark = bigMark();
+    BigInt* keep[] = { &sum, &term };
+    for (u32 k = 1; !bigIsZero(&term) && !failed(); k++) {
+        fixedMul(&term, &r, bits, &term);
+        bigDivSmall(&term, k, &term);
+        bigAdd(&sum, &term, &sum);
+        bigRelease(mark, keep, 2);
+    }
+    for (int i = 0; i < EXP_HALVINGS; i++) fixedMul(&sum, &sum, bits, &sum);
+    makeFloat(out, &sum, n - bits);
+}
+
+static void numberLn(const Number* x, Number* out) {
+    if (isZero(x)) {
+        fail("Undefined");
+        return;
+    }
+    if (isNegative(x)) {
+        fail("Not real");
+        return;
+    }
+    if (x->exact && isOne(&x->num) && isOne(&x->den)) {
+        setInteger(out, 0);
+        return;
+    }
+
+    // x = 2^k y with y within √2 of 1, and ln y = 2 atanh((y - 1)/(y + 1))
+    int bits = working;
+    int k = (int)floor(log2Of(x) + 0.5);
+    const BigInt* ln2 = lnTwo(bits);
+    BigInt y, one, num, den, z, square;
+    toFixed(x, bits - k, &y);
+    fixedOne(bits, &one);
+    bigSub(&y, &one, &num);
+    bigAdd(&y, &one, &den);
+    fixedDiv(&num, &den, bits, &z);
+    fixedMul(&z, &z, bits, &square);
+
+    BigInt sum = z, power = z, term;
+    int mark = bigMark();
+    BigInt* keep[] = { &sum, &power };
+    for (u32 i = 1; !bigIsZero(&power) && !failed(); i++) {
+        fixedMul(&power, &square, bits, &power);
+        bigDivSmall(&power, 2 * i + 1, &term);
+        bigAdd(&sum, &term, &sum);
+        bigRelease(mark, keep, 2);
+    }
+
+    BigInt shift;
+    bigShift(&sum, 1, &sum);
+    bigMulSmall(ln2, (u32)abs(k), &shift);
+    if (k < 0) bigNegate(&shift);
+    bigAdd(&sum, &shift, &sum);
+    makeFloat(out, &sum, -bits);
+}
+
+// n if a is 10^n
+static bool powerOfTen(const Number* a, int* n) {
+    if (!a->exact || isNegative(a) || isZero(a)) return false;
+    int sign = 1;
+    BigInt t = a->num;
+    if (!isOne(&a->den)) {
+        if (!isOne(&a->num)) return false;
+        t = a->den;
+        sign = -1;
+    }
+
+    int count = 0;
+    int mark = bigMark();
+    BigInt* keep[] = { &t };
+    while (!isOne(&t)) {
+        if (bigDivSmall(&t, 10, &t) != 0) return false;
+        count++;
+        bigRelease(mark, keep, 1);
+    }
+    *n = sign * count;
+    return true;
+}
+
+static void numberLog(const Number* x, Number* out) {
+    int n;
+    if (powerOfTen(x, &n)) {
+        setInteger(out, n);
+        return;
+    }
+    Number ten, lnX, lnTen;
+    setInteger(&ten, 10);
+    numberLn(x, &lnX);
+    numberLn(&ten, &lnTen);
+    if (!failed()) numberDiv(&lnX, &lnTen, out);
+}
+
+static void halfPi(Number* out) {
+    makeFloat(out, pi(working), -working - 1);
+}
+
+static void numberAtan(const Number* x, Number* out) {
+    if (x->exact && isZero(x)) {
+        setInteger(out, 0);
+        return;
+    }
+    int bits = working;
+    const BigInt* halfTurn = pi(bits);
+
+    // Above 1, atan x = ±π/2 - atan(1/x)
+    Number t = *x;
+    bool invert = fabs(toDouble(x)) > 1.0;
+    if (invert) {
+        Number one;
+        setInteger(&one, 1);
+        numberDiv(&one, x, &t);
+    }
+
+    // atan a = 2 atan(a / (1 + sqrt(1 + a^2)))
+    BigInt a, one, root, square;
+    toFixed(&t, bits, &a);
+    fixedOne(bits, &one);
+    for (int i = 0; i < ATAN_HALVINGS; i++) {
+        fixedMul(&a, &a, bits, &square);
+        bigAdd(&square, &one, &square);
+        fixedSqrt(&square, bits, &root);
+        bigAdd(&root, &one, &root);
+        fixedDiv(&a, &root, bits, &a);
+    }
+    fixedMul(&a, &a, bits, &square);
+
+    BigInt sum = a, power = a, term;
+    int mark = bigMark();
+    BigInt* keep[] = { &sum, &power };
+    for (u32 k = 1; !bigIsZero(&power) && !failed(); k++) {
+        fixedMul(&power, &square, bits, &power);
+        bigDivSmall(&power, 2 * k + 1, &term);
+        if (k & 1) bigSub(&sum, &term, &sum);
+        else bigAdd(&sum, &term, &sum);
+        bigRelease(mark, keep, 2);
+    }
+    bigShift(&sum, ATAN_HALVINGS, &sum);
+
+    if (invert) {
+        BigInt quarter;
+        bigShift(halfTurn, -1, &quarter);
+        if (isNegative(x)) bigNegate(&quarter);
+        bigSub(&quarter, &sum, &sum);
+    }
+    makeFloat(out, &sum, -bits);
+}
+
+// Degrees of asin, acos or atan of x where that is a whole number
+static bool exactArc(u8 op, const Number* x, s64* degrees) {
+    static const struct { u8 op; s8 num, den; s16 degrees; } angles[] = {
+        {EXPR_OP_ASIN, 0, 1, 0}, {EXPR_OP_ASIN, 1, 2, 30}, {EXPR_OP_ASIN, -1, 2, -30},
+        {EXPR_OP_ASIN, 1, 1, 90}, {EXPR_OP_ASIN, -1, 1, -90},
+        {EXPR_OP_ACOS, 1, 1, 0}, {EXPR_OP_ACOS, 1, 2, 60}, {EXPR_OP_ACOS, 0, 1, 90},
+        {EXPR_OP_ACOS, -1, 2, 120}, {EXPR_OP_ACOS, -1, 1, 180},
+        {EXPR_OP_ATAN, 0, 1, 0}, {EXPR_OP_ATAN, 1, 1, 45}, {EXPR_OP_ATAN, -1, 1, -45},
+    };
+    s64 num, den;
+    if (!x->exact || !bigToInt(&x->num, &num) || !bigToInt(&x->den, &den)) return false;
+    for (unsigned i = 0; i < sizeof(angles) / sizeof(angles[0]); i++) {
+        if (angles[i].op == op && angles[i].num == num && angles[i].den == den) {
+            *degrees = angles[i].degrees;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void numberArc(u8 op, const Number* x, Number* out) {
+    s64 degrees;
+    if (exactArc(op, x, &degrees) && degrees == 0) {
+        setInteger(out, 0);
+        return;
+    }
+    if (op == EXPR_OP_ATAN) {
+        numberAtan(x, out);
+        return;
+    }
+
+    // asin x = atan(x / sqrt(1 - x^2)), acos x = π/2 - asin x
+    Number one, t, angle;
+    setInteger(&one, 1);
+    numberMul(x, x, &t);
+    numberAdd(&one, &t, true, &t);
+    if (isNegative(&t)) {
+        fail("Not real");
+        return;
+    }
+    if (isZero(&t)) {
+        halfPi(&angle);
+        if (isNegative(x)) bigNegate(&angle.num);
+    } else {
+        numberSqrt(&t, &t);
+        numberDiv(x, &t, &t);
+        numberAtan(&t, &angle);
+    }
+    if (op == EXPR_OP_ACOS) {
+        Number quarter;
+        halfPi(&quarter);
+        numberAdd(&quarter, &angle, true, &angle);
+    }
+    *out = angle;
+}
+
+// sin and cos of x at bits, reduced modulo 2π with extra bits for the
+// whole turns, then the series at r/2^k doubled back k times
+static void sinCos(const Number* x, int bits, BigInt* s, BigInt* c) {
+    int extra = (topBit(x) > 0 ? topBit(x) : 0) + 8;
+    BigInt r, turn;
+    bigShift(pi(bits + extra), 1, &turn);
+    toFixed(x, bits + extra, &r);
+    bigDivMod(&r, &turn, NULL, &r);
+    bigShift(&r, -extra - TRIG_HALVINGS, &r);
+
+    BigInt term = r;
+    fixedOne(bits, c);
+    *s = r;
+    int mark = bigMark();
+    BigInt* keep[] = { s, c, &term };
+    for (u32 k = 2; !bigIsZero(&term) && !failed(); k++) {
+        // r^k/k! goes to cos for even k and sin for odd, with signs - - + +
+        fixedMul(&term, &r, bits, &term);
+        bigDivSmall(&term, k, &term);
+        BigInt* target = (k & 1) ? s : c;
+        if ((k / 2) & 1) bigSub(target, &term, target);
+        else bigAdd(target, &term, target);
+        bigRelease(mark, keep, 3);
+    }
+
+    for (int i = 0; i < TRIG_HALVINGS; i++) {
+        BigInt sc, cc, ss;
+        fixedMul(s, c, bits, &sc);
+        fixedMul(c, c, bits, &cc);
+        fixedMul(s, s, bits, &ss);
+        bigShift(&sc, 1, s);
+        bigSub(&cc, &ss, c);
+    }
+}
+
+static void numberTrig(u8 op, const Number* x, Number* out) {
+    if (x->exact && isZero(x)) {
+        setInteger(out, op == EXPR_OP_COS ? 1 : 0);
+        return;
+    }
+    if (topBit(x) > TRIG_MAX_BITS) {
+        fail("Out of range");
+        return;
+    }
+    int bits = working;
+    BigInt s, c;
+    sinCos(x, bits, &s, &c);
+    if (op == EXPR_OP_SIN) {
+        makeFloat(out, &s, -bits);
+    } else if (op == EXPR_OP_COS) {
+        makeFloat(out, &c, -bits);
+    } else if (bigIsZero(&c)) {
+        fail("Undefined");
+    } else {
+        BigInt t;
+        fixedDiv(&s, &c, bits, &t);
+        makeFloat(out, &t, -bits);
+    }
+}
+
+// sin, cos or tan of a whole number of degrees where that is rational
+static bool exactTrig(u8 op, const Number* degrees, Number* out) {
+    if (!isInteger(degrees)) return false;
+    u32 d = bigDivSmall(&degrees->num, 360, NULL);
+    if (isNegative(degrees) && d) d = 360 - d;
+
+    if (op == EXPR_OP_TAN) {
+        if (d % 180 == 90) fail("Undefined");
+        else if (d % 180 == 0) setInteger(out, 0);
+        else if (d % 90 == 45) setInteger(out, d % 180 == 45 ? 1 : -1);
+        else return false;
+        return true;
+    }
+
+    if (op == EXPR_OP_COS) d = (d + 90) % 360; // cos d = sin(d + 90)
+    if (d % 90 == 0) setInteger(out, d == 90 ? 1 : d == 270 ? -1 : 0);
+    else if (d == 30 || d == 150) setFraction(out, 1, 2);
+    else if (d == 210 || d == 330) setFraction(out, -1, 2);
+    else return false;
+    return true;
+}
+
+static void powerInteger(const Number* a, s64 n, Number* out) {
+    if (isZero(a) && n < 0) {
+        fail("Division by zero");
+        return;
+    }
+    u32 m = (u32)(n < 0 ? -n : n);
+    if (a->exact) {
+        Number r;
+        r.exact = true;
+        r.exp = 0;
+        bigPow(&a->num, m, &r.num);
+        bigPow(&a->den, m, &r.den);
+        if (n < 0) {
+            BigInt t = r.num;
+            r.num = r.den;
+            r.den = t;
+            if (r.den.negative) {
+                bigNegate(&r.num);
+                bigNegate(&r.den);
+            }
+        }
+        *out = r;
+        return;
+    }
+
+    // Square and multiply, once the result is known to be in range
+    if (!isZero(a) && fabs(log2Of(a) * m) > EXACT_RANGE_BITS + 1) {
+        fail("Out of range");
+        return;
+    }
+    Number result, base = *a;
+    setInteger(&result, 1);
+    while (m > 0 && !failed()) {
+        if (m & 1) numberMul(&result, &base, &result);
+        m >>= 1;
+        if (m) numberMul(&base, &base, &base);
+    }
+    if (n < 0) {
+        Number one;
+        setInteger(&one, 1);
+        numberDiv(&one, &result, &result);
+    }
+    *out = result;
+}
+
+static void numberPow(const Number* a, const Number* b, Number* out) {
+    if (isInteger(b)) {
+        s64 n;
+        if (bigToInt(&b->num, &n) && n >= -0x7FFFFFFF && n <= 0x7FFFFFFF) {
+            powerInteger(a, n, out);
+        } else if (a->exact && isOne(&a->den) && bigBits(&a->num) <= 1) {
+            // 0, 1 and -1 to a huge power
+            bool odd = bigDivSmall(&b->num, 2, NULL) != 0;
+            if (isZero(a) && isNegative(b)) fail("Division by zero");
+            else if (isNegative(a) && !odd) setInteger(out, 1);
+            else *out = *a;
+        } else {
+            fail("Too large");
+        }
+        return;
+    }
+
+    // An exponent p/q whose root of a is rational
+    s64 q = 0;
+    bool smallRoot = b->exact && bigToInt(&b->den, &q) && q <= MAX_ROOT;
+    if (a->exact && smallRoot && (!isNegative(a) || (q & 1))) {
+        Number root, p;
+        BigInt magnitude = a->num;
+        magnitude.negative = false;
+        if (exactRoot(&magnitude, (u32)q, &root.num) && exactRoot(&a->den, (u32)q, &root.den)) {
+            root.exact = true;
+            root.exp = 0;
+            if (isNegative(a)) bigNegate(&root.num);
+            p = *b;
+            bigSet(&p.den, 1);
+            numberPow(&root, &p, out);
+            return;
+        }
+    }
+
+    // Otherwise a^b = e^(b ln a), real for a < 0 only as an odd root
+    if (isZero(a)) {
+        if (isNegative(b)) fail("Division by zero");
+        else setInteger(out, 0);
+        return;
+    }
+    Number base = *a;
+    bool negate = false;
+    if (isNegative(a)) {
+        if (!b->exact || !(q & 1)) {
+            fail("Not real");
+            return;
+        }
+        bigNegate(&base.num);
+        negate = bigDivSmall(&b->num, 2, NULL) != 0;
+    }
+    Number t;
+    numberLn(&base, &t);
+    numberMul(b, &t, &t);
+    if (failed()) return;
+    numberExp(&t, out);
+    if (negate) bigNegate(&out->num);
+}
+
+// lo (lo + 1) ... hi as a balanced product tree, so the big
+// multiplications are between numbers of similar size
+static void product(u32 lo, u32 hi, BigInt* out) {
+    if (hi - lo < 16) {
+        bigSet(out, lo);
+        for (u32 k = lo + 1; k <= hi; k++) bigMulSmall(out, k, out);
+        return;
+    }
+    int mark = bigMark();
+    u32 mid = lo + (hi - lo) / 2;
+    BigInt a, b;
+    product(lo, mid, &a);
+    product(mid + 1, hi, &b);
+    bigMul(&a, &b, out);
+    BigInt* keep[] = { out };
+    bigRelease(mark, keep, 1);
+}
+
+static void numberFactorial(const Number* a, Number* out) {
+    s64 n;
+    if (!isInteger(a) || isNegative(a) || !bigToInt(&a->num, &n)) {
+        fail("Factorial needs a whole number");
+        return;
+    }
+    if (n > 0x7FFFFFFF || lgamma((double)n + 1.0) / M_LN2 > 32.0 * BIG_MAX_LIMBS - 64.0) {
+        fail("Too large");
+        return;
+    }
+    setInteger(out, 1);
+    if (n > 1) product(2, (u32)n, &out->num);
+}
+
+// ---- constants ----
+
+// A literal as typed: digits, a point and an exponent, read as strtod
+// reads them. Hex literals keep the value of the double.
+static bool readLiteral(const char* s, Number* out) {
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) return false;
+
+    char digits[256];
+    int count = 0, scale = 0, i = 0;
+    for (; isdigit((unsigned char)s[i]) && count < (int)sizeof(digits); i++) digits[count++] = s[i];
+    if (s[i] == '.') {
+        for (i++; isdigit((unsigned char)s[i]) && count < (int)sizeof(digits); i++) {
+            digits[count++] = s[i];
+            scale++;
+        }
+    }
+    int exponent = 0;
+    if (s[i] == 'e' || s[i] == 'E') {
+        int j = i + 1;
+        bool negative = s[j] == '-';
+        if (s[j] == '-' || s[j] == '+') j++;
+        for (; isdigit((unsigned char)s[j]); j++) {
+            if (exponent < 1000000) exponent = exponent * 10 + (s[j] - '0');
+        }
+        if (negative) exponent = -exponent;
+    }
+    exponent -= scale;
+    if (exponent > MAX_LITERAL_EXP || exponent < -MAX_LITERAL_EXP) {
+        fail("Out of range");
+        return true;
+    }
+
+    BigInt ten;
+    out->exact = true;
+    out->exp = 0;
+    bigFromDecimal(&out->num, digits, count);
+    bigSet(&out->den, 1);
+    bigSet(&ten, 10);
+    if (exponent > 0) {
+        bigPow(&ten, exponent, &ten);
+        bigMul(&out->num, &ten, &out->num);
+    } else if (exponent < 0) {
+        bigPow(&ten, -exponent, &out->den);
+        reduce(out);
+    }
+    return true;
+}
+
+// The double itself, which is a fraction with a power of 2 below
+static void fromDouble(double value, Number* out) {
+    if (!isfinite(value)) {
+        fail("Undefined");
+        return;
+    }
+    int e;
+    double m = frexp(value, &e);
+    setInteger(out, (s64)ldexp(m, 53));
+    e -= 53;
+    if (e >= 0) {
+        bigShift(&out->num, e, &out->num);
+    } else {
+        bigShift(&out->den, -e, &out->den);
+        reduce(out);
+    }
+}
+
+static void constant(const ExprNode* node, const char* source, Number* out) {
+    Number a, b;
+    switch (node->slot) {
+        case EXPR_CONST_PI:
+            makeFloat(out, pi(working), -working);
+            break;
+        case EXPR_CONST_E:
+            setInteger(&a, 1);
+            numberExp(&a, out);
+            break;
+        case EXPR_CONST_DEGREE:
+        case EXPR_CONST_RADIAN:
+            makeFloat(&a, pi(working), -working);
+            setInteger(&b, 180);
+            if (node->slot == EXPR_CONST_DEGREE) numberDiv(&a, &b, out);
+            else numberDiv(&b, &a, out);
+            break;
+        default:
+            if (node->text < 0 || !readLiteral(source + node->text, out)) fromDouble(node->value, out);
+            break;
+    }
+}
+
+// ---- evaluation ----
+
+static bool isKind(const ExprProgram* prog, int index, ExprConstKind kind) {
+    return prog->nodes[index].op == EXPR_OP_CONST && prog->nodes[index].slot == kind;
+}
+
+static bool isArc(u8 op) {
+    return op == EXPR_OP_ASIN || op == EXPR_OP_ACOS || op == EXPR_OP_ATAN;
+}
+
+static void evaluate(const ExprProgram* prog, const char* source, int index) {
+    const ExprNode* node = &prog->nodes[index];
+    Number* out = &values[index];
+    const Number* a = node->left >= 0 ? &values[node->left] : NULL;
+    const Number* b = node->right >= 0 ? &values[node->right] : NULL;
+
+    switch (node->op) {
+        case EXPR_OP_CONST: constant(node, source, out); break;
+        case EXPR_OP_VAR:   setInteger(out, 0); break;
+        case EXPR_OP_NEG:
+            *out = *a;
+            bigNegate(&out->num);
+            break;
+        case EXPR_OP_ABS:
+            *out = *a;
+            out->num.negative = false;
+            break;
+        case EXPR_OP_SQRT: numberSqrt(a, out); break;
+
+        case EXPR_OP_SIN:
+        case EXPR_OP_COS:
+        case EXPR_OP_TAN: {
+            // In degrees the argument is d * π/180, and whole d can be exact
+            const ExprNode* arg = &prog->nodes[node->left];
+            if (arg->op == EXPR_OP_MUL && isKind(prog, arg->right, EXPR_CONST_DEGREE) &&
+                exactTrig(node->op, &values[arg->left], out)) {
+                break;
+            }
+            numberTrig(node->op, a, out);
+            break;
+        }
+        case EXPR_OP_ASIN:
+        case EXPR_OP_ACOS:
+        case EXPR_OP_ATAN: numberArc(node->op, a, out); break;
+
+        case EXPR_OP_LN:   numberLn(a, out); break;
+        case EXPR_OP_LOG:  numberLog(a, out); break;
+        case EXPR_OP_EXP:  numberExp(a, out); break;
+        case EXPR_OP_FACT: numberFactorial(a, out); break;
+        case EXPR_OP_ADD:  numberAdd(a, b, false, out); break;
+        case EXPR_OP_SUB:  numberAdd(a, b, true, out); break;
+
+        case EXPR_OP_MUL: {
+            // Inverse trig in degrees is scaled by 180/π
+            const ExprNode* arc = &prog->nodes[node->left];
+            s64 degrees;
+            if (isKind(prog, node->right, EXPR_CONST_RADIAN) && isArc(arc->op) &&
+                exactArc(arc->op, &values[arc->left], &degrees)) {
+                setInteger(out, degrees);
+                break;
+            }
+            numberMul(a, b, out);
+            break;
+        }
+        case EXPR_OP_DIV: numberDiv(a, b, out); break;
+        case EXPR_OP_POW: numberPow(a, b, out); break;
+        default:
+            fail("Not supported");
+            break;
+    }
+}
+
+// ---- formatting ----
+
+static void put(char* out, int size, int* length, char c) {
+    if (*length < size - 1) out[*length] = c;
+    (*length)++;
+}
+
+// |num|/den > 0 rounded to digits significant digits, like %g: positional
+// while the exponent is in -5..digits-1, else d.ddde+N. Trailing zeros go.
+// Returns the decimal exponent.
+static int decimalText(const BigInt* num, const BigInt* den, int digits, char* out, int size) {
+    if (bigIsZero(num)) {
+        snprintf(out, size, "0");
+        return 0;
+    }
+    BigInt magnitude = *num;
+    magnitude.negative = false;
+    int en, ed;
+    double mn = bigFrexp(&magnitude, &en), md = bigFrexp(den, &ed);
+    int exponent = (int)floor((log2(mn / md) + en - ed) * M_LN2 / M_LN10);
+
+    // The estimate can be one off, and rounding can carry into a new digit
+    char buffer[EXACT_MAX_DIGITS + 8];
+    int count = 0;
+    for (int attempt = 0; attempt < 4 && !failed(); attempt++) {
+        int shift = digits - 1 - exponent;
+        BigInt scale, scaled = magnitude, divisor = *den, q;
+        bigSet(&scale, 10);
+        bigPow(&scale, shift < 0 ? -shift : shift, &scale);
+        if (shift >= 0) bigMul(&scaled, &scale, &scaled);
+        else bigMul(&divisor, &scale, &divisor);
+        bigShift(&scaled, 1, &scaled);
+        bigAdd(&scaled, &divisor, &scaled);
+        bigShift(&divisor, 1, &divisor);
+        bigDivMod(&scaled, &divisor, &q, NULL);
+        count = bigToDecimal(&q, buffer, sizeof(buffer));
+        if (count == digits) break;
+        exponent += count - digits;
+    }
+    if (count != digits) {
+        snprintf(out, size, "?");
+        return 0;
+    }
+    while (count > 1 && buffer[count - 1] == '0') count--;
+
+    int length = 0;
+    if (num->negative) put(out, size, &length, '-');
+    if (exponent >= -5 && exponent < digits) {
+        if (exponent < 0) {
+            put(out, size, &length, '0');
+            put(out, size, &length, '.');
+            for (int i = 0; i < -exponent - 1; i++) put(out, size, &length, '0');
+            for (int i = 0; i < count; i++) put(out, size, &length, buffer[i]);
+        } else {
+            for (int i = 0; i <= exponent; i++) put(out, size, &length, i < count ? buffer[i] : '0');
+            if (count > exponent + 1) put(out, size, &length, '.');
+            for (int i = exponent + 1; i < count; i++) put(out, size, &length, buffer[i]);
+        }
+    } else {
+        char tail[16];
+        put(out, size, &length, buffer[0]);
+        if (count > 1) put(out, size, &length, '.');
+        for (int i = 1; i < count; i++) put(out, size, &length, buffer[i]);
+        snprintf(tail, sizeof(tail), "e%c%02d", exponent < 0 ? '-' : '+', abs(exponent));
+        for (int i = 0; tail[i]; i++) put(out, size, &length, tail[i]);
+    }
+    out[length < size - 1 ? length : size - 1] = '\0';
+    return exponent;
+}
+
+static void format(const Number* v, int digits, ExactResult* result) {
+    BigInt num = v->num, den = v->den;
+    if (!v->exact) {
+        if (v->exp >= 0) bigShift(&num, v->exp, &num);
+        else bigShift(&den, -v->exp, &den);
+    }
+
+    result->exact = v->exact;
+    result->fraction = false;
+    result->integerDigits = 0;
+    result->decimal[0] = '\0';
+    decimalText(&num, &den, 12, result->summary, sizeof(result->summary));
+
+    if (!v->exact) {
+        decimalText(&num, &den, digits, result->text, sizeof(result->text));
+    } else if (isOne(&den)) {
+        // All of it when it fits, else rounded (the digit count stays exact)
+        if (bigBits(&num) * 0.30103 + 2 < EXACT_MAX_TEXT) {
+            int length = bigToDecimal(&num, result->text, sizeof(result->text));
+            result->integerDigits = length - (num.negative ? 1 : 0);
+        } else {
+            int exponent = decimalText(&num, &den, digits, result->text, sizeof(result->text));
+            result->integerDigits = exponent + 1;
+        }
+    } else {
+        decimalText(&num, &den, digits, result->decimal, sizeof(result->decimal));
+        int length = bigToDecimal(&num, result->text, sizeof(result->text));
+        if (length + 1 < (int)sizeof(result->text)) {
+            result->text[length] = '/';
+            length += 1 + bigToDecimal(&den, result->text + length + 1, sizeof(result->text) - length - 1);
+        }
+        if (length < (int)sizeof(result->text)) {
+            result->fraction = true;
+        } else {
+            // Too long to show as a fraction
+            result->exact = false;
+            snprintf(result->text, sizeof(result->text), "%s", result->decimal);
+            result->decimal[0] = '\0';
+        }
+    }
+}
+
+void cleanupExact() {
+    bigFreeArena();
+}
+
+bool exactEvaluate(const ExprProgram* prog, const char* source, int digits,
+                   ExactResult* result, char* error, int errorSize) {
+    if (prog->calculusCount > 0 || prog->root < 0) {
+        snprintf(error, errorSize, "ERROR: Exact mode has no \xE2\x88\xAB or \xCE\xA3");
+        return false;
+    }
+    if (digits < 1) digits = 1;
+    if (digits > EXACT_MAX_DIGITS) digits = EXACT_MAX_DIGITS;
+
+    bigReset();
+    failure = NULL;
+    piBits = ln2Bits = -1;
+    precision = (int)ceil(digits * (M_LN10 / M_LN2)) + GUARD_BITS;
+    working = precision + GUARD_BITS;
+
+    // Children precede their parents, so one ascending pass over the
+    // nodes under the root has every operand ready
+    bool reachable[EXPR_MAX_NODES] = {false};
+    reachable[prog->root] = true;
+    for (int i = prog->root; i >= 0; i--) {
+        const ExprNode* n = &prog->nodes[i];
+        if (!reachable[i]) continue;
+        if (n->left >= 0) reachable[n->left] = true;
+        if (n->right >= 0) reachable[n->right] = true;
+    }
+    for (int i = 0; i <= prog->root && !failed(); i++) {
+        if (reachable[i]) evaluate(prog, source, i);
+    }
+
+    if (!failed()) format(&values[prog->root], digits, result);
+    if (failed()) {
+        snprintf(error, errorSize, "ERROR: %s", failure ? failure : bigError());
+        return false;
+    }
+    return true;
+}
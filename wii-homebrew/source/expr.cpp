@@ -0,0 +1,1404 @@
+#include "expr.h"
+#include "fastmath.h"
+
+// Binding powers; higher binds tighter
+#define PREC_ADD 1
+#define PREC_MUL 2     // also implicit multiplication ("2x", "3(x+1)")
+#define PREC_UNARY 3   // prefix minus and functions without parentheses
+#define PREC_POW 4     // right associative
+
+typedef enum {
+    TOK_END,
+    TOK_NUMBER,
+    TOK_CONST,   // π, e
+    TOK_VAR,
+    TOK_FUNC,
+    TOK_PLUS,
+    TOK_MINUS,
+    TOK_STAR,
+    TOK_SLASH,
+    TOK_CARET,
+    TOK_LPAREN,
+    TOK_RPAREN,
+    TOK_BANG,
+    TOK_SQUARE,  // ²
+    TOK_CUBE,    // ³
+    TOK_ROOT,    // √
+    TOK_CALCULUS, // ∫, Σ
+    TOK_COMMA,
+    TOK_ERROR
+} TokenType;
+
+typedef struct {
+    TokenType type;
+    double value;  // TOK_NUMBER, TOK_CONST
+    int arg;       // ExprOp for TOK_FUNC, ExprVar for TOK_VAR, ExprConstKind,
+                   // ExprCalculusOp
+    int pos;       // byte offset
+} Token;
+
+typedef struct {
+    const char* text;
+    TokenType type;
+    int arg;
+    double value;
+} NameEntry;
+
+// Longest match wins, so "exp" is not read as e*x*p and "tan" not as t*a*n
+static const NameEntry names[] = {
+    {"asin", TOK_FUNC, EXPR_OP_ASIN, 0},
+    {"acos", TOK_FUNC, EXPR_OP_ACOS, 0},
+    {"atan", TOK_FUNC, EXPR_OP_ATAN, 0},
+    {"sqrt", TOK_FUNC, EXPR_OP_SQRT, 0},
+    {"sin", TOK_FUNC, EXPR_OP_SIN, 0},
+    {"cos", TOK_FUNC, EXPR_OP_COS, 0},
+    {"tan", TOK_FUNC, EXPR_OP_TAN, 0},
+    {"log", TOK_FUNC, EXPR_OP_LOG, 0},
+    {"exp", TOK_FUNC, EXPR_OP_EXP, 0},
+    {"abs", TOK_FUNC, EXPR_OP_ABS, 0},
+    {"ln", TOK_FUNC, EXPR_OP_LN, 0},
+    {"pi", TOK_CONST, EXPR_CONST_PI, M_PI},
+    {"\xCF\x80", TOK_CONST, EXPR_CONST_PI, M_PI}, // π
+    {"e", TOK_CONST, EXPR_CONST_E, M_E},
+    {"x", TOK_VAR, EXPR_VAR_X, 0},
+    {"y", TOK_VAR, EXPR_VAR_Y, 0},
+    {"t", TOK_VAR, EXPR_VAR_T, 0},
+    {"\xCE\xB8", TOK_VAR, EXPR_VAR_THETA, 0}, // θ
+    {"\xC3\x97", TOK_STAR, 0, 0},             // ×
+    {"\xC2\xB7", TOK_STAR, 0, 0},             // ·
+    {"\xC3\xB7", TOK_SLASH, 0, 0},            // ÷
+    {"\xE2\x88\x92", TOK_MINUS, 0, 0},        // −
+    {"\xE2\x88\x9A", TOK_ROOT, 0, 0},         // √
+    {"\xC2\xB2", TOK_SQUARE, 0, 0},           // ²
+    {"\xC2\xB3", TOK_CUBE, 0, 0},             // ³
+    {"\xE2\x88\xAB", TOK_CALCULUS, EXPR_INTEGRAL, 0}, // ∫
+    {"\xCE\xA3", TOK_CALCULUS, EXPR_SUM, 0},        // Σ
+    {"\xE2\x88\x91", TOK_CALCULUS, EXPR_SUM, 0},    // ∑
+};
+#define NAME_COUNT (int)(sizeof(names) / sizeof(names[0]))
+
+typedef struct {
+    const char* source;
+    int pos;
+    Token tok;      // lookahead
+    ExprProgram* prog;
+    ExprAngleMode angles;
+    int depth;
+} Parser;
+
+static void fail(Parser* p, const char* message, int pos) {
+    if (p->prog->error[0]) return; // keep the first error
+    snprintf(p->prog->error, sizeof(p->prog->error), "%s", message);
+    p->prog->errorPos = pos;
+}
+
+static bool failed(const Parser* p) {
+    return p->prog->error[0] != '\0';
+}
+
+// ---- tokenizer ----
+
+static void advance(Parser* p) {
+    const char* s = p->source;
+    while (s[p->pos] == ' ') p->pos++;
+
+    Token* t = &p->tok;
+    t->pos = p->pos;
+    t->value = 0;
+    t->arg = 0;
+
+    char c = s[p->pos];
+    if (c == '\0') {
+        t->type = TOK_END;
+        return;
+    }
+
+    if ((c >= '0' && c <= '9') || (c == '.' && s[p->pos + 1] >= '0' && s[p->pos + 1] <= '9')) {
+        char* end;
+        t->type = TOK_NUMBER;
+        t->value = strtod(s + p->pos, &end);
+        p->pos = end - s;
+        return;
+    }
+
+    switch (c) {
+        case '+': t->type = TOK_PLUS; p->pos++; return;
+        case '-': t->type = TOK_MINUS; p->pos++; return;
+        case '*': t->type = TOK_STAR; p->pos++; return;
+        case '/': t->type = TOK_SLASH; p->pos++; return;
+        case '^': t->type = TOK_CARET; p->pos++; return;
+        case '(': t->type = TOK_LPAREN; p->pos++; return;
+        case ')': t->type = TOK_RPAREN; p->pos++; return;
+        case '!': t->type = TOK_BANG; p->pos++; return;
+        case ',': t->type = TOK_COMMA; p->pos++; return;
+    }
+
+    // Names and multi-byte symbols
+    const NameEntry* best = NULL;
+    int bestLength = 0;
+    for (int i = 0; i < NAME_COUNT; i++) {
+        int length = strlen(names[i].text);
+        if (length > bestLength && strncmp(s + p->pos, names[i].text, length) == 0) {
+            best = &names[i];
+            bestLength = length;
+        }
+    }
+    if (best) {
+        t->type = best->type;
+        t->arg = best->arg;
+        t->value = best->value;
+        p->pos += bestLength;
+        return;
+    }
+
+    t->type = TOK_ERROR;
+    fail(p, "Unknown symbol", p->pos);
+}
+
+// ---- AST ----
+
+static s16 newNode(Parser* p, ExprOp op, s16 left, s16 right, double value) {
+    ExprProgram* prog = p->prog;
+    if (prog->nodeCount >= EXPR_MAX_NODES) {
+        fail(p, "Expression too long", p->tok.pos);
+        return -1;
+    }
+    ExprNode* node = &prog->nodes[prog->nodeCount];
+    node->op = (u8)op;
+    node->slot = 0;
+    node->left = left;
+    node->right = right;
+    node->text = -1;
+    node->value = value;
+    return (s16)prog->nodeCount++;
+}
+
+static s16 constNode(Parser* p, double value) {
+    return newNode(p, EXPR_OP_CONST, -1, -1, value);
+}
+
+static s16 kindNode(Parser* p, ExprConstKind kind, double value) {
+    s16 node = constNode(p, value);
+    if (node >= 0) p->prog->nodes[node].slot = (u8)kind;
+    return node;
+}
+
+static bool isTrig(u8 op) {
+    return op == EXPR_OP_SIN || op == EXPR_OP_COS || op == EXPR_OP_TAN;
+}
+
+// The x of a parsed sin(x·π/180), cos or tan, else -1. Degree trig is run
+// on x itself so multiples of 90 come out exact (see sinDeg).
+static int degreeOperand(const ExprProgram* prog, const ExprNode* node) {
+    if (!isTrig(node->op)) return -1;
+    const ExprNode* arg = &prog->nodes[node->left];
+    if (arg->op != EXPR_OP_MUL) return -1;
+    const ExprNode* scale = &prog->nodes[arg->right];
+    return scale->op == EXPR_OP_CONST && scale->slot == EXPR_CONST_DEGREE ? arg->left : -1;
+}
+
+// Degree mode scales trig arguments (compiled back to degree trig, see
+// degreeOperand) and inverse trig results
+static s16 functionNode(Parser* p, ExprOp op, s16 arg) {
+    bool degrees = p->angles == EXPR_DEGREES;
+    if (degrees && isTrig(op)) {
+        arg = newNode(p, EXPR_OP_MUL, arg, kindNode(p, EXPR_CONST_DEGREE, M_PI / 180.0), 0);
+    }
+    s16 node = newNode(p, op, arg, -1, 0);
+    if (degrees && (op == EXPR_OP_ASIN || op == EXPR_OP_ACOS || op == EXPR_OP_ATAN)) {
+        node = newNode(p, EXPR_OP_MUL, node, kindNode(p, EXPR_CONST_RADIAN, 180.0 / M_PI), 0);
+    }
+    return node;
+}
+
+static s16 parseExpr(Parser* p, int minPrec);
+
+static bool expect(Parser* p, TokenType type, const char* message) {
+    if (failed(p)) return false;
+    if (p->tok.type != type) {
+        fail(p, message, p->tok.pos);
+        return false;
+    }
+    advance(p);
+    return true;
+}
+
+// ∫(f, a, b) or Σ(f, a, b); the placeholder gets its value from exprResolve
+static s16 parseCalculus(Parser* p, ExprCalculusOp op) {
+    ExprProgram* prog = p->prog;
+    int start = p->tok.pos;
+    u32 outerMask = prog->varMask;
+
+    advance(p);
+    if (!expect(p, TOK_LPAREN, "Missing (")) return -1;
+    prog->varMask = 0;
+    s16 body = parseExpr(p, 0);
+    if (!failed(p) && (prog->varMask & ~(1u << EXPR_VAR_X))) fail(p, "Only x inside the body", start);
+    prog->varMask = 0;
+    if (!expect(p, TOK_COMMA, "Missing , before the bounds")) return -1;
+    s16 lower = parseExpr(p, 0);
+    if (!expect(p, TOK_COMMA, "Missing , before the bounds")) return -1;
+    s16 upper = parseExpr(p, 0);
+    if (!expect(p, TOK_RPAREN, "Missing )")) return -1;
+    if (prog->varMask) {
+        fail(p, "Bounds must be numbers", start);
+        return -1;
+    }
+    prog->varMask = outerMask;
+
+    if (prog->calculusCount >= EXPR_MAX_CALCULUS) {
+        fail(p, "Too many integrals and sums", start);
+        return -1;
+    }
+    s16 node = constNode(p, NAN);
+    ExprCalculus* c = &prog->calculus[prog->calculusCount++];
+    c->op = (u8)op;
+    c->body = body;
+    c->lower = lower;
+    c->upper = upper;
+    c->node = node;
+    return node;
+}
+
+static s16 parsePrefix(Parser* p) {
+    Token t = p->tok;
+
+    switch (t.type) {
+        case TOK_NUMBER:
+        case TOK_CONST: {
+            advance(p);
+            s16 node = kindNode(p, (ExprConstKind)t.arg, t.value);
+            if (node >= 0 && t.type == TOK_NUMBER) p->prog->nodes[node].text = (s16)t.pos;
+            return node;
+        }
+
+        case TOK_VAR: {
+            advance(p);
+            s16 node = newNode(p, EXPR_OP_VAR, -1, -1, 0);
+            if (node >= 0) p->prog->nodes[node].slot = (u8)t.arg;
+            p->prog->varMask |= 1u << t.arg;
+            return node;
+        }
+
+        case TOK_FUNC: {
+            // sin(x)^2 squares the sine; sin x^2 takes the sine of x^2
+            advance(p);
+            s16 arg;
+            if (p->tok.type == TOK_LPAREN) {
+                advance(p);
+                arg = parseExpr(p, 0);
+                if (p->tok.type != TOK_RPAREN) {
+                    fail(p, "Missing )", p->tok.pos);
+                    return -1;
+                }
+                advance(p);
+            } else {
+                arg = parseExpr(p, PREC_UNARY);
+            }
+            if (failed(p)) return -1;
+            return functionNode(p, (ExprOp)t.arg, arg);
+        }
+
+        case TOK_LPAREN: {
+            advance(p);
+            s16 inner = parseExpr(p, 0);
+            if (failed(p)) return -1;
+            if (p->tok.type != TOK_RPAREN) {
+                fail(p, "Missing )", p->tok.pos);
+                return -1;
+            }
+            advance(p);
+            return inner;
+        }
+
+        case TOK_MINUS: {
+            advance(p);
+            s16 operand = parseExpr(p, PREC_UNARY);
+            if (failed(p)) return -1;
+            return newNode(p, EXPR_OP_NEG, operand, -1, 0);
+        }
+
+        case TOK_PLUS:
+            advance(p);
+            return parseExpr(p, PREC_UNARY);
+
+        case TOK_ROOT: {
+            advance(p);
+            s16 operand = parseExpr(p, PREC_UNARY);
+            if (failed(p)) return -1;
+            return newNode(p, EXPR_OP_SQRT, operand, -1, 0);
+        }
+
+        case TOK_CALCULUS:
+            return parseCalculus(p, (ExprCalculusOp)t.arg);
+
+        case TOK_END:
+            fail(p, "Incomplete expression", t.pos);
+            return -1;
+
+        default:
+            fail(p, "Unexpected symbol", t.pos);
+            return -1;
+    }
+}
+
+static s16 parseExpr(Parser* p, int minPrec) {
+    if (++p->depth > EXPR_MAX_DEPTH) {
+        fail(p, "Too deeply nested", p->tok.pos);
+        return -1;
+    }
+
+    s16 left = parsePrefix(p);
+
+    while (!failed(p)) {
+        ExprOp op;
+        int prec;
+        bool rightAssoc = false;
+        bool implicit = false;
+
+        switch (p->tok.type) {
+            case TOK_PLUS:  op = EXPR_OP_ADD; prec = PREC_ADD; break;
+            case TOK_MINUS: op = EXPR_OP_SUB; prec = PREC_ADD; break;
+            case TOK_STAR:  op = EXPR_OP_MUL; prec = PREC_MUL; break;
+            case TOK_SLASH: op = EXPR_OP_DIV; prec = PREC_MUL; break;
+            case TOK_CARET: op = EXPR_OP_POW; prec = PREC_POW; rightAssoc = true; break;
+
+            // Postfix operators bind tightest of all
+            case TOK_BANG:
+                advance(p);
+                left = newNode(p, EXPR_OP_FACT, left, -1, 0);
+                continue;
+            case TOK_SQUARE:
+            case TOK_CUBE: {
+                double power = p->tok.type == TOK_SQUARE ? 2.0 : 3.0;
+                advance(p);
+                left = newNode(p, EXPR_OP_POW, left, constNode(p, power), 0);
+                continue;
+            }
+
+            // Juxtaposition multiplies
+            case TOK_NUMBER:
+            case TOK_CONST:
+            case TOK_VAR:
+            case TOK_FUNC:
+            case TOK_LPAREN:
+            case TOK_ROOT:
+            case TOK_CALCULUS:
+                op = EXPR_OP_MUL;
+                prec = PREC_MUL;
+                implicit = true;
+                break;
+
+            default:
+                p->depth--;
+                return left;
+        }
+
+        if (prec < minPrec) break;
+
+        if (!implicit) advance(p);
+        s16 right = parseExpr(p, rightAssoc ? prec : prec + 1);
+        if (failed(p)) break;
+        left = newNode(p, op, left, right, 0);
+    }
+
+    p->depth--;
+    return left;
+}
+
+// ---- bytecode ----
+
+// Code generation state; temp[i] >= 0 gives node i a temporary
+typedef struct {
+    ExprProgram* prog;
+    s8 temp[EXPR_MAX_NODES];
+    bool ready[EXPR_MAX_NODES]; // value already sits in its temp
+} CodeGen;
+
+static bool emit(ExprProgram* prog, ExprOp op, int arg) {
+    if (prog->codeLength >= EXPR_MAX_CODE) return false;
+    prog->code[prog->codeLength].op = (u8)op;
+    prog->code[prog->codeLength].arg = (u8)arg;
+    prog->codeLength++;
+    return true;
+}
+
+static int constIndex(ExprProgram* prog, double value) {
+    for (int i = 0; i < prog->constCount; i++) {
+        if (memcmp(&prog->consts[i], &value, sizeof(double)) == 0) return i;
+    }
+    if (prog->constCount >= EXPR_MAX_CONSTS) return -1;
+    prog->consts[prog->constCount] = value;
+    return prog->constCount++;
+}
+
+static void pushed(ExprProgram* prog, int depth) {
+    if (depth + 1 > prog->maxStack) prog->maxStack = depth + 1;
+}
+
+// Post-order walk; depth is the stack height below this node's value
+static bool compileNode(CodeGen* gen, int index, int depth) {
+    ExprProgram* prog = gen->prog;
+    const ExprNode* node = &prog->nodes[index];
+
+    pushed(prog, depth);
+    if (prog->maxStack > EXPR_MAX_STACK) return false;
+
+    if (gen->ready[index]) return emit(prog, EXPR_OP_LOAD, gen->temp[index]);
+
+    switch (node->op) {
+        case EXPR_OP_CONST: {
+            int k = constIndex(prog, node->value);
+            return k >= 0 && emit(prog, EXPR_OP_CONST, k);
+        }
+        case EXPR_OP_VAR:
+            return emit(prog, EXPR_OP_VAR, node->slot);
+    }
+
+    int degrees = degreeOperand(prog, node);
+    if (!compileNode(gen, degrees >= 0 ? degrees : node->left, depth)) return false;
+    if (node->right >= 0 && !compileNode(gen, node->right, depth + 1)) return false;
+
+    int arg = node->op == EXPR_OP_POWI || isTrig(node->op) ? (u8)(s8)node->value : 0;
+    if (degrees >= 0) arg = 1;
+    if (!emit(prog, (ExprOp)node->op, arg)) return false;
+
+    if (gen->temp[index] >= 0) {
+        gen->ready[index] = true;
+        return emit(prog, EXPR_OP_TEE, gen->temp[index]);
+    }
+    return true;
+}
+
+static void resetCode(ExprProgram* prog) {
+    prog->codeLength = 0;
+    prog->constCount = 0;
+    prog->maxStack = 0;
+    prog->bodyStart = 0;
+    prog->tempCount = 0;
+}
+
+// Plain code for the AST from prog->root
+static bool generate(ExprProgram* prog) {
+    CodeGen gen;
+    gen.prog = prog;
+    memset(gen.temp, -1, sizeof(gen.temp));
+    memset(gen.ready, 0, sizeof(gen.ready));
+    resetCode(prog);
+    return compileNode(&gen, prog->root, 0);
+}
+
+bool exprCompile(ExprProgram* prog, const char* source, ExprAngleMode angles) {
+    prog->nodeCount = 0;
+    prog->root = -1;
+    prog->varMask = 0;
+    prog->calculusCount = 0;
+    prog->precision = EXPR_PRECISE;
+    resetCode(prog);
+    prog->error[0] = '\0';
+    prog->errorPos = 0;
+
+    Parser p;
+    p.source = source;
+    p.pos = 0;
+    p.prog = prog;
+    p.angles = angles;
+    p.depth = 0;
+
+    advance(&p);
+    if (p.tok.type == TOK_END) {
+        fail(&p, "Empty expression", 0);
+        return false;
+    }
+
+    s16 root = parseExpr(&p, 0);
+    if (!failed(&p) && p.tok.type != TOK_END) {
+        fail(&p, p.tok.type == TOK_RPAREN ? "Unmatched )" : "Unexpected symbol", p.tok.pos);
+    }
+    if (failed(&p)) return false;
+
+    prog->root = root;
+    if (!generate(prog)) {
+        fail(&p, "Expression too long", 0);
+        return false;
+    }
+    return true;
+}
+
+bool exprCompileSubtree(const ExprProgram* prog, int node, ExprProgram* out) {
+    *out = *prog;
+    out->root = node;
+    out->calculusCount = 0;
+
+    // Children precede their parents, so a descending pass marks the subtree
+    bool reachable[EXPR_MAX_NODES] = {false};
+    reachable[node] = true;
+    out->varMask = 0;
+    for (int i = node; i >= 0; i--) {
+        const ExprNode* n = &out->nodes[i];
+        if (!reachable[i]) continue;
+        if (n->op == EXPR_OP_VAR) out->varMask |= 1u << n->slot;
+        if (n->left >= 0) reachable[n->left] = true;
+        if (n->right >= 0) reachable[n->right] = true;
+    }
+    return generate(out);
+}
+
+bool exprResolve(ExprProgram* prog, int k, double value) {
+    prog->nodes[prog->calculus[k].node].value = value;
+    return generate(prog);
+}
+
+// ---- optimizer ----
+
+static double powi(double base, int n) {
+    unsigned m = n < 0 ? -n : n;
+    double result = 1.0;
+    while (m) {
+        if (m & 1) result *= base;
+        base *= base;
+        m >>= 1;
+    }
+    return n < 0 ? 1.0 / result : result;
+}
+
+// Same arithmetic as the VM, for folding constant nodes
+static double applyOp(u8 op, double a, double b, double n) {
+    switch (op) {
+        case EXPR_OP_NEG:  return -a;
+        case EXPR_OP_SQRT: return sqrt(a);
+        case EXPR_OP_SIN:  return n ? sinDeg(a) : sin(a);
+        case EXPR_OP_COS:  return n ? cosDeg(a) : cos(a);
+        case EXPR_OP_TAN:  return n ? tanDeg(a) : tan(a);
+        case EXPR_OP_ASIN: return asin(a);
+        case EXPR_OP_ACOS: return acos(a);
+        case EXPR_OP_ATAN: return atan(a);
+        case EXPR_OP_LN:   return log(a);
+        case EXPR_OP_LOG:  return log10(a);
+        case EXPR_OP_EXP:  return exp(a);
+        case EXPR_OP_ABS:  return fabs(a);
+        case EXPR_OP_FACT: return tgamma(a + 1.0);
+        case EXPR_OP_ADD:  return a + b;
+        case EXPR_OP_SUB:  return a - b;
+        case EXPR_OP_MUL:  return a * b;
+        case EXPR_OP_DIV:  return a / b;
+        case EXPR_OP_POW:  return pow(a, b);
+        case EXPR_OP_SQR:  return a * a;
+        case EXPR_OP_POWI: return powi(a, (int)n);
+    }
+    return NAN;
+}
+
+// The AST is rebuilt bottom-up into a DAG: identical subtrees intern to one
+// node, so a repeated subexpression shows up as a node with several parents
+typedef struct {
+    const ExprProgram* source;
+    ExprNode nodes[EXPR_MAX_NODES];
+    int count;
+    s16 memo[EXPR_MAX_NODES]; // source node -> rebuilt node
+} Optimizer;
+
+static s16 intern(Optimizer* o, u8 op, u8 slot, s16 left, s16 right, double value) {
+    for (int i = 0; i < o->count; i++) {
+        const ExprNode* n = &o->nodes[i];
+        if (n->op == op && n->slot == slot && n->left == left && n->right == right &&
+            memcmp(&n->value, &value, sizeof(double)) == 0) {
+            return (s16)i;
+        }
+    }
+    if (o->count >= EXPR_MAX_NODES) return -1;
+
+    ExprNode* n = &o->nodes[o->count];
+    n->op = op;
+    n->slot = slot;
+    n->left = left;
+    n->right = right;
+    n->text = -1;
+    n->value = value;
+    return (s16)o->count++;
+}
+
+static s16 constant(Optimizer* o, double value) {
+    return intern(o, EXPR_OP_CONST, 0, -1, -1, value);
+}
+
+static bool isConst(const Optimizer* o, s16 index, double value) {
+    return index >= 0 && o->nodes[index].op == EXPR_OP_CONST && o->nodes[index].value == value;
+}
+
+// Local rewrites of one node whose operands are already simplified
+static s16 rewrite(Optimizer* o, u8 op, s16 left, s16 right) {
+    const ExprNode* a = &o->nodes[left];
+    const ExprNode* b = right >= 0 ? &o->nodes[right] : NULL;
+
+    if (a->op == EXPR_OP_CONST && (!b || b->op == EXPR_OP_CONST)) {
+        return constant(o, applyOp(op, a->value, b ? b->value : 0.0, 0.0));
+    }
+
+    switch (op) {
+        case EXPR_OP_ADD:
+            if (isConst(o, right, 0.0)) return left;
+            if (isConst(o, left, 0.0)) return right;
+            break;
+        case EXPR_OP_SUB:
+            if (isConst(o, right, 0.0)) return left;
+            break;
+        case EXPR_OP_MUL:
+            if (isConst(o, right, 1.0)) return left;
+            if (isConst(o, left, 1.0)) return right;
+            if (left == right) return intern(o, EXPR_OP_SQR, 0, left, -1, 0.0);
+            break;
+        case EXPR_OP_DIV:
+            if (isConst(o, right, 1.0)) return left;
+            break;
+        case EXPR_OP_NEG:
+            if (a->op == EXPR_OP_NEG) return a->left;
+            break;
+        case EXPR_OP_POW:
+            // Integer powers become multiplies (pow(x, 0) is 1 even for NaN)
+            if (b->op == EXPR_OP_CONST && b->value == floor(b->value) && fabs(b->value) <= EXPR_MAX_POWI) {
+                double n = b->value;
+                if (n == 0.0) return constant(o, 1.0);
+                if (n == 1.0) return left;
+                if (n == 2.0) return intern(o, EXPR_OP_SQR, 0, left, -1, 0.0);
+                return intern(o, EXPR_OP_POWI, 0, left, -1, n);
+            }
+            break;
+    }
+    return intern(o, op, 0, left, right, 0.0);
+}
+
+static s16 simplify(Optimizer* o, int index) {
+    if (o->memo[index] >= 0) return o->memo[index];
+
+    const ExprNode* node = &o->source->nodes[index];
+    int degrees = degreeOperand(o->source, node);
+    s16 result;
+    if (node->op == EXPR_OP_CONST || node->op == EXPR_OP_VAR) {
+        u8 slot = node->op == EXPR_OP_VAR ? node->slot : 0;
+        result = intern(o, node->op, slot, -1, -1, node->value);
+    } else if (degrees >= 0) {
+        // Kept in degrees, value 1, so folding sin(180) gives 0 as well
+        s16 arg = simplify(o, degrees);
+        if (arg < 0) return -1;
+        if (o->nodes[arg].op == EXPR_OP_CONST) {
+            result = constant(o, applyOp(node->op, o->nodes[arg].value, 0.0, 1.0));
+        } else {
+            result = intern(o, node->op, 0, arg, -1, 1.0);
+        }
+    } else {
+        s16 left = simplify(o, node->left);
+        s16 right = node->right >= 0 ? simplify(o, node->right) : -1;
+        if (left < 0 || (node->right >= 0 && right < 0)) return -1;
+        result = rewrite(o, node->op, left, right);
+    }
+    o->memo[index] = result;
+    return result;
+}
+
+static bool isLeaf(const ExprNode* node) {
+    return node->op == EXPR_OP_CONST || node->op == EXPR_OP_VAR;
+}
+
+static void countUses(const ExprProgram* prog, int index, u8* uses, bool* visited) {
+    if (uses[index] < 255) uses[index]++;
+    if (visited[index]) return;
+    visited[index] = true;
+
+    const ExprNode* node = &prog->nodes[index];
+    if (node->left >= 0) countUses(prog, node->left, uses, visited);
+    if (node->right >= 0) countUses(prog, node->right, uses, visited);
+}
+
+void exprOptimize(ExprProgram* prog, int loopVar) {
+    static Optimizer o;
+    static ExprProgram original;
+    if (prog->root < 0) return;
+    original = *prog;
+
+    o.source = prog;
+    o.count = 0;
+    memset(o.memo, -1, sizeof(o.memo));
+    s16 root = simplify(&o, prog->root);
+    if (root < 0) return;
+
+    memcpy(prog->nodes, o.nodes, o.count * sizeof(ExprNode));
+    prog->nodeCount = o.count;
+    prog->root = root;
+    prog->calculusCount = 0; // their subtrees are gone
+
+    // Nodes are interned children first, so one ascending pass sees
+    // operands before the nodes that use them
+    u8 uses[EXPR_MAX_NODES] = {0};
+    bool reachable[EXPR_MAX_NODES] = {false};
+    bool varying[EXPR_MAX_NODES] = {false};
+    bool hoist[EXPR_MAX_NODES] = {false};
+    countUses(prog, root, uses, reachable);
+
+    for (int i = 0; i < prog->nodeCount; i++) {
+        const ExprNode* node = &prog->nodes[i];
+        varying[i] = (node->op == EXPR_OP_VAR && node->slot == loopVar) ||
+                     (node->left >= 0 && varying[node->left]) ||
+                     (node->right >= 0 && varying[node->right]);
+    }
+
+    // Hoist the largest subtrees that do not depend on loopVar
+    if (loopVar < EXPR_VAR_COUNT) {
+        for (int i = 0; i < prog->nodeCount; i++) {
+            const ExprNode* node = &prog->nodes[i];
+            if (!reachable[i] || !varying[i]) continue;
+            if (node->left >= 0 && !varying[node->left]) hoist[node->left] = true;
+            if (node->right >= 0 && !varying[node->right]) hoist[node->right] = true;
+        }
+        if (!varying[root]) hoist[root] = true;
+    }
+
+    CodeGen gen;
+    gen.prog = prog;
+    memset(gen.temp, -1, sizeof(gen.temp));
+    memset(gen.ready, 0, sizeof(gen.ready));
+    resetCode(prog);
+
+    for (int i = 0; i < prog->nodeCount; i++) {
+        if (!reachable[i] || isLeaf(&prog->nodes[i])) {
+            hoist[i] = false;
+            continue;
+        }
+        if ((hoist[i] || uses[i] > 1) && prog->tempCount < EXPR_MAX_TEMPS) {
+            gen.temp[i] = (s8)prog->tempCount++;
+        }
+    }
+
+    // Prologue: each hoisted value goes straight into its temp
+    bool ok = true;
+    for (int i = 0; i < prog->nodeCount && ok; i++) {
+        if (!hoist[i] || gen.temp[i] < 0 || gen.ready[i]) continue;
+        ok = compileNode(&gen, i, 0);
+        if (ok) prog->code[prog->codeLength - 1].op = EXPR_OP_STORE; // was TEE
+    }
+    prog->bodyStart = prog->codeLength;
+    ok = ok && compileNode(&gen, root, 0);
+
+    if (!ok) *prog = original; // rare: temps made the code too long
+}
+
+// Trig operand for the float kernels, which take radians
+static inline double radians(double x, int degrees) {
+    return degrees ? x * (M_PI / 180.0) : x;
+}
+
+// Shared by every entry point; temps holds shared and hoisted values
+static double run(const ExprProgram* prog, int from, int to, const double* vars, double* temps) {
+    double stack[EXPR_MAX_STACK];
+    int sp = -1;
+    bool fast = prog->precision == EXPR_FAST;
+
+    const ExprInstr* in = prog->code + from;
+    const ExprInstr* end = prog->code + to;
+    for (; in < end; in++) {
+        switch (in->op) {
+            case EXPR_OP_CONST: stack[++sp] = prog->consts[in->arg]; break;
+            case EXPR_OP_VAR:   stack[++sp] = vars[in->arg]; break;
+
+            case EXPR_OP_NEG:  stack[sp] = -stack[sp]; break;
+            case EXPR_OP_SQRT: stack[sp] = fast ? fastSqrt(stack[sp]) : sqrt(stack[sp]); break;
+            case EXPR_OP_SIN:  stack[sp] = fast ? fastSin(radians(stack[sp], in->arg)) : applyOp(in->op, stack[sp], 0, in->arg); break;
+            case EXPR_OP_COS:  stack[sp] = fast ? fastCos(radians(stack[sp], in->arg)) : applyOp(in->op, stack[sp], 0, in->arg); break;
+            case EXPR_OP_TAN:  stack[sp] = fast ? fastTan(radians(stack[sp], in->arg)) : applyOp(in->op, stack[sp], 0, in->arg); break;
+            case EXPR_OP_ASIN: stack[sp] = fast ? fastAsin(stack[sp]) : asin(stack[sp]); break;
+            case EXPR_OP_ACOS: stack[sp] = fast ? fastAcos(stack[sp]) : acos(stack[sp]); break;
+            case EXPR_OP_ATAN: stack[sp] = fast ? fastAtan(stack[sp]) : atan(stack[sp]); break;
+            case EXPR_OP_LN:   stack[sp] = fast ? fastLog(stack[sp]) : log(stack[sp]); break;
+            case EXPR_OP_LOG:  stack[sp] = fast ? fastLog10(stack[sp]) : log10(stack[sp]); break;
+            case EXPR_OP_EXP:  stack[sp] = fast ? fastExp(stack[sp]) : exp(stack[sp]); break;
+            case EXPR_OP_ABS:  stack[sp] = fabs(stack[sp]); break;
+            case EXPR_OP_FACT: stack[sp] = tgamma(stack[sp] + 1.0); break;
+
+            case EXPR_OP_ADD: sp--; stack[sp] += stack[sp + 1]; break;
+            case EXPR_OP_SUB: sp--; stack[sp] -= stack[sp + 1]; break;
+            case EXPR_OP_MUL: sp--; stack[sp] *= stack[sp + 1]; break;
+            case EXPR_OP_DIV: sp--; stack[sp] /= stack[sp + 1]; break;
+            case EXPR_OP_POW:
+                sp--;
+                stack[sp] = fast ? fastPow(stack[sp], stack[sp + 1]) : pow(stack[sp], stack[sp + 1]);
+                break;
+
+            case EXPR_OP_SQR:  stack[sp] *= stack[sp]; break;
+            case EXPR_OP_POWI: stack[sp] = powi(stack[sp], (s8)in->arg); break;
+            case EXPR_OP_LOAD:  stack[++sp] = temps[in->arg]; break;
+            case EXPR_OP_STORE: temps[in->arg] = stack[sp--]; break;
+            case EXPR_OP_TEE:   temps[in->arg] = stack[sp]; break;
+        }
+    }
+    return sp >= 0 ? stack[sp] : NAN;
+}
+
+double exprEval(const ExprProgram* prog, const double* vars) {
+    double temps[EXPR_MAX_TEMPS];
+    return run(prog, 0, prog->codeLength, vars, temps);
+}
+
+void exprBind(ExprProgram* prog, const double* vars) {
+    run(prog, 0, prog->bodyStart, vars, prog->bound);
+}
+
+double exprEvalBound(const ExprProgram* prog, const double* vars) {
+    double temps[EXPR_MAX_TEMPS];
+    memcpy(temps, prog->bound, prog->tempCount * sizeof(double));
+    return run(prog, prog->bodyStart, prog->codeLength, vars, temps);
+}
+
+// ---- derivatives ----
+
+// Digamma, for the derivative of x! = gamma(x + 1)
+static double digamma(double x) {
+    if (x <= 0.0 && x == floor(x)) return NAN; // poles
+    if (x < 0.0) return digamma(1.0 - x) - M_PI / tan(M_PI * x);
+
+    double result = 0.0;
+    while (x < 10.0) { // recurrence up to where the series is good to 1e-14
+        result -= 1.0 / x;
+        x += 1.0;
+    }
+    double f = 1.0 / (x * x);
+    return result + log(x) - 0.5 / x -
+           f * (1.0 / 12 - f * (1.0 / 120 - f * (1.0 / 252 - f * (1.0 / 240 - f / 132))));
+}
+
+// Chain rule for a unary op: dx is the operand's derivative, value the result
+static double unaryDeriv(u8 op, int n, double x, double dx, double value) {
+    if (dx == 0.0) return 0.0; // also where the factor below is infinite
+    switch (op) {
+        case EXPR_OP_NEG:  return -dx;
+        case EXPR_OP_SQRT: return dx / (2.0 * value);
+        case EXPR_OP_SIN:  return n ? dx * (M_PI / 180.0) * cosDeg(x) : dx * cos(x);
+        case EXPR_OP_COS:  return n ? -dx * (M_PI / 180.0) * sinDeg(x) : -dx * sin(x);
+        case EXPR_OP_TAN:  return dx * (n ? M_PI / 180.0 : 1.0) * (1.0 + value * value);
+        case EXPR_OP_ASIN: return dx / sqrt(1.0 - x * x);
+        case EXPR_OP_ACOS: return -dx / sqrt(1.0 - x * x);
+        case EXPR_OP_ATAN: return dx / (1.0 + x * x);
+        case EXPR_OP_LN:   return dx / x;
+        case EXPR_OP_LOG:  return dx / (x * M_LN10);
+        case EXPR_OP_EXP:  return dx * value;
+        case EXPR_OP_ABS:  return x < 0.0 ? -dx : dx;
+        case EXPR_OP_FACT: return dx * value * digamma(x + 1.0);
+        case EXPR_OP_SQR:  return dx * 2.0 * x;
+        case EXPR_OP_POWI: return dx * n * powi(x, n - 1);
+    }
+    return NAN;
+}
+
+static double binaryDeriv(u8 op, double x, double dx, double y, double dy, double value) {
+    switch (op) {
+        case EXPR_OP_ADD: return dx + dy;
+        case EXPR_OP_SUB: return dx - dy;
+        case EXPR_OP_MUL: return dx * y + x * dy;
+        case EXPR_OP_DIV: return (dx - value * dy) / y;
+        case EXPR_OP_POW:
+            if (dy == 0.0) { // constant exponent: y x^(y-1) also works for x < 0
+                return dx == 0.0 ? 0.0 : dx * y * pow(x, y - 1.0);
+            }
+            return value * (dy * log(x) + (dx == 0.0 ? 0.0 : y * dx / x));
+    }
+    return NAN;
+}
+
+// Forward mode: every stack slot carries (value, d value / d var)
+typedef struct {
+    double v;
+    double d;
+} Dual;
+
+double exprEvalDual(const ExprProgram* prog, const double* vars, ExprVar var, double* derivative) {
+    Dual stack[EXPR_MAX_STACK];
+    Dual temps[EXPR_MAX_TEMPS];
+    int sp = -1;
+
+    const ExprInstr* in = prog->code;
+    const ExprInstr* end = prog->code + prog->codeLength;
+    for (; in < end; in++) {
+        u8 op = in->op;
+
+        switch (op) {
+            case EXPR_OP_CONST:
+                sp++;
+                stack[sp].v = prog->consts[in->arg];
+                stack[sp].d = 0.0;
+                break;
+            case EXPR_OP_VAR:
+                sp++;
+                stack[sp].v = vars[in->arg];
+                stack[sp].d = in->arg == var ? 1.0 : 0.0;
+                break;
+            case EXPR_OP_LOAD:  stack[++sp] = temps[in->arg]; break;
+            case EXPR_OP_STORE: temps[in->arg] = stack[sp--]; break;
+            case EXPR_OP_TEE:   temps[in->arg] = stack[sp]; break;
+
+            case EXPR_OP_ADD:
+            case EXPR_OP_SUB:
+            case EXPR_OP_MUL:
+            case EXPR_OP_DIV:
+            case EXPR_OP_POW: {
+                Dual b = stack[sp--];
+                Dual* a = &stack[sp];
+                double value = applyOp(op, a->v, b.v, 0);
+                a->d = binaryDeriv(op, a->v, a->d, b.v, b.d, value);
+                a->v = value;
+                break;
+            }
+
+            default: { // unary
+                Dual* a = &stack[sp];
+                double value = applyOp(op, a->v, 0, (s8)in->arg);
+                a->d = unaryDeriv(op, (s8)in->arg, a->v, a->d, value);
+                a->v = value;
+                break;
+            }
+        }
+    }
+
+    if (sp < 0) {
+        *derivative = NAN;
+        return NAN;
+    }
+    *derivative = stack[sp].d;
+    return stack[sp].v;
+}
+
+// ---- batch evaluation ----
+
+// A batch value is either one scalar shared by every lane (constants, the
+// other variables and anything computed from them only) or a row of lanes
+typedef struct {
+    const double* lanes;  // NULL when uniform
+    double scalar;
+    const double* derivs; // d/d lane; NULL when zero (always for uniforms)
+} LaneValue;
+
+static double laneRows[EXPR_MAX_STACK][EXPR_LANES];
+static double laneTemps[EXPR_MAX_TEMPS][EXPR_LANES];
+static double laneDerivs[EXPR_MAX_STACK][EXPR_LANES];
+static double laneTempDerivs[EXPR_MAX_TEMPS][EXPR_LANES];
+static double laneOnes[EXPR_LANES];    // d lane / d lane
+static double laneZeros[EXPR_LANES];
+static double laneScratch[2][EXPR_LANES];
+
+// Float kernels; ops without one fall through to the precise loops
+static bool fastUnaryLanes(u8 op, double* out, const double* a, int count) {
+    int i;
+    switch (op) {
+        case EXPR_OP_SQRT: for (i = 0; i < count; i++) out[i] = fastSqrt(a[i]); break;
+        case EXPR_OP_SIN:  for (i = 0; i < count; i++) out[i] = fastSin(a[i]); break;
+        case EXPR_OP_COS:  for (i = 0; i < count; i++) out[i] = fastCos(a[i]); break;
+        case EXPR_OP_TAN:  for (i = 0; i < count; i++) out[i] = fastTan(a[i]); break;
+        case EXPR_OP_ASIN: for (i = 0; i < count; i++) out[i] = fastAsin(a[i]); break;
+        case EXPR_OP_ACOS: for (i = 0; i < count; i++) out[i] = fastAcos(a[i]); break;
+        case EXPR_OP_ATAN: for (i = 0; i < count; i++) out[i] = fastAtan(a[i]); break;
+        case EXPR_OP_LN:   for (i = 0; i < count; i++) out[i] = fastLog(a[i]); break;
+        case EXPR_OP_LOG:  for (i = 0; i < count; i++) out[i] = fastLog10(a[i]); break;
+        case EXPR_OP_EXP:  for (i = 0; i < count; i++) out[i] = fastExp(a[i]); break;
+        default: return false;
+    }
+    return true;
+}
+
+// out may be the same row as a; every loop reads and writes lane i only.
+// n is the POWI exponent, or 1 for trig in degrees.
+static void unaryLanes(u8 op, int n, bool fast, double* out, const double* a, int count) {
+    int i;
+    if (fast && n && isTrig(op)) {
+        for (i = 0; i < count; i++) out[i] = radians(a[i], 1);
+        a = out;
+    }
+    if (fast && fastUnaryLanes(op, out, a, count)) return;
+
+    switch (op) {
+        case EXPR_OP_NEG:  for (i = 0; i < count; i++) out[i] = -a[i]; break;
+        case EXPR_OP_SQRT: for (i = 0; i < count; i++) out[i] = sqrt(a[i]); break;
+        case EXPR_OP_SIN:
+            if (n) for (i = 0; i < count; i++) out[i] = sinDeg(a[i]);
+            else for (i = 0; i < count; i++) out[i] = sin(a[i]);
+            break;
+        case EXPR_OP_COS:
+            if (n) for (i = 0; i < count; i++) out[i] = cosDeg(a[i]);
+            else for (i = 0; i < count; i++) out[i] = cos(a[i]);
+            break;
+        case EXPR_OP_TAN:
+            if (n) for (i = 0; i < count; i++) out[i] = tanDeg(a[i]);
+            else for (i = 0; i < count; i++) out[i] = tan(a[i]);
+            break;
+        case EXPR_OP_ASIN: for (i = 0; i < count; i++) out[i] = asin(a[i]); break;
+        case EXPR_OP_ACOS: for (i = 0; i < count; i++) out[i] = acos(a[i]); break;
+        case EXPR_OP_ATAN: for (i = 0; i < count; i++) out[i] = atan(a[i]); break;
+        case EXPR_OP_LN:   for (i = 0; i < count; i++) out[i] = log(a[i]); break;
+        case EXPR_OP_LOG:  for (i = 0; i < count; i++) out[i] = log10(a[i]); break;
+        case EXPR_OP_EXP:  for (i = 0; i < count; i++) out[i] = exp(a[i]); break;
+        case EXPR_OP_ABS:  for (i = 0; i < count; i++) out[i] = fabs(a[i]); break;
+        case EXPR_OP_FACT: for (i = 0; i < count; i++) out[i] = tgamma(a[i] + 1.0); break;
+        case EXPR_OP_SQR:  for (i = 0; i < count; i++) out[i] = a[i] * a[i]; break;
+        case EXPR_OP_POWI: for (i = 0; i < count; i++) out[i] = powi(a[i], n); break;
+    }
+}
+
+// One loop per operand shape keeps each a straight line over the lanes
+static void binaryLanes(u8 op, bool fast, double* out, LaneValue a, LaneValue b, int count) {
+    const double* x = a.lanes;
+    const double* y = b.lanes;
+    double s;
+    int i;
+
+    if (fast && op == EXPR_OP_POW) {
+        for (i = 0; i < count; i++) {
+            out[i] = fastPow(x ? x[i] : a.scalar, y ? y[i] : b.scalar);
+        }
+    } else if (x && y) {
+        switch (op) {
+            case EXPR_OP_ADD: for (i = 0; i < count; i++) out[i] = x[i] + y[i]; break;
+            case EXPR_OP_SUB: for (i = 0; i < count; i++) out[i] = x[i] - y[i]; break;
+            case EXPR_OP_MUL: for (i = 0; i < count; i++) out[i] = x[i] * y[i]; break;
+            case EXPR_OP_DIV: for (i = 0; i < count; i++) out[i] = x[i] / y[i]; break;
+            case EXPR_OP_POW: for (i = 0; i < count; i++) out[i] = pow(x[i], y[i]); break;
+        }
+    } else if (x) {
+        s = b.scalar;
+        switch (op) {
+            case EXPR_OP_ADD: for (i = 0; i < count; i++) out[i] = x[i] + s; break;
+            case EXPR_OP_SUB: for (i = 0; i < count; i++) out[i] = x[i] - s; break;
+            case EXPR_OP_MUL: for (i = 0; i < count; i++) out[i] = x[i] * s; break;
+            case EXPR_OP_DIV: for (i = 0; i < count; i++) out[i] = x[i] / s; break;
+            case EXPR_OP_POW: for (i = 0; i < count; i++) out[i] = pow(x[i], s); break;
+        }
+    } else {
+        s = a.scalar;
+        switch (op) {
+            case EXPR_OP_ADD: for (i = 0; i < count; i++) out[i] = s + y[i]; break;
+            case EXPR_OP_SUB: for (i = 0; i < count; i++) out[i] = s - y[i]; break;
+            case EXPR_OP_MUL: for (i = 0; i < count; i++) out[i] = s * y[i]; break;
+            case EXPR_OP_DIV: for (i = 0; i < count; i++) out[i] = s / y[i]; break;
+            case EXPR_OP_POW: for (i = 0; i < count; i++) out[i] = pow(s, y[i]); break;
+        }
+    }
+}
+
+// Up to EXPR_LANES values of the lane variable; uniform work runs once.
+// With dout, derivatives with respect to the lane variable ride along.
+static void runLanes(const ExprProgram* prog, const double* vars, int lane,
+                     const double* xs, double* out, double* dout, int count) {
+    LaneValue stack[EXPR_MAX_STACK];
+    LaneValue temps[EXPR_MAX_TEMPS];
+    int sp = -1;
+    bool fast = prog->precision == EXPR_FAST;
+    double* value = laneScratch[0];
+    double* spread = laneScratch[1];
+    int i;
+
+    const ExprInstr* in = prog->code;
+    const ExprInstr* end = prog->code + prog->codeLength;
+    for (; in < end; in++) {
+        u8 op = in->op;
+        LaneValue* top = &stack[sp < 0 ? 0 : sp];
+
+        switch (op) {
+            case EXPR_OP_CONST:
+                sp++;
+                stack[sp].lanes = NULL;
+                stack[sp].scalar = prog->consts[in->arg];
+                stack[sp].derivs = NULL;
+                break;
+            case EXPR_OP_VAR:
+                sp++;
+                stack[sp].lanes = in->arg == lane ? xs : NULL;
+                stack[sp].scalar = vars[in->arg];
+                stack[sp].derivs = in->arg == lane ? laneOnes : NULL;
+                break;
+            case EXPR_OP_LOAD:
+                stack[++sp] = temps[in->arg];
+                break;
+            case EXPR_OP_STORE:
+            case EXPR_OP_TEE:
+                temps[in->arg] = *top;
+                if (top->lanes) {
+                    memcpy(laneTemps[in->arg], top->lanes, count * sizeof(double));
+                    temps[in->arg].lanes = laneTemps[in->arg];
+                }
+                if (dout && top->derivs) {
+                    memcpy(laneTempDerivs[in->arg], top->derivs, count * sizeof(double));
+                    temps[in->arg].derivs = laneTempDerivs[in->arg];
+                }
+                if (op == EXPR_OP_STORE) sp--;
+                break;
+
+            case EXPR_OP_ADD:
+            case EXPR_OP_SUB:
+            case EXPR_OP_MUL:
+            case EXPR_OP_DIV:
+            case EXPR_OP_POW: {
+                sp--;
+                LaneValue* a = &stack[sp];
+                if (!a->lanes && !top->lanes) {
+                    a->scalar = applyOp(op, a->scalar, top->scalar, 0);
+                } else if (!dout) {
+                    binaryLanes(op, fast, laneRows[sp], *a, *top, count);
+                    a->lanes = laneRows[sp];
+                } else {
+                    // The uniform side, if any, is spread out for the derivative loop
+                    binaryLanes(op, fast, value, *a, *top, count);
+                    const double* x = a->lanes;
+                    const double* y = top->lanes;
+                    if (!x || !y) {
+                        double s = x ? top->scalar : a->scalar;
+                        for (i = 0; i < count; i++) spread[i] = s;
+                        if (!x) x = spread; else y = spread;
+                    }
+                    const double* dx = a->derivs ? a->derivs : laneZeros;
+                    const double* dy = top->derivs ? top->derivs : laneZeros;
+                    for (i = 0; i < count; i++) {
+                        laneDerivs[sp][i] = binaryDeriv(op, x[i], dx[i], y[i], dy[i], value[i]);
+                    }
+                    memcpy(laneRows[sp], value, count * sizeof(double));
+                    a->lanes = laneRows[sp];
+                    a->derivs = laneDerivs[sp];
+                }
+                break;
+            }
+
+            default: // unary
+                if (!top->lanes) {
+                    top->scalar = applyOp(op, top->scalar, 0, (s8)in->arg);
+                } else if (!dout) {
+                    unaryLanes(op, (s8)in->arg, fast, laneRows[sp], top->lanes, count);
+                    top->lanes = laneRows[sp];
+                } else {
+                    const double* x = top->lanes;
+                    unaryLanes(op, (s8)in->arg, fast, value, x, count);
+                    for (i = 0; i < count; i++) {
+                        laneDerivs[sp][i] = unaryDeriv(op, (s8)in->arg, x[i], top->derivs[i], value[i]);
+                    }
+                    memcpy(laneRows[sp], value, count * sizeof(double));
+                    top->lanes = laneRows[sp];
+                    top->derivs = laneDerivs[sp];
+                }
+                break;
+        }
+    }
+
+    if (sp < 0) {
+        for (i = 0; i < count; i++) out[i] = NAN;
+        if (dout) for (i = 0; i < count; i++) dout[i] = NAN;
+        return;
+    }
+    if (stack[sp].lanes) {
+        memcpy(out, stack[sp].lanes, count * sizeof(double));
+    } else {
+        for (i = 0; i < count; i++) out[i] = stack[sp].scalar;
+    }
+    if (dout) {
+        const double* d = stack[sp].derivs ? stack[sp].derivs : laneZeros;
+        memcpy(dout, d, count * sizeof(double));
+    }
+}
+
+void exprEvalBatch(const ExprProgram* prog, const double* vars, ExprVar lane,
+                   const double* xs, double* out, int count) {
+    for (int done = 0; done < count; done += EXPR_LANES) {
+        int n = count - done < EXPR_LANES ? count - done : EXPR_LANES;
+        runLanes(prog, vars, lane, xs + done, out + done, NULL, n);
+    }
+}
+
+void exprEvalBatchDual(const ExprProgram* prog, const double* vars, ExprVar lane,
+                       const double* xs, double* out, double* derivs, int count) {
+    for (int i = 0; i < EXPR_LANES; i++) laneOnes[i] = 1.0;
+    for (int done = 0; done < count; done += EXPR_LANES) {
+        int n = count - done < EXPR_LANES ? count - done : EXPR_LANES;
+        runLanes(prog, vars, lane, xs + done, out + done, derivs + done, n);
+    }
+}
+
+// ---- interval bounds ----
+
+typedef struct {
+    double lo;
+    double hi;
+} Interval;
+
+static Interval makeInterval(double a, double b) {
+    Interval r;
+    r.lo = a < b ? a : b;
+    r.hi = a < b ? b : a;
+    return r;
+}
+
+static Interval hull4(double a, double b, double c, double d) {
+    Interval r = makeInterval(a, b);
+    Interval s = makeInterval(c, d);
+    if (s.lo < r.lo) r.lo = s.lo;
+    if (s.hi > r.hi) r.hi = s.hi;
+    return r;
+}
+
+static bool containsZero(Interval a) {
+    return a.lo <= 0.0 && a.hi >= 0.0;
+}
+
+// Smallest p = offset + k * period with p >= lo
+static double nextPoint(double lo, double offset, double period) {
+    return offset + ceil((lo - offset) / period) * period;
+}
+
+// sin over an interval: the endpoints, plus +-1 where a peak falls inside
+static Interval sinInterval(Interval a) {
+    if (a.hi - a.lo >= 2.0 * M_PI) return makeInterval(-1.0, 1.0);
+    Interval r = makeInterval(sin(a.lo), sin(a.hi));
+    if (nextPoint(a.lo, M_PI / 2.0, 2.0 * M_PI) <= a.hi) r.hi = 1.0;
+    if (nextPoint(a.lo, -M_PI / 2.0, 2.0 * M_PI) <= a.hi) r.lo = -1.0;
+    return r;
+}
+
+static Interval powiInterval(Interval a, int n) {
+    if (n == 0) return makeInterval(1.0, 1.0);
+    if (n < 0) {
+        if (containsZero(a)) return makeInterval(-INFINITY, INFINITY);
+        Interval p = powiInterval(a, -n);
+        return makeInterval(1.0 / p.lo, 1.0 / p.hi);
+    }
+    Interval r = makeInterval(powi(a.lo, n), powi(a.hi, n));
+    if ((n & 1) == 0 && containsZero(a)) r.lo = 0.0;
+    return r;
+}
+
+// Gamma(u) for x! with u = x + 1; its one minimum on u > 0 is at 1.4616
+static Interval gammaInterval(Interval u) {
+    if (floor(u.hi < 0.0 ? u.hi : 0.0) >= u.lo) {
+        return makeInterval(-INFINITY, INFINITY); // a pole at 0, -1, -2, ...
+    }
+    Interval r = makeInterval(tgamma(u.lo), tgamma(u.hi));
+    if (u.lo > 0.0 && u.lo < 1.4616321449683623 && u.hi > 1.4616321449683623) {
+        r.lo = 0.88560319441088870;
+    }
+    return r;
+}
+
+// Bounds of f with each variable in [lo[v], hi[v]], by interval
+// arithmetic. Returns false where f is unbounded or partly undefined on the
+// box, which at plotting scale means a pole or a domain edge.
+bool exprEvalBox(const ExprProgram* prog, const double* lo, const double* hi,
+                 double* outLo, double* outHi) {
+    Interval stack[EXPR_MAX_STACK];
+    Interval temps[EXPR_MAX_TEMPS];
+    int sp = -1;
+
+    const ExprInstr* in = prog->code;
+    const ExprInstr* end = prog->code + prog->codeLength;
+    for (; in < end; in++) {
+        Interval* a = &stack[sp < 0 ? 0 : sp];
+        Interval b;
+
+        if (isTrig(in->op) && in->arg) { // degrees
+            a->lo *= M_PI / 180.0;
+            a->hi *= M_PI / 180.0;
+        }
+        switch (in->op) {
+            case EXPR_OP_CONST:
+                sp++;
+                stack[sp].lo = stack[sp].hi = prog->consts[in->arg];
+                break;
+            case EXPR_OP_VAR:
+                sp++;
+                stack[sp] = makeInterval(lo[in->arg], hi[in->arg]);
+                break;
+            case EXPR_OP_LOAD:  stack[++sp] = temps[in->arg]; break;
+            case EXPR_OP_STORE: temps[in->arg] = stack[sp--]; break;
+            case EXPR_OP_TEE:   temps[in->arg] = *a; break;
+
+            case EXPR_OP_NEG:  *a = makeInterval(-a->hi, -a->lo); break;
+            case EXPR_OP_SQRT:
+                if (a->lo < 0.0) return false;
+                *a = makeInterval(sqrt(a->lo), sqrt(a->hi));
+                break;
+            case EXPR_OP_SIN: *a = sinInterval(*a); break;
+            case EXPR_OP_COS:
+                a->lo += M_PI / 2.0;
+                a->hi += M_PI / 2.0;
+                *a = sinInterval(*a);
+                break;
+            case EXPR_OP_TAN:
+                if (nextPoint(a->lo, M_PI / 2.0, M_PI) <= a->hi) return false;
+                *a = makeInterval(tan(a->lo), tan(a->hi));
+                break;
+            case EXPR_OP_ASIN:
+                if (a->lo < -1.0 || a->hi > 1.0) return false;
+                *a = makeInterval(asin(a->lo), asin(a->hi));
+                break;
+            case EXPR_OP_ACOS:
+                if (a->lo < -1.0 || a->hi > 1.0) return false;
+                *a = makeInterval(acos(a->lo), acos(a->hi));
+                break;
+            case EXPR_OP_ATAN: *a = makeInterval(atan(a->lo), atan(a->hi)); break;
+            case EXPR_OP_LN:
+            case EXPR_OP_LOG:
+                if (a->lo <= 0.0) return false;
+                *a = makeInterval(applyOp(in->op, a->lo, 0, 0), applyOp(in->op, a->hi, 0, 0));
+                break;
+            case EXPR_OP_EXP: *a = makeInterval(exp(a->lo), exp(a->hi)); break;
+            case EXPR_OP_ABS:
+                if (containsZero(*a)) *a = makeInterval(0.0, fmax(-a->lo, a->hi));
+                else *a = makeInterval(fabs(a->lo), fabs(a->hi));
+                break;
+            case EXPR_OP_FACT:
+                a->lo += 1.0;
+                a->hi += 1.0;
+                *a = gammaInterval(*a);
+                break;
+            case EXPR_OP_SQR:  *a = powiInterval(*a, 2); break;
+            case EXPR_OP_POWI: *a = powiInterval(*a, (s8)in->arg); break;
+
+            default: // binary
+                b = stack[sp--];
+                a = &stack[sp];
+                switch (in->op) {
+                    case EXPR_OP_ADD: *a = makeInterval(a->lo + b.lo, a->hi + b.hi); break;
+                    case EXPR_OP_SUB: *a = makeInterval(a->lo - b.hi, a->hi - b.lo); break;
+                    case EXPR_OP_MUL:
+                        *a = hull4(a->lo * b.lo, a->lo * b.hi, a->hi * b.lo, a->hi * b.hi);
+                        break;
+                    case EXPR_OP_DIV:
+                        if (containsZero(b)) return false;
+                        *a = hull4(a->lo / b.lo, a->lo / b.hi, a->hi / b.lo, a->hi / b.hi);
+                        break;
+                    case EXPR_OP_POW:
+                        if (b.lo == b.hi && b.lo == floor(b.lo) && fabs(b.lo) <= 1024.0) {
+                            *a = powiInterval(*a, (int)b.lo);
+                        } else if (a->lo > 0.0 || (a->lo == 0.0 && b.lo > 0.0)) {
+                            *a = hull4(pow(a->lo, b.lo), pow(a->lo, b.hi), pow(a->hi, b.lo), pow(a->hi, b.hi));
+                        } else {
+                            return false; // negative bases are defined only at integers
+                        }
+                        break;
+                }
+                break;
+        }
+
+        if (sp >= 0 && !(isfinite(stack[sp].lo) && isfinite(stack[sp].hi))) return false;
+    }
+
+    if (sp < 0) return false;
+    *outLo = stack[sp].lo;
+    *outHi = stack[sp].hi;
+    return true;
+}
+
+bool exprEvalInterval(const ExprProgram* prog, const double* vars, ExprVar var,
+                      double lo, double hi, double* outLo, double* outHi) {
+    double los[EXPR_VAR_COUNT], his[EXPR_VAR_COUNT];
+    for (int v = 0; v < EXPR_VAR_COUNT; v++) {
+        los[v] = his[v] = vars[v];
+    }
+    los[var] = lo;
+    his[var] = hi;
+    return exprEvalBox(prog, los, his, outLo, outHi);
+}
+
+bool exprUsesVar(const ExprProgram* prog, ExprVar var) {
+    return (prog->varMask >> var) & 1;
+}
@@ -0,0 +1,342 @@
+#include "fastmath.h"
+
+// Everything is evaluated in double internally: on the 750's scalar FPU a
+// double costs little more than a float, and the extra bits leave the final
+// conversion as the only significant rounding.
+
+#define PIO2_HI 1.57079632673412561417e+00  // first 33 bits of pi/2
+#define PIO2_LO 6.07710050650619224932e-11  // pi/2 - PIO2_HI
+#define TWO_OVER_PI 6.36619772367581382433e-01
+#define REDUCE_LIMIT 1.0e6f                 // k * PIO2_HI stays exact below this
+#define ROUND_SHIFT 6755399441055744.0      // 1.5 * 2^52: adding it rounds to an integer
+#define LN2 0.69314718055994530942
+#define LOG10_E 0.43429448190325182765
+
+static inline u64 doubleBits(double x) {
+    u64 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static inline double bitsDouble(u64 bits) {
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+static inline u32 floatBits(float x) {
+    u32 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static inline float bitsFloat(u32 bits) {
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// ---- trigonometric ----
+
+// Minimax fits on |x| <= pi/4 (relative error 2^-32 and 2^-30 in the tail)
+static inline double sinPoly(double x) {
+    double z = x * x;
+    return x + x * z * (-0.16666666663854809 + z * (0.0083333318746687535 +
+               z * (-0.00019840086724458655 + z * 2.7249924912154832e-06)));
+}
+
+static inline double cosPoly(double x) {
+    double z = x * x;
+    return 1.0 + z * (-0.49999999969119047 + z * (0.041666650644488698 +
+                 z * (-0.001388758915474279 + z * 2.4463788215997344e-05)));
+}
+
+// x = k * pi/2 + r with |r| <= pi/4; returns k mod 4
+static inline int reduceHalfPi(float x, double* r) {
+    double k = (double)x * TWO_OVER_PI + ROUND_SHIFT;
+    int quadrant = (int)(doubleBits(k) & 3);
+    k -= ROUND_SHIFT;
+    *r = ((double)x - k * PIO2_HI) - k * PIO2_LO;
+    return quadrant;
+}
+
+float fastSin(float x) {
+    if (!(fabsf(x) < REDUCE_LIMIT)) return (float)sin((double)x); // huge, inf, NaN
+    double r;
+    switch (reduceHalfPi(x, &r)) {
+        case 0:  return (float)sinPoly(r);
+        case 1:  return (float)cosPoly(r);
+        case 2:  return (float)-sinPoly(r);
+        default: return (float)-cosPoly(r);
+    }
+}
+
+float fastCos(float x) {
+    if (!(fabsf(x) < REDUCE_LIMIT)) return (float)cos((double)x);
+    double r;
+    switch (reduceHalfPi(x, &r)) {
+        case 0:  return (float)cosPoly(r);
+        case 1:  return (float)-sinPoly(r);
+        case 2:  return (float)-cosPoly(r);
+        default: return (float)sinPoly(r);
+    }
+}
+
+float fastTan(float x) {
+    if (!(fabsf(x) < REDUCE_LIMIT)) return (float)tan((double)x);
+    double r;
+    int quadrant = reduceHalfPi(x, &r);
+    if (quadrant & 1) return (float)(-cosPoly(r) / sinPoly(r));
+    return (float)(sinPoly(r) / cosPoly(r));
+}
+
+// atan on |u| <= 2 - sqrt(3) (relative error 2^-30 in the tail)
+static inline double atanPoly(double u) {
+    double z = u * u;
+    return u + u * z * (-0.33333333308708846 + z * (0.1999998282918006 +
+               z * (-0.14283788536000225 + z * (0.11034922869497051 +
+               z * -0.078387697637518364))));
+}
+
+float fastAtan(float x) {
+    double t = fabs((double)x);
+    double base = 0.0;
+    bool inverted = t > 1.0;
+    if (inverted) t = 1.0 / t;
+    if (t > 0.26794919243112270) { // 2 - sqrt(3): shift by atan(1/sqrt(3))
+        t = (t * 1.7320508075688772 - 1.0) / (t + 1.7320508075688772);
+        base = M_PI / 6.0;
+    }
+    double result = base + atanPoly(t);
+    if (inverted) result = M_PI / 2.0 - result;
+    return (float)(x < 0.0f ? -result : result);
+}
+
+// ---- square root ----
+
+// The 750 has no fsqrt; libm falls back to a bit-by-bit loop. A reciprocal
+// square root guess refined by Newton steps gives a full double instead.
+static double sqrtNewton(double x) {
+    double y = bitsDouble(0x5fe6eb50c7b537a9ULL - (doubleBits(x) >> 1)); // 3.5%
+    double half = 0.5 * x;
+    y = y * (1.5 - half * y * y);
+    y = y * (1.5 - half * y * y);
+    y = y * (1.5 - half * y * y);
+    double s = x * y;
+    return s + 0.5 * y * (x - s * s);
+}
+
+float fastSqrt(float x) {
+    if (!(x > 0.0f) || isinf(x)) return x < 0.0f ? NAN : x; // 0, inf, NaN, negatives
+    return (float)sqrtNewton(x);
+}
+
+// asin on |x| <= 0.5 (relative error 2^-33 in the tail)
+static inline double asinPoly(double x) {
+    double z = x * x;
+    return x + x * z * (0.16666666665497151 + z * (0.075000005985749504 +
+               z * (0.044642358578661619 + z * (0.030397632532101981 +
+               z * (0.022132458038048534 + z * (0.019306189925321581 +
+               z * (0.0054433651329116994 + z * 0.029305055394713366)))))));
+}
+
+float fastAsin(float x) {
+    double a = fabs((double)x);
+    if (!(a <= 1.0)) return NAN;
+    double result;
+    if (a <= 0.5) {
+        result = asinPoly(a);
+    } else { // asin(a) = pi/2 - 2 asin(sqrt((1 - a) / 2))
+        result = M_PI / 2.0 - 2.0 * asinPoly(sqrtNewton(0.5 - 0.5 * a));
+    }
+    return (float)(x < 0.0f ? -result : result);
+}
+
+float fastAcos(float x) {
+    double a = (double)x;
+    if (!(fabs(a) <= 1.0)) return NAN;
+    if (a == 1.0) return 0.0f;
+    if (fabs(a) <= 0.5) return (float)(M_PI / 2.0 - asinPoly(a));
+    double half = 2.0 * asinPoly(sqrtNewton(0.5 - 0.5 * fabs(a)));
+    return (float)(a > 0.0 ? half : M_PI - half);
+}
+
+// ---- exponential and logarithm ----
+
+// 2^(j/32)
+static const double exp2Table[32] = {
+    1,
+    1.0218971486541166,
+    1.0442737824274138,
+    1.0671404006768237,
+    1.0905077326652577,
+    1.1143867425958924,
+    1.1387886347566916,
+    1.1637248587775775,
+    1.189207115002721,
+    1.215247359980469,
+    1.241857812073484,
+    1.2690509571917332,
+    1.2968395546510096,
+    1.3252366431597413,
+    1.3542555469368927,
+    1.383909881963832,
+    1.4142135623730951,
+    1.4451808069770467,
+    1.4768261459394993,
+    1.5091644275934228,
+    1.5422108254079407,
+    1.5759808451078865,
+    1.6104903319492543,
+    1.6457554781539649,
+    1.681792830507429,
+    1.7186192981224779,
+    1.7562521603732995,
+    1.7947090750031072,
+    1.8340080864093424,
+    1.8741676341103,
+    1.9152065613971474,
+    1.9571441241754002,
+};
+
+// x = 2^(k + j/32) * (1 + p), |p| <= ln2/64; double in, double out
+static double expCore(double x) {
+    double k = x * (32.0 / LN2) + ROUND_SHIFT;
+    u64 ki = doubleBits(k);
+    k -= ROUND_SHIFT;
+    double r = x - k * (LN2 / 32.0);
+    int n = (int)(s64)(ki << 13) >> 18;  // floor(k / 32), sign-extended from 51 bits
+    double scale = bitsDouble(doubleBits(exp2Table[ki & 31]) + ((u64)(s64)n << 52));
+    double p = r + r * r * (0.5 + r * (1.0 / 6.0 + r * (1.0 / 24.0 + r * (1.0 / 120.0))));
+    return scale + scale * p;
+}
+
+float fastExp(float x) {
+    if (x > 100.0f) return INFINITY;  // past FLT_MAX either way
+    if (x < -110.0f) return 0.0f;     // below the smallest subnormal
+    if (x != x) return x;
+    return (float)expCore(x);
+}
+
+// Bins of the mantissa, folded into [0.7, 1.4) so the bin around 1.0 is
+// exact (invc = 1): {1/c, -log(1/c)} with 1/c short enough that z/c is
+// exact in double
+static const double logTable[32][2] = {
+    {1.4143647029995918, -0.34668045713141593}, // 0.69922-0.71484
+    {1.3837838396430016, -0.32482165976824967}, // 0.71484-0.73047
+    {1.3544974103569984, -0.30343047066004702}, // 0.73047-0.74609
+    {1.3264249265193939, -0.28248729783343784}, // 0.74609-0.76172
+    {1.2994924336671829, -0.26197375258702266}, // 0.76172-0.77734
+    {1.2736318856477737, -0.24187257163612097}, // 0.77734-0.79297
+    {1.2487805336713791, -0.22216750207018765}, // 0.79297-0.80859
+    {1.2248804271221161, -0.20284322871991589}, // 0.80859-0.82422
+    {1.2018779739737511, -0.1838853118029844}, // 0.82422-0.83984
+    {1.1797235459089279, -0.16528012790096691}, // 0.83984-0.85547
+    {1.1583710834383965, -0.14701477983636216}, // 0.85547-0.87109
+    {1.1377778127789497, -0.12907707303789065}, // 0.87109-0.88672
+    {1.117903970181942, -0.11145547675213748}, // 0.88672-0.90234
+    {1.0987124815583229, -0.094139022957178728}, // 0.90234-0.91797
+    {1.0801688134670258, -0.077117337686950643}, // 0.91797-0.93359
+    {1.0622406974434853, -0.060380542566563028}, // 0.93359-0.94922
+    {1.0448979884386063, -0.04391926193272}, // 0.94922-0.96484
+    {1.0281124785542488, -0.027724575983635539}, // 0.96484-0.98047
+    {1.0118577405810356, -0.011787988435643309}, // 0.98047-0.99609
+    {1, 0}, // 0.99609-1.02344
+    {0.96240606904029846, 0.038318808189953056}, // 1.02344-1.05469
+    {0.93430662155151367, 0.067950606029154828}, // 1.05469-1.08594
+    {0.90780146792531013, 0.096729571947078152}, // 1.08594-1.11719
+    {0.88275866582989693, 0.12470342736552843}, // 1.11719-1.14844
+    {0.85906044766306877, 0.15191598966805236}, // 1.14844-1.17969
+    {0.83660135045647621, 0.17840760575531292}, // 1.17969-1.21094
+    {0.81528666242957115, 0.20421549454242113}, // 1.21094-1.24219
+    {0.79503109306097031, 0.22937405432409522}, // 1.24219-1.27344
+    {0.77575761079788208, 0.25391516481181958}, // 1.27344-1.30469
+    {0.75739648565649986, 0.27786840353510994}, // 1.30469-1.33594
+    {0.73988442495465279, 0.30126128747538983}, // 1.33594-1.36719
+    {0.72316387295722961, 0.32411942558054385}, // 1.36719-1.39844
+};
+
+#define LOG_OFFSET 0x3f330000u // bit pattern of 0.69921875
+
+// Natural log of a positive, finite, non-zero float
+static double logCore(float x) {
+    u32 ix = floatBits(x);
+    int k = 0;
+    if (ix < 0x00800000u) { // subnormal
+        ix = floatBits(x * 8388608.0f);
+        k = -23;
+    }
+    u32 tmp = ix - LOG_OFFSET;
+    int i = (tmp >> 18) & 31;
+    k += (s32)tmp >> 23;
+    double z = bitsFloat(ix - (tmp & 0xff800000u));
+    double r = z * logTable[i][0] - 1.0;
+    double r2 = r * r;
+    double p = r - r2 * (0.5 - r * (1.0 / 3.0 - r * (0.25 - r * (0.2 - r * (1.0 / 6.0)))));
+    return k * LN2 + logTable[i][1] + p;
+}
+
+float fastLog(float x) {
+    if (x == 1.0f) return 0.0f;
+    if (!(x > 0.0f) || isinf(x)) return x == 0.0f ? -INFINITY : (x < 0.0f ? NAN : x);
+    return (float)logCore(x);
+}
+
+float fastLog10(float x) {
+    if (x == 1.0f) return 0.0f;
+    if (!(x > 0.0f) || isinf(x)) return x == 0.0f ? -INFINITY : (x < 0.0f ? NAN : x);
+    return (float)(logCore(x) * LOG10_E);
+}
+
+float fastPow(float x, float y) {
+    // Negative bases, zeros and non-finite values keep libm's special cases
+    if (!(x > 0.0f) || isinf(x) || !isfinite(y)) return (float)pow((double)x, (double)y);
+    if (x == 1.0f || y == 0.0f) return 1.0f;
+    double t = (double)y * logCore(x);
+    if (t > 100.0) return INFINITY;
+    if (t < -110.0) return 0.0f;
+    return (float)expCore(t);
+}
+
+// ---- precise degree trig ----
+
+// Reduce to [-45, 45] degrees before converting, so multiples of 90 come
+// out exact and large arguments do not lose the fraction to pi's rounding
+static int reduceDegrees(double x, double* r) {
+    double a = fmod(x, 360.0);         // exact
+    double q = floor(a / 90.0 + 0.5);  // nearest quadrant
+    *r = (a - q * 90.0) * (M_PI / 180.0);
+    return (int)q & 3;
+}
+
+// 0.0 - sin(r) rather than -sin(r), so sin(180) shows 0 and not -0
+double sinDeg(double x) {
+    if (!isfinite(x)) return NAN;
+    double r;
+    switch (reduceDegrees(x, &r)) {
+        case 0:  return sin(r);
+        case 1:  return cos(r);
+        case 2:  return 0.0 - sin(r);
+        default: return -cos(r);
+    }
+}
+
+double cosDeg(double x) {
+    if (!isfinite(x)) return NAN;
+    double r;
+    switch (reduceDegrees(x, &r)) {
+        case 0:  return cos(r);
+        case 1:  return 0.0 - sin(r);
+        case 2:  return -cos(r);
+        default: return sin(r);
+    }
+}
+
+double tanDeg(double x) {
+    if (!isfinite(x)) return NAN;
+    double r;
+    int quadrant = reduceDegrees(x, &r);
+    if (r == 0.0) return (quadrant & 1) ? NAN : 0.0; // tan(90) has no value
+    if (quadrant & 1) return -cos(r) / sin(r);
+    return sin(r) / cos(r);
+}
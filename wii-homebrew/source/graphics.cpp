@@ -41,6 +41,10 @@ void drawRectangle(float x, float y, float width, float height, u32 color) {
     GRRLIB_Rectangle(x, y, width, height, color, 1);
 }
 
+void drawLine(float x1, float y1, float x2, float y2, u32 color) {
+    GRRLIB_Line(x1, y1, x2, y2, color);
+}
+
 void drawCircle(float x, float y, float radius, u32 color) {
     // Draw filled circle using GRRLIB
     for (float r = 0; r < radius; r += 1.0f) {
@@ -0,0 +1,1019 @@
+#include "graphview.h"
+#include "graphics.h"
+#include "input.h"
+#include <ogc/lwp_watchdog.h>
+#include <math.h>
+#include <ctype.h>
+
+#define GRAPH_BUDGET_US 4000   // evaluation time per frame
+#define GRAPH_REFINE_DEPTH 3   // up to 7 samples between two columns
+#define GRAPH_REFINE_MAX 7
+#define GRAPH_POLE_DEPTH 4     // interval splits before a segment counts as broken
+#define GRAPH_PAN_COLUMNS 4    // per frame with the D-pad held
+#define GRAPH_PAN_Y 0.02       // of the y range per frame
+#define GRAPH_MIN_STEP 1e-9
+#define GRAPH_MAX_STEP 1e6
+
+#define GRAPH_MAX_ITEMS 6
+#define GRAPH_MAX_SOURCE 256
+#define GRAPH_CURVE_SAMPLES 1024 // over one turn of t or θ
+#define GRAPH_MAX_SEGMENTS 4096  // per implicit curve
+#define GRAPH_CELL_SIZE 32       // quadtree roots, in pixels
+#define GRAPH_LEAF_SIZE 2
+#define GRAPH_CELL_STACK 256
+
+#define COLOR_TANGENT 0xF8E71CFF
+
+static const u32 itemColors[GRAPH_MAX_ITEMS] = {
+    COLOR_CYAN, COLOR_ORANGE, COLOR_GREEN, COLOR_RED, COLOR_BLUE, COLOR_PURPLE
+};
+
+typedef enum {
+    GRAPH_FUNCTION,   // y = f(x)
+    GRAPH_PARAMETRIC, // x(t), y(t)
+    GRAPH_POLAR,      // r(θ)
+    GRAPH_IMPLICIT    // f(x, y) = g(x, y)
+} GraphKind;
+
+typedef enum {
+    COLUMN_EMPTY,
+    COLUMN_SAMPLED,  // segment to the next column not checked yet
+    COLUMN_DONE
+} ColumnState;
+
+// Column k lives in slot k mod GRAPH_WIDTH; a slot is stale when its
+// column does not match
+typedef struct {
+    s64 column;
+    u8 state;          // ColumnState
+    bool broken;       // pole or domain edge before the next column
+    u8 refineCount;
+    double y;
+    double slope;      // f'(x), from the same pass as y
+    double refineX[GRAPH_REFINE_MAX];
+    double refineY[GRAPH_REFINE_MAX];
+} GraphColumn;
+
+// Functions keep their columns across pans; a zoom remaps them into the
+// other buffer
+typedef struct {
+    GraphColumn buffers[2][GRAPH_WIDTH];
+    u8 front;
+} FunctionCache;
+
+// Parametric and polar samples cover the whole parameter range, so they
+// do not depend on the view at all
+typedef struct {
+    int sampled;
+    int checked;
+    double x[GRAPH_CURVE_SAMPLES];
+    double y[GRAPH_CURVE_SAMPLES];
+    bool broken[GRAPH_CURVE_SAMPLES]; // segment to the next sample
+} CurveCache;
+
+typedef struct {
+    double step;      // x per column
+    s64 firstColumn;  // grid index of the left edge
+    double minY;
+    double maxY;
+} GraphView;
+
+// In pixels of the view it was traced for
+typedef struct {
+    float x0, y0, x1, y1;
+} GraphSegment;
+
+// Quadtree cell, in pixels of the view being traced
+typedef struct {
+    s16 px, py;
+    s16 size;
+} GraphCell;
+
+// Implicit curves are traced per view. The front buffer stays on screen
+// while the back one is traced for the current view.
+typedef struct {
+    GraphSegment segments[2][GRAPH_MAX_SEGMENTS];
+    int segmentCount[2];
+    GraphView views[2];  // each buffer's view
+    u8 front;
+    bool built;          // the front buffer holds a finished trace
+    bool tracing;
+    GraphCell cells[GRAPH_CELL_STACK];
+    int cellCount;
+} ImplicitCache;
+
+typedef struct {
+    bool used;
+    u8 kind;           // GraphKind
+    ExprAngleMode angles;
+    char source[GRAPH_MAX_SOURCE];
+    ExprProgram program;   // y(x), x(t), r(θ) or f - g
+    ExprProgram programY;  // y(t)
+    union {
+        FunctionCache function;
+        CurveCache curve;
+        ImplicitCache implicit;
+    } cache;
+} GraphItem;
+
+// A parsed entry, before it replaces or keeps an item
+typedef struct {
+    u8 kind;
+    char source[GRAPH_MAX_SOURCE];
+    ExprProgram program;
+    ExprProgram programY;
+} PendingItem;
+
+// Items keep their slot, and so their colour and cache, while the others
+// are edited
+static GraphItem items[GRAPH_MAX_ITEMS];
+static PendingItem pending[GRAPH_MAX_ITEMS];
+
+static bool valid = false;
+static bool autoscalePending = false; // first full pass still running
+static bool showDerivative = false;
+
+static GraphView view;
+
+// A-drag with the pointer
+static bool dragging = false;
+static float dragX, dragY;
+static float dragRemainder = 0.0f; // part of a column not yet panned
+
+// Tangent under the pointer, on the nearest function
+static bool tangentValid = false;
+static int tangentItem;
+static double tangentX;
+static double tangentY;
+static double tangentSlope;
+
+static double viewX(const GraphView* v, double px) {
+    return (v->firstColumn + px) * v->step;
+}
+
+static double viewY(const GraphView* v, double py) {
+    return v->maxY - py * (v->maxY - v->minY) / GRAPH_HEIGHT;
+}
+
+static bool sameView(const GraphView* a, const GraphView* b) {
+    return a->step == b->step && a->firstColumn == b->firstColumn &&
+           a->minY == b->minY && a->maxY == b->maxY;
+}
+
+static bool overBudget(u64 start) {
+    return ticks_to_microsecs(gettime() - start) >= GRAPH_BUDGET_US;
+}
+
+// Interval arithmetic bounds prog over [t0, t1]; where it cannot, halve
+// and look again. Still unbounded after GRAPH_POLE_DEPTH halvings: a pole
+// or domain edge that the line must not be drawn across.
+static bool segmentBroken(const ExprProgram* prog, ExprVar var, double t0, double t1, int depth) {
+    double vars[EXPR_VAR_COUNT] = {0};
+    double lo, hi;
+    if (exprEvalInterval(prog, vars, var, t0, t1, &lo, &hi)) return false;
+    if (depth == 0) return true;
+
+    double tm = 0.5 * (t0 + t1);
+    return segmentBroken(prog, var, t0, tm, depth - 1) || segmentBroken(prog, var, tm, t1, depth - 1);
+}
+
+// ---- functions ----
+
+static GraphColumn* frontColumns(GraphItem* item) {
+    return item->cache.function.buffers[item->cache.function.front];
+}
+
+static int slotFor(s64 column) {
+    int slot = (int)(column % GRAPH_WIDTH);
+    return slot < 0 ? slot + GRAPH_WIDTH : slot;
+}
+
+// Screen column i, or NULL while it has no sample
+static GraphColumn* columnAt(GraphItem* item, int i) {
+    s64 k = view.firstColumn + i;
+    GraphColumn* c = &frontColumns(item)[slotFor(k)];
+    return (c->column == k && c->state != COLUMN_EMPTY) ? c : NULL;
+}
+
+static void clearColumns(GraphColumn* buffer) {
+    for (int i = 0; i < GRAPH_WIDTH; i++) {
+        buffer[i].state = COLUMN_EMPTY;
+    }
+}
+
+// Evaluate runs of empty columns a block at a time. True once every
+// column in view has a sample.
+static bool sampleColumns(GraphItem* item, u64 start) {
+    double vars[EXPR_VAR_COUNT] = {0};
+    double xs[EXPR_LANES], ys[EXPR_LANES], slopes[EXPR_LANES];
+    GraphColumn* columns = frontColumns(item);
+
+    int i = 0;
+    while (i < GRAPH_WIDTH) {
+        if (columnAt(item, i)) {
+            i++;
+            continue;
+        }
+
+        int n = 0;
+        while (i + n < GRAPH_WIDTH && n < EXPR_LANES && !columnAt(item, i + n)) {
+            xs[n] = viewX(&view, i + n);
+            n++;
+        }
+        exprEvalBatchDual(&item->program, vars, EXPR_VAR_X, xs, ys, slopes, n);
+
+        for (int j = 0; j < n; j++) {
+            s64 k = view.firstColumn + i + j;
+            GraphColumn* c = &columns[slotFor(k)];
+            c->column = k;
+            c->state = COLUMN_SAMPLED;
+            c->broken = false;
+            c->refineCount = 0;
+            c->y = ys[j];
+            c->slope = slopes[j];
+        }
+        i += n;
+
+        if (i < GRAPH_WIDTH && overBudget(start)) return false;
+    }
+    return true;
+}
+
+// Between two samples a chord misses the curve by about |s1 - s0| dx / 8
+// (exact for a parabola); split until that is under half a pixel
+static void refineSegment(const ExprProgram* prog, GraphColumn* c, double x0, double y0, double s0,
+                          double x1, double y1, double s1, int depth) {
+    if (depth == 0 || c->refineCount >= GRAPH_REFINE_MAX) return;
+    if (!isfinite(y0) || !isfinite(y1) || !isfinite(s0) || !isfinite(s1)) return;
+
+    double pixelsPerY = GRAPH_HEIGHT / (view.maxY - view.minY);
+    double miss = fabs(s1 - s0) * (x1 - x0) / 8.0 * pixelsPerY;
+    if (miss <= 0.5) return;
+
+    double vars[EXPR_VAR_COUNT] = {0};
+    double xm = 0.5 * (x0 + x1);
+    double sm;
+    vars[EXPR_VAR_X] = xm;
+    double ym = exprEvalDual(prog, vars, EXPR_VAR_X, &sm);
+
+    refineSegment(prog, c, x0, y0, s0, xm, ym, sm, depth - 1);
+    if (c->refineCount >= GRAPH_REFINE_MAX) return;
+    c->refineX[c->refineCount] = xm;
+    c->refineY[c->refineCount] = ym;
+    c->refineCount++;
+    refineSegment(prog, c, xm, ym, sm, x1, y1, s1, depth - 1);
+}
+
+static void checkSegment(GraphItem* item, GraphColumn* c, const GraphColumn* next) {
+    double x0 = c->column * view.step, x1 = next->column * view.step;
+    c->refineCount = 0;
+    c->broken = !isfinite(c->y) || !isfinite(next->y) ||
+                segmentBroken(&item->program, EXPR_VAR_X, x0, x1, GRAPH_POLE_DEPTH);
+    if (!c->broken) {
+        refineSegment(&item->program, c, x0, c->y, c->slope, x1, next->y, next->slope, GRAPH_REFINE_DEPTH);
+    }
+    c->state = COLUMN_DONE;
+}
+
+static bool checkColumns(GraphItem* item, u64 start) {
+    for (int i = 0; i < GRAPH_WIDTH - 1; i++) {
+        GraphColumn* c = columnAt(item, i);
+        if (c->state != COLUMN_SAMPLED) continue;
+        checkSegment(item, c, columnAt(item, i + 1));
+        if (overBudget(start)) return false;
+    }
+    return true;
+}
+
+// Zooming by 2 keeps every other column, or the middle half; refinements
+// depend on the pixel scale and are redone
+static void remapColumns(GraphItem* item, bool in, s64 newFirst) {
+    FunctionCache* cache = &item->cache.function;
+    GraphColumn* columns = cache->buffers[cache->front];
+    GraphColumn* target = cache->buffers[cache->front ^ 1];
+    clearColumns(target);
+
+    for (int i = 0; i < GRAPH_WIDTH; i++) {
+        s64 k = newFirst + i;
+        s64 old;
+        if (in) {
+            if (k % 2 != 0) continue;
+            old = k / 2;
+        } else {
+            old = k * 2;
+        }
+
+        GraphColumn* c = &columns[slotFor(old)];
+        if (c->column != old || c->state == COLUMN_EMPTY) continue;
+        GraphColumn* t = &target[slotFor(k)];
+        t->column = k;
+        t->state = COLUMN_SAMPLED;
+        t->broken = false;
+        t->refineCount = 0;
+        t->y = c->y;
+        t->slope = c->slope;
+    }
+    cache->front ^= 1;
+}
+
+// ---- parametric and polar ----
+
+static double parameterAt(const GraphItem* item, int i) {
+    double turn = item->angles == EXPR_DEGREES ? 360.0 : 2.0 * M_PI;
+    return turn * i / (GRAPH_CURVE_SAMPLES - 1);
+}
+
+// Sample the parameter range, then check each segment for a pole. True
+// once both are done; nothing here depends on the view.
+static bool sampleCurve(GraphItem* item, u64 start) {
+    CurveCache* curve = &item->cache.curve;
+    double vars[EXPR_VAR_COUNT] = {0};
+    double ts[EXPR_LANES], r[EXPR_LANES];
+
+    while (curve->sampled < GRAPH_CURVE_SAMPLES) {
+        int first = curve->sampled;
+        int n = GRAPH_CURVE_SAMPLES - first;
+        if (n > EXPR_LANES) n = EXPR_LANES;
+        for (int j = 0; j < n; j++) {
+            ts[j] = parameterAt(item, first + j);
+        }
+
+        if (item->kind == GRAPH_PARAMETRIC) {
+            exprEvalBatch(&item->program, vars, EXPR_VAR_T, ts, curve->x + first, n);
+            exprEvalBatch(&item->programY, vars, EXPR_VAR_T, ts, curve->y + first, n);
+        } else {
+            double toRadians = item->angles == EXPR_DEGREES ? M_PI / 180.0 : 1.0;
+            exprEvalBatch(&item->program, vars, EXPR_VAR_THETA, ts, r, n);
+            for (int j = 0; j < n; j++) {
+                curve->x[first + j] = r[j] * cos(ts[j] * toRadians);
+                curve->y[first + j] = r[j] * sin(ts[j] * toRadians);
+            }
+        }
+        curve->sampled += n;
+        if (overBudget(start)) return false;
+    }
+
+    while (curve->checked < GRAPH_CURVE_SAMPLES - 1) {
+        int i = curve->checked;
+        double t0 = parameterAt(item, i), t1 = parameterAt(item, i + 1);
+        bool broken = !isfinite(curve->x[i]) || !isfinite(curve->y[i]) ||
+                      !isfinite(curve->x[i + 1]) || !isfinite(curve->y[i + 1]);
+        if (!broken && item->kind == GRAPH_PARAMETRIC) {
+            broken = segmentBroken(&item->program, EXPR_VAR_T, t0, t1, GRAPH_POLE_DEPTH) ||
+                     segmentBroken(&item->programY, EXPR_VAR_T, t0, t1, GRAPH_POLE_DEPTH);
+        } else if (!broken) {
+            broken = segmentBroken(&item->program, EXPR_VAR_THETA, t0, t1, GRAPH_POLE_DEPTH);
+        }
+        curve->broken[i] = broken;
+        curve->checked++;
+        if (overBudget(start)) return false;
+    }
+    return true;
+}
+
+// ---- implicit ----
+
+static void pushCell(ImplicitCache* cache, int px, int py, int size) {
+    if (cache->cellCount >= GRAPH_CELL_STACK) return;
+    GraphCell* cell = &cache->cells[cache->cellCount++];
+    cell->px = px;
+    cell->py = py;
+    cell->size = size;
+}
+
+static void emitSegment(ImplicitCache* cache, double x0, double y0, double x1, double y1) {
+    int back = cache->front ^ 1;
+    if (cache->segmentCount[back] >= GRAPH_MAX_SEGMENTS) return;
+    GraphSegment* s = &cache->segments[back][cache->segmentCount[back]++];
+    s->x0 = x0;
+    s->y0 = y0;
+    s->x1 = x1;
+    s->y1 = y1;
+}
+
+// Marching squares on one leaf. Corners run counter-clockwise from the
+// bottom left; edge e joins corner e and corner e + 1.
+static void traceLeaf(GraphItem* item, const GraphView* v, const GraphCell* cell) {
+    const double cx[4] = { (double)cell->px, (double)cell->px + cell->size,
+                           (double)cell->px + cell->size, (double)cell->px };
+    const double cy[4] = { (double)cell->py + cell->size, (double)cell->py + cell->size,
+                           (double)cell->py, (double)cell->py };
+    double f[4];
+    double vars[EXPR_VAR_COUNT] = {0};
+    for (int i = 0; i < 4; i++) {
+        vars[EXPR_VAR_X] = viewX(v, cx[i]);
+        vars[EXPR_VAR_Y] = viewY(v, cy[i]);
+        f[i] = exprEval(&item->program, vars);
+        if (!isfinite(f[i])) return;
+    }
+
+    // Where the sign changes along each edge, by linear interpolation
+    double ex[4], ey[4];
+    int crossings = 0;
+    for (int e = 0; e < 4; e++) {
+        int a = e, b = (e + 1) & 3;
+        if ((f[a] > 0.0) == (f[b] > 0.0)) {
+            ex[e] = NAN;
+            continue;
+        }
+        double t = f[a] / (f[a] - f[b]);
+        ex[e] = cx[a] + (cx[b] - cx[a]) * t;
+        ey[e] = cy[a] + (cy[b] - cy[a]) * t;
+        crossings++;
+    }
+
+    ImplicitCache* cache = &item->cache.implicit;
+    if (crossings == 2) {
+        int a = -1;
+        for (int e = 0; e < 4; e++) {
+            if (isnan(ex[e])) continue;
+            if (a < 0) {
+                a = e;
+            } else {
+                emitSegment(cache, ex[a], ey[a], ex[e], ey[e]);
+            }
+        }
+    } else if (crossings == 4) {
+        // Saddle: the centre decides which pair of corners is joined
+        vars[EXPR_VAR_X] = viewX(v, cell->px + 0.5 * cell->size);
+        vars[EXPR_VAR_Y] = viewY(v, cell->py + 0.5 * cell->size);
+        bool centre = exprEval(&item->program, vars) > 0.0;
+        if (centre == (f[0] > 0.0)) {
+            emitSegment(cache, ex[0], ey[0], ex[1], ey[1]);
+            emitSegment(cache, ex[2], ey[2], ex[3], ey[3]);
+        } else {
+            emitSegment(cache, ex[3], ey[3], ex[0], ey[0]);
+            emitSegment(cache, ex[1], ey[1], ex[2], ey[2]);
+        }
+    }
+}
+
+// Quadtree over the view: a cell whose interval bounds exclude zero cannot
+// hold the curve and is dropped; the rest split down to GRAPH_LEAF_SIZE
+// pixels for marching squares. Cells where f is unbounded (a pole) are
+// left out at leaf size, so no line joins the two sides. False when the
+// budget ran out first; a view change since then starts a new trace.
+static bool traceImplicit(GraphItem* item, u64 start) {
+    ImplicitCache* cache = &item->cache.implicit;
+
+    int back = cache->front ^ 1;
+    if (!cache->tracing) {
+        if (cache->built && sameView(&cache->views[cache->front], &view)) return true;
+
+        cache->tracing = true;
+        cache->views[back] = view;
+        cache->segmentCount[back] = 0;
+        cache->cellCount = 0;
+        for (int py = 0; py < GRAPH_HEIGHT; py += GRAPH_CELL_SIZE) {
+            for (int px = 0; px < GRAPH_WIDTH; px += GRAPH_CELL_SIZE) {
+                pushCell(cache, px, py, GRAPH_CELL_SIZE);
+            }
+        }
+    }
+
+    const GraphView* v = &cache->views[back];
+    while (cache->cellCount > 0) {
+        GraphCell cell = cache->cells[--cache->cellCount];
+        double lo[EXPR_VAR_COUNT] = {0}, hi[EXPR_VAR_COUNT] = {0};
+        lo[EXPR_VAR_X] = viewX(v, cell.px);
+        hi[EXPR_VAR_X] = viewX(v, cell.px + cell.size);
+        lo[EXPR_VAR_Y] = viewY(v, cell.py + cell.size);
+        hi[EXPR_VAR_Y] = viewY(v, cell.py);
+
+        double fLo, fHi;
+        bool bounded = exprEvalBox(&item->program, lo, hi, &fLo, &fHi);
+        if (bounded && (fLo > 0.0 || fHi < 0.0)) {
+            // no zero in this cell
+        } else if (cell.size > GRAPH_LEAF_SIZE) {
+            int half = cell.size / 2;
+            pushCell(cache, cell.px, cell.py, half);
+            pushCell(cache, cell.px + half, cell.py, half);
+            pushCell(cache, cell.px, cell.py + half, half);
+            pushCell(cache, cell.px + half, cell.py + half, half);
+        } else if (bounded) {
+            traceLeaf(item, v, &cell);
+        }
+
+        if (cache->cellCount > 0 && overBudget(start)) return false;
+    }
+
+    cache->front = back;
+    cache->built = true;
+    cache->tracing = false;
+    return true;
+}
+
+// ---- view ----
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Fit y to the first full pass of the functions and curves. Near a pole a
+// few samples reach far past the rest; when the extremes dwarf the middle
+// 96%, scale to that instead.
+static void autoscale() {
+    static double values[GRAPH_MAX_ITEMS * GRAPH_CURVE_SAMPLES];
+    int n = 0;
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        GraphItem* item = &items[i];
+        if (!item->used) continue;
+        if (item->kind == GRAPH_FUNCTION) {
+            for (int col = 0; col < GRAPH_WIDTH; col++) {
+                GraphColumn* c = columnAt(item, col);
+                if (c && isfinite(c->y)) values[n++] = c->y;
+            }
+        } else if (item->kind != GRAPH_IMPLICIT) {
+            for (int s = 0; s < GRAPH_CURVE_SAMPLES; s++) {
+                if (isfinite(item->cache.curve.y[s])) values[n++] = item->cache.curve.y[s];
+            }
+        }
+    }
+    if (n == 0) return; // nothing in view; keep the default range
+
+    qsort(values, n, sizeof(double), compareDoubles);
+    double lo = values[0], hi = values[n - 1];
+    int trim = n * 2 / 100;
+    double trimmedLo = values[trim], trimmedHi = values[n - 1 - trim];
+    if (hi - lo > 4.0 * (trimmedHi - trimmedLo)) {
+        lo = trimmedLo;
+        hi = trimmedHi;
+    }
+
+    // Add padding
+    double range = hi - lo;
+    if (range <= 0.0) range = 1.0;
+    view.minY = lo - range * 0.1;
+    view.maxY = hi + range * 0.1;
+}
+
+// This frame's share: samples for every item first, then pole checks and
+// refinement, then implicit traces, until the budget runs out
+static void work() {
+    u64 start = gettime();
+
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        GraphItem* item = &items[i];
+        if (!item->used) continue;
+        if (item->kind == GRAPH_FUNCTION && !sampleColumns(item, start)) return;
+        if ((item->kind == GRAPH_PARAMETRIC || item->kind == GRAPH_POLAR) && !sampleCurve(item, start)) return;
+    }
+
+    if (autoscalePending) {
+        autoscale();
+        autoscalePending = false;
+    }
+
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        GraphItem* item = &items[i];
+        if (!item->used) continue;
+        if (item->kind == GRAPH_FUNCTION && !checkColumns(item, start)) return;
+        if (item->kind == GRAPH_IMPLICIT && !traceImplicit(item, start)) return;
+    }
+}
+
+static void panY(double dy) {
+    view.minY += dy;
+    view.maxY += dy;
+}
+
+// Zoom by 2 (in) or 1/2 about screen point (px, py). The step changes by
+// exactly 2, so function columns carry over on the same grid.
+static void zoom(bool in, float px, float py) {
+    double newStep = in ? view.step * 0.5 : view.step * 2.0;
+    if (newStep < GRAPH_MIN_STEP || newStep > GRAPH_MAX_STEP) return;
+
+    double anchorX = viewX(&view, px - GRAPH_X);
+    double anchorY = viewY(&view, py - GRAPH_Y);
+    double scale = in ? 0.5 : 2.0;
+    s64 newFirst = (s64)floor(anchorX / newStep - (px - GRAPH_X) + 0.5);
+
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        if (items[i].used && items[i].kind == GRAPH_FUNCTION) {
+            remapColumns(&items[i], in, newFirst);
+        }
+    }
+
+    view.step = newStep;
+    view.firstColumn = newFirst;
+    view.minY = anchorY - (anchorY - view.minY) * scale;
+    view.maxY = anchorY + (view.maxY - anchorY) * scale;
+}
+
+// ---- entries ----
+
+// Offset of c outside any parentheses, or -1
+static int findTopLevel(const char* s, char c) {
+    int depth = 0;
+    for (int i = 0; s[i]; i++) {
+        if (s[i] == '(') depth++;
+        else if (s[i] == ')') depth--;
+        else if (s[i] == c && depth == 0) return i;
+    }
+    return -1;
+}
+
+// Copy s[0, length) without surrounding spaces
+static void copyTrimmed(char* out, int outSize, const char* s, int length) {
+    while (length > 0 && isspace((unsigned char)*s)) {
+        s++;
+        length--;
+    }
+    while (length > 0 && isspace((unsigned char)s[length - 1])) length--;
+    if (length > outSize - 1) length = outSize - 1;
+    memcpy(out, s, length);
+    out[length] = '\0';
+}
+
+static bool compilePart(ExprProgram* prog, const char* s, int length, ExprAngleMode angles) {
+    char text[GRAPH_MAX_SOURCE];
+    copyTrimmed(text, sizeof(text), s, length);
+    return exprCompile(prog, text, angles);
+}
+
+// The kind follows from the text: "y = f" is a function, any other "=" an
+// implicit curve, "x(t), y(t)" parametric and an expression in θ polar
+static const char* compileEntry(PendingItem* entry, ExprAngleMode angles) {
+    const char* s = entry->source;
+    int eq = findTopLevel(s, '=');
+    int comma = findTopLevel(s, ',');
+    u32 allowed;
+
+    if (eq >= 0) {
+        char lhs[GRAPH_MAX_SOURCE];
+        copyTrimmed(lhs, sizeof(lhs), s, eq);
+        if (strcmp(lhs, "y") == 0) {
+            entry->kind = GRAPH_FUNCTION;
+            if (!compilePart(&entry->program, s + eq + 1, strlen(s + eq + 1), angles)) return entry->program.error;
+        } else {
+            char text[GRAPH_MAX_SOURCE + 8];
+            snprintf(text, sizeof(text), "(%.*s)-(%s)", eq, s, s + eq + 1);
+            entry->kind = GRAPH_IMPLICIT;
+            if (!exprCompile(&entry->program, text, angles)) return entry->program.error;
+        }
+    } else if (comma >= 0) {
+        entry->kind = GRAPH_PARAMETRIC;
+        if (!compilePart(&entry->program, s, comma, angles)) return entry->program.error;
+        if (!compilePart(&entry->programY, s + comma + 1, strlen(s + comma + 1), angles)) return entry->programY.error;
+    } else {
+        if (!exprCompile(&entry->program, s, angles)) return entry->program.error;
+        entry->kind = exprUsesVar(&entry->program, EXPR_VAR_THETA) ? GRAPH_POLAR : GRAPH_FUNCTION;
+    }
+
+    switch (entry->kind) {
+        case GRAPH_FUNCTION:   allowed = 1 << EXPR_VAR_X; break;
+        case GRAPH_PARAMETRIC: allowed = 1 << EXPR_VAR_T; break;
+        case GRAPH_POLAR:      allowed = 1 << EXPR_VAR_THETA; break;
+        default:               allowed = (1 << EXPR_VAR_X) | (1 << EXPR_VAR_Y); break;
+    }
+    u32 used = entry->program.varMask | (entry->kind == GRAPH_PARAMETRIC ? entry->programY.varMask : 0);
+    if (used & ~allowed) {
+        if (entry->kind == GRAPH_FUNCTION && exprUsesVar(&entry->program, EXPR_VAR_Y)) return "Use = for x and y";
+        if (entry->kind == GRAPH_FUNCTION && exprUsesVar(&entry->program, EXPR_VAR_T)) return "Use x(t), y(t)";
+        return "Mixed variables";
+    }
+    // Their values take many evaluations, which the plot has no time for
+    if (entry->program.calculusCount > 0 || (entry->kind == GRAPH_PARAMETRIC && entry->programY.calculusCount > 0)) {
+        return "\xE2\x88\xAB and \xCE\xA3 need the = key";
+    }
+    return NULL;
+}
+
+// Move a compiled entry into a free slot with an empty cache
+static void startItem(GraphItem* item, const PendingItem* entry, ExprAngleMode angles) {
+    item->used = true;
+    item->kind = entry->kind;
+    item->angles = angles;
+    strcpy(item->source, entry->source);
+    item->program = entry->program;
+    item->programY = entry->programY;
+
+    // Work that does not depend on the plotted variable is done once per block
+    static const int loopVars[] = { EXPR_VAR_X, EXPR_VAR_T, EXPR_VAR_THETA, EXPR_VAR_COUNT };
+    exprOptimize(&item->program, loopVars[item->kind]);
+    item->program.precision = EXPR_FAST; // screen pixels need far fewer digits
+    if (item->kind == GRAPH_PARAMETRIC) {
+        exprOptimize(&item->programY, EXPR_VAR_T);
+        item->programY.precision = EXPR_FAST;
+    }
+
+    switch (item->kind) {
+        case GRAPH_FUNCTION:
+            clearColumns(item->cache.function.buffers[0]);
+            clearColumns(item->cache.function.buffers[1]);
+            item->cache.function.front = 0;
+            break;
+        case GRAPH_PARAMETRIC:
+        case GRAPH_POLAR:
+            item->cache.curve.sampled = 0;
+            item->cache.curve.checked = 0;
+            break;
+        case GRAPH_IMPLICIT:
+            item->cache.implicit.segmentCount[0] = 0;
+            item->cache.implicit.segmentCount[1] = 0;
+            item->cache.implicit.front = 0;
+            item->cache.implicit.built = false;
+            item->cache.implicit.tracing = false;
+            break;
+    }
+}
+
+bool graphPlot(const char* source, ExprAngleMode angles, char* error, int errorSize) {
+    valid = false;
+
+    // Parse every entry before touching the items, so an error leaves
+    // their caches for the corrected text
+    int count = 0;
+    const char* s = source;
+    for (;;) {
+        int length = findTopLevel(s, ';');
+        if (length < 0) length = strlen(s);
+
+        PendingItem* entry = &pending[count];
+        copyTrimmed(entry->source, sizeof(entry->source), s, length);
+        if (entry->source[0]) {
+            if (count == GRAPH_MAX_ITEMS) {
+                snprintf(error, errorSize, "ERROR: At most %d plots", GRAPH_MAX_ITEMS);
+                return false;
+            }
+            const char* message = compileEntry(entry, angles);
+            if (message) {
+                if (findTopLevel(source, ';') >= 0) {
+                    snprintf(error, errorSize, "ERROR in plot %d: %s", count + 1, message);
+                } else {
+                    snprintf(error, errorSize, "ERROR: %s", message);
+                }
+                return false;
+            }
+            count++;
+        }
+
+        if (!s[length]) break;
+        s += length + 1;
+    }
+    if (count == 0) {
+        snprintf(error, errorSize, "ERROR: Nothing to plot");
+        return false;
+    }
+
+    // Entries whose text is unchanged keep their slot and cache
+    bool keep[GRAPH_MAX_ITEMS] = {false};
+    bool matched[GRAPH_MAX_ITEMS] = {false};
+    bool anyKept = false;
+    for (int e = 0; e < count; e++) {
+        for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+            if (items[i].used && !keep[i] && items[i].angles == angles &&
+                strcmp(items[i].source, pending[e].source) == 0) {
+                keep[i] = matched[e] = anyKept = true;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        if (!keep[i]) items[i].used = false;
+    }
+    for (int e = 0; e < count; e++) {
+        if (matched[e]) continue;
+        for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+            if (!items[i].used) {
+                startItem(&items[i], &pending[e], angles);
+                break;
+            }
+        }
+    }
+
+    // A new set of plots starts at -10 to 10 with y fitted once the first
+    // pass is in; an edit keeps the view
+    if (!anyKept) {
+        view.step = 20.0 / GRAPH_WIDTH;
+        view.firstColumn = -GRAPH_WIDTH / 2;
+        view.minY = -10.0;
+        view.maxY = 10.0;
+        autoscalePending = true;
+    }
+
+    dragging = false;
+    tangentValid = false;
+    valid = true;
+    return true;
+}
+
+void graphClear() {
+    valid = false;
+}
+
+bool graphIsValid() {
+    return valid;
+}
+
+void graphUpdate() {
+    InputState* input = getInput();
+    bool inGraph = isPointInRect(input->x, input->y, GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT);
+
+    // D-pad pans while held
+    view.firstColumn += input->dpadX * GRAPH_PAN_COLUMNS;
+    if (input->dpadY != 0) panY(-input->dpadY * GRAPH_PAN_Y * (view.maxY - view.minY));
+
+    // A-drag moves the plot with the pointer
+    if (input->pressed && inGraph) {
+        dragging = true;
+        dragX = input->x;
+        dragY = input->y;
+        dragRemainder = 0.0f;
+    } else if (dragging && input->held) {
+        dragRemainder += input->x - dragX;
+        int columnsMoved = (int)dragRemainder;
+        view.firstColumn -= columnsMoved;
+        dragRemainder -= columnsMoved;
+        panY((input->y - dragY) * (view.maxY - view.minY) / GRAPH_HEIGHT);
+        dragX = input->x;
+        dragY = input->y;
+    } else {
+        dragging = false;
+    }
+
+    // 1 zooms out, 2 in, about the pointer when it is on the plot
+    if (input->oneButton || input->twoButton) {
+        float px = inGraph ? input->x : GRAPH_X + GRAPH_WIDTH / 2;
+        float py = inGraph ? input->y : GRAPH_Y + GRAPH_HEIGHT / 2;
+        zoom(input->twoButton, px, py);
+    }
+
+    // Wiimote + toggles the derivative curves
+    if (input->plusButton) {
+        showDerivative = !showDerivative;
+    }
+
+    work();
+
+    // Tangent at the pointer on the function passing closest to it, from
+    // one dual-number evaluation each
+    tangentValid = false;
+    if (inGraph && !dragging && !autoscalePending) {
+        double vars[EXPR_VAR_COUNT] = {0};
+        double pointerY = viewY(&view, input->y - GRAPH_Y);
+        double best = INFINITY;
+        vars[EXPR_VAR_X] = viewX(&view, input->x - GRAPH_X);
+        for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+            if (!items[i].used || items[i].kind != GRAPH_FUNCTION) continue;
+            double slope;
+            double y = exprEvalDual(&items[i].program, vars, EXPR_VAR_X, &slope);
+            if (!isfinite(y) || !isfinite(slope) || fabs(y - pointerY) >= best) continue;
+            best = fabs(y - pointerY);
+            tangentValid = true;
+            tangentItem = i;
+            tangentX = vars[EXPR_VAR_X];
+            tangentY = y;
+            tangentSlope = slope;
+        }
+    }
+}
+
+// Segment in graph coordinates, clipped to the plot area; skipped where
+// either end is outside the domain
+static void drawGraphSegment(double x0, double y0, double x1, double y1, u32 color) {
+    if (!isfinite(x0) || !isfinite(y0) || !isfinite(x1) || !isfinite(y1)) return;
+
+    // Liang-Barsky against the view rectangle
+    double left = viewX(&view, 0), right = viewX(&view, GRAPH_WIDTH);
+    double dx = x1 - x0, dy = y1 - y0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0 - left, right - x0, y0 - view.minY, view.maxY - y0 };
+    double t0 = 0.0, t1 = 1.0;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            if (t > t0) t0 = t;
+        } else if (t < t1) {
+            t1 = t;
+        }
+    }
+    if (t0 > t1) return;
+
+    double scaleX = 1.0 / view.step;
+    double scaleY = GRAPH_HEIGHT / (view.maxY - view.minY);
+    double ax = x0 + dx * t0, ay = y0 + dy * t0;
+    double bx = x0 + dx * t1, by = y0 + dy * t1;
+    drawLine(GRAPH_X + (ax - left) * scaleX, GRAPH_Y + GRAPH_HEIGHT - (ay - view.minY) * scaleY,
+             GRAPH_X + (bx - left) * scaleX, GRAPH_Y + GRAPH_HEIGHT - (by - view.minY) * scaleY,
+             color);
+}
+
+static void drawItem(GraphItem* item, u32 color) {
+    if (item->kind == GRAPH_FUNCTION) {
+        // Through the extra samples where it bends; checked segments only,
+        // so nothing is drawn across a pole
+        u32 derivColor = (color & 0xFFFFFF00) | 0x80;
+        for (int i = 0; i < GRAPH_WIDTH - 1; i++) {
+            GraphColumn* c = columnAt(item, i);
+            GraphColumn* next = columnAt(item, i + 1);
+            if (!c || !next || c->state != COLUMN_DONE || c->broken) continue;
+
+            double x0 = c->column * view.step;
+            double y0 = c->y;
+            for (int r = 0; r < c->refineCount; r++) {
+                drawGraphSegment(x0, y0, c->refineX[r], c->refineY[r], color);
+                x0 = c->refineX[r];
+                y0 = c->refineY[r];
+            }
+            drawGraphSegment(x0, y0, next->column * view.step, next->y, color);
+
+            if (showDerivative) {
+                drawGraphSegment(c->column * view.step, c->slope, next->column * view.step, next->slope, derivColor);
+            }
+        }
+    } else if (item->kind == GRAPH_IMPLICIT) {
+        const ImplicitCache* cache = &item->cache.implicit;
+        if (!cache->built) return;
+        const GraphSegment* segments = cache->segments[cache->front];
+        const GraphView* v = &cache->views[cache->front];
+        for (int i = 0; i < cache->segmentCount[cache->front]; i++) {
+            const GraphSegment* seg = &segments[i];
+            drawGraphSegment(viewX(v, seg->x0), viewY(v, seg->y0), viewX(v, seg->x1), viewY(v, seg->y1), color);
+        }
+    } else {
+        const CurveCache* curve = &item->cache.curve;
+        for (int i = 0; i < curve->checked; i++) {
+            if (curve->broken[i]) continue;
+            drawGraphSegment(curve->x[i], curve->y[i], curve->x[i + 1], curve->y[i + 1], color);
+        }
+    }
+}
+
+void graphRender() {
+    if (!valid) return;
+
+    drawGlassRectangle(GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT, 0x000000AA);
+
+    // Axes, where they are in view
+    if (view.minY <= 0.0 && view.maxY >= 0.0) {
+        float yZero = GRAPH_Y + GRAPH_HEIGHT - (0.0 - view.minY) * GRAPH_HEIGHT / (view.maxY - view.minY);
+        drawRectangle(GRAPH_X, yZero, GRAPH_WIDTH, 1, COLOR_WHITE);
+    }
+    if (view.firstColumn <= 0 && view.firstColumn + GRAPH_WIDTH >= 0) {
+        drawRectangle(GRAPH_X - view.firstColumn, GRAPH_Y, 1, GRAPH_HEIGHT, COLOR_WHITE);
+    }
+
+    if (autoscalePending) {
+        int done = 0, total = 0;
+        for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+            GraphItem* item = &items[i];
+            if (!item->used) continue;
+            if (item->kind == GRAPH_FUNCTION) {
+                for (int col = 0; col < GRAPH_WIDTH; col++) {
+                    if (columnAt(item, col)) done++;
+                }
+                total += GRAPH_WIDTH;
+            } else if (item->kind != GRAPH_IMPLICIT) {
+                done += item->cache.curve.sampled + item->cache.curve.checked;
+                total += 2 * GRAPH_CURVE_SAMPLES - 1;
+            }
+        }
+        char progress[32];
+        snprintf(progress, sizeof(progress), "Plotting... %d%%", total ? done * 100 / total : 0);
+        drawText(GRAPH_X + GRAPH_WIDTH / 2 - 60, GRAPH_Y + GRAPH_HEIGHT / 2 - 10, progress, COLOR_WHITE, 1.0f);
+        return;
+    }
+
+    int shown = 0;
+    for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+        if (!items[i].used) continue;
+        drawItem(&items[i], itemColors[i]);
+        shown++;
+    }
+
+    // Legend, when there is more than one entry
+    if (shown > 1) {
+        int row = 0;
+        for (int i = 0; i < GRAPH_MAX_ITEMS; i++) {
+            if (!items[i].used) continue;
+            char legend[40];
+            snprintf(legend, sizeof(legend), "%.36s", items[i].source);
+            drawText(GRAPH_X + GRAPH_WIDTH - 200, GRAPH_Y + 5 + row * 14, legend, itemColors[i], 0.6f);
+            row++;
+        }
+    }
+
+    // Tangent line and readout at the pointer
+    if (tangentValid) {
+        double left = viewX(&view, 0), right = viewX(&view, GRAPH_WIDTH);
+        drawGraphSegment(left, tangentY + tangentSlope * (left - tangentX),
+                         right, tangentY + tangentSlope * (right - tangentX), COLOR_TANGENT);
+        char tangentStr[64];
+        snprintf(tangentStr, sizeof(tangentStr), "x=%.4g  f=%.4g  f'=%.4g", tangentX, tangentY, tangentSlope);
+        drawText(GRAPH_X + 5, GRAPH_Y + 5, tangentStr, itemColors[tangentItem], 0.6f);
+    }
+
+    // Range labels
+    char labelStr[64];
+    snprintf(labelStr, sizeof(labelStr), "X: %.4g to %.4g", viewX(&view, 0), viewX(&view, GRAPH_WIDTH));
+    drawText(GRAPH_X, GRAPH_Y + GRAPH_HEIGHT + 5, labelStr, COLOR_WHITE, 0.6f);
+
+    snprintf(labelStr, sizeof(labelStr), "Y: %.4g to %.4g", view.minY, view.maxY);
+    drawText(GRAPH_X, GRAPH_Y + GRAPH_HEIGHT + 20, labelStr, COLOR_WHITE, 0.6f);
+}
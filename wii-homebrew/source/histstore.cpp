@@ -0,0 +1,454 @@
+#include "histstore.h"
+#include <ogc/lwp_watchdog.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef GEKKO
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#define HIST_DIR "sd:/apps/wii-dashboard/history"
+
+#define FILE_MAGIC 0x50485831   // "PHX1"
+#define FILE_VERSION 1
+#define FILE_HEADER_SIZE 8
+#define BLOCK_MAGIC 0x50484231  // "PHB1"
+
+// Block header, big-endian:
+//   0 magic  4 count  6 payload bytes  8 time column bytes  10 reserved
+//  12 first ms  20 last ms  28 first  32 last  36 low  40 high (fixed point)
+//  44 CRC-32 of bytes 0-43 and the payload
+#define BLOCK_HEADER_SIZE 48
+#define MAX_BLOCK_SIZE (BLOCK_HEADER_SIZE + 2 * HIST_COLUMN_BYTES)
+
+#define PRICE_SCALE 10000.0
+#define MAX_PRICE 100000.0f
+#define MAX_VARINT_BYTES 5
+#define FLUSH_AGE_MS (10 * 60 * 1000) // a quiet symbol still reaches the card
+
+static u8 ioBuffer[MAX_BLOCK_SIZE];            // SD reads and block assembly
+static PricePoint decodeBuffer[HIST_BLOCK_POINTS];
+
+// ---- encoding helpers ----
+
+static u32 crcTable[256];
+static bool crcReady = false;
+
+static u32 crc32(u32 crc, const u8* data, u32 length) {
+    if (!crcReady) {
+        for (u32 i = 0; i < 256; i++) {
+            u32 c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            crcTable[i] = c;
+        }
+        crcReady = true;
+    }
+    crc = ~crc;
+    for (u32 i = 0; i < length; i++) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put16(u8* p, u16 v) { p[0] = v >> 8; p[1] = v; }
+static void put32(u8* p, u32 v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+static void put64(u8* p, u64 v) { put32(p, (u32)(v >> 32)); put32(p + 4, (u32)v); }
+static u16 get16(const u8* p) { return (u16)(p[0] << 8 | p[1]); }
+static u32 get32(const u8* p) { return (u32)p[0] << 24 | (u32)p[1] << 16 | (u32)p[2] << 8 | p[3]; }
+static u64 get64(const u8* p) { return (u64)get32(p) << 32 | get32(p + 4); }
+
+static u32 zigzag(s32 v) { return ((u32)v << 1) ^ (u32)(v >> 31); }
+static s32 unzigzag(u32 v) { return (s32)(v >> 1) ^ -(s32)(v & 1); }
+
+static int putVarint(u8* out, u32 v) {
+    int n = 0;
+    while (v >= 0x80) {
+        out[n++] = (u8)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (u8)v;
+    return n;
+}
+
+// Returns false when the varint runs past end
+static bool getVarint(const u8** p, const u8* end, u32* out) {
+    u32 v = 0;
+    for (int shift = 0; shift < 7 * MAX_VARINT_BYTES; shift += 7) {
+        if (*p >= end) return false;
+        u8 b = *(*p)++;
+        v |= (u32)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static s32 toFixed(float price) {
+    if (price < 0.0f) price = 0.0f;
+    if (price > MAX_PRICE) price = MAX_PRICE;
+    return (s32)(price * PRICE_SCALE + 0.5);
+}
+
+static void historyPath(const char* symbol, char* out, int size) {
+    // Keep index and class symbols ("^GSPC", "BRK.B") FAT-safe
+    char name[16];
+    int n = 0;
+    for (; symbol[n] && n < (int)sizeof(name) - 1; n++) {
+        char c = symbol[n];
+        bool safe = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-';
+        name[n] = safe ? c : '_';
+    }
+    name[n] = '\0';
+    snprintf(out, size, "%s/%s.phx", HIST_DIR, name);
+}
+
+void initHistStore() {
+    mkdir(HIST_DIR, 0777);
+}
+
+// ---- reading ----
+
+// Bytes [offset, offset + size) of the file; valid until the next call
+static const u8* readAt(HistFile* file, u32 offset, u32 size) {
+#ifdef GEKKO
+    if (size > sizeof(ioBuffer)) return NULL;
+    if (fseek(file->file, offset, SEEK_SET) != 0) return NULL;
+    if (fread(ioBuffer, 1, size, file->file) != size) return NULL;
+    return ioBuffer;
+#else
+    if (offset + size > file->mapSize) return NULL;
+    return file->map + offset;
+#endif
+}
+
+static void truncateFile(HistFile* file, u32 size) {
+#ifdef GEKKO
+    fflush(file->file);
+    ftruncate(fileno(file->file), size);
+#else
+    ftruncate(file->fd, size);
+    file->mapSize = size;
+#endif
+}
+
+static bool blockCrcOk(const u8* block, u32 payloadBytes) {
+    u32 crc = crc32(0, block, 44);
+    crc = crc32(crc, block + BLOCK_HEADER_SIZE, payloadBytes);
+    return crc == get32(block + 44);
+}
+
+static bool addIndexEntry(HistFile* file, int* capacity, const HistBlock* block) {
+    if (file->blockCount == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 64;
+        HistBlock* blocks = (HistBlock*)realloc(file->blocks, grown * sizeof(HistBlock));
+        if (!blocks) return false;
+        file->blocks = blocks;
+        *capacity = grown;
+    }
+    file->blocks[file->blockCount++] = *block;
+    return true;
+}
+
+// A block header that makes sense at offset
+static bool readBlockHeader(HistFile* file, u32 offset, u32 size, HistBlock* block) {
+    block->payloadBytes = 0;
+    const u8* h = size - offset >= BLOCK_HEADER_SIZE ? readAt(file, offset, BLOCK_HEADER_SIZE) : NULL;
+    if (!h || get32(h) != BLOCK_MAGIC) return false;
+
+    block->offset = offset;
+    block->count = get16(h + 4);
+    block->payloadBytes = get16(h + 6);
+    block->firstMs = (s64)get64(h + 12);
+    block->lastMs = (s64)get64(h + 20);
+    block->first = (s32)get32(h + 28) / PRICE_SCALE;
+    block->last = (s32)get32(h + 32) / PRICE_SCALE;
+    block->low = (s32)get32(h + 36) / PRICE_SCALE;
+    block->high = (s32)get32(h + 40) / PRICE_SCALE;
+
+    return block->count > 0 && block->count <= HIST_BLOCK_POINTS &&
+           block->payloadBytes <= 2 * HIST_COLUMN_BYTES &&
+           offset + BLOCK_HEADER_SIZE + block->payloadBytes <= size;
+}
+
+// Offset of the next block magic at or after offset, or size if none
+static u32 findBlockMagic(HistFile* file, u32 offset, u32 size) {
+    while (size - offset >= 4) {
+        u32 chunk = size - offset < sizeof(ioBuffer) ? size - offset : sizeof(ioBuffer);
+        const u8* data = readAt(file, offset, chunk);
+        if (!data) break;
+        for (u32 i = 0; i + 4 <= chunk; i++) {
+            if (get32(data + i) == BLOCK_MAGIC) return offset + i;
+        }
+        offset += chunk - 3; // a magic may straddle the chunks
+    }
+    return size;
+}
+
+bool histOpen(HistFile* file, const char* symbol) {
+    memset(file, 0, sizeof(*file));
+
+    char path[64];
+    historyPath(symbol, path, sizeof(path));
+
+    u32 size;
+#ifdef GEKKO
+    file->file = fopen(path, "r+b");
+    if (!file->file) return false;
+    fseek(file->file, 0, SEEK_END);
+    size = (u32)ftell(file->file);
+#else
+    file->fd = open(path, O_RDWR);
+    if (file->fd < 0) return false;
+    struct stat info;
+    fstat(file->fd, &info);
+    size = (u32)info.st_size;
+    if (size > 0) {
+        void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, file->fd, 0);
+        if (map == MAP_FAILED) {
+            close(file->fd);
+            return false;
+        }
+        file->map = (const u8*)map;
+    }
+    file->mapSize = size;
+    file->mapLength = size;
+#endif
+
+    if (size == 0) return true;
+
+    const u8* header = readAt(file, 0, FILE_HEADER_SIZE);
+    if (!header || get32(header) != FILE_MAGIC || get32(header + 4) != FILE_VERSION) {
+        printf("History %s: unreadable header, starting over\n", symbol);
+        truncateFile(file, 0);
+        return true;
+    }
+
+    // Index from the headers; payloads are skipped except the last block's,
+    // which is where an interrupted write would leave damage, and those
+    // found by resyncing past a damaged block
+    int capacity = 0;
+    u32 offset = FILE_HEADER_SIZE;
+    u32 damaged = 0; // start of the damaged run being skipped, 0 if none
+    while (offset < size) {
+        HistBlock block;
+        bool valid = readBlockHeader(file, offset, size, &block);
+        u32 end = offset + BLOCK_HEADER_SIZE + block.payloadBytes;
+        if (valid && (end == size || damaged)) {
+            const u8* whole = readAt(file, offset, end - offset);
+            valid = whole && blockCrcOk(whole, block.payloadBytes);
+        }
+
+        if (!valid) {
+            if (!damaged) damaged = offset;
+            offset = findBlockMagic(file, offset + 1, size);
+            continue;
+        }
+
+        // Damage mid-file is skipped; the blocks after it are still good
+        if (damaged) {
+            printf("History %s: skipping %u damaged bytes\n", symbol, (unsigned)(offset - damaged));
+            damaged = 0;
+        }
+        if (!addIndexEntry(file, &capacity, &block)) return true; // indexed as far as memory allows
+        offset = end;
+    }
+
+    // Only damage that runs to the end of the file is cut off
+    if (damaged) {
+        printf("History %s: dropping %u damaged bytes at the tail\n", symbol, (unsigned)(size - damaged));
+        truncateFile(file, damaged);
+    }
+    return true;
+}
+
+void histClose(HistFile* file) {
+#ifdef GEKKO
+    if (file->file) fclose(file->file);
+#else
+    if (file->map) munmap((void*)file->map, file->mapLength);
+    close(file->fd);
+#endif
+    free(file->blocks);
+    file->blocks = NULL;
+    file->blockCount = 0;
+}
+
+int histFindBlock(const HistFile* file, s64 timeMs) {
+    int low = 0, high = file->blockCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (file->blocks[mid].lastMs < timeMs) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+int histReadBlock(HistFile* file, int index, PricePoint* out) {
+    const HistBlock* block = &file->blocks[index];
+    const u8* data = readAt(file, block->offset, BLOCK_HEADER_SIZE + block->payloadBytes);
+    if (!data || !blockCrcOk(data, block->payloadBytes)) return -1;
+
+    u16 timeBytes = get16(data + 8);
+    if (timeBytes > block->payloadBytes) return -1;
+
+    const u8* timePos = data + BLOCK_HEADER_SIZE;
+    const u8* timeEnd = timePos + timeBytes;
+    const u8* pricePos = timeEnd;
+    const u8* priceEnd = data + BLOCK_HEADER_SIZE + block->payloadBytes;
+
+    s64 timeMs = block->firstMs;
+    s32 price = (s32)get32(data + 28);
+    out[0].timeUs = timeMs * 1000;
+    out[0].price = price / PRICE_SCALE;
+
+    for (int i = 1; i < block->count; i++) {
+        u32 dt, dp;
+        if (!getVarint(&timePos, timeEnd, &dt) || !getVarint(&pricePos, priceEnd, &dp)) return -1;
+        timeMs += dt;
+        price += unzigzag(dp);
+        out[i].timeUs = timeMs * 1000;
+        out[i].price = price / PRICE_SCALE;
+    }
+    return block->count;
+}
+
+// ---- writing ----
+
+void histWriterInit(HistWriter* writer, const char* symbol) {
+    memset(writer, 0, sizeof(*writer));
+    snprintf(writer->symbol, sizeof(writer->symbol), "%s", symbol);
+}
+
+// Validate the file once per session and continue from its last point
+static int resume(HistWriter* writer, PricePoint* out, int max) {
+    writer->checked = true;
+
+    HistFile file;
+    if (!histOpen(&file, writer->symbol)) return 0;
+
+    if (file.blockCount > 0) {
+        s64 fileLastMs = file.blocks[file.blockCount - 1].lastMs;
+        if (writer->count > 0 && writer->firstMs < fileLastMs) {
+            // Buffered before the check, behind the file's end (the clock
+            // stepped back); dropped to keep the file in time order
+            printf("History %s: dropping %d points older than the file\n", writer->symbol, writer->count);
+            writer->count = 0;
+        }
+        if (writer->count == 0) writer->lastMs = fileLastMs;
+    }
+
+    // Newest blocks covering max points, decoded oldest first
+    int start = file.blockCount;
+    int total = 0;
+    while (start > 0 && total < max) {
+        start--;
+        total += file.blocks[start].count;
+    }
+
+    int skip = total > max ? total - max : 0;
+    int n = 0;
+    for (int b = start; b < file.blockCount; b++) {
+        int count = histReadBlock(&file, b, decodeBuffer);
+        for (int i = 0; i < count; i++) {
+            if (skip > 0) {
+                skip--;
+                continue;
+            }
+            out[n++] = decodeBuffer[i];
+        }
+    }
+
+    histClose(&file);
+    return n;
+}
+
+int histLoadRecent(HistWriter* writer, PricePoint* out, int max) {
+    return resume(writer, out, max);
+}
+
+bool histFlush(HistWriter* writer) {
+    if (writer->count == 0) return true;
+    if (!writer->checked) resume(writer, NULL, 0);
+    if (writer->count == 0) return true; // dropped by the check
+
+    u16 payload = writer->timeBytes + writer->priceBytes;
+    u8* block = ioBuffer;
+    put32(block, BLOCK_MAGIC);
+    put16(block + 4, writer->count);
+    put16(block + 6, payload);
+    put16(block + 8, writer->timeBytes);
+    put16(block + 10, 0);
+    put64(block + 12, (u64)writer->firstMs);
+    put64(block + 20, (u64)writer->lastMs);
+    put32(block + 28, (u32)writer->firstPrice);
+    put32(block + 32, (u32)writer->lastPrice);
+    put32(block + 36, (u32)writer->lowPrice);
+    put32(block + 40, (u32)writer->highPrice);
+    memcpy(block + BLOCK_HEADER_SIZE, writer->timeColumn, writer->timeBytes);
+    memcpy(block + BLOCK_HEADER_SIZE + writer->timeBytes, writer->priceColumn, writer->priceBytes);
+
+    u32 crc = crc32(0, block, 44);
+    put32(block + 44, crc32(crc, block + BLOCK_HEADER_SIZE, payload));
+
+    // The pending block is dropped either way; it cannot grow any further
+    writer->count = 0;
+
+    char path[64];
+    historyPath(writer->symbol, path, sizeof(path));
+    FILE* file = fopen(path, "ab");
+    if (!file) {
+        printf("History %s: cannot open %s\n", writer->symbol, path);
+        return false;
+    }
+
+    bool ok = true;
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) {
+        u8 header[FILE_HEADER_SIZE];
+        put32(header, FILE_MAGIC);
+        put32(header + 4, FILE_VERSION);
+        ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    }
+    u32 size = BLOCK_HEADER_SIZE + payload;
+    ok = ok && fwrite(block, 1, size, file) == size;
+    fclose(file);
+
+    if (!ok) printf("History %s: write failed\n", writer->symbol);
+    return ok;
+}
+
+// The file itself is only touched when the block is written
+void histAppend(HistWriter* writer, s64 timeUs, float price) {
+    s64 timeMs = timeUs / 1000;
+    s32 fixed = toFixed(price);
+
+    // Keep the file in time order even if the clock steps back
+    if (timeMs < writer->lastMs) return;
+
+    // A gap too long for one varint starts a new block
+    if (writer->count > 0 && timeMs - writer->lastMs > 0xFFFFFFFFLL) histFlush(writer);
+
+    u64 nowMs = ticks_to_millisecs(gettime());
+    if (writer->count == 0) {
+        writer->firstMs = timeMs;
+        writer->firstPrice = fixed;
+        writer->lowPrice = fixed;
+        writer->highPrice = fixed;
+        writer->timeBytes = 0;
+        writer->priceBytes = 0;
+        writer->openedMs = nowMs;
+    } else {
+        writer->timeBytes += putVarint(writer->timeColumn + writer->timeBytes, (u32)(timeMs - writer->lastMs));
+        writer->priceBytes += putVarint(writer->priceColumn + writer->priceBytes, zigzag(fixed - writer->lastPrice));
+        if (fixed < writer->lowPrice) writer->lowPrice = fixed;
+        if (fixed > writer->highPrice) writer->highPrice = fixed;
+    }
+    writer->lastMs = timeMs;
+    writer->lastPrice = fixed;
+    writer->count++;
+
+    bool full = writer->count == HIST_BLOCK_POINTS ||
+                writer->timeBytes > HIST_COLUMN_BYTES - MAX_VARINT_BYTES ||
+                writer->priceBytes > HIST_COLUMN_BYTES - MAX_VARINT_BYTES;
+    if (full || nowMs - writer->openedMs >= FLUSH_AGE_MS) histFlush(writer);
+}
@@ -0,0 +1,84 @@
+#include "indicators.h"
+
+void indicatorsInit(IndicatorState* state) {
+    memset(state, 0, sizeof(*state));
+}
+
+// Welford's update, extended to remove the sample leaving the window
+static void windowAdd(IndicatorState* state, float price) {
+    if (state->windowCount == IND_SMA_PERIOD) {
+        double old = state->window[state->windowHead];
+        double oldMean = state->mean;
+        state->mean += (price - old) / IND_SMA_PERIOD;
+        state->m2 += (price - old) * (price - state->mean + old - oldMean);
+        if (state->m2 < 0.0) state->m2 = 0.0; // rounding
+    } else {
+        state->windowCount++;
+        double delta = price - state->mean;
+        state->mean += delta / state->windowCount;
+        state->m2 += delta * (price - state->mean);
+    }
+    state->window[state->windowHead] = price;
+    state->windowHead = (state->windowHead + 1) % IND_SMA_PERIOD;
+}
+
+void indicatorsAdd(IndicatorState* state, float price, float typical, float volume) {
+    IndicatorValues* values = &state->values;
+
+    windowAdd(state, price);
+    if (state->windowCount == IND_SMA_PERIOD) {
+        double stddev = sqrt(state->m2 / IND_SMA_PERIOD);
+        values->smaValid = true;
+        values->sma = (float)state->mean;
+        values->bandsValid = true;
+        values->upperBand = (float)(state->mean + IND_BOLLINGER_K * stddev);
+        values->lowerBand = (float)(state->mean - IND_BOLLINGER_K * stddev);
+    }
+
+    // EMA seeded with the SMA of its first period
+    state->emaSamples++;
+    if (state->emaSamples <= IND_EMA_PERIOD) {
+        state->ema += (price - state->ema) / state->emaSamples;
+    } else {
+        state->ema += (price - state->ema) * (2.0 / (IND_EMA_PERIOD + 1));
+    }
+    if (state->emaSamples >= IND_EMA_PERIOD) {
+        values->emaValid = true;
+        values->ema = (float)state->ema;
+    }
+
+    // RSI: simple average of the first period's moves, then Wilder smoothing
+    if (state->hasLastPrice) {
+        double move = price - state->lastPrice;
+        double gain = move > 0.0 ? move : 0.0;
+        double loss = move < 0.0 ? -move : 0.0;
+
+        state->rsiSamples++;
+        if (state->rsiSamples <= IND_RSI_PERIOD) {
+            state->avgGain += (gain - state->avgGain) / state->rsiSamples;
+            state->avgLoss += (loss - state->avgLoss) / state->rsiSamples;
+        } else {
+            state->avgGain = (state->avgGain * (IND_RSI_PERIOD - 1) + gain) / IND_RSI_PERIOD;
+            state->avgLoss = (state->avgLoss * (IND_RSI_PERIOD - 1) + loss) / IND_RSI_PERIOD;
+        }
+
+        if (state->rsiSamples >= IND_RSI_PERIOD) {
+            double total = state->avgGain + state->avgLoss;
+            values->rsiValid = true;
+            values->rsi = total > 0.0 ? (float)(100.0 * state->avgGain / total) : 50.0f;
+        }
+    }
+    state->lastPrice = price;
+    state->hasLastPrice = true;
+
+    if (volume > 0.0f) {
+        state->priceVolume += (double)typical * volume;
+        state->volume += volume;
+        values->vwapValid = true;
+        values->vwap = (float)(state->priceVolume / state->volume);
+    }
+}
+
+const IndicatorValues* indicatorsGet(const IndicatorState* state) {
+    return &state->values;
+}
@@ -29,6 +29,8 @@ void updateInput() {
     currentInput.homeButton = (pressed & WPAD_BUTTON_HOME) != 0;
     currentInput.plusButton = (pressed & WPAD_BUTTON_PLUS) != 0;
     currentInput.minusButton = (pressed & WPAD_BUTTON_MINUS) != 0;
+    currentInput.oneButton = (pressed & WPAD_BUTTON_1) != 0;
+    currentInput.twoButton = (pressed & WPAD_BUTTON_2) != 0;
     
     currentInput.pressed = (pressed & WPAD_BUTTON_A) != 0;
     currentInput.held = (held & WPAD_BUTTON_A) != 0;
@@ -2,6 +2,14 @@
 #include "graphics.h"
 #include "input.h"
 #include "network.h"
+#include "config.h"
+#include "quotestream.h"
+#include "sntp.h"
+#include "netsched.h"
+#include "netstats.h"
+#include "metrics.h"
+#include "alerts.h"
+#include "toast.h"
 #include "dashboard.h"
 #include "clock.h"
 #include "worldclock.h"
@@ -28,6 +36,9 @@ int main(int argc, char **argv) {
     // Initialize FAT for SD card access
     fatInitDefault();
     
+    // Load settings from SD (falls back to defaults)
+    loadConfig();
+    
     // Initialize graphics system
     initGraphics();
     
@@ -37,6 +48,17 @@ int main(int argc, char **argv) {
     // Initialize network
     bool networkAvailable = initNetwork();
     
+    // Background fetches for all scenes
+    initNetStats();
+    initMetrics(networkAvailable ? getConfig()->metricsPort : 0);
+    initNetScheduler();
+    
+    // Application clock, disciplined in the background via SNTP
+    initSntp((networkAvailable && getConfig()->ntpEnabled) ? "pool.ntp.org" : NULL);
+    
+    // Price alerts, checked as quotes arrive and shown as toasts in any scene
+    initAlerts();
+    
     // Initialize scenes
     initDashboard();
     initClock();
@@ -45,11 +67,6 @@ int main(int argc, char **argv) {
     initStocks();
     initCalculator();
     
-    // Sync time via NTP if network available
-    if (networkAvailable) {
-        syncNTPTime();
-    }
-    
     // Main loop
     while(currentScene != SCENE_EXIT) {
         // Update input
@@ -61,6 +78,15 @@ int main(int argc, char **argv) {
             break;
         }
         
+        // Background services
+        updateQuoteStream();
+        updateSntp();
+        updateNetScheduler();
+        serviceStocks();
+        updateNetStats();
+        updateMetrics();
+        updateToasts();
+        
         // Update current scene
         switch(currentScene) {
             case SCENE_DASHBOARD:
@@ -117,6 +143,7 @@ int main(int argc, char **argv) {
                 break;
         }
         
+        renderToasts();
         endFrame();
     }
     
@@ -127,6 +154,10 @@ int main(int argc, char **argv) {
     cleanupNotes();
     cleanupStocks();
     cleanupCalculator();
+    cleanupSntp();
+    cleanupNetScheduler();
+    cleanupMetrics();
+    cleanupNetStats();
     cleanupNetwork();
     cleanupGraphics();
     
@@ -0,0 +1,471 @@
+#include "metrics.h"
+#include "netstats.h"
+#include "sntp.h"
+#include <network.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <ogc/lwp.h>
+#include <ogc/mutex.h>
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_CLIENTS 2
+#define REQUEST_SIZE 512
+#define HEADER_SIZE 256
+#define RESPONSE_SIZE (96 * 1024) // a freshness line per source
+#define CLIENT_TIMEOUT_MS 2000
+
+#define FRAME_WINDOW 256   // frames kept for percentiles
+#define MAX_SOURCES 1024   // the whole stock watchlist
+
+#define SERVER_STACK_SIZE (16 * 1024)
+#define SERVER_PRIORITY 40 // below the main loop and the fetch worker
+#define SERVER_POLL_US 5000
+
+typedef enum {
+    CLIENT_FREE,
+    CLIENT_READING,
+    CLIENT_WRITING
+} ClientState;
+
+typedef struct {
+    ClientState state;
+    int sock;
+    u64 since;
+    char request[REQUEST_SIZE];
+    int requestLen;
+    char response[RESPONSE_SIZE];
+    int responseLen;
+    int responseSent;
+} MetricsClient;
+
+typedef struct {
+    char name[16];
+    u64 lastMs;
+} FreshnessSource;
+
+// Written by the main thread, read by the network thread under statsMutex
+typedef struct {
+    u32 frameUs[FRAME_WINDOW];
+    u64 frameCount;
+    u64 frameSumUs;
+    SntpStats sntp;
+    time_t now;
+    FreshnessSource sources[MAX_SOURCES];
+    int sourceCount;
+} MetricsSnapshot;
+
+typedef struct {
+    char* data;
+    int size;
+    int length;
+} OutBuffer;
+
+static int listenSock = -1;
+static MetricsClient clients[MAX_CLIENTS];
+static MetricsSnapshot shared;
+static MetricsSnapshot report; // server thread's copy of shared
+static mutex_t statsMutex = LWP_MUTEX_NULL;
+static lwp_t serverThread = LWP_THREAD_NULL;
+static volatile bool serverQuit = false;
+static bool serverRunning = false;
+static bool metricsReady = false;
+static u64 startMs = 0;
+static u64 lastFrameTicks = 0;
+
+static u64 nowMs() {
+    return ticks_to_millisecs(gettime());
+}
+
+// ---------------------------------------------------------------------------
+// Main thread side
+// ---------------------------------------------------------------------------
+
+void updateMetrics() {
+    if (!metricsReady) return;
+
+    u64 ticks = gettime();
+    u32 frameUs = lastFrameTicks ? (u32)ticks_to_microsecs(ticks - lastFrameTicks) : 0;
+    lastFrameTicks = ticks;
+
+    LWP_MutexLock(statsMutex);
+    if (frameUs > 0) {
+        shared.frameUs[shared.frameCount % FRAME_WINDOW] = frameUs;
+        shared.frameCount++;
+        shared.frameSumUs += frameUs;
+    }
+    shared.sntp = *getSntpStats();
+    shared.now = sntpTime();
+    LWP_MutexUnlock(statsMutex);
+}
+
+void metricsMarkFresh(const char* source) {
+    if (!metricsReady) return;
+
+    LWP_MutexLock(statsMutex);
+    FreshnessSource* entry = NULL;
+    for (int i = 0; i < shared.sourceCount && !entry; i++) {
+        if (strcmp(shared.sources[i].name, source) == 0) entry = &shared.sources[i];
+    }
+    if (!entry && shared.sourceCount < MAX_SOURCES) {
+        entry = &shared.sources[shared.sourceCount++];
+        snprintf(entry->name, sizeof(entry->name), "%s", source);
+    }
+    if (entry) entry->lastMs = nowMs();
+    LWP_MutexUnlock(statsMutex);
+}
+
+// ---------------------------------------------------------------------------
+// Report generation (server thread)
+// ---------------------------------------------------------------------------
+
+static void append(OutBuffer* out, const char* format, ...) {
+    if (out->length >= out->size - 1) return;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out->data + out->length, out->size - out->length, format, args);
+    va_end(args);
+
+    if (written > 0) {
+        out->length += written;
+        if (out->length > out->size - 1) out->length = out->size - 1; // truncated
+    }
+}
+
+static int compareU32(const void* a, const void* b) {
+    u32 x = *(const u32*)a;
+    u32 y = *(const u32*)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    u64 count;
+    double avgMs;
+    double p50Ms;
+    double p99Ms;
+    double maxMs;
+} FrameSummary;
+
+// Caller holds statsMutex
+static FrameSummary summarizeFrames() {
+    FrameSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.count = shared.frameCount;
+    if (shared.frameCount == 0) return summary;
+
+    static u32 sorted[FRAME_WINDOW];
+    int n = shared.frameCount < FRAME_WINDOW ? (int)shared.frameCount : FRAME_WINDOW;
+    memcpy(sorted, shared.frameUs, n * sizeof(u32));
+    qsort(sorted, n, sizeof(u32), compareU32);
+
+    summary.avgMs = shared.frameSumUs / 1000.0 / shared.frameCount;
+    summary.p50Ms = sorted[(n - 1) / 2] / 1000.0;
+    summary.p99Ms = sorted[(n * 99 - 1) / 100] / 1000.0;
+    summary.maxMs = sorted[n - 1] / 1000.0;
+    return summary;
+}
+
+typedef struct {
+    u32 mem1Free;
+    u32 mem2Free;
+    u32 mallocArena;
+    u32 mallocUsed;
+} HeapSummary;
+
+static HeapSummary summarizeHeap() {
+    HeapSummary heap;
+#ifdef GEKKO
+    struct mallinfo info = mallinfo();
+#else
+    struct mallinfo2 info = mallinfo2(); // mallinfo is deprecated in glibc
+#endif
+    heap.mem1Free = (u32)((uintptr_t)SYS_GetArena1Hi() - (uintptr_t)SYS_GetArena1Lo());
+    heap.mem2Free = (u32)((uintptr_t)SYS_GetArena2Hi() - (uintptr_t)SYS_GetArena2Lo());
+    heap.mallocArena = info.arena;
+    heap.mallocUsed = info.uordblks;
+    return heap;
+}
+
+static void writeJson(OutBuffer* out, const FrameSummary* frames, const HeapSummary* heap,
+                      const MetricsSnapshot* snap, u64 now) {
+    append(out, "{\"uptime_s\":%.1f,", (now - startMs) / 1000.0);
+    append(out, "\"frames\":{\"count\":%llu,\"avg_ms\":%.2f,\"p50_ms\":%.2f,\"p99_ms\":%.2f,\"max_ms\":%.2f},",
+           (unsigned long long)frames->count, frames->avgMs, frames->p50Ms, frames->p99Ms, frames->maxMs);
+    append(out, "\"heap\":{\"mem1_free\":%u,\"mem2_free\":%u,\"malloc_arena\":%u,\"malloc_used\":%u},",
+           heap->mem1Free, heap->mem2Free, heap->mallocArena, heap->mallocUsed);
+    append(out, "\"sntp\":{\"synced\":%s,\"offset_ms\":%.3f,\"jitter_ms\":%.3f,\"last_sync_age_s\":%ld},",
+           snap->sntp.synced ? "true" : "false", snap->sntp.offsetMs, snap->sntp.jitterMs,
+           snap->sntp.synced ? (long)(snap->now - snap->sntp.lastSync) : -1L);
+
+    append(out, "\"hosts\":[");
+    for (int i = 0; i < netStatsHostCount(); i++) {
+        NetHostStats stats;
+        if (!netStatsGetHost(i, &stats)) continue;
+
+        const NetLatency* total = &stats.phases[NET_PHASE_TOTAL];
+        append(out, "%s{\"host\":\"%s\",\"requests\":%u,\"outcomes\":{", i ? "," : "", stats.host, stats.requests);
+        for (int o = 0; o < NET_OUTCOME_COUNT; o++) {
+            append(out, "%s\"%s\":%u", o ? "," : "", netOutcomeName((NetOutcome)o), stats.outcomes[o]);
+        }
+        append(out, "},\"bytes_in\":%llu,\"bytes_out\":%llu,\"reused_connections\":%u,",
+               (unsigned long long)stats.bytesIn, (unsigned long long)stats.bytesOut, stats.reusedConnections);
+        append(out, "\"latency_ms\":{\"p50\":%.1f,\"p95\":%.1f,\"p99\":%.1f,\"max\":%.1f}}",
+               total->p50Us / 1000.0, total->p95Us / 1000.0, total->p99Us / 1000.0, total->maxUs / 1000.0);
+    }
+    append(out, "],");
+
+    append(out, "\"freshness_s\":{");
+    for (int i = 0; i < snap->sourceCount; i++) {
+        append(out, "%s\"%s\":%.1f", i ? "," : "", snap->sources[i].name,
+               (now - snap->sources[i].lastMs) / 1000.0);
+    }
+    append(out, "}}\n");
+}
+
+static void writePrometheus(OutBuffer* out, const FrameSummary* frames, const HeapSummary* heap,
+                            const MetricsSnapshot* snap, u64 now) {
+    append(out, "# TYPE wiidash_uptime_seconds gauge\nwiidash_uptime_seconds %.1f\n", (now - startMs) / 1000.0);
+
+    append(out, "# HELP wiidash_frame_seconds Frame interval over the last %d frames\n", FRAME_WINDOW);
+    append(out, "# TYPE wiidash_frame_seconds summary\n");
+    append(out, "wiidash_frame_seconds{quantile=\"0.5\"} %.6f\n", frames->p50Ms / 1000.0);
+    append(out, "wiidash_frame_seconds{quantile=\"0.99\"} %.6f\n", frames->p99Ms / 1000.0);
+    append(out, "wiidash_frame_seconds{quantile=\"1\"} %.6f\n", frames->maxMs / 1000.0);
+    append(out, "wiidash_frame_seconds_sum %.6f\n", frames->avgMs * frames->count / 1000.0);
+    append(out, "wiidash_frame_seconds_count %llu\n", (unsigned long long)frames->count);
+
+    append(out, "# TYPE wiidash_heap_bytes gauge\n");
+    append(out, "wiidash_heap_bytes{kind=\"mem1_free\"} %u\n", heap->mem1Free);
+    append(out, "wiidash_heap_bytes{kind=\"mem2_free\"} %u\n", heap->mem2Free);
+    append(out, "wiidash_heap_bytes{kind=\"malloc_arena\"} %u\n", heap->mallocArena);
+    append(out, "wiidash_heap_bytes{kind=\"malloc_used\"} %u\n", heap->mallocUsed);
+
+    append(out, "# TYPE wiidash_sntp_synced gauge\nwiidash_sntp_synced %d\n", snap->sntp.synced ? 1 : 0);
+    append(out, "# TYPE wiidash_sntp_offset_seconds gauge\nwiidash_sntp_offset_seconds %.6f\n",
+           snap->sntp.offsetMs / 1000.0);
+
+    int hostCount = netStatsHostCount();
+    append(out, "# TYPE wiidash_http_requests_total counter\n");
+    for (int i = 0; i < hostCount; i++) {
+        NetHostStats stats;
+        if (!netStatsGetHost(i, &stats)) continue;
+        for (int o = 0; o < NET_OUTCOME_COUNT; o++) {
+            append(out, "wiidash_http_requests_total{host=\"%s\",outcome=\"%s\"} %u\n",
+                   stats.host, netOutcomeName((NetOutcome)o), stats.outcomes[o]);
+        }
+    }
+    append(out, "# TYPE wiidash_http_bytes_total counter\n");
+    for (int i = 0; i < hostCount; i++) {
+        NetHostStats stats;
+        if (!netStatsGetHost(i, &stats)) continue;
+        append(out, "wiidash_http_bytes_total{host=\"%s\",direction=\"in\"} %llu\n",
+               stats.host, (unsigned long long)stats.bytesIn);
+        append(out, "wiidash_http_bytes_total{host=\"%s\",direction=\"out\"} %llu\n",
+               stats.host, (unsigned long long)stats.bytesOut);
+    }
+    append(out, "# TYPE wiidash_http_request_seconds summary\n");
+    for (int i = 0; i < hostCount; i++) {
+        NetHostStats stats;
+        if (!netStatsGetHost(i, &stats)) continue;
+        const NetLatency* total = &stats.phases[NET_PHASE_TOTAL];
+        append(out, "wiidash_http_request_seconds{host=\"%s\",quantile=\"0.5\"} %.6f\n", stats.host, total->p50Us / 1e6);
+        append(out, "wiidash_http_request_seconds{host=\"%s\",quantile=\"0.95\"} %.6f\n", stats.host, total->p95Us / 1e6);
+        append(out, "wiidash_http_request_seconds{host=\"%s\",quantile=\"0.99\"} %.6f\n", stats.host, total->p99Us / 1e6);
+        append(out, "wiidash_http_request_seconds_count{host=\"%s\"} %u\n", stats.host, total->count);
+    }
+
+    append(out, "# HELP wiidash_data_age_seconds Time since a data source last received fresh data\n");
+    append(out, "# TYPE wiidash_data_age_seconds gauge\n");
+    for (int i = 0; i < snap->sourceCount; i++) {
+        append(out, "wiidash_data_age_seconds{source=\"%s\"} %.1f\n", snap->sources[i].name,
+               (now - snap->sources[i].lastMs) / 1000.0);
+    }
+}
+
+static void buildResponse(MetricsClient* client) {
+    bool json = strncmp(client->request, "GET /metrics.json", 17) == 0;
+    bool prometheus = !json && (strncmp(client->request, "GET /metrics ", 13) == 0 ||
+                                strncmp(client->request, "GET / ", 6) == 0);
+
+    // Header is written after the body so Content-Length is known, into
+    // the space left in front of it
+    char* body = client->response + HEADER_SIZE;
+    OutBuffer out = { body, RESPONSE_SIZE - HEADER_SIZE, 0 };
+
+    if (json || prometheus) {
+        LWP_MutexLock(statsMutex);
+        FrameSummary frames = summarizeFrames();
+        report = shared;
+        LWP_MutexUnlock(statsMutex);
+
+        HeapSummary heap = summarizeHeap();
+        u64 now = nowMs();
+        if (json) {
+            writeJson(&out, &frames, &heap, &report, now);
+        } else {
+            writePrometheus(&out, &frames, &heap, &report, now);
+        }
+    } else {
+        append(&out, "not found\n");
+    }
+
+    const char* status = (json || prometheus) ? "200 OK" : "404 Not Found";
+    const char* type = json ? "application/json" :
+                       prometheus ? "text/plain; version=0.0.4" : "text/plain";
+    char header[HEADER_SIZE];
+    int headerLen = snprintf(header, sizeof(header),
+        "HTTP/1.0 %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+        status, type, out.length);
+    client->responseSent = HEADER_SIZE - headerLen;
+    memcpy(client->response + client->responseSent, header, headerLen);
+    client->responseLen = HEADER_SIZE + out.length;
+}
+
+// ---------------------------------------------------------------------------
+// Non-blocking server, on its own thread so slow fetches can't stall it
+// ---------------------------------------------------------------------------
+
+static void closeClient(MetricsClient* client) {
+    if (client->sock >= 0) net_close(client->sock);
+    client->sock = -1;
+    client->state = CLIENT_FREE;
+}
+
+static void acceptClients() {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        MetricsClient* client = &clients[i];
+        if (client->state != CLIENT_FREE) continue;
+
+        struct sockaddr_in addr;
+        u32 addrLen = sizeof(addr);
+        s32 sock = net_accept(listenSock, (struct sockaddr*)&addr, &addrLen);
+        if (sock < 0) return; // nothing pending (or a transient error)
+
+        net_fcntl(sock, F_SETFL, IOS_O_NONBLOCK);
+        client->sock = sock;
+        client->state = CLIENT_READING;
+        client->since = nowMs();
+        client->requestLen = 0;
+    }
+}
+
+static void serviceClient(MetricsClient* client) {
+    if (nowMs() - client->since > CLIENT_TIMEOUT_MS) {
+        closeClient(client);
+        return;
+    }
+
+    if (client->state == CLIENT_READING) {
+        s32 received = net_recv(client->sock, client->request + client->requestLen,
+                                REQUEST_SIZE - 1 - client->requestLen, 0);
+        if (received == -EAGAIN) return;
+        if (received <= 0) {
+            closeClient(client);
+            return;
+        }
+        client->requestLen += received;
+        client->request[client->requestLen] = '\0';
+
+        // Only the request line matters; wait for the end of the headers
+        if (strstr(client->request, "\r\n\r\n") || strstr(client->request, "\n\n") ||
+            client->requestLen >= REQUEST_SIZE - 1) {
+            buildResponse(client);
+            client->state = CLIENT_WRITING;
+        }
+    }
+
+    if (client->state == CLIENT_WRITING) {
+        s32 sent = net_send(client->sock, client->response + client->responseSent,
+                            client->responseLen - client->responseSent, 0);
+        if (sent == -EAGAIN) return;
+        if (sent <= 0) {
+            closeClient(client);
+            return;
+        }
+        client->responseSent += sent;
+        if (client->responseSent >= client->responseLen) closeClient(client);
+    }
+}
+
+static void* serverMain(void* arg) {
+    while (!serverQuit) {
+        acceptClients();
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].state != CLIENT_FREE) serviceClient(&clients[i]);
+        }
+        usleep(SERVER_POLL_US);
+    }
+    return NULL;
+}
+
+bool initMetrics(int port) {
+    memset(&shared, 0, sizeof(shared));
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].sock = -1;
+        clients[i].state = CLIENT_FREE;
+    }
+    LWP_MutexInit(&statsMutex, false);
+    metricsReady = true;
+    startMs = nowMs();
+    lastFrameTicks = 0;
+
+    if (port <= 0) return false;
+
+    listenSock = net_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSock < 0) {
+        printf("Metrics: failed to create socket\n");
+        listenSock = -1;
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (net_bind(listenSock, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        net_listen(listenSock, MAX_CLIENTS) < 0) {
+        printf("Metrics: failed to listen on port %d\n", port);
+        net_close(listenSock);
+        listenSock = -1;
+        return false;
+    }
+    net_fcntl(listenSock, F_SETFL, IOS_O_NONBLOCK);
+
+    serverQuit = false;
+    if (LWP_CreateThread(&serverThread, serverMain, NULL, NULL, SERVER_STACK_SIZE, SERVER_PRIORITY) < 0) {
+        printf("Metrics: failed to start server thread\n");
+        net_close(listenSock);
+        listenSock = -1;
+        return false;
+    }
+    serverRunning = true;
+
+    printf("Metrics: serving on port %d\n", port);
+    return true;
+}
+
+void cleanupMetrics() {
+    if (!metricsReady) return;
+
+    if (serverRunning) {
+        serverQuit = true;
+        LWP_JoinThread(serverThread, NULL);
+        serverRunning = false;
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        closeClient(&clients[i]);
+    }
+    if (listenSock >= 0) net_close(listenSock);
+    listenSock = -1;
+
+    metricsReady = false;
+    LWP_MutexDestroy(statsMutex);
+}
@@ -0,0 +1,475 @@
+#include "netsched.h"
+#include "network.h"
+#include <ogc/lwp.h>
+#include <ogc/mutex.h>
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_SUBSCRIPTIONS 1024
+#define MAX_REQUESTS 16
+#define MAX_HOSTS 8
+
+#define DEFAULT_HOST_INTERVAL_MS 1000
+#define BACKOFF_BASE_MS 5000
+#define BACKOFF_MAX_SHIFT 6
+#define VISIBLE_SCENE_BOOST 3
+#define PRIORITY_LEVELS (NET_PRIORITY_HIGH + VISIBLE_SCENE_BOOST + 1)
+#define PREFETCH_MIN_AGE_MS 60000 // data younger than this is not prefetched
+
+#define WORKER_STACK_SIZE (32 * 1024)
+#define WORKER_PRIORITY 50 // below the main loop so rendering wins
+
+typedef struct {
+    bool active;
+    bool paused;
+    bool waiting;        // attached to a queued or in-flight request
+    bool prefetching;    // due early because of netPrefetchScene()
+    char url[256];
+    Scene owner;
+    int priority;
+    u32 intervalMs;
+    u64 nextDueMs;
+    u64 resumeDueMs;     // schedule to restore if a prefetch is cancelled
+    u64 lastOkMs;
+    int failures;
+    NetDataCallback callback;
+    void* userData;
+} NetSubscription;
+
+typedef enum {
+    REQUEST_FREE,
+    REQUEST_QUEUED,
+    REQUEST_IN_FLIGHT,
+    REQUEST_DONE
+} RequestState;
+
+// Shared with the worker thread, guarded by queueMutex
+typedef struct {
+    RequestState state;
+    char url[256];
+    char host[64];
+    Scene owner;         // most important subscriber's scene
+    int priority;        // most important subscriber's base priority
+    bool ok;
+    char* body;
+} NetRequest;
+
+typedef struct {
+    char host[64];
+    u32 minIntervalMs;
+    u64 nextAllowedMs;
+} NetHostLimit;
+
+// Subscriptions are only touched by the main thread
+static NetSubscription subscriptions[MAX_SUBSCRIPTIONS];
+
+static NetRequest requests[MAX_REQUESTS];
+static NetHostLimit hosts[MAX_HOSTS];
+static int hostCount = 0;
+
+static mutex_t queueMutex = LWP_MUTEX_NULL;
+static lwp_t workerThread = LWP_THREAD_NULL;
+static volatile bool workerQuit = false;
+static bool schedulerRunning = false;
+
+static u64 nowMs() {
+    return ticks_to_millisecs(gettime());
+}
+
+static void hostFromUrl(const char* url, char* out, int size) {
+    const char* start = strstr(url, "://");
+    start = start ? start + 3 : url;
+
+    int len = 0;
+    while (start[len] && start[len] != '/' && start[len] != ':' && len < size - 1) {
+        len++;
+    }
+    memcpy(out, start, len);
+    out[len] = '\0';
+}
+
+// Caller holds queueMutex
+static NetHostLimit* findHost(const char* host, bool create) {
+    for (int i = 0; i < hostCount; i++) {
+        if (strcmp(hosts[i].host, host) == 0) return &hosts[i];
+    }
+    if (!create || hostCount >= MAX_HOSTS) return NULL;
+
+    NetHostLimit* limit = &hosts[hostCount++];
+    snprintf(limit->host, sizeof(limit->host), "%s", host);
+    limit->minIntervalMs = DEFAULT_HOST_INTERVAL_MS;
+    limit->nextAllowedMs = 0;
+    return limit;
+}
+
+static int subscriptionPriority(const NetSubscription* sub) {
+    int priority = sub->prefetching ? NET_PRIORITY_LOW : sub->priority;
+    return priority + (sub->owner == currentScene ? VISIBLE_SCENE_BOOST : 0);
+}
+
+static int effectivePriority(const NetRequest* request) {
+    return request->priority + (request->owner == currentScene ? VISIBLE_SCENE_BOOST : 0);
+}
+
+// Caller holds queueMutex. Highest priority queued request whose host is
+// outside its rate limit window, oldest slot first on ties.
+static NetRequest* pickRequest(u64 now) {
+    NetRequest* best = NULL;
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        NetRequest* request = &requests[i];
+        if (request->state != REQUEST_QUEUED) continue;
+
+        NetHostLimit* limit = findHost(request->host, true);
+        if (limit && now < limit->nextAllowedMs) continue;
+
+        if (!best || effectivePriority(request) > effectivePriority(best)) {
+            best = request;
+        }
+    }
+    return best;
+}
+
+static void* workerMain(void* arg) {
+    while (!workerQuit) {
+        LWP_MutexLock(queueMutex);
+        u64 now = nowMs();
+        NetRequest* request = pickRequest(now);
+        char url[256];
+        if (request) {
+            request->state = REQUEST_IN_FLIGHT;
+            snprintf(url, sizeof(url), "%s", request->url);
+
+            NetHostLimit* limit = findHost(request->host, true);
+            if (limit) limit->nextAllowedMs = now + limit->minIntervalMs;
+        }
+        LWP_MutexUnlock(queueMutex);
+
+        if (!request) {
+            usleep(10000);
+            continue;
+        }
+
+        // httpGet's buffer is only ever used from this thread
+        char* body = NULL;
+        bool ok = false;
+        if (isNetworkConnected()) {
+            const char* response = httpGet(url);
+            if (response) {
+                body = strdup(response);
+                ok = (body != NULL);
+            }
+        }
+
+        LWP_MutexLock(queueMutex);
+        request->body = body;
+        request->ok = ok;
+        request->state = REQUEST_DONE;
+        LWP_MutexUnlock(queueMutex);
+    }
+    return NULL;
+}
+
+// Attach a due subscription to a request for its URL, coalescing duplicates.
+// Caller holds queueMutex.
+static bool enqueue(NetSubscription* sub) {
+    int priority = sub->prefetching ? NET_PRIORITY_LOW : sub->priority;
+    NetRequest* freeSlot = NULL;
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        NetRequest* request = &requests[i];
+        if (request->state == REQUEST_FREE) {
+            if (!freeSlot) freeSlot = request;
+            continue;
+        }
+        if ((request->state == REQUEST_QUEUED || request->state == REQUEST_IN_FLIGHT) &&
+            strcmp(request->url, sub->url) == 0) {
+            if (priority > request->priority) request->priority = priority;
+            if (sub->owner == currentScene) request->owner = sub->owner;
+            return true;
+        }
+    }
+
+    if (!freeSlot) return false;
+
+    snprintf(freeSlot->url, sizeof(freeSlot->url), "%s", sub->url);
+    hostFromUrl(sub->url, freeSlot->host, sizeof(freeSlot->host));
+    freeSlot->owner = sub->owner;
+    freeSlot->priority = priority;
+    freeSlot->ok = false;
+    freeSlot->body = NULL;
+    freeSlot->state = REQUEST_QUEUED;
+    return true;
+}
+
+static u32 backoffDelay(const NetSubscription* sub) {
+    int shift = sub->failures - 1;
+    if (shift > BACKOFF_MAX_SHIFT) shift = BACKOFF_MAX_SHIFT;
+
+    u32 delay = BACKOFF_BASE_MS << shift;
+    u32 cap = sub->intervalMs > BACKOFF_BASE_MS ? sub->intervalMs : BACKOFF_BASE_MS;
+    if (delay > cap) delay = cap;
+
+    // +/-25% jitter so failed subscriptions don't retry in lockstep
+    u32 jitter = delay / 4;
+    return delay - jitter + (jitter > 0 ? rand() % (2 * jitter + 1) : 0);
+}
+
+static void deliver(const char* url, bool ok, const char* body, u64 now) {
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (!sub->active || !sub->waiting || strcmp(sub->url, url) != 0) continue;
+
+        sub->waiting = false;
+        sub->prefetching = false;
+        if (ok) {
+            sub->lastOkMs = now;
+            sub->failures = 0;
+            sub->nextDueMs = now + sub->intervalMs;
+        } else {
+            sub->failures++;
+            sub->nextDueMs = now + backoffDelay(sub);
+        }
+
+        if (sub->callback) {
+            sub->callback(ok ? body : NULL, ok, sub->userData);
+        }
+    }
+}
+
+void initNetScheduler() {
+    memset(subscriptions, 0, sizeof(subscriptions));
+    memset(requests, 0, sizeof(requests));
+    hostCount = 0;
+
+    LWP_MutexInit(&queueMutex, false);
+    workerQuit = false;
+    if (LWP_CreateThread(&workerThread, workerMain, NULL, NULL, WORKER_STACK_SIZE, WORKER_PRIORITY) < 0) {
+        printf("Failed to start network thread\n");
+        return;
+    }
+    schedulerRunning = true;
+}
+
+void cleanupNetScheduler() {
+    if (!schedulerRunning) return;
+
+    // Waits for any in-flight request to finish or time out
+    workerQuit = true;
+    LWP_JoinThread(workerThread, NULL);
+    schedulerRunning = false;
+
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        free(requests[i].body);
+        requests[i].body = NULL;
+        requests[i].state = REQUEST_FREE;
+    }
+    LWP_MutexDestroy(queueMutex);
+}
+
+void updateNetScheduler() {
+    if (!schedulerRunning) return;
+
+    u64 now = nowMs();
+
+    // Collect finished requests; callbacks run unlocked so they may resubscribe
+    char urls[MAX_REQUESTS][256];
+    char* bodies[MAX_REQUESTS];
+    bool results[MAX_REQUESTS];
+    int finished = 0;
+
+    LWP_MutexLock(queueMutex);
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        NetRequest* request = &requests[i];
+        if (request->state != REQUEST_DONE) continue;
+
+        snprintf(urls[finished], sizeof(urls[finished]), "%s", request->url);
+        bodies[finished] = request->body;
+        results[finished] = request->ok;
+        finished++;
+
+        request->body = NULL;
+        request->state = REQUEST_FREE;
+    }
+
+    // Queue every subscription that has come due, most important first so a
+    // backlog of low-priority work can't hold the queue
+    static u16 due[PRIORITY_LEVELS][MAX_SUBSCRIPTIONS];
+    int dueCount[PRIORITY_LEVELS] = {0};
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (!sub->active || sub->paused || sub->waiting || now < sub->nextDueMs) continue;
+
+        int priority = subscriptionPriority(sub);
+        due[priority][dueCount[priority]++] = i;
+    }
+
+    bool queueFull = false;
+    for (int priority = PRIORITY_LEVELS - 1; priority >= 0 && !queueFull; priority--) {
+        for (int n = 0; n < dueCount[priority]; n++) {
+            NetSubscription* sub = &subscriptions[due[priority][n]];
+            if (!enqueue(sub)) {
+                queueFull = true; // try again next frame
+                break;
+            }
+            sub->waiting = true;
+        }
+    }
+    LWP_MutexUnlock(queueMutex);
+
+    for (int i = 0; i < finished; i++) {
+        deliver(urls[i], results[i], bodies[i], now);
+        free(bodies[i]);
+    }
+}
+
+int netSubscribe(const char* url, Scene owner, NetPriority priority,
+                 int intervalSec, NetDataCallback callback, void* userData) {
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (sub->active) continue;
+
+        memset(sub, 0, sizeof(*sub));
+        snprintf(sub->url, sizeof(sub->url), "%s", url);
+        sub->owner = owner;
+        sub->priority = priority;
+        sub->intervalMs = (u32)intervalSec * 1000;
+        sub->nextDueMs = 0; // fetch on the next update
+        sub->callback = callback;
+        sub->userData = userData;
+        sub->active = true;
+        return i;
+    }
+
+    printf("Network scheduler full, cannot subscribe to %s\n", url);
+    return -1;
+}
+
+void netUnsubscribe(int id) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS) return;
+    // An in-flight request for it is simply not delivered
+    subscriptions[id].active = false;
+}
+
+void netSetInterval(int id, int intervalSec) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS || !subscriptions[id].active) return;
+
+    NetSubscription* sub = &subscriptions[id];
+    u32 newInterval = (u32)intervalSec * 1000;
+    if (!sub->waiting && sub->failures == 0 && sub->nextDueMs >= sub->intervalMs) {
+        // Keep the phase, just stretch or shrink the remaining wait
+        sub->nextDueMs = sub->nextDueMs - sub->intervalMs + newInterval;
+    }
+    sub->intervalMs = newInterval;
+}
+
+void netSetPriority(int id, NetPriority priority) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS) return;
+    subscriptions[id].priority = priority;
+}
+
+void netSetPaused(int id, bool paused) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS) return;
+    subscriptions[id].paused = paused;
+}
+
+void netRefresh(int id) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS || !subscriptions[id].active) return;
+    subscriptions[id].nextDueMs = 0;
+    subscriptions[id].prefetching = false;
+}
+
+void netRefreshScene(Scene owner) {
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        if (subscriptions[i].active && subscriptions[i].owner == owner) {
+            subscriptions[i].nextDueMs = 0;
+            subscriptions[i].prefetching = false;
+        }
+    }
+}
+
+// Most important first: what the scene shows on opening has the higher
+// (e.g. the visible stock tiles), the rest follows in subscription order
+void netPrefetchScene(Scene owner, int limit) {
+    u64 now = nowMs();
+    int started = 0;
+    for (int priority = NET_PRIORITY_HIGH; priority >= NET_PRIORITY_LOW && started < limit; priority--) {
+        for (int i = 0; i < MAX_SUBSCRIPTIONS && started < limit; i++) {
+            NetSubscription* sub = &subscriptions[i];
+            if (!sub->active || sub->owner != owner || sub->priority != priority || sub->paused ||
+                sub->waiting || sub->prefetching || sub->nextDueMs <= now) continue;
+            if (sub->lastOkMs != 0 && now - sub->lastOkMs < PREFETCH_MIN_AGE_MS) continue;
+
+            sub->prefetching = true;
+            sub->resumeDueMs = sub->nextDueMs;
+            sub->nextDueMs = 0;
+            started++;
+        }
+    }
+}
+
+// Drop the queued request for a URL if only prefetches are waiting on it.
+// Caller holds queueMutex.
+static void cancelQueuedPrefetch(const char* url) {
+    NetRequest* queued = NULL;
+    for (int i = 0; i < MAX_REQUESTS && !queued; i++) {
+        if (requests[i].state == REQUEST_QUEUED && strcmp(requests[i].url, url) == 0) {
+            queued = &requests[i];
+        }
+    }
+    if (!queued) return; // already in flight, let it land
+
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (sub->active && sub->waiting && !sub->prefetching && strcmp(sub->url, url) == 0) return;
+    }
+
+    queued->state = REQUEST_FREE;
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (!sub->active || !sub->waiting || strcmp(sub->url, url) != 0) continue;
+        sub->waiting = false;
+        sub->prefetching = false;
+        sub->nextDueMs = sub->resumeDueMs;
+    }
+}
+
+void netCancelPrefetch(Scene owner) {
+    if (!schedulerRunning) return;
+
+    LWP_MutexLock(queueMutex);
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        NetSubscription* sub = &subscriptions[i];
+        if (!sub->active || sub->owner != owner || !sub->prefetching) continue;
+
+        if (sub->waiting) {
+            cancelQueuedPrefetch(sub->url);
+        } else {
+            sub->prefetching = false;
+            sub->nextDueMs = sub->resumeDueMs;
+        }
+    }
+    LWP_MutexUnlock(queueMutex);
+}
+
+int netSecondsUntilRefresh(int id) {
+    if (id < 0 || id >= MAX_SUBSCRIPTIONS || !subscriptions[id].active) return 0;
+
+    NetSubscription* sub = &subscriptions[id];
+    u64 now = nowMs();
+    if (sub->waiting || sub->nextDueMs <= now) return 0;
+    return (int)((sub->nextDueMs - now) / 1000);
+}
+
+bool netSceneBusy(Scene owner) {
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        if (subscriptions[i].active && subscriptions[i].owner == owner && subscriptions[i].waiting) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void netSetHostRateLimit(const char* host, int minIntervalMs) {
+    if (schedulerRunning) LWP_MutexLock(queueMutex);
+    NetHostLimit* limit = findHost(host, true);
+    if (limit) limit->minIntervalMs = minIntervalMs;
+    if (schedulerRunning) LWP_MutexUnlock(queueMutex);
+}
@@ -0,0 +1,241 @@
+#include "netstats.h"
+#include "sntp.h"
+#include <ogc/mutex.h>
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_STAT_HOSTS 8
+
+// Log-linear histogram: 8 sub-buckets per power of two keeps the
+// percentile error under 12.5% while covering 1 us .. ~70 min.
+#define HIST_SUB_BITS 3
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_OCTAVES 32
+#define HIST_BUCKETS (HIST_OCTAVES * HIST_SUB_BUCKETS)
+
+#define LOG_INTERVAL_MS (5 * 60 * 1000)
+
+static const char* LOG_PATH = "sd:/apps/wii-dashboard/netstats.log";
+
+typedef struct {
+    u32 counts[HIST_BUCKETS];
+    u32 total;
+    u32 maxUs;
+} LatencyHistogram;
+
+typedef struct {
+    char host[64];
+    u32 requests;
+    u32 outcomes[NET_OUTCOME_COUNT];
+    u64 bytesIn;
+    u64 bytesOut;
+    u32 reusedConnections;
+    u32 fullHandshakes;
+    u32 resumedHandshakes;
+    u64 fullHandshakeUs;
+    u64 resumedHandshakeUs;
+    LatencyHistogram phases[NET_PHASE_COUNT];
+} HostRecord;
+
+static HostRecord hosts[MAX_STAT_HOSTS];
+static int hostCount = 0;
+static mutex_t statsMutex = LWP_MUTEX_NULL;
+static bool statsReady = false;
+static u64 nextLogMs = 0;
+
+static const char* outcomeNames[NET_OUTCOME_COUNT] = {
+    "ok", "dns_failed", "connect_failed", "tls_failed", "send_failed", "no_data", "http_error"
+};
+
+static const char* phaseNames[NET_PHASE_COUNT] = {
+    "dns", "connect", "tls", "ttfb", "transfer", "total"
+};
+
+static u64 nowMs() {
+    return ticks_to_millisecs(gettime());
+}
+
+static int bucketFor(u32 us) {
+    if (us < HIST_SUB_BUCKETS) return us;
+
+    int octave = 31 - __builtin_clz(us);                     // floor(log2(us))
+    int sub = (us >> (octave - HIST_SUB_BITS)) & (HIST_SUB_BUCKETS - 1);
+    return (octave - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS + sub;
+}
+
+// Midpoint of a bucket's value range
+static u32 bucketValue(int bucket) {
+    if (bucket < HIST_SUB_BUCKETS) return bucket;
+
+    int octave = bucket / HIST_SUB_BUCKETS + HIST_SUB_BITS - 1;
+    int sub = bucket % HIST_SUB_BUCKETS;
+    u32 width = 1u << (octave - HIST_SUB_BITS);
+    u32 low = (1u << octave) + sub * width;
+    return low + width / 2;
+}
+
+static void histogramAdd(LatencyHistogram* h, u32 us) {
+    h->counts[bucketFor(us)]++;
+    h->total++;
+    if (us > h->maxUs) h->maxUs = us;
+}
+
+static u32 histogramPercentile(const LatencyHistogram* h, int percent) {
+    if (h->total == 0) return 0;
+
+    u32 rank = (u32)(((u64)h->total * percent + 99) / 100);
+    if (rank == 0) rank = 1;
+
+    u32 seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            u32 value = bucketValue(i);
+            return value > h->maxUs ? h->maxUs : value;
+        }
+    }
+    return h->maxUs;
+}
+
+// Caller holds statsMutex
+static HostRecord* findHost(const char* host) {
+    for (int i = 0; i < hostCount; i++) {
+        if (strcmp(hosts[i].host, host) == 0) return &hosts[i];
+    }
+    if (hostCount >= MAX_STAT_HOSTS) return NULL;
+
+    HostRecord* record = &hosts[hostCount++];
+    memset(record, 0, sizeof(*record));
+    snprintf(record->host, sizeof(record->host), "%s", host);
+    return record;
+}
+
+void netStatsRecord(const NetTiming* timing) {
+    if (!statsReady) return;
+
+    LWP_MutexLock(statsMutex);
+    HostRecord* record = findHost(timing->host);
+    if (record) {
+        record->requests++;
+        record->outcomes[timing->outcome]++;
+        record->bytesIn += timing->bytesIn;
+        record->bytesOut += timing->bytesOut;
+        if (timing->connectionReused) record->reusedConnections++;
+
+        u32 handshakeUs = timing->phaseUs[NET_PHASE_TLS];
+        if (handshakeUs > 0 && timing->tlsResumed) {
+            record->resumedHandshakes++;
+            record->resumedHandshakeUs += handshakeUs;
+        } else if (handshakeUs > 0) {
+            record->fullHandshakes++;
+            record->fullHandshakeUs += handshakeUs;
+        }
+
+        // Only phases that were reached are recorded, so failures don't drag
+        // the percentiles of later phases toward zero
+        for (int p = 0; p < NET_PHASE_COUNT; p++) {
+            if (timing->phaseUs[p] > 0 || p == NET_PHASE_TOTAL) {
+                histogramAdd(&record->phases[p], timing->phaseUs[p]);
+            }
+        }
+    }
+    LWP_MutexUnlock(statsMutex);
+}
+
+int netStatsHostCount() {
+    return hostCount;
+}
+
+bool netStatsGetHost(int index, NetHostStats* out) {
+    if (!statsReady || index < 0 || index >= hostCount) return false;
+
+    LWP_MutexLock(statsMutex);
+    const HostRecord* record = &hosts[index];
+    snprintf(out->host, sizeof(out->host), "%s", record->host);
+    out->requests = record->requests;
+    memcpy(out->outcomes, record->outcomes, sizeof(out->outcomes));
+    out->bytesIn = record->bytesIn;
+    out->bytesOut = record->bytesOut;
+    out->reusedConnections = record->reusedConnections;
+    out->fullHandshakes = record->fullHandshakes;
+    out->resumedHandshakes = record->resumedHandshakes;
+    out->fullHandshakeAvgUs = record->fullHandshakes ?
+        (u32)(record->fullHandshakeUs / record->fullHandshakes) : 0;
+    out->resumedHandshakeAvgUs = record->resumedHandshakes ?
+        (u32)(record->resumedHandshakeUs / record->resumedHandshakes) : 0;
+
+    for (int p = 0; p < NET_PHASE_COUNT; p++) {
+        const LatencyHistogram* h = &record->phases[p];
+        out->phases[p].count = h->total;
+        out->phases[p].p50Us = histogramPercentile(h, 50);
+        out->phases[p].p95Us = histogramPercentile(h, 95);
+        out->phases[p].p99Us = histogramPercentile(h, 99);
+        out->phases[p].maxUs = h->maxUs;
+    }
+    LWP_MutexUnlock(statsMutex);
+    return true;
+}
+
+const char* netOutcomeName(NetOutcome outcome) {
+    return (outcome >= 0 && outcome < NET_OUTCOME_COUNT) ? outcomeNames[outcome] : "unknown";
+}
+
+const char* netPhaseName(NetPhase phase) {
+    return (phase >= 0 && phase < NET_PHASE_COUNT) ? phaseNames[phase] : "unknown";
+}
+
+// One line per host: cumulative counters plus p50/p95/p99 per phase in ms
+static void writeLog() {
+    int count = netStatsHostCount();
+    if (count == 0) return;
+
+    FILE* file = fopen(LOG_PATH, "a");
+    if (!file) {
+        printf("Failed to open %s\n", LOG_PATH);
+        return;
+    }
+
+    long now = (long)sntpTime();
+    for (int i = 0; i < count; i++) {
+        NetHostStats stats;
+        if (!netStatsGetHost(i, &stats)) continue;
+
+        fprintf(file, "%ld host=%s req=%u ok=%u fail=%u in=%llu out=%llu",
+                now, stats.host, stats.requests, stats.outcomes[NET_OUTCOME_OK],
+                stats.requests - stats.outcomes[NET_OUTCOME_OK],
+                (unsigned long long)stats.bytesIn, (unsigned long long)stats.bytesOut);
+        fprintf(file, " reused=%u tls_full=%u/%.1fms tls_resumed=%u/%.1fms",
+                stats.reusedConnections, stats.fullHandshakes, stats.fullHandshakeAvgUs / 1000.0f,
+                stats.resumedHandshakes, stats.resumedHandshakeAvgUs / 1000.0f);
+
+        for (int p = 0; p < NET_PHASE_COUNT; p++) {
+            const NetLatency* l = &stats.phases[p];
+            if (l->count == 0) continue;
+            fprintf(file, " %s=%.1f/%.1f/%.1f", phaseNames[p],
+                    l->p50Us / 1000.0f, l->p95Us / 1000.0f, l->p99Us / 1000.0f);
+        }
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+}
+
+void initNetStats() {
+    memset(hosts, 0, sizeof(hosts));
+    hostCount = 0;
+    LWP_MutexInit(&statsMutex, false);
+    statsReady = true;
+    nextLogMs = nowMs() + LOG_INTERVAL_MS;
+}
+
+void cleanupNetStats() {
+    if (!statsReady) return;
+    writeLog();
+    statsReady = false;
+    LWP_MutexDestroy(statsMutex);
+}
+
+void updateNetStats() {
+    if (!statsReady || nowMs() < nextLogMs) return;
+    nextLogMs = nowMs() + LOG_INTERVAL_MS;
+    writeLog();
+}
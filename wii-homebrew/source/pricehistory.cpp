@@ -0,0 +1,130 @@
+#include "pricehistory.h"
+
+#define RING_MASK (PRICE_HISTORY_CAPACITY - 1)
+
+// Deque indices run freely and are masked on access
+#define QUEUE_SIZE(head, tail) ((tail) - (head))
+
+static const PricePoint* pointAt(const PriceHistory* history, u32 sequence) {
+    return &history->points[sequence & RING_MASK];
+}
+
+void historyInit(PriceHistory* history) {
+    memset(history, 0, sizeof(*history));
+}
+
+void historyAppend(PriceHistory* history, s64 timeUs, float price) {
+    u32 sequence = history->appended;
+
+    // The point about to be overwritten leaves the window
+    if (sequence >= PRICE_HISTORY_CAPACITY) {
+        u32 evicted = sequence - PRICE_HISTORY_CAPACITY;
+        if (QUEUE_SIZE(history->minHead, history->minTail) > 0 &&
+            history->minQueue[history->minHead & RING_MASK] == evicted) {
+            history->minHead++;
+        }
+        if (QUEUE_SIZE(history->maxHead, history->maxTail) > 0 &&
+            history->maxQueue[history->maxHead & RING_MASK] == evicted) {
+            history->maxHead++;
+        }
+    }
+
+    PricePoint* point = &history->points[sequence & RING_MASK];
+    point->timeUs = timeUs;
+    point->price = price;
+
+    // Drop entries the new point dominates; each is removed at most once
+    while (QUEUE_SIZE(history->minHead, history->minTail) > 0 &&
+           pointAt(history, history->minQueue[(history->minTail - 1) & RING_MASK])->price >= price) {
+        history->minTail--;
+    }
+    history->minQueue[history->minTail++ & RING_MASK] = sequence;
+
+    while (QUEUE_SIZE(history->maxHead, history->maxTail) > 0 &&
+           pointAt(history, history->maxQueue[(history->maxTail - 1) & RING_MASK])->price <= price) {
+        history->maxTail--;
+    }
+    history->maxQueue[history->maxTail++ & RING_MASK] = sequence;
+
+    history->appended++;
+}
+
+int historyCount(const PriceHistory* history) {
+    return history->appended < PRICE_HISTORY_CAPACITY ? (int)history->appended : PRICE_HISTORY_CAPACITY;
+}
+
+const PricePoint* historyAt(const PriceHistory* history, int index) {
+    u32 oldest = history->appended - historyCount(history);
+    return pointAt(history, oldest + index);
+}
+
+float historyMin(const PriceHistory* history) {
+    if (history->appended == 0) return 0.0f;
+    return pointAt(history, history->minQueue[history->minHead & RING_MASK])->price;
+}
+
+float historyMax(const PriceHistory* history) {
+    if (history->appended == 0) return 0.0f;
+    return pointAt(history, history->maxQueue[history->maxHead & RING_MASK])->price;
+}
+
+int historyDownsample(const PriceHistory* history, PricePoint* out, int maxPoints) {
+    int count = historyCount(history);
+    if (maxPoints >= count || maxPoints < 3) {
+        int n = count < maxPoints ? count : maxPoints;
+        for (int i = 0; i < n; i++) {
+            out[i] = *historyAt(history, count - n + i);
+        }
+        return n;
+    }
+
+    // First and last points are kept; the rest are split into equal buckets
+    // and each bucket contributes the point forming the largest triangle
+    // with the previous pick and the next bucket's average
+    double bucketSize = (double)(count - 2) / (maxPoints - 2);
+    s64 timeBase = historyAt(history, 0)->timeUs;
+    int picked = 0;
+    int previous = 0;
+    out[picked++] = *historyAt(history, 0);
+
+    for (int bucket = 0; bucket < maxPoints - 2; bucket++) {
+        int start = (int)(bucket * bucketSize) + 1;
+        int end = (int)((bucket + 1) * bucketSize) + 1;
+
+        // Average of the next bucket (or the last point for the final bucket)
+        int nextStart = end;
+        int nextEnd = (int)((bucket + 2) * bucketSize) + 1;
+        if (nextEnd > count) nextEnd = count;
+        if (nextStart >= nextEnd) nextStart = nextEnd - 1;
+
+        double avgTime = 0.0, avgPrice = 0.0;
+        for (int i = nextStart; i < nextEnd; i++) {
+            const PricePoint* p = historyAt(history, i);
+            avgTime += (double)(p->timeUs - timeBase);
+            avgPrice += p->price;
+        }
+        avgTime /= (nextEnd - nextStart);
+        avgPrice /= (nextEnd - nextStart);
+
+        const PricePoint* a = historyAt(history, previous);
+        double aTime = (double)(a->timeUs - timeBase);
+        double bestArea = -1.0;
+        int best = start;
+
+        for (int i = start; i < end; i++) {
+            const PricePoint* p = historyAt(history, i);
+            double area = fabs((aTime - avgTime) * (p->price - a->price) -
+                               (aTime - (double)(p->timeUs - timeBase)) * (avgPrice - a->price));
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+
+        out[picked++] = *historyAt(history, best);
+        previous = best;
+    }
+
+    out[picked++] = *historyAt(history, count - 1);
+    return picked;
+}
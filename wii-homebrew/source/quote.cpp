@@ -0,0 +1,53 @@
+#include "quote.h"
+
+void quoteInit(Quote* quote) {
+    memset(quote, 0, sizeof(*quote));
+    quote->source = QUOTE_SOURCE_NONE;
+    quote->textDirty = true;
+}
+
+bool quoteUpdate(Quote* quote, double price, double prevClose, QuoteSource source, s64 timeUs) {
+    double close = prevClose > 0.0 ? prevClose : quote->prevClose;
+
+    // Repeated polls mostly return the same numbers; keep the cached text
+    bool changed = price != quote->price || close != quote->prevClose;
+    if (changed) {
+        quote->price = price;
+        quote->prevClose = close;
+        if (close > 0.0) {
+            quote->change = price - close;
+            quote->changePercent = quote->change / close * 100.0;
+        }
+        quote->textDirty = true;
+    }
+
+    quote->source = source;
+    quote->timeUs = timeUs;
+    return changed;
+}
+
+bool quoteHasData(const Quote* quote) {
+    return quote->source == QUOTE_SOURCE_POLL || quote->source == QUOTE_SOURCE_STREAM;
+}
+
+bool quoteIsUp(const Quote* quote) {
+    return quote->change >= 0.0;
+}
+
+static void formatText(Quote* quote) {
+    if (!quote->textDirty) return;
+
+    snprintf(quote->priceText, sizeof(quote->priceText), "$%.2f", quote->price);
+    snprintf(quote->changeText, sizeof(quote->changeText), "%+.2f%%", quote->changePercent);
+    quote->textDirty = false;
+}
+
+const char* quotePriceText(Quote* quote) {
+    formatText(quote);
+    return quote->priceText;
+}
+
+const char* quoteChangeText(Quote* quote) {
+    formatText(quote);
+    return quote->changeText;
+}
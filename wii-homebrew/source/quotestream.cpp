@@ -0,0 +1,434 @@
+#include "quotestream.h"
+#include "network.h"
+#include <network.h>
+#include <errno.h>
+#include <ctype.h>
+#include <ogc/lwp.h>
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_STREAM_SYMBOLS 64
+#define MAX_SYMBOL_LEN 15   // symbols[] entries, without the terminator
+#define STREAM_RX_SIZE 2048
+#define STREAM_EVENT_SIZE 512
+#define RESOLVER_STACK_SIZE (16 * 1024)
+#define RESOLVER_PRIORITY 40
+
+#define CONNECT_TIMEOUT_MS 5000
+#define IDLE_TIMEOUT_MS 30000   // no bytes (not even a heartbeat) for this long = dead
+#define BACKOFF_MIN_MS 1000
+#define BACKOFF_MAX_MS 60000
+
+typedef enum {
+    STREAM_DISABLED,
+    STREAM_WAITING,     // backing off before the next connect attempt
+    STREAM_RESOLVING,   // DNS lookup running on the resolver thread
+    STREAM_CONNECTING,
+    STREAM_HANDSHAKE,   // request sent, waiting for the HTTP response header
+    STREAM_OPEN
+} StreamState;
+
+static StreamState state = STREAM_DISABLED;
+static QuoteTickHandler tickHandler = NULL;
+
+static char host[128];
+static char path[256];
+static int port = 80;
+static struct sockaddr_in serverAddr;
+static bool addrResolved = false;
+
+// DNS is blocking in libogc, so lookups run on a short-lived thread
+static lwp_t resolverThread = LWP_THREAD_NULL;
+static volatile int resolveResult = 0; // 0 pending, 1 resolved, -1 failed
+static u32 resolvedAddr = 0;
+
+static char symbols[MAX_STREAM_SYMBOLS][MAX_SYMBOL_LEN + 1];
+static int symbolCount = 0;
+
+static int sock = -1;
+static u64 stateSince = 0;
+static u64 lastActivity = 0;
+static u64 retryAt = 0;
+static int backoffMs = BACKOFF_MIN_MS;
+
+// Every symbol fully percent-encoded, plus a comma each
+static char request[sizeof(path) + sizeof(host) + MAX_STREAM_SYMBOLS * (MAX_SYMBOL_LEN * 3 + 1) + 160];
+static int requestLen = 0;
+static int requestSent = 0;
+
+static char rxBuffer[STREAM_RX_SIZE];
+static int rxLen = 0;
+static char eventData[STREAM_EVENT_SIZE];
+static int eventLen = 0;
+
+static u64 nowMs() {
+    return ticks_to_millisecs(gettime());
+}
+
+static void setState(StreamState newState) {
+    state = newState;
+    stateSince = nowMs();
+}
+
+static void closeSocket() {
+    if (sock >= 0) {
+        net_close(sock);
+        sock = -1;
+    }
+    rxLen = 0;
+    eventLen = 0;
+}
+
+// Drop the connection and schedule a retry with exponential backoff + jitter
+static void scheduleReconnect(const char* reason) {
+    printf("Quote stream: %s, retrying in %d ms\n", reason, backoffMs);
+    closeSocket();
+
+    int jitter = backoffMs / 4;
+    int delay = backoffMs - jitter + (jitter > 0 ? rand() % (2 * jitter + 1) : 0);
+    retryAt = nowMs() + delay;
+
+    backoffMs *= 2;
+    if (backoffMs > BACKOFF_MAX_MS) backoffMs = BACKOFF_MAX_MS;
+
+    setState(STREAM_WAITING);
+}
+
+static bool parseUrl(const char* url) {
+    const char* hostStart = strstr(url, "://");
+    hostStart = hostStart ? hostStart + 3 : url;
+
+    const char* pathStart = strchr(hostStart, '/');
+    int hostLen = pathStart ? (int)(pathStart - hostStart) : (int)strlen(hostStart);
+    if (hostLen <= 0 || hostLen >= (int)sizeof(host)) return false;
+
+    memcpy(host, hostStart, hostLen);
+    host[hostLen] = '\0';
+    snprintf(path, sizeof(path), "%s", pathStart ? pathStart : "/");
+
+    // Optional :port suffix
+    port = 80;
+    char* colon = strchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+        if (port <= 0) port = 80;
+    }
+    return true;
+}
+
+// Query-string form of a symbol: everything but the RFC 3986 unreserved
+// characters is %XX, so ^GSPC and BRK.B survive intact
+static int encodeSymbol(const char* symbol, char* out) {
+    static const char hex[] = "0123456789ABCDEF";
+    int len = 0;
+    for (const unsigned char* c = (const unsigned char*)symbol; *c; c++) {
+        if (isalnum(*c) || *c == '-' || *c == '.' || *c == '_' || *c == '~') {
+            out[len++] = *c;
+        } else {
+            out[len++] = '%';
+            out[len++] = hex[*c >> 4];
+            out[len++] = hex[*c & 15];
+        }
+    }
+    return len;
+}
+
+static bool buildRequest() {
+    char symbolList[MAX_STREAM_SYMBOLS * (MAX_SYMBOL_LEN * 3 + 1)];
+    int listLen = 0;
+    for (int i = 0; i < symbolCount; i++) {
+        if (i > 0) symbolList[listLen++] = ',';
+        listLen += encodeSymbol(symbols[i], symbolList + listLen);
+    }
+    symbolList[listLen] = '\0';
+
+    // The port is part of the Host header unless it is the default
+    char hostHeader[sizeof(host) + 8];
+    if (port == 80) snprintf(hostHeader, sizeof(hostHeader), "%s", host);
+    else snprintf(hostHeader, sizeof(hostHeader), "%s:%d", host, port);
+
+    requestLen = snprintf(request, sizeof(request),
+        "GET %s%csymbols=%s HTTP/1.0\r\n"
+        "Host: %s\r\n"
+        "User-Agent: WiiDashboard/1.0\r\n"
+        "Accept: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "\r\n",
+        path, strchr(path, '?') ? '&' : '?', symbolList, hostHeader);
+    requestSent = 0;
+    return requestLen > 0 && requestLen < (int)sizeof(request);
+}
+
+static void* resolverMain(void* arg) {
+    u32 address;
+    bool ok = resolveHost(host, &address);
+    resolvedAddr = address;
+    resolveResult = ok ? 1 : -1;
+    return NULL;
+}
+
+static void joinResolver() {
+    if (resolverThread == LWP_THREAD_NULL) return;
+    LWP_JoinThread(resolverThread, NULL);
+    resolverThread = LWP_THREAD_NULL;
+}
+
+static void startResolve() {
+    resolveResult = 0;
+    if (LWP_CreateThread(&resolverThread, resolverMain, NULL, NULL,
+                         RESOLVER_STACK_SIZE, RESOLVER_PRIORITY) < 0) {
+        resolverThread = LWP_THREAD_NULL;
+        scheduleReconnect("failed to start resolver");
+        return;
+    }
+    setState(STREAM_RESOLVING);
+}
+
+static void openSocket() {
+    sock = net_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        scheduleReconnect("failed to create socket");
+        return;
+    }
+    net_fcntl(sock, F_SETFL, IOS_O_NONBLOCK);
+
+    if (!buildRequest()) {
+        closeSocket();
+        state = STREAM_DISABLED;
+        printf("Quote stream: request too long, streaming disabled\n");
+        return;
+    }
+    setState(STREAM_CONNECTING);
+}
+
+static void startConnect() {
+    if (!isNetworkConnected()) {
+        scheduleReconnect("network down");
+        return;
+    }
+
+    // Resolve once per session, and again after a failed connect
+    if (!addrResolved) {
+        startResolve();
+        return;
+    }
+    openSocket();
+}
+
+static void pollResolve() {
+    if (resolveResult == 0) return;
+    joinResolver();
+
+    if (resolveResult < 0) {
+        scheduleReconnect("failed to resolve host");
+        return;
+    }
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(port);
+    serverAddr.sin_addr.s_addr = resolvedAddr;
+    addrResolved = true;
+    openSocket();
+}
+
+static void pollConnect() {
+    s32 result = net_connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+    if (result == 0 || result == -EISCONN) {
+        setState(STREAM_HANDSHAKE);
+        lastActivity = nowMs();
+        return;
+    }
+    if (result != -EINPROGRESS && result != -EALREADY) {
+        addrResolved = false; // the host may have moved
+        scheduleReconnect("connect failed");
+        return;
+    }
+    if (nowMs() - stateSince > CONNECT_TIMEOUT_MS) {
+        scheduleReconnect("connect timeout");
+    }
+}
+
+static void dispatchEvent() {
+    if (eventLen == 0) return;
+    eventData[eventLen] = '\0';
+    eventLen = 0;
+
+    // Tick payload: {"symbol":"AAPL","price":189.32,"previousClose":187.10}
+    const char* symbol = jsonGetString(eventData, "symbol");
+    if (!symbol) return;
+
+    char symbolCopy[16];
+    snprintf(symbolCopy, sizeof(symbolCopy), "%s", symbol);
+
+    float price = jsonGetFloat(eventData, "price");
+    float prevClose = jsonGetFloat(eventData, "previousClose");
+    if (price <= 0.0f) return;
+
+    if (tickHandler) {
+        tickHandler(symbolCopy, price, prevClose);
+    }
+}
+
+static void processLine(char* line) {
+    int len = strlen(line);
+    if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+
+    if (len == 0) {
+        dispatchEvent();
+    } else if (strncmp(line, "data:", 5) == 0) {
+        const char* value = line + 5;
+        if (*value == ' ') value++;
+        int valueLen = strlen(value);
+        if (eventLen + valueLen < STREAM_EVENT_SIZE - 1) {
+            memcpy(eventData + eventLen, value, valueLen);
+            eventLen += valueLen;
+        }
+    }
+    // ':' heartbeats, "event:", "id:" and "retry:" need no handling
+}
+
+// Returns false if the response header was rejected
+static bool consumeHeader() {
+    rxBuffer[rxLen] = '\0';
+    char* headerEnd = strstr(rxBuffer, "\r\n\r\n");
+    if (!headerEnd) {
+        if (rxLen >= STREAM_RX_SIZE - 1) return false; // header too large
+        return true;
+    }
+
+    if (strncmp(rxBuffer, "HTTP/1.", 7) != 0 || strncmp(rxBuffer + 8, " 200", 4) != 0) {
+        return false;
+    }
+
+    int headerLen = (headerEnd + 4) - rxBuffer;
+    memmove(rxBuffer, rxBuffer + headerLen, rxLen - headerLen);
+    rxLen -= headerLen;
+
+    printf("Quote stream connected to %s (%d symbols)\n", host, symbolCount);
+    backoffMs = BACKOFF_MIN_MS;
+    setState(STREAM_OPEN);
+    return true;
+}
+
+static void consumeEvents() {
+    int start = 0;
+    for (int i = 0; i < rxLen; i++) {
+        if (rxBuffer[i] == '\n') {
+            rxBuffer[i] = '\0';
+            processLine(rxBuffer + start);
+            start = i + 1;
+        }
+    }
+
+    if (start > 0) {
+        memmove(rxBuffer, rxBuffer + start, rxLen - start);
+        rxLen -= start;
+    } else if (rxLen >= STREAM_RX_SIZE - 1) {
+        rxLen = 0; // a single line larger than the buffer; drop it
+    }
+}
+
+static void pollSocket() {
+    // Finish sending the subscription request
+    while (requestSent < requestLen) {
+        s32 sent = net_send(sock, request + requestSent, requestLen - requestSent, 0);
+        if (sent == -EAGAIN) return;
+        if (sent <= 0) {
+            scheduleReconnect("send failed");
+            return;
+        }
+        requestSent += sent;
+    }
+
+    // Drain whatever has arrived, bounded so a burst can't eat the frame
+    for (int reads = 0; reads < 4; reads++) {
+        s32 received = net_recv(sock, rxBuffer + rxLen, STREAM_RX_SIZE - rxLen - 1, 0);
+        if (received == -EAGAIN) break;
+        if (received <= 0) {
+            scheduleReconnect(received == 0 ? "server closed stream" : "receive failed");
+            return;
+        }
+
+        rxLen += received;
+        lastActivity = nowMs();
+
+        if (state == STREAM_HANDSHAKE && !consumeHeader()) {
+            scheduleReconnect("bad response");
+            return;
+        }
+        if (state == STREAM_OPEN) {
+            consumeEvents();
+        }
+    }
+
+    if (nowMs() - lastActivity > IDLE_TIMEOUT_MS) {
+        scheduleReconnect("stream idle");
+    }
+}
+
+bool initQuoteStream(const char* url, QuoteTickHandler handler) {
+    if (!url || !url[0] || !parseUrl(url)) {
+        state = STREAM_DISABLED;
+        return false;
+    }
+
+    tickHandler = handler;
+    addrResolved = false;
+    backoffMs = BACKOFF_MIN_MS;
+    retryAt = 0;
+    setState(STREAM_WAITING);
+
+    printf("Quote stream enabled: %s:%d%s\n", host, port, path);
+    return true;
+}
+
+void cleanupQuoteStream() {
+    joinResolver(); // waits out a lookup in progress
+    closeSocket();
+    state = STREAM_DISABLED;
+    symbolCount = 0;
+}
+
+bool quoteStreamSubscribe(const char* symbol) {
+    for (int i = 0; i < symbolCount; i++) {
+        if (strcmp(symbols[i], symbol) == 0) return true;
+    }
+    if (symbolCount >= MAX_STREAM_SYMBOLS || strlen(symbol) > MAX_SYMBOL_LEN) return false;
+
+    snprintf(symbols[symbolCount], sizeof(symbols[symbolCount]), "%s", symbol);
+    symbolCount++;
+
+    // The symbol list is sent in the request, so reconnect to pick it up
+    if (state == STREAM_CONNECTING || state == STREAM_HANDSHAKE || state == STREAM_OPEN) {
+        closeSocket();
+        retryAt = 0;
+        setState(STREAM_WAITING);
+    }
+    return true;
+}
+
+void updateQuoteStream() {
+    switch (state) {
+        case STREAM_WAITING:
+            if (nowMs() >= retryAt) {
+                startConnect();
+            }
+            break;
+        case STREAM_RESOLVING:
+            pollResolve();
+            break;
+        case STREAM_CONNECTING:
+            pollConnect();
+            break;
+        case STREAM_HANDSHAKE:
+        case STREAM_OPEN:
+            pollSocket();
+            break;
+        default:
+            break;
+    }
+}
+
+bool isQuoteStreamActive() {
+    return state == STREAM_OPEN && (nowMs() - lastActivity) <= IDLE_TIMEOUT_MS;
+}
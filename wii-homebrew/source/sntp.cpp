@@ -0,0 +1,387 @@
+#include "sntp.h"
+#include "network.h"
+#include <network.h>
+#include <errno.h>
+#include <ogc/lwp.h>
+#include <ogc/lwp_watchdog.h>
+
+#define NTP_PORT 123
+#define NTP_PACKET_SIZE 48
+#define NTP_UNIX_DELTA 2208988800ULL // seconds from 1900 to 1970
+
+#define SAMPLES_PER_ROUND 4
+#define SAMPLE_SPACING_MS 250
+#define SAMPLE_TIMEOUT_MS 1000
+#define RESYNC_INTERVAL_MS (15 * 60 * 1000)
+#define RETRY_INTERVAL_MS (60 * 1000)
+#define RESOLVER_STACK_SIZE (16 * 1024)
+#define RESOLVER_PRIORITY 40
+
+#define STEP_THRESHOLD_US 128000 // only the very first sync may step the clock
+#define MAX_SLEW_RATE 0.005       // 5 ms of correction per second
+#define MAX_DRIFT 0.0005          // clamp frequency estimate to +/-500 ppm
+
+typedef enum {
+    SNTP_DISABLED,
+    SNTP_IDLE,      // waiting for the next round
+    SNTP_RESOLVING, // DNS lookup running on the resolver thread
+    SNTP_SENDING,
+    SNTP_WAITING    // request out, polling for the reply
+} SntpState;
+
+typedef struct {
+    s64 offsetUs;
+    s64 delayUs;
+} SntpSample;
+
+static SntpState state = SNTP_DISABLED;
+static SntpStats stats;
+
+static char serverName[128];
+static struct sockaddr_in serverAddr;
+static bool addrResolved = false;
+static int sock = -1;
+
+// DNS is blocking in libogc, so lookups run on a short-lived thread
+static lwp_t resolverThread = LWP_THREAD_NULL;
+static volatile int resolveResult = 0; // 0 pending, 1 resolved, -1 failed
+static u32 resolvedAddr = 0;
+
+static SntpSample samples[SAMPLES_PER_ROUND];
+static int sampleCount = 0;
+static int attempts = 0;
+static u64 nextActionMs = 0;
+static u64 sentAtMs = 0;
+static s64 requestT1 = 0; // app clock when the request left
+static u8 requestXmt[8];  // echoed back by the server as the originate stamp
+
+// Application clock: app = baseApp + elapsed * (1 + drift) + slew
+static s64 baseMonoUs = 0;
+static s64 baseAppUs = 0;
+static double drift = 0.0;
+static double driftCarryUs = 0.0; // fraction of a microsecond not yet in baseAppUs
+static s64 slewRemainingUs = 0;
+static s64 lastRoundMonoUs = 0;
+
+static s64 monoUs() {
+    return (s64)ticks_to_microsecs(gettime());
+}
+
+static u64 nowMs() {
+    return ticks_to_millisecs(gettime());
+}
+
+// Portion of the pending correction that may be applied over dt
+static s64 slewFor(s64 dtUs) {
+    s64 limit = (s64)(dtUs * MAX_SLEW_RATE);
+    if (slewRemainingUs > limit) return limit;
+    if (slewRemainingUs < -limit) return -limit;
+    return slewRemainingUs;
+}
+
+s64 sntpTimeUs() {
+    s64 dt = monoUs() - baseMonoUs;
+    return baseAppUs + dt + (s64)(dt * drift + driftCarryUs) + slewFor(dt);
+}
+
+time_t sntpTime() {
+    s64 us = sntpTimeUs();
+    return (time_t)(us / 1000000);
+}
+
+// Fold elapsed time into the base so the slew budget is consumed gradually.
+// A frame's drift is well under a microsecond at realistic crystal error,
+// so the fraction is carried to the next rebase instead of dropped.
+static void rebaseClock() {
+    s64 mono = monoUs();
+    s64 dt = mono - baseMonoUs;
+    s64 applied = slewFor(dt);
+
+    double driftUs = dt * drift + driftCarryUs;
+    s64 whole = (s64)driftUs;
+    driftCarryUs = driftUs - whole;
+
+    baseAppUs += dt + whole + applied;
+    baseMonoUs = mono;
+    slewRemainingUs -= applied;
+}
+
+static void writeTimestamp(u8* out, s64 unixUs) {
+    u64 seconds = (u64)(unixUs / 1000000) + NTP_UNIX_DELTA;
+    u64 fraction = ((u64)(unixUs % 1000000) << 32) / 1000000;
+    for (int i = 0; i < 4; i++) {
+        out[i] = (u8)(seconds >> (24 - i * 8));
+        out[4 + i] = (u8)(fraction >> (24 - i * 8));
+    }
+}
+
+static s64 readTimestamp(const u8* in) {
+    u64 seconds = ((u64)in[0] << 24) | ((u64)in[1] << 16) | ((u64)in[2] << 8) | in[3];
+    u64 fraction = ((u64)in[4] << 24) | ((u64)in[5] << 16) | ((u64)in[6] << 8) | in[7];
+
+    // Era 1 starts in 2036; timestamps with the top bit clear belong to it
+    if (!(seconds & 0x80000000ULL)) seconds += 0x100000000ULL;
+
+    return (s64)(seconds - NTP_UNIX_DELTA) * 1000000 + (s64)((fraction * 1000000) >> 32);
+}
+
+static void closeSocket() {
+    if (sock >= 0) {
+        net_close(sock);
+        sock = -1;
+    }
+}
+
+static void scheduleRound(u64 delayMs) {
+    closeSocket();
+    state = SNTP_IDLE;
+    nextActionMs = nowMs() + delayMs;
+}
+
+// Pick the minimum-delay sample and discipline the clock with it
+static void finishRound() {
+    closeSocket();
+
+    if (sampleCount == 0) {
+        printf("NTP: no replies from %s\n", serverName);
+        addrResolved = false;
+        scheduleRound(RETRY_INTERVAL_MS);
+        return;
+    }
+
+    int best = 0;
+    for (int i = 1; i < sampleCount; i++) {
+        if (samples[i].delayUs < samples[best].delayUs) best = i;
+    }
+    s64 offset = samples[best].offsetUs;
+
+    double sumSquares = 0.0;
+    for (int i = 0; i < sampleCount; i++) {
+        double d = (double)(samples[i].offsetUs - offset);
+        sumSquares += d * d;
+    }
+    double jitterUs = sampleCount > 1 ? sqrt(sumSquares / (sampleCount - 1)) : 0.0;
+
+    rebaseClock();
+    s64 mono = baseMonoUs;
+
+    if (!stats.synced && (offset > STEP_THRESHOLD_US || offset < -STEP_THRESHOLD_US)) {
+        // The console clock is arbitrary until the first sync; step once
+        baseAppUs += offset;
+        slewRemainingUs = 0;
+
+        time_t stepped = (time_t)(baseAppUs / 1000000);
+        stime(&stepped);
+    } else {
+        // Offset left over since the previous round is frequency error
+        if (stats.synced && lastRoundMonoUs > 0) {
+            s64 interval = mono - lastRoundMonoUs;
+            if (interval > 60 * 1000000LL) {
+                double measured = (double)(offset - slewRemainingUs) / (double)interval;
+                drift += 0.25 * measured;
+                if (drift > MAX_DRIFT) drift = MAX_DRIFT;
+                if (drift < -MAX_DRIFT) drift = -MAX_DRIFT;
+            }
+        }
+        slewRemainingUs = offset;
+    }
+    lastRoundMonoUs = mono;
+
+    stats.synced = true;
+    stats.rounds++;
+    stats.offsetMs = offset / 1000.0;
+    stats.delayMs = samples[best].delayUs / 1000.0;
+    stats.jitterMs = jitterUs / 1000.0;
+    stats.driftPpm = drift * 1e6;
+    stats.lastSync = sntpTime();
+
+    printf("NTP: offset %.3f ms, delay %.3f ms, jitter %.3f ms (%d samples)\n",
+           stats.offsetMs, stats.delayMs, stats.jitterMs, sampleCount);
+
+    scheduleRound(RESYNC_INTERVAL_MS);
+}
+
+static void* resolverMain(void* arg) {
+    u32 address;
+    bool ok = resolveHost(serverName, &address);
+    resolvedAddr = address;
+    resolveResult = ok ? 1 : -1;
+    return NULL;
+}
+
+static void joinResolver() {
+    if (resolverThread == LWP_THREAD_NULL) return;
+    LWP_JoinThread(resolverThread, NULL);
+    resolverThread = LWP_THREAD_NULL;
+}
+
+static bool openRound() {
+    sock = net_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) return false;
+    net_fcntl(sock, F_SETFL, IOS_O_NONBLOCK);
+
+    sampleCount = 0;
+    attempts = 0;
+    state = SNTP_SENDING;
+    nextActionMs = nowMs();
+    return true;
+}
+
+// Resolve once, and again after a round with no replies
+static bool beginRound() {
+    if (!isNetworkConnected()) return false;
+    if (addrResolved) return openRound();
+
+    resolveResult = 0;
+    if (LWP_CreateThread(&resolverThread, resolverMain, NULL, NULL,
+                         RESOLVER_STACK_SIZE, RESOLVER_PRIORITY) < 0) {
+        resolverThread = LWP_THREAD_NULL;
+        return false;
+    }
+    state = SNTP_RESOLVING;
+    return true;
+}
+
+static void pollResolve() {
+    if (resolveResult == 0) return;
+    joinResolver();
+
+    if (resolveResult < 0) {
+        printf("NTP: failed to resolve %s\n", serverName);
+        scheduleRound(RETRY_INTERVAL_MS);
+        return;
+    }
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(NTP_PORT);
+    serverAddr.sin_addr.s_addr = resolvedAddr;
+    addrResolved = true;
+    if (!openRound()) scheduleRound(RETRY_INTERVAL_MS);
+}
+
+static void sendRequest() {
+    u8 msg[NTP_PACKET_SIZE];
+    memset(msg, 0, sizeof(msg));
+    msg[0] = 0x23; // LI 0, version 4, client mode
+
+    // Random low bits make the originate check meaningful
+    requestT1 = sntpTimeUs();
+    writeTimestamp(requestXmt, requestT1);
+    requestXmt[7] = (u8)rand();
+    memcpy(msg + 40, requestXmt, 8);
+
+    attempts++;
+    s32 sent = net_sendto(sock, msg, sizeof(msg), 0,
+                          (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+    if (sent < 0) {
+        finishRound();
+        return;
+    }
+
+    sentAtMs = nowMs();
+    state = SNTP_WAITING;
+}
+
+static void pollReply() {
+    u8 msg[NTP_PACKET_SIZE];
+    struct sockaddr_in from;
+    socklen_t len = sizeof(from);
+
+    s32 received = net_recvfrom(sock, msg, sizeof(msg), 0, (struct sockaddr*)&from, &len);
+    if (received < 0) {
+        if (nowMs() - sentAtMs > SAMPLE_TIMEOUT_MS) {
+            // Lost sample; move on
+            if (attempts >= SAMPLES_PER_ROUND) finishRound();
+            else state = SNTP_SENDING;
+        }
+        return;
+    }
+
+    s64 t4 = sntpTimeUs();
+
+    int mode = msg[0] & 0x07;
+    int leap = msg[0] >> 6;
+    int stratum = msg[1];
+    bool valid = received >= NTP_PACKET_SIZE && mode == 4 && leap != 3 &&
+                 stratum > 0 && stratum < 16 && memcmp(msg + 24, requestXmt, 8) == 0;
+
+    if (valid) {
+        s64 t1 = requestT1;
+        s64 t2 = readTimestamp(msg + 32);
+        s64 t3 = readTimestamp(msg + 40);
+
+        SntpSample* s = &samples[sampleCount++];
+        s->offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+        s->delayUs = (t4 - t1) - (t3 - t2);
+        if (s->delayUs < 0) s->delayUs = 0;
+    }
+
+    if (attempts >= SAMPLES_PER_ROUND) {
+        finishRound();
+    } else {
+        state = SNTP_SENDING;
+        nextActionMs = nowMs() + SAMPLE_SPACING_MS;
+    }
+}
+
+void initSntp(const char* server) {
+    memset(&stats, 0, sizeof(stats));
+
+    // Start from the console clock until the first round completes
+    baseMonoUs = monoUs();
+    baseAppUs = (s64)time(NULL) * 1000000;
+    drift = 0.0;
+    driftCarryUs = 0.0;
+    slewRemainingUs = 0;
+    lastRoundMonoUs = 0;
+
+    // Without a server the app clock just free-runs from the console clock
+    addrResolved = false;
+    if (!server) {
+        state = SNTP_DISABLED;
+        return;
+    }
+
+    snprintf(serverName, sizeof(serverName), "%s", server);
+    state = SNTP_IDLE;
+    nextActionMs = 0;
+}
+
+void cleanupSntp() {
+    joinResolver(); // waits out a lookup in progress
+    closeSocket();
+    state = SNTP_DISABLED;
+}
+
+void sntpRequestSync() {
+    if (state == SNTP_IDLE) {
+        nextActionMs = 0;
+    }
+}
+
+void updateSntp() {
+    rebaseClock();
+
+    switch (state) {
+        case SNTP_IDLE:
+            if (nowMs() >= nextActionMs && !beginRound()) {
+                scheduleRound(RETRY_INTERVAL_MS);
+            }
+            break;
+        case SNTP_RESOLVING:
+            pollResolve();
+            break;
+        case SNTP_SENDING:
+            if (nowMs() >= nextActionMs) sendRequest();
+            break;
+        case SNTP_WAITING:
+            pollReply();
+            break;
+        default:
+            break;
+    }
+}
+
+const SntpStats* getSntpStats() {
+    return &stats;
+}
@@ -0,0 +1,726 @@
+#include "solver.h"
+#include "graphics.h"
+#include <ogc/lwp_watchdog.h>
+#include <math.h>
+#include <float.h>
+
+#define SOLVER_BUDGET_US 4000    // work per frame
+#define SOLVER_MAX_DEGREE 16
+#define SOLVER_SCAN_CELLS 4096   // sign-change cells over the scan range
+#define SOLVER_LEAF_SIZE (2.0 * SOLVER_SYSTEM_RANGE / 128.0)
+#define SOLVER_MAX_BOXES 64
+#define SOLVER_NEWTON_STEPS 60
+#define SOLVER_ROOT_LINES 6
+#define SOLVER_STURM_CUTOFF 16.0 // remainder rounding, in eps * degree
+
+typedef enum {
+    SOLVE_NONE,
+    SOLVE_POLYNOMIAL, // every real root, isolated with a Sturm sequence
+    SOLVE_SCAN,       // sign changes over the scan range, refined by Brent
+    SOLVE_SYSTEM      // two equations, boxes pruned by intervals, then Newton
+} SolveKind;
+
+// c[i] is the coefficient of x^i
+typedef struct {
+    int degree;
+    double c[SOLVER_MAX_DEGREE + 1];
+} Poly;
+
+// (lo, hi] with the Sturm sign changes at both ends
+typedef struct {
+    double lo, hi;
+    int changesLo, changesHi;
+} RootInterval;
+
+typedef struct {
+    double x, y;   // lower left
+    double size;
+} SolverBox;
+
+static u8 kind = SOLVE_NONE;
+static bool busy = false;
+static const char* note = NULL; // outcome that is not a list of roots
+static ExprProgram programs[2];
+static double evalVars[EXPR_VAR_COUNT];
+
+static double rootX[SOLVER_MAX_ROOTS];
+static double rootY[SOLVER_MAX_ROOTS];
+static int rootCount = 0;
+static bool moreRoots = false; // found more than fit
+
+// Polynomial
+static Poly nodePolys[EXPR_MAX_NODES];
+static Poly sturm[SOLVER_MAX_DEGREE + 1];
+static int sturmCount;
+static double rootBound;
+static RootInterval intervals[SOLVER_MAX_DEGREE + 8];
+static int intervalCount;
+
+// Scan
+static int scanned;  // samples taken, of SOLVER_SCAN_CELLS + 1
+static double prevX, prevF, prevSlope;
+
+// System
+static SolverBox boxes[SOLVER_MAX_BOXES];
+static int boxCount;
+
+static bool overBudget(u64 start) {
+    return ticks_to_microsecs(gettime() - start) >= SOLVER_BUDGET_US;
+}
+
+// Roots are kept in ascending x; near-duplicates, as when neighbouring
+// boxes converge on the same point, are dropped. Past SOLVER_MAX_ROOTS the
+// ones nearest the origin stay.
+static void addRoot(double x, double y) {
+    for (int i = 0; i < rootCount; i++) {
+        if (fabs(rootX[i] - x) <= 1e-8 * (1.0 + fabs(x)) &&
+            fabs(rootY[i] - y) <= 1e-8 * (1.0 + fabs(y))) return;
+    }
+    if (rootCount == SOLVER_MAX_ROOTS) {
+        moreRoots = true;
+        int far = 0;
+        for (int i = 1; i < rootCount; i++) {
+            if (fabs(rootX[i]) + fabs(rootY[i]) > fabs(rootX[far]) + fabs(rootY[far])) far = i;
+        }
+        if (fabs(x) + fabs(y) >= fabs(rootX[far]) + fabs(rootY[far])) return;
+        for (int i = far; i < rootCount - 1; i++) {
+            rootX[i] = rootX[i + 1];
+            rootY[i] = rootY[i + 1];
+        }
+        rootCount--;
+    }
+
+    int i = rootCount++;
+    while (i > 0 && rootX[i - 1] > x) {
+        rootX[i] = rootX[i - 1];
+        rootY[i] = rootY[i - 1];
+        i--;
+    }
+    rootX[i] = x;
+    rootY[i] = y;
+}
+
+// Brent's method (after netlib's zeroin) on [a, b] with f(a), f(b) of
+// opposite signs: inverse quadratic or secant steps while they make
+// progress, bisection when they do not
+static double brent(double (*f)(double), double a, double b, double fa, double fb) {
+    double c = a, fc = fa;
+
+    for (int iter = 0; iter < 200; iter++) {
+        double prevStep = b - a;
+        if (fabs(fc) < fabs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+
+        double tol = 2.0 * DBL_EPSILON * fabs(b) + 1e-300;
+        double step = 0.5 * (c - b);
+        if (fabs(step) <= tol || fb == 0.0) return b;
+
+        if (fabs(prevStep) >= tol && fabs(fa) > fabs(fb)) {
+            double cb = c - b, p, q;
+            if (a == c) {
+                double t1 = fb / fa;
+                p = cb * t1;
+                q = 1.0 - t1;
+            } else {
+                double qa = fa / fc, t1 = fb / fc, t2 = fb / fa;
+                p = t2 * (cb * qa * (qa - t1) - (b - a) * (t1 - 1.0));
+                q = (qa - 1.0) * (t1 - 1.0) * (t2 - 1.0);
+            }
+            if (p > 0.0) q = -q;
+            else p = -p;
+
+            if (p < 0.75 * cb * q - 0.5 * fabs(tol * q) && p < fabs(0.5 * prevStep * q)) {
+                step = p / q;
+            }
+        }
+        if (fabs(step) < tol) step = step > 0.0 ? tol : -tol;
+
+        a = b;
+        fa = fb;
+        b += step;
+        fb = f(b);
+        if ((fb > 0.0) == (fc > 0.0)) {
+            c = a;
+            fc = fa;
+        }
+    }
+    return b;
+}
+
+static double evalF(double x) {
+    evalVars[EXPR_VAR_X] = x;
+    return exprEval(&programs[0], evalVars);
+}
+
+static double evalSlope(double x) {
+    double slope;
+    evalVars[EXPR_VAR_X] = x;
+    exprEvalDual(&programs[0], evalVars, EXPR_VAR_X, &slope);
+    return slope;
+}
+
+// ---- polynomials ----
+
+static double horner(const Poly* p, double x) {
+    double v = p->c[p->degree];
+    for (int i = p->degree - 1; i >= 0; i--) {
+        v = v * x + p->c[i];
+    }
+    return v;
+}
+
+static double evalPoly(double x) {
+    return horner(&sturm[0], x);
+}
+
+static void trimPoly(Poly* p) {
+    while (p->degree > 0 && p->c[p->degree] == 0.0) p->degree--;
+}
+
+static bool mulPoly(const Poly* a, const Poly* b, Poly* out) {
+    if (a->degree + b->degree > SOLVER_MAX_DEGREE) return false;
+    Poly r;
+    r.degree = a->degree + b->degree;
+    for (int i = 0; i <= r.degree; i++) r.c[i] = 0.0;
+    for (int i = 0; i <= a->degree; i++) {
+        for (int j = 0; j <= b->degree; j++) {
+            r.c[i + j] += a->c[i] * b->c[j];
+        }
+    }
+    trimPoly(&r);
+    *out = r;
+    return true;
+}
+
+// Coefficients of the AST when it is a polynomial in x. Children come
+// before their parents in the node array, so one ascending pass works.
+static bool extractPoly(const ExprProgram* prog, Poly* out) {
+    for (int i = 0; i < prog->nodeCount; i++) {
+        const ExprNode* node = &prog->nodes[i];
+        Poly* p = &nodePolys[i];
+        const Poly* a = node->left >= 0 ? &nodePolys[node->left] : NULL;
+        const Poly* b = node->right >= 0 ? &nodePolys[node->right] : NULL;
+        p->degree = -1; // not a polynomial
+
+        if ((a && a->degree < 0) || (b && b->degree < 0)) continue;
+
+        switch (node->op) {
+            case EXPR_OP_CONST:
+                p->degree = 0;
+                p->c[0] = node->value;
+                break;
+            case EXPR_OP_VAR:
+                p->degree = 1;
+                p->c[0] = 0.0;
+                p->c[1] = 1.0;
+                break;
+            case EXPR_OP_NEG:
+                *p = *a;
+                for (int k = 0; k <= p->degree; k++) p->c[k] = -p->c[k];
+                break;
+            case EXPR_OP_ADD:
+            case EXPR_OP_SUB: {
+                double sign = node->op == EXPR_OP_ADD ? 1.0 : -1.0;
+                p->degree = a->degree > b->degree ? a->degree : b->degree;
+                for (int k = 0; k <= p->degree; k++) {
+                    p->c[k] = (k <= a->degree ? a->c[k] : 0.0) + sign * (k <= b->degree ? b->c[k] : 0.0);
+                }
+                trimPoly(p);
+                break;
+            }
+            case EXPR_OP_MUL:
+                if (!mulPoly(a, b, p)) p->degree = -1;
+                break;
+            case EXPR_OP_DIV:
+                if (b->degree == 0 && b->c[0] != 0.0) {
+                    *p = *a;
+                    for (int k = 0; k <= p->degree; k++) p->c[k] /= b->c[0];
+                }
+                break;
+            case EXPR_OP_POW: {
+                if (b->degree != 0) break;
+                double n = b->c[0];
+                if (n < 0.0 || n != floor(n) || n * a->degree > SOLVER_MAX_DEGREE) break;
+                Poly r;
+                r.degree = 0;
+                r.c[0] = 1.0;
+                for (int k = 0; k < (int)n; k++) mulPoly(&r, a, &r);
+                *p = r;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (prog->root < 0 || nodePolys[prog->root].degree < 0) return false;
+    *out = nodePolys[prog->root];
+    return true;
+}
+
+static void scalePoly(Poly* p) {
+    double big = 0.0;
+    for (int i = 0; i <= p->degree; i++) {
+        if (fabs(p->c[i]) > big) big = fabs(p->c[i]);
+    }
+    if (big > 0.0) {
+        for (int i = 0; i <= p->degree; i++) p->c[i] /= big;
+    }
+}
+
+// p0 = p, p1 = p', p(k+1) = -(p(k-1) mod p(k)), each scaled to a largest
+// coefficient of 1. Remainder coefficients within cutoff times the rounding
+// of the division (eps * degree * largest dividend coefficient) are zero.
+static void buildSturm(const Poly* p, double cutoff) {
+    sturm[0] = *p;
+    scalePoly(&sturm[0]);
+
+    Poly* d = &sturm[1];
+    d->degree = p->degree - 1;
+    for (int i = 1; i <= p->degree; i++) d->c[i - 1] = i * sturm[0].c[i];
+    scalePoly(d);
+    sturmCount = 2;
+
+    while (sturm[sturmCount - 1].degree > 0) {
+        Poly r = sturm[sturmCount - 2];
+        const Poly* q = &sturm[sturmCount - 1];
+        double big = 0.0;
+        for (int i = 0; i <= r.degree; i++) {
+            if (fabs(r.c[i]) > big) big = fabs(r.c[i]);
+        }
+        double zero = cutoff * DBL_EPSILON * r.degree * big;
+
+        for (int i = r.degree - q->degree; i >= 0; i--) {
+            double factor = r.c[i + q->degree] / q->c[q->degree];
+            for (int k = 0; k <= q->degree; k++) r.c[i + k] -= factor * q->c[k];
+            r.c[i + q->degree] = 0.0;
+        }
+        r.degree = q->degree - 1;
+
+        for (int i = 0; i <= r.degree; i++) {
+            if (fabs(r.c[i]) <= zero) r.c[i] = 0.0;
+        }
+        trimPoly(&r);
+        if (r.degree == 0 && r.c[0] == 0.0) break; // p had a repeated root
+
+        for (int i = 0; i <= r.degree; i++) r.c[i] = -r.c[i];
+        scalePoly(&r);
+        sturm[sturmCount++] = r;
+    }
+}
+
+static int signChanges(double x) {
+    int changes = 0;
+    double last = 0.0;
+    for (int i = 0; i < sturmCount; i++) {
+        double v = horner(&sturm[i], x);
+        if (v == 0.0) continue;
+        if (last != 0.0 && (v > 0.0) != (last > 0.0)) changes++;
+        last = v;
+    }
+    return changes;
+}
+
+static void pushInterval(double lo, double hi, int changesLo, int changesHi) {
+    if (changesLo <= changesHi) return; // no root inside
+    if (intervalCount == SOLVER_MAX_DEGREE + 8) return;
+    RootInterval* r = &intervals[intervalCount++];
+    r->lo = lo;
+    r->hi = hi;
+    r->changesLo = changesLo;
+    r->changesHi = changesHi;
+}
+
+static void startPolynomial(const Poly* p) {
+    if (p->degree == 0) {
+        note = p->c[0] == 0.0 ? "True for every x" : "No solution";
+        busy = false;
+        return;
+    }
+
+    buildSturm(p, SOLVER_STURM_CUTOFF);
+
+    // A sequence ending above degree 0 ends in gcd(p, p'), which holds the
+    // repeated roots. p / gcd has the same roots, all simple, so Brent finds
+    // them to full precision instead of where a flat p rounds to zero.
+    const Poly* g = &sturm[sturmCount - 1];
+    if (g->degree > 0) {
+        Poly r = sturm[0], q;
+        double size[SOLVER_MAX_DEGREE + 1]; // magnitude of what went into r.c[i]
+        for (int i = 0; i <= r.degree; i++) size[i] = fabs(r.c[i]);
+        q.degree = r.degree - g->degree;
+        for (int i = q.degree; i >= 0; i--) {
+            q.c[i] = r.c[i + g->degree] / g->c[g->degree];
+            for (int k = 0; k <= g->degree; k++) {
+                r.c[i + k] -= q.c[i] * g->c[k];
+                size[i + k] += fabs(q.c[i] * g->c[k]);
+            }
+        }
+
+        // Only if gcd divides p, so the roots of p / gcd are roots of p.
+        // Otherwise the cut-off took close simple roots (or a small
+        // constant term) for a repeated root, and the sequence is built
+        // again on exact cancellation alone.
+        bool divides = true;
+        for (int i = 0; i < g->degree; i++) {
+            if (fabs(r.c[i]) > SOLVER_STURM_CUTOFF * DBL_EPSILON * p->degree * size[i]) divides = false;
+        }
+        buildSturm(divides ? &q : p, divides ? SOLVER_STURM_CUTOFF : 0.0);
+    }
+
+    // Cauchy's bound: every root lies within 1 + max |c(i) / c(n)|
+    rootBound = 0.0;
+    for (int i = 0; i < p->degree; i++) {
+        double r = fabs(p->c[i] / p->c[p->degree]);
+        if (r > rootBound) rootBound = r;
+    }
+    rootBound += 1.0;
+
+    intervalCount = 0;
+    pushInterval(-rootBound, rootBound, signChanges(-rootBound), signChanges(rootBound));
+}
+
+// Split until each interval holds one root, then refine it: Brent where
+// p changes sign, Sturm bisection at a root of even multiplicity
+static void polynomialStep(u64 start) {
+    while (intervalCount > 0) {
+        RootInterval r = intervals[--intervalCount];
+        int count = r.changesLo - r.changesHi;
+        double width = r.hi - r.lo;
+        double pLo = evalPoly(r.lo), pHi = evalPoly(r.hi);
+
+        if (count == 1 && ((pLo < 0.0 && pHi > 0.0) || (pLo > 0.0 && pHi < 0.0))) {
+            addRoot(brent(evalPoly, r.lo, r.hi, pLo, pHi), 0.0);
+        } else if (width <= 4.0 * DBL_EPSILON * (fabs(r.lo) + fabs(r.hi)) + 1e-300) {
+            addRoot(0.5 * (r.lo + r.hi), 0.0); // repeated root, or roots closer than doubles tell apart
+        } else {
+            // Off centre, so round test values such as 0 are rarely hit
+            double mid = r.lo + width * 0.4970930954;
+            if (evalPoly(mid) == 0.0) {
+                addRoot(mid, 0.0);
+                double gap = width * 1e-9;
+                pushInterval(r.lo, mid - gap, r.changesLo, signChanges(mid - gap));
+                pushInterval(mid + gap, r.hi, signChanges(mid + gap), r.changesHi);
+            } else {
+                int changesMid = signChanges(mid);
+                pushInterval(r.lo, mid, r.changesLo, changesMid);
+                pushInterval(mid, r.hi, changesMid, r.changesHi);
+            }
+        }
+
+        if (intervalCount > 0 && overBudget(start)) return;
+    }
+    busy = false;
+}
+
+// ---- general f(x) ----
+
+static void checkCell(double a, double fa, double sa, double b, double fb, double sb) {
+    if (!isfinite(fa) || !isfinite(fb)) return;
+
+    if ((fa < 0.0 && fb > 0.0) || (fa > 0.0 && fb < 0.0)) {
+        // Across a pole f changes sign too, but grows instead of vanishing
+        double r = brent(evalF, a, b, fa, fb);
+        if (fabs(evalF(r)) <= fmin(fabs(fa), fabs(fb))) addRoot(r, 0.0);
+    } else if (fa != 0.0 && fb != 0.0 && isfinite(sa) && isfinite(sb) && fa * sa < 0.0 && fb * sb > 0.0) {
+        // |f| falls then rises: a minimum inside that may touch zero
+        double m = brent(evalSlope, a, b, sa, sb);
+        if (fabs(evalF(m)) <= 1e-12 * fmax(1.0, fmax(fabs(fa), fabs(fb)))) addRoot(m, 0.0);
+    }
+}
+
+// Samples in blocks on the batch evaluator, carrying the last one over to
+// the next block and the next frame
+static void scanStep(u64 start) {
+    double xs[EXPR_LANES], fs[EXPR_LANES], slopes[EXPR_LANES];
+    double vars[EXPR_VAR_COUNT] = {0};
+
+    while (scanned <= SOLVER_SCAN_CELLS) {
+        int n = SOLVER_SCAN_CELLS + 1 - scanned;
+        if (n > EXPR_LANES) n = EXPR_LANES;
+        for (int j = 0; j < n; j++) {
+            xs[j] = -SOLVER_SCAN_RANGE + 2.0 * SOLVER_SCAN_RANGE * (scanned + j) / SOLVER_SCAN_CELLS;
+        }
+        exprEvalBatchDual(&programs[0], vars, EXPR_VAR_X, xs, fs, slopes, n);
+
+        for (int j = 0; j < n; j++) {
+            if (fs[j] == 0.0) addRoot(xs[j], 0.0);
+            if (scanned + j > 0) checkCell(prevX, prevF, prevSlope, xs[j], fs[j], slopes[j]);
+            prevX = xs[j];
+            prevF = fs[j];
+            prevSlope = slopes[j];
+        }
+        scanned += n;
+
+        if (scanned <= SOLVER_SCAN_CELLS && overBudget(start)) return;
+    }
+    busy = false;
+}
+
+// ---- systems ----
+
+static void pushBox(double x, double y, double size) {
+    if (boxCount == SOLVER_MAX_BOXES) return;
+    SolverBox* box = &boxes[boxCount++];
+    box->x = x;
+    box->y = y;
+    box->size = size;
+}
+
+// Newton's method from the centre of a leaf box, with the Jacobian from
+// dual-number evaluations. A root is kept only near the box it started
+// from, so each one is reached from the boxes around it.
+static void newtonFrom(const SolverBox* box) {
+    double v[EXPR_VAR_COUNT] = {0};
+    double x = box->x + 0.5 * box->size, y = box->y + 0.5 * box->size;
+    bool converged = false;
+
+    for (int iter = 0; iter < SOLVER_NEWTON_STEPS && !converged; iter++) {
+        double f1x, f1y, f2x, f2y;
+        v[EXPR_VAR_X] = x;
+        v[EXPR_VAR_Y] = y;
+        double f1 = exprEvalDual(&programs[0], v, EXPR_VAR_X, &f1x);
+        exprEvalDual(&programs[0], v, EXPR_VAR_Y, &f1y);
+        double f2 = exprEvalDual(&programs[1], v, EXPR_VAR_X, &f2x);
+        exprEvalDual(&programs[1], v, EXPR_VAR_Y, &f2y);
+
+        double det = f1x * f2y - f1y * f2x;
+        if (!isfinite(det) || det == 0.0) return;
+        double dx = (f1 * f2y - f2 * f1y) / det;
+        double dy = (f2 * f1x - f1 * f2x) / det;
+        x -= dx;
+        y -= dy;
+        if (!isfinite(x) || !isfinite(y)) return;
+        converged = fabs(dx) <= 1e-12 * (1.0 + fabs(x)) && fabs(dy) <= 1e-12 * (1.0 + fabs(y));
+    }
+    if (!converged) return;
+    if (x < box->x - box->size || x > box->x + 2.0 * box->size ||
+        y < box->y - box->size || y > box->y + 2.0 * box->size) return;
+
+    v[EXPR_VAR_X] = x;
+    v[EXPR_VAR_Y] = y;
+    double tol = 1e-9 * (1.0 + fabs(x) + fabs(y));
+    if (fabs(exprEval(&programs[0], v)) > tol || fabs(exprEval(&programs[1], v)) > tol) return;
+    addRoot(x, y);
+}
+
+// A box where interval bounds keep either function away from zero holds
+// no solution; the rest split down to SOLVER_LEAF_SIZE
+static void systemStep(u64 start) {
+    while (boxCount > 0) {
+        SolverBox box = boxes[--boxCount];
+        double lo[EXPR_VAR_COUNT] = {0}, hi[EXPR_VAR_COUNT] = {0};
+        lo[EXPR_VAR_X] = box.x;
+        hi[EXPR_VAR_X] = box.x + box.size;
+        lo[EXPR_VAR_Y] = box.y;
+        hi[EXPR_VAR_Y] = box.y + box.size;
+
+        bool possible = true;
+        for (int k = 0; k < 2 && possible; k++) {
+            double fLo, fHi;
+            if (exprEvalBox(&programs[k], lo, hi, &fLo, &fHi) && (fLo > 0.0 || fHi < 0.0)) possible = false;
+        }
+
+        if (possible && box.size > SOLVER_LEAF_SIZE) {
+            double half = 0.5 * box.size;
+            pushBox(box.x, box.y, half);
+            pushBox(box.x + half, box.y, half);
+            pushBox(box.x, box.y + half, half);
+            pushBox(box.x + half, box.y + half, half);
+        } else if (possible) {
+            newtonFrom(&box);
+        }
+
+        if (boxCount > 0 && overBudget(start)) return;
+    }
+    busy = false;
+}
+
+// ---- entry ----
+
+// Offset of c outside any parentheses, or -1
+static int findTopLevel(const char* s, int length, char c) {
+    int depth = 0;
+    for (int i = 0; i < length && s[i]; i++) {
+        if (s[i] == '(') depth++;
+        else if (s[i] == ')') depth--;
+        else if (s[i] == c && depth == 0) return i;
+    }
+    return -1;
+}
+
+// "f = g" compiles as (f) - (g); a bare f is f = 0
+static bool compileEquation(ExprProgram* prog, const char* s, int length, ExprAngleMode angles) {
+    char text[300];
+    int eq = findTopLevel(s, length, '=');
+    if (eq >= 0) {
+        snprintf(text, sizeof(text), "(%.*s)-(%.*s)", eq, s, length - eq - 1, s + eq + 1);
+    } else {
+        snprintf(text, sizeof(text), "%.*s", length, s);
+    }
+    return exprCompile(prog, text, angles);
+}
+
+bool solverStart(const char* source, ExprAngleMode angles, char* error, int errorSize) {
+    busy = false;
+    kind = SOLVE_NONE;
+    note = NULL;
+    rootCount = 0;
+    moreRoots = false;
+
+    int length = strlen(source);
+    int split = findTopLevel(source, length, ';');
+    int count = split >= 0 ? 2 : 1;
+    if (split >= 0 && findTopLevel(source + split + 1, length - split - 1, ';') >= 0) {
+        snprintf(error, errorSize, "ERROR: At most 2 equations");
+        return false;
+    }
+
+    for (int k = 0; k < count; k++) {
+        const char* s = k == 0 ? source : source + split + 1;
+        int n = k == 0 && split >= 0 ? split : strlen(s);
+        if (!compileEquation(&programs[k], s, n, angles)) {
+            snprintf(error, errorSize, "ERROR: %s", programs[k].error);
+            return false;
+        }
+        if (programs[k].calculusCount > 0) {
+            snprintf(error, errorSize, "ERROR: Solve without \xE2\x88\xAB and \xCE\xA3");
+            return false;
+        }
+    }
+
+    u32 used = programs[0].varMask | (count == 2 ? programs[1].varMask : 0);
+    u32 allowed = count == 2 ? (1u << EXPR_VAR_X) | (1u << EXPR_VAR_Y) : 1u << EXPR_VAR_X;
+    if (used & ~allowed) {
+        snprintf(error, errorSize, "ERROR: %s",
+                 count == 1 && exprUsesVar(&programs[0], EXPR_VAR_Y) ? "x and y need 2 equations" : "Solve for x (and y)");
+        return false;
+    }
+
+    busy = true;
+    Poly p;
+    if (count == 2) {
+        kind = SOLVE_SYSTEM;
+        exprOptimize(&programs[0], EXPR_VAR_COUNT);
+        exprOptimize(&programs[1], EXPR_VAR_COUNT);
+        boxCount = 0;
+        pushBox(-SOLVER_SYSTEM_RANGE, -SOLVER_SYSTEM_RANGE, 2.0 * SOLVER_SYSTEM_RANGE);
+    } else if (extractPoly(&programs[0], &p)) {
+        kind = SOLVE_POLYNOMIAL;
+        startPolynomial(&p);
+    } else {
+        kind = SOLVE_SCAN;
+        exprOptimize(&programs[0], EXPR_VAR_X);
+        scanned = 0;
+    }
+    return true;
+}
+
+void solverCancel() {
+    busy = false;
+    kind = SOLVE_NONE;
+}
+
+void solverStep() {
+    if (!busy) return;
+
+    u64 start = gettime();
+    switch (kind) {
+        case SOLVE_POLYNOMIAL: polynomialStep(start); break;
+        case SOLVE_SCAN:       scanStep(start); break;
+        case SOLVE_SYSTEM:     systemStep(start); break;
+        default:               busy = false; break;
+    }
+}
+
+bool solverBusy() {
+    return busy;
+}
+
+bool solverHasResult() {
+    return kind != SOLVE_NONE;
+}
+
+// Rounding leaves roots at 0 as tiny multiples of the search scale
+static double cleanRoot(double v) {
+    double scale = kind == SOLVE_POLYNOMIAL ? rootBound : 1.0;
+    return fabs(v) < 1e-12 * scale ? 0.0 : v;
+}
+
+static void formatRoot(char* out, int size, int i) {
+    if (kind == SOLVE_SYSTEM) {
+        snprintf(out, size, "x = %.10g, y = %.10g", cleanRoot(rootX[i]), cleanRoot(rootY[i]));
+    } else {
+        snprintf(out, size, "x = %.10g", cleanRoot(rootX[i]));
+    }
+}
+
+void solverSummary(char* out, int size) {
+    if (note) {
+        snprintf(out, size, "%s", note);
+        return;
+    }
+    if (rootCount == 0) {
+        snprintf(out, size, "No real roots found");
+        return;
+    }
+
+    int used = 0;
+    out[0] = '\0';
+    for (int i = 0; i < rootCount && used < size - 1; i++) {
+        char root[64];
+        if (kind == SOLVE_SYSTEM) {
+            snprintf(root, sizeof(root), "(%.8g, %.8g)", cleanRoot(rootX[i]), cleanRoot(rootY[i]));
+        } else {
+            snprintf(root, sizeof(root), "%.8g", cleanRoot(rootX[i]));
+        }
+        used += snprintf(out + used, size - used, "%s%s%s", i == 0 ? (kind == SOLVE_SYSTEM ? "(x, y) = " : "x = ") : "", i > 0 ? ", " : "", root);
+    }
+}
+
+// Share of the search space already covered
+static int progressPercent() {
+    double left = 0.0;
+    switch (kind) {
+        case SOLVE_POLYNOMIAL:
+            for (int i = 0; i < intervalCount; i++) left += intervals[i].hi - intervals[i].lo;
+            left /= 2.0 * rootBound;
+            break;
+        case SOLVE_SCAN:
+            left = 1.0 - (double)scanned / (SOLVER_SCAN_CELLS + 1);
+            break;
+        case SOLVE_SYSTEM:
+            for (int i = 0; i < boxCount; i++) left += boxes[i].size * boxes[i].size;
+            left /= 4.0 * SOLVER_SYSTEM_RANGE * SOLVER_SYSTEM_RANGE;
+            break;
+    }
+    return (int)((1.0 - left) * 100.0);
+}
+
+void solverRender(float x, float y) {
+    if (kind == SOLVE_NONE) return;
+
+    char line[80];
+    const char* method = kind == SOLVE_POLYNOMIAL ? "all real roots (Sturm)" :
+                         kind == SOLVE_SCAN ? "roots in -100 to 100" : "solutions in -10 to 10";
+    if (busy) {
+        snprintf(line, sizeof(line), "Solving for %s... %d%%", method, progressPercent());
+    } else if (note) {
+        snprintf(line, sizeof(line), "%s", note);
+    } else {
+        snprintf(line, sizeof(line), "%d %s%s: %s", rootCount, rootCount == 1 ? "root" : "roots",
+                 moreRoots ? "+" : "", method);
+    }
+    drawText(x, y, line, busy ? COLOR_ORANGE : COLOR_GREEN, 0.8f);
+
+    for (int i = 0; i < rootCount && i < SOLVER_ROOT_LINES; i++) {
+        formatRoot(line, sizeof(line), i);
+        drawText(x + 20, y + 22 + i * 20, line, COLOR_WHITE, 0.8f);
+    }
+    if (rootCount > SOLVER_ROOT_LINES) {
+        snprintf(line, sizeof(line), "... and %d more", rootCount - SOLVER_ROOT_LINES);
+        drawText(x + 20, y + 22 + SOLVER_ROOT_LINES * 20, line, COLOR_GRAY, 0.7f);
+    }
+}
@@ -0,0 +1,364 @@
+#include "stockchart.h"
+#include "graphics.h"
+#include "input.h"
+#include "network.h"
+#include "netsched.h"
+#include "candles.h"
+#include "indicators.h"
+#include "histstore.h"
+#include "sntp.h"
+#include <ogc/lwp_watchdog.h>
+
+#define CHART_REFRESH_SEC 60
+#define STORED_DAYS 30
+#define REPEAT_MS 150
+
+// Plot area: prices on top, RSI below
+#define CHART_X 50
+#define CHART_Y 90
+#define CHART_WIDTH 530
+#define CHART_HEIGHT 270
+#define PRICE_HEIGHT 200
+#define RSI_Y (CHART_Y + PRICE_HEIGHT + 15)
+#define RSI_HEIGHT (CHART_HEIGHT - PRICE_HEIGHT - 15)
+
+#define COLOR_GRID 0xFFFFFF20
+#define COLOR_BANDS 0xFFFFFF60
+
+static const int zoomLevels[] = { 24, 48, 96 }; // candles across the plot
+#define ZOOM_LEVELS (int)(sizeof(zoomLevels) / sizeof(zoomLevels[0]))
+
+static bool chartOpen = false;
+static char chartSymbol[16];
+static char chartName[48];
+static ChartQuoteHandler quoteHandler = NULL;
+static int subscription = -1;
+static bool fetchFailed = false;
+
+static ChartSeries series;
+static ChartSeries fresh; // parse target, merged into series
+static CandleSet candleSets[CANDLE_INTERVAL_COUNT];
+
+static bool storedLoaded = false; // daily candles read from SD
+
+static CandleInterval interval = CANDLE_5M;
+static int zoom = 1;
+static int panOffset = 0;  // candles back from the latest
+static u64 nextRepeatMs = 0;
+
+// Indicator values per candle of the interval on screen. Closed candles are
+// folded into committed once; the forming last candle is evaluated on a copy.
+static IndicatorValues candleIndicators[CHART_MAX_POINTS];
+static IndicatorState committed;
+static int committedCount = 0;
+static CandleInterval indicatorInterval = CANDLE_INTERVAL_COUNT;
+
+static void onChartData(const char* body, bool ok, void* userData) {
+    if (!chartOpen) return;
+
+    if (!ok || !parseChartSeries(body, &fresh)) {
+        fetchFailed = (series.count == 0);
+        return;
+    }
+    fetchFailed = false;
+
+    // Every interval is told what changed; each catches up when next shown
+    int changedFrom = chartMerge(&series, &fresh);
+    for (int i = 0; i < CANDLE_INTERVAL_COUNT; i++) {
+        candlesInvalidate(&candleSets[i], changedFrom);
+    }
+
+    float price, prevClose;
+    if (quoteHandler && parseStockQuote(body, &price, &prevClose)) {
+        quoteHandler(chartSymbol, price, prevClose);
+    }
+}
+
+static void addCandle(IndicatorState* state, const CandleSet* set, int i) {
+    float typical = (set->high[i] + set->low[i] + set->close[i]) / 3.0f;
+    indicatorsAdd(state, set->close[i], typical, set->volume[i]);
+}
+
+// Bring candleIndicators up to date with the candles that changed
+static void syncIndicators(CandleSet* set) {
+    if (interval != indicatorInterval || set->changedFrom < committedCount) {
+        indicatorsInit(&committed);
+        committedCount = 0;
+        indicatorInterval = interval;
+    } else if (set->changedFrom >= set->count) {
+        return;
+    }
+
+    while (committedCount < set->count - 1) {
+        addCandle(&committed, set, committedCount);
+        candleIndicators[committedCount] = *indicatorsGet(&committed);
+        committedCount++;
+    }
+
+    if (set->count > 0) {
+        IndicatorState forming = committed;
+        addCandle(&forming, set, set->count - 1);
+        candleIndicators[set->count - 1] = *indicatorsGet(&forming);
+    }
+    candlesAcknowledge(set);
+}
+
+// Daily candles for the last STORED_DAYS days. A block that lies within one
+// day is folded in from its header summary; only blocks spanning midnight
+// or the range start are decoded.
+static void loadStoredCandles(CandleSet* set) {
+    static PricePoint points[HIST_BLOCK_POINTS];
+
+    candlesInit(set, CANDLE_1D);
+    storedLoaded = true;
+
+    HistFile file;
+    if (!histOpen(&file, chartSymbol)) return;
+
+    s64 fromMs = sntpTimeUs() / 1000 - (s64)STORED_DAYS * 24 * 60 * 60 * 1000;
+    int firstBlock = histFindBlock(&file, fromMs);
+    for (int b = firstBlock; b < file.blockCount; b++) {
+        const HistBlock* block = &file.blocks[b];
+        u32 first = (u32)(block->firstMs / 1000);
+        u32 last = (u32)(block->lastMs / 1000);
+
+        if (block->firstMs >= fromMs && first / set->intervalSec == last / set->intervalSec) {
+            candlesAppend(set, first, block->first, block->high, block->low, block->last, 0.0f);
+            continue;
+        }
+
+        int count = histReadBlock(&file, b, points);
+        for (int i = 0; i < count; i++) {
+            if (points[i].timeUs / 1000 < fromMs) continue;
+            float price = points[i].price;
+            candlesAppend(set, (u32)(points[i].timeUs / 1000000), price, price, price, price, 0.0f);
+        }
+    }
+    histClose(&file);
+}
+
+void openStockChart(const char* symbol, const char* name, ChartQuoteHandler handler) {
+    closeStockChart();
+
+    snprintf(chartSymbol, sizeof(chartSymbol), "%s", symbol);
+    snprintf(chartName, sizeof(chartName), "%s", name);
+    quoteHandler = handler;
+    fetchFailed = false;
+    panOffset = 0;
+    indicatorInterval = CANDLE_INTERVAL_COUNT;
+    storedLoaded = false;
+
+    series.count = 0;
+    for (int i = 0; i < CANDLE_INTERVAL_COUNT; i++) {
+        candlesInit(&candleSets[i], (CandleInterval)i);
+    }
+
+    char url[512];
+    stockChartUrl(symbol, url, sizeof(url));
+    subscription = netSubscribe(url, SCENE_STOCKS, NET_PRIORITY_HIGH, CHART_REFRESH_SEC, onChartData, NULL);
+    chartOpen = true;
+}
+
+void closeStockChart() {
+    if (!chartOpen) return;
+    netUnsubscribe(subscription);
+    subscription = -1;
+    chartOpen = false;
+}
+
+bool isStockChartOpen() {
+    return chartOpen;
+}
+
+void updateStockChart() {
+    InputState* input = getInput();
+
+    if (input->bButton) {
+        closeStockChart();
+        return;
+    }
+
+    // +/- pick the candle interval
+    if (input->plusButton && interval < CANDLE_INTERVAL_COUNT - 1) {
+        interval = (CandleInterval)(interval + 1);
+        panOffset = 0;
+    }
+    if (input->minusButton && interval > 0) {
+        interval = (CandleInterval)(interval - 1);
+        panOffset = 0;
+    }
+
+    // Only the interval on screen is kept current
+    CandleSet* set = &candleSets[interval];
+    if (interval == CANDLE_1D) {
+        if (!storedLoaded || input->pressed) loadStoredCandles(set);
+    } else {
+        storedLoaded = false;
+        candlesSync(set, &series);
+    }
+
+    // D-pad: left/right pans through time, up/down zooms (held keys repeat)
+    u64 now = ticks_to_millisecs(gettime());
+    if (input->dpadX == 0 && input->dpadY == 0) {
+        nextRepeatMs = 0;
+    } else if (now >= nextRepeatMs) {
+        int visible = zoomLevels[zoom];
+        panOffset -= input->dpadX * (visible / 8);
+        zoom += input->dpadY;
+        if (zoom < 0) zoom = 0;
+        if (zoom >= ZOOM_LEVELS) zoom = ZOOM_LEVELS - 1;
+        nextRepeatMs = now + REPEAT_MS;
+    }
+
+    syncIndicators(set);
+
+    int maxPan = set->count - zoomLevels[zoom];
+    if (panOffset > maxPan) panOffset = maxPan;
+    if (panOffset < 0) panOffset = 0;
+
+    if (input->pressed) {
+        netRefresh(subscription);
+    }
+}
+
+// Time of day for intraday candles, month/day for daily ones
+static void formatClock(u32 utc, int gmtOffset, bool daily, char* out, int size) {
+    time_t local = (time_t)utc + (daily ? 0 : gmtOffset);
+    struct tm parts;
+    gmtime_r(&local, &parts);
+    if (daily) snprintf(out, size, "%02u/%02u", (u8)(parts.tm_mon + 1), (u8)parts.tm_mday);
+    else snprintf(out, size, "%02u:%02u", (u8)parts.tm_hour, (u8)parts.tm_min);
+}
+
+void renderStockChart() {
+    const CandleSet* set = &candleSets[interval];
+
+    char title[96];
+    snprintf(title, sizeof(title), "%s  %s", chartSymbol, chartName);
+    drawText(40, 30, title, COLOR_WHITE, 1.5f);
+
+    char intervalText[16];
+    snprintf(intervalText, sizeof(intervalText), "[%s]", candleIntervalName(interval));
+    drawText(540, 36, intervalText, COLOR_CYAN, 1.0f);
+
+    drawGlassRectangle(CHART_X - 10, CHART_Y - 10, CHART_WIDTH + 70, CHART_HEIGHT + 40, COLOR_GLASS_DARK);
+
+    if (set->count == 0) {
+        const char* status = interval == CANDLE_1D ? "No stored history yet" :
+                             fetchFailed ? "No chart data" :
+                             netSceneBusy(SCENE_STOCKS) ? "Loading chart..." : "Waiting for data";
+        drawText(CHART_X + 180, CHART_Y + CHART_HEIGHT / 2, status, COLOR_GRAY, 1.0f);
+    } else {
+        int visible = zoomLevels[zoom];
+        int last = set->count - panOffset;  // exclusive
+        int first = last - visible;
+        if (first < 0) first = 0;
+
+        // Vertical scale from the visible candles and bands only
+        float low = set->low[first], high = set->high[first];
+        for (int i = first; i < last; i++) {
+            const IndicatorValues* v = &candleIndicators[i];
+            float lo = v->bandsValid && v->lowerBand < set->low[i] ? v->lowerBand : set->low[i];
+            float hi = v->bandsValid && v->upperBand > set->high[i] ? v->upperBand : set->high[i];
+            if (lo < low) low = lo;
+            if (hi > high) high = hi;
+        }
+        float range = (high - low) > 0.0001f ? (high - low) : 1.0f;
+
+        // Price grid
+        for (int g = 0; g <= 4; g++) {
+            float y = CHART_Y + PRICE_HEIGHT * g / 4.0f;
+            drawLine(CHART_X, y, CHART_X + CHART_WIDTH, y, COLOR_GRID);
+
+            char label[16];
+            snprintf(label, sizeof(label), "%.2f", high - range * g / 4.0f);
+            drawText(CHART_X + CHART_WIDTH + 4, y - 6, label, COLOR_GRAY, 0.6f);
+        }
+
+        float slot = (float)CHART_WIDTH / visible;
+        float bodyWidth = slot * 0.6f > 1.0f ? slot * 0.6f : 1.0f;
+
+        for (int i = first; i < last; i++) {
+            float cx = CHART_X + (i - first + 0.5f) * slot;
+            float yHigh = CHART_Y + (high - set->high[i]) / range * PRICE_HEIGHT;
+            float yLow = CHART_Y + (high - set->low[i]) / range * PRICE_HEIGHT;
+            float yOpen = CHART_Y + (high - set->open[i]) / range * PRICE_HEIGHT;
+            float yClose = CHART_Y + (high - set->close[i]) / range * PRICE_HEIGHT;
+
+            u32 color = set->close[i] >= set->open[i] ? COLOR_GREEN : COLOR_RED;
+            float top = yOpen < yClose ? yOpen : yClose;
+            float height = fabsf(yClose - yOpen);
+
+            drawLine(cx, yHigh, cx, yLow, color);
+            drawRectangle(cx - bodyWidth / 2, top, bodyWidth, height > 1.0f ? height : 1.0f, color);
+        }
+
+        // Overlays, joined between neighbouring candles where both are valid
+        for (int i = first + 1; i < last; i++) {
+            const IndicatorValues* a = &candleIndicators[i - 1];
+            const IndicatorValues* b = &candleIndicators[i];
+            float x0 = CHART_X + (i - 1 - first + 0.5f) * slot;
+            float x1 = x0 + slot;
+
+            if (a->bandsValid && b->bandsValid) {
+                drawLine(x0, CHART_Y + (high - a->upperBand) / range * PRICE_HEIGHT,
+                         x1, CHART_Y + (high - b->upperBand) / range * PRICE_HEIGHT, COLOR_BANDS);
+                drawLine(x0, CHART_Y + (high - a->lowerBand) / range * PRICE_HEIGHT,
+                         x1, CHART_Y + (high - b->lowerBand) / range * PRICE_HEIGHT, COLOR_BANDS);
+            }
+            if (a->smaValid && b->smaValid) {
+                drawLine(x0, CHART_Y + (high - a->sma) / range * PRICE_HEIGHT,
+                         x1, CHART_Y + (high - b->sma) / range * PRICE_HEIGHT, COLOR_ORANGE);
+            }
+            if (a->emaValid && b->emaValid) {
+                drawLine(x0, CHART_Y + (high - a->ema) / range * PRICE_HEIGHT,
+                         x1, CHART_Y + (high - b->ema) / range * PRICE_HEIGHT, COLOR_CYAN);
+            }
+            if (a->vwapValid && b->vwapValid) {
+                drawLine(x0, CHART_Y + (high - a->vwap) / range * PRICE_HEIGHT,
+                         x1, CHART_Y + (high - b->vwap) / range * PRICE_HEIGHT, COLOR_PURPLE);
+            }
+            if (a->rsiValid && b->rsiValid) {
+                drawLine(x0, RSI_Y + (100.0f - a->rsi) / 100.0f * RSI_HEIGHT,
+                         x1, RSI_Y + (100.0f - b->rsi) / 100.0f * RSI_HEIGHT, COLOR_WHITE);
+            }
+        }
+
+        // RSI panel with the usual 30/70 guides
+        drawLine(CHART_X, RSI_Y + RSI_HEIGHT * 0.3f, CHART_X + CHART_WIDTH, RSI_Y + RSI_HEIGHT * 0.3f, COLOR_GRID);
+        drawLine(CHART_X, RSI_Y + RSI_HEIGHT * 0.7f, CHART_X + CHART_WIDTH, RSI_Y + RSI_HEIGHT * 0.7f, COLOR_GRID);
+        drawText(CHART_X + CHART_WIDTH + 4, RSI_Y + RSI_HEIGHT / 2 - 6, "RSI", COLOR_GRAY, 0.6f);
+
+        // Legend with the latest visible values
+        const IndicatorValues* latest = &candleIndicators[last - 1];
+        char legend[24];
+        if (latest->smaValid) {
+            snprintf(legend, sizeof(legend), "SMA%d %.2f", IND_SMA_PERIOD, latest->sma);
+            drawText(CHART_X, 66, legend, COLOR_ORANGE, 0.6f);
+        }
+        if (latest->emaValid) {
+            snprintf(legend, sizeof(legend), "EMA%d %.2f", IND_EMA_PERIOD, latest->ema);
+            drawText(CHART_X + 120, 66, legend, COLOR_CYAN, 0.6f);
+        }
+        if (latest->vwapValid) {
+            snprintf(legend, sizeof(legend), "VWAP %.2f", latest->vwap);
+            drawText(CHART_X + 240, 66, legend, COLOR_PURPLE, 0.6f);
+        }
+        if (latest->rsiValid) {
+            snprintf(legend, sizeof(legend), "RSI%d %.0f", IND_RSI_PERIOD, latest->rsi);
+            drawText(CHART_X + 360, 66, legend, COLOR_WHITE, 0.6f);
+        }
+
+        // Exchange-local times at both ends and the middle
+        int marks[3] = { first, (first + last - 1) / 2, last - 1 };
+        for (int m = 0; m < 3; m++) {
+            char clock[8];
+            formatClock(set->start[marks[m]], series.gmtOffset, interval == CANDLE_1D, clock, sizeof(clock));
+            float x = CHART_X + (marks[m] - first + 0.5f) * slot - 15;
+            drawText(x, CHART_Y + CHART_HEIGHT + 8, clock, COLOR_GRAY, 0.7f);
+        }
+    }
+
+    drawText(60, 420, "+/-: Interval | Up/Down: Zoom | Left/Right: Pan", COLOR_WHITE, 0.9f);
+    drawText(180, 445, "A: Refresh | B: Back to list", COLOR_WHITE, 0.9f);
+}
@@ -2,84 +2,547 @@
 #include "graphics.h"
 #include "input.h"
 #include "network.h"
+#include "config.h"
+#include "quotestream.h"
+#include "netsched.h"
+#include "metrics.h"
+#include "pricehistory.h"
+#include "indicators.h"
+#include "histstore.h"
+#include "quote.h"
+#include "stockchart.h"
+#include "sntp.h"
+#include "alerts.h"
+#include <ogc/lwp_watchdog.h>
 
-#define MAX_STOCKS 6
+#define MAX_STOCKS 1000
+#define SPARK_POINTS 48 // drawn segments per tile, whatever the history length
+
+// Grid layout; only the rows in view are laid out and drawn
+#define GRID_COLUMNS 2
+#define VISIBLE_ROWS 3
+#define GRID_TOP 80
+#define ROW_HEIGHT 110
+#define SCROLL_REPEAT_MS 150
+
+// Off-screen symbols refresh this many times less often, at low priority
+#define OFFSCREEN_INTERVAL_FACTOR 4
+
+#define TREND_POOL_SIZE 48     // tiles on screen, alert symbols, recently viewed
+#define RESTORE_BUDGET_US 4000 // SD history reads per frame, after the first
+
+static const char* WATCHLIST_PATH = "sd:/apps/wii-dashboard/watchlist.txt";
+
+// Trend data, from a small LRU pool: a symbol gets one while its tile is
+// on screen or it has alert rules, and keeps it until the slot is reused.
+// A new owner's trend is filled from the SD history a few per frame.
+typedef struct {
+    int owner;                      // index into stocks, -1 when free
+    bool restored;                  // history loaded, advancing with quotes
+    u32 lastUsed;
+    PriceHistory history;
+    PricePoint spark[SPARK_POINTS]; // downsampled on append, not per frame
+    int sparkCount;
+    IndicatorState indicators;      // advanced once per price move
+    char indicatorText[48];         // formatted on update, drawn as is
+} StockTrend;
 
 typedef struct {
-    const char* symbol;
-    const char* name;
-    char price[32];
-    char change[32];
-    bool isPositive;
+    char symbol[16];
+    char name[48];
+    Quote quote;
+    bool visible;
+    bool streamed;        // carried by the quote stream
+    int subscription;
+    AlertRange alerts;    // this symbol's compiled rules
+    HistWriter store;     // pending block of the on-SD history
+    StockTrend* trend;
 } StockInfo;
 
-static StockInfo stocks[MAX_STOCKS] = {
-    {"AAPL", "Apple Inc.", "$0.00", "+0.00%", true},
-    {"MSFT", "Microsoft Corp.", "$0.00", "+0.00%", true},
-    {"GOOGL", "Alphabet Inc.", "$0.00", "+0.00%", true},
-    {"TSLA", "Tesla Inc.", "$0.00", "+0.00%", true},
-    {"AMZN", "Amazon.com Inc.", "$0.00", "+0.00%", true},
-    {"NVDA", "NVIDIA Corp.", "$0.00", "+0.00%", true}
+static const char* defaultWatchlist[][2] = {
+    {"AAPL", "Apple Inc."},
+    {"MSFT", "Microsoft Corp."},
+    {"GOOGL", "Alphabet Inc."},
+    {"TSLA", "Tesla Inc."},
+    {"AMZN", "Amazon.com Inc."},
+    {"NVDA", "NVIDIA Corp."}
 };
 
-static int updateCounter = 0;
-static bool isLoading = false;
+static StockInfo* stocks = NULL;
+static int stockCount = 0;
+static int* bySymbol = NULL; // indices sorted by symbol, for tick lookup
+static StockTrend* trends = NULL;
+static int trendCount = 0;
+static u32 trendClock = 0;
+
+static int topRow = 0;
+static u64 nextScrollMs = 0;
+static int pollInterval = 300;
+static bool wasStreaming = false;
+
+static void formatIndicators(StockTrend* trend) {
+    const IndicatorValues* values = indicatorsGet(&trend->indicators);
+    char* out = trend->indicatorText;
+    int size = sizeof(trend->indicatorText);
+    int len = 0;
+    
+    out[0] = '\0';
+    if (values->smaValid) {
+        len += snprintf(out + len, size - len, "SMA%d %.2f  ", IND_SMA_PERIOD, values->sma);
+    }
+    if (values->emaValid && len < size) {
+        len += snprintf(out + len, size - len, "EMA%d %.2f  ", IND_EMA_PERIOD, values->ema);
+    }
+    if (values->rsiValid && len < size) {
+        snprintf(out + len, size - len, "RSI %.0f", values->rsi);
+    }
+}
+
+static bool trendPinned(const StockInfo* stock) {
+    return stock->visible || stock->alerts.count > 0;
+}
+
+// The symbol's trend, taking over the least recently used one that is not
+// pinned if it has none yet; NULL when every trend is pinned
+static StockTrend* acquireTrend(StockInfo* stock) {
+    StockTrend* trend = stock->trend;
+    if (!trend) {
+        for (int i = 0; i < trendCount; i++) {
+            StockTrend* candidate = &trends[i];
+            if (candidate->owner >= 0 && trendPinned(&stocks[candidate->owner])) continue;
+            if (!trend || candidate->lastUsed < trend->lastUsed) trend = candidate;
+        }
+        if (!trend) return NULL;
+        
+        // The previous owner's points are all in its SD history already
+        if (trend->owner >= 0) stocks[trend->owner].trend = NULL;
+        trend->owner = stock - stocks;
+        trend->restored = false;
+        trend->sparkCount = 0;
+        trend->indicatorText[0] = '\0';
+        stock->trend = trend;
+    }
+    trend->lastUsed = ++trendClock;
+    return trend;
+}
+
+// Continue from what this and previous sessions stored on SD
+static void restoreTrend(StockInfo* stock) {
+    static PricePoint stored[PRICE_HISTORY_CAPACITY];
+    StockTrend* trend = stock->trend;
+    
+    historyInit(&trend->history);
+    indicatorsInit(&trend->indicators);
+    
+    // Points still pending in memory are written first, so none are missed
+    histFlush(&stock->store);
+    int count = histLoadRecent(&stock->store, stored, PRICE_HISTORY_CAPACITY);
+    for (int i = 0; i < count; i++) {
+        historyAppend(&trend->history, stored[i].timeUs, stored[i].price);
+        indicatorsAdd(&trend->indicators, stored[i].price, stored[i].price, 0.0f);
+    }
+    trend->sparkCount = historyDownsample(&trend->history, trend->spark, SPARK_POINTS);
+    formatIndicators(trend);
+    trend->restored = true;
+}
+
+// Newest acquisitions first: at least one per frame, more within the budget
+static void restorePendingTrends() {
+    u64 start = gettime();
+    do {
+        StockTrend* next = NULL;
+        for (int i = 0; i < trendCount; i++) {
+            StockTrend* trend = &trends[i];
+            if (trend->owner < 0 || trend->restored) continue;
+            if (!next || trend->lastUsed > next->lastUsed) next = trend;
+        }
+        if (!next) return;
+        restoreTrend(&stocks[next->owner]);
+    } while (ticks_to_microsecs(gettime() - start) < RESTORE_BUDGET_US);
+}
+
+// Apply a quote (polled or streamed) to a tile
+static void applyQuote(StockInfo* stock, float price, float prevClose, QuoteSource source) {
+    s64 now = sntpTimeUs();
+    
+    // Only price moves are kept: repeated polls of an unchanged price would
+    // flatten the trend and its indicators. Every move reaches the SD
+    // history, so a trend restored from it continues the same series.
+    bool moved = !quoteHasData(&stock->quote) || price != (float)stock->quote.price;
+    bool changed = quoteUpdate(&stock->quote, price, prevClose, source, now);
+    metricsMarkFresh(stock->symbol);
+    
+    StockTrend* trend = (stock->trend && stock->trend->restored) ? stock->trend : NULL;
+    if (moved) {
+        histAppend(&stock->store, now, price);
+        if (trend) {
+            historyAppend(&trend->history, now, price);
+            trend->sparkCount = historyDownsample(&trend->history, trend->spark, SPARK_POINTS);
+            
+            // Quotes carry no volume, so tiles show everything but VWAP
+            indicatorsAdd(&trend->indicators, price, price, 0.0f);
+            formatIndicators(trend);
+        }
+    }
+    
+    // Only this symbol's rules, and only when its numbers moved
+    if (changed && stock->alerts.count > 0) {
+        alertsEvaluate(stock->alerts, stock->symbol, &stock->quote,
+                       trend ? indicatorsGet(&trend->indicators) : NULL);
+    }
+}
+
+// Trend line scaled to the min/max of the whole history window
+static void drawSparkline(const StockInfo* stock, float x, float y, float width, float height) {
+    const StockTrend* trend = stock->trend;
+    if (!trend || trend->sparkCount < 2) return;
+    
+    float low = historyMin(&trend->history);
+    float high = historyMax(&trend->history);
+    float range = (high - low) > 0.0001f ? (high - low) : 1.0f;
+    
+    s64 startUs = trend->spark[0].timeUs;
+    s64 spanUs = trend->spark[trend->sparkCount - 1].timeUs - startUs;
+    u32 color = quoteIsUp(&stock->quote) ? COLOR_GREEN : COLOR_RED;
+    
+    float prevX = 0, prevY = 0;
+    for (int i = 0; i < trend->sparkCount; i++) {
+        const PricePoint* p = &trend->spark[i];
+        float px = x + (spanUs > 0 ? (float)(p->timeUs - startUs) / spanUs
+                                   : (float)i / (trend->sparkCount - 1)) * width;
+        float py = y + height - (p->price - low) / range * height;
+        if (i > 0) drawLine(prevX, prevY, px, py, color);
+        prevX = px;
+        prevY = py;
+    }
+}
+
+static int compareSymbols(const void* a, const void* b) {
+    return strcmp(stocks[*(const int*)a].symbol, stocks[*(const int*)b].symbol);
+}
+
+static StockInfo* findStock(const char* symbol) {
+    int low = 0, high = stockCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(stocks[bySymbol[mid]].symbol, symbol);
+        if (cmp == 0) return &stocks[bySymbol[mid]];
+        if (cmp < 0) low = mid + 1;
+        else high = mid - 1;
+    }
+    return NULL;
+}
+
+// Apply a streamed tick to the matching tile
+static void onQuoteTick(const char* symbol, float price, float prevClose) {
+    StockInfo* stock = findStock(symbol);
+    if (stock) {
+        applyQuote(stock, price, prevClose, QUOTE_SOURCE_STREAM);
+    }
+}
+
+// Scheduler delivery for one symbol's chart endpoint
+static void onQuoteData(const char* body, bool ok, void* userData) {
+    StockInfo* stock = (StockInfo*)userData;
+    
+    float price, prevClose;
+    if (ok && parseStockQuote(body, &price, &prevClose)) {
+        applyQuote(stock, price, prevClose, QUOTE_SOURCE_POLL);
+        return;
+    }
+    
+    printf("Failed to fetch stock data for %s\n", stock->symbol);
+    if (!quoteHasData(&stock->quote)) {
+        // Placeholder until the first real quote arrives
+        double price = 150.25 + (rand() % 100) / 10.0;
+        double prevClose = price / (1.0 + (rand() % 200 - 100) / 1000.0);
+        quoteUpdate(&stock->quote, price, prevClose, QUOTE_SOURCE_PLACEHOLDER, sntpTimeUs());
+    }
+}
+
+// The chart response carries the latest price too
+static void onChartQuote(const char* symbol, float price, float prevClose) {
+    StockInfo* stock = findStock(symbol);
+    if (stock) {
+        applyQuote(stock, price, prevClose, QUOTE_SOURCE_POLL);
+    }
+}
+
+// Symbols the stream carries need no polling while it delivers
+static void syncPollingWithStream() {
+    bool streaming = isQuoteStreamActive();
+    if (streaming == wasStreaming) return;
+    
+    wasStreaming = streaming;
+    for (int i = 0; i < stockCount; i++) {
+        if (stocks[i].streamed) netSetPaused(stocks[i].subscription, streaming);
+    }
+}
+
+static void setVisible(StockInfo* stock, bool visible) {
+    if (stock->visible == visible) return;
+    stock->visible = visible;
+    if (visible) acquireTrend(stock);
+    
+    // Keeping the phase means a long-idle symbol is due as soon as it scrolls in
+    netSetPriority(stock->subscription, visible ? NET_PRIORITY_NORMAL : NET_PRIORITY_LOW);
+    netSetInterval(stock->subscription, visible ? pollInterval : pollInterval * OFFSCREEN_INTERVAL_FACTOR);
+}
+
+// Tile under the pointer, or -1
+static int tileAt(float px, float py) {
+    for (int slot = 0; slot < VISIBLE_ROWS * GRID_COLUMNS; slot++) {
+        float x = 40 + (slot % GRID_COLUMNS) * 310;
+        float y = GRID_TOP + (slot / GRID_COLUMNS) * ROW_HEIGHT;
+        int index = topRow * GRID_COLUMNS + slot;
+        if (index < stockCount && isPointInRect(px, py, x, y, 290, 100)) return index;
+    }
+    return -1;
+}
+
+static int rowCount() {
+    return (stockCount + GRID_COLUMNS - 1) / GRID_COLUMNS;
+}
+
+// Move the window, touching only the rows that leave or enter it
+static void scrollTo(int row) {
+    int maxTop = rowCount() - VISIBLE_ROWS;
+    if (row > maxTop) row = maxTop;
+    if (row < 0) row = 0;
+    
+    int oldFirst = topRow * GRID_COLUMNS;
+    int newFirst = row * GRID_COLUMNS;
+    int span = VISIBLE_ROWS * GRID_COLUMNS;
+    
+    for (int i = oldFirst; i < oldFirst + span && i < stockCount; i++) {
+        if (i < newFirst || i >= newFirst + span) setVisible(&stocks[i], false);
+    }
+    for (int i = newFirst; i < newFirst + span && i < stockCount; i++) {
+        setVisible(&stocks[i], true);
+    }
+    topRow = row;
+}
+
+static void addStock(const char* symbol, const char* name) {
+    if (stockCount >= MAX_STOCKS) return;
+    
+    StockInfo* stock = &stocks[stockCount++];
+    memset(stock, 0, sizeof(*stock));
+    snprintf(stock->symbol, sizeof(stock->symbol), "%s", symbol);
+    snprintf(stock->name, sizeof(stock->name), "%s", name);
+    quoteInit(&stock->quote);
+    stock->subscription = -1;
+    stock->alerts = alertsForSymbol(stock->symbol);
+    histWriterInit(&stock->store, stock->symbol);
+}
+
+// One symbol per line, optionally followed by ",Company name"; # starts a comment
+static void loadWatchlist() {
+    stocks = (StockInfo*)malloc(MAX_STOCKS * sizeof(StockInfo));
+    stockCount = 0;
+    if (!stocks) return;
+    
+    FILE* file = fopen(WATCHLIST_PATH, "r");
+    if (file) {
+        char line[128];
+        while (fgets(line, sizeof(line), file)) {
+            line[strcspn(line, "#\r\n")] = '\0';
+    
+            char* name = strchr(line, ',');
+            if (name) *name++ = '\0';
+    
+            char* symbol = line;
+            while (*symbol == ' ' || *symbol == '\t') symbol++;
+            int len = strcspn(symbol, " \t");
+            symbol[len] = '\0';
+            if (len == 0) continue;
+    
+            while (name && (*name == ' ' || *name == '\t')) name++;
+            addStock(symbol, name ? name : "");
+        }
+        fclose(file);
+        printf("Watchlist: %d symbols from %s\n", stockCount, WATCHLIST_PATH);
+    }
+    
+    if (stockCount == 0) {
+        int defaults = sizeof(defaultWatchlist) / sizeof(defaultWatchlist[0]);
+        for (int i = 0; i < defaults; i++) {
+            addStock(defaultWatchlist[i][0], defaultWatchlist[i][1]);
+        }
+    }
+    
+    // Give back the unused tail; subscriptions keep pointers, so this is final
+    StockInfo* shrunk = (StockInfo*)realloc(stocks, stockCount * sizeof(StockInfo));
+    if (shrunk) stocks = shrunk;
+    
+    bySymbol = (int*)malloc(stockCount * sizeof(int));
+    if (bySymbol) {
+        for (int i = 0; i < stockCount; i++) bySymbol[i] = i;
+        qsort(bySymbol, stockCount, sizeof(int), compareSymbols);
+    }
+}
 
 void initStocks() {
-    // Initial fetch
-    for (int i = 0; i < MAX_STOCKS; i++) {
-        fetchStockData(stocks[i].symbol, stocks[i].price, stocks[i].change);
-        stocks[i].isPositive = (stocks[i].change[0] == '+');
+    initHistStore();
+    loadWatchlist();
+    if (!bySymbol) {
+        stockCount = 0;
+        return;
+    }
+    
+    // Subscribe each symbol; the scheduler owns the refresh timing.
+    // Everything starts off-screen and the first page is promoted below.
+    pollInterval = getConfig()->stockUpdateInterval;
+    if (pollInterval <= 0) pollInterval = 300;
+    
+    for (int i = 0; i < stockCount; i++) {
+        char url[512];
+        stockQuoteUrl(stocks[i].symbol, url, sizeof(url));
+        stocks[i].subscription = netSubscribe(url, SCENE_STOCKS, NET_PRIORITY_LOW,
+                                              pollInterval * OFFSCREEN_INTERVAL_FACTOR,
+                                              onQuoteData, &stocks[i]);
+    }
+    
+    // Trends for the first page and for every symbol with alert rules
+    trendCount = stockCount < TREND_POOL_SIZE ? stockCount : TREND_POOL_SIZE;
+    trends = (StockTrend*)malloc(trendCount * sizeof(StockTrend));
+    if (!trends) trendCount = 0;
+    for (int i = 0; i < trendCount; i++) {
+        trends[i].owner = -1;
+        trends[i].lastUsed = 0;
+    }
+    trendClock = 0;
+    for (int i = 0; i < stockCount; i++) {
+        if (stocks[i].alerts.count > 0) acquireTrend(&stocks[i]);
+    }
+    topRow = 0;
+    scrollTo(0);
+    
+    // Prefer push updates when a feed is configured; polling stays as the fallback.
+    // The stream carries as many symbols as it supports, in watchlist order.
+    wasStreaming = false;
+    if (initQuoteStream(getConfig()->quoteStreamUrl, onQuoteTick)) {
+        for (int i = 0; i < stockCount; i++) {
+            stocks[i].streamed = quoteStreamSubscribe(stocks[i].symbol);
+        }
     }
 }
 
 void cleanupStocks() {
-    // Nothing to cleanup
+    for (int i = 0; i < stockCount; i++) {
+        netUnsubscribe(stocks[i].subscription);
+        histFlush(&stocks[i].store);
+    }
+    cleanupQuoteStream();
+    closeStockChart();
+    
+    free(trends);
+    free(stocks);
+    free(bySymbol);
+    trends = NULL;
+    trendCount = 0;
+    stocks = NULL;
+    bySymbol = NULL;
+    stockCount = 0;
+}
+
+// Every frame, whatever the scene: quotes arrive in the background too
+void serviceStocks() {
+    syncPollingWithStream();
+    restorePendingTrends();
 }
 
 void updateStocks() {
     InputState* input = getInput();
     
+    if (isStockChartOpen()) {
+        updateStockChart();
+        return;
+    }
+    
     // B button to go back
     if (input->bButton) {
         changeScene(SCENE_DASHBOARD);
         return;
     }
     
-    // Update stocks every 5 minutes (18000 frames at 60fps)
-    updateCounter++;
-    if (updateCounter >= 18000) {
-        updateCounter = 0;
-        
-        if (!isLoading) {
-            isLoading = true;
-            
-            // Fetch new data
-            for (int i = 0; i < MAX_STOCKS; i++) {
-                fetchStockData(stocks[i].symbol, stocks[i].price, stocks[i].change);
-                stocks[i].isPositive = (stocks[i].change[0] == '+');
-            }
-            
-            isLoading = false;
-        }
+    // D-pad scrolls a row at a time with key repeat, +/- by a page
+    u64 now = ticks_to_millisecs(gettime());
+    if (input->dpadY == 0) {
+        nextScrollMs = 0;
+    } else if (now >= nextScrollMs) {
+        scrollTo(topRow + input->dpadY);
+        nextScrollMs = now + SCROLL_REPEAT_MS;
     }
+    if (input->plusButton) scrollTo(topRow + VISIBLE_ROWS);
+    if (input->minusButton) scrollTo(topRow - VISIBLE_ROWS);
     
-    // Manual refresh with A button
+    // A on a tile opens its chart
+    int tile = input->pressed ? tileAt(input->x, input->y) : -1;
+    if (tile >= 0) {
+        // The daily view reads the file, so it must hold every quote so far
+        histFlush(&stocks[tile].store);
+        openStockChart(stocks[tile].symbol, stocks[tile].name, onChartQuote);
+        return;
+    }
+    
+    // Manual refresh with A button elsewhere: what's on screen first
     if (input->pressed) {
-        updateCounter = 0;
-        for (int i = 0; i < MAX_STOCKS; i++) {
-            fetchStockData(stocks[i].symbol, stocks[i].price, stocks[i].change);
-            stocks[i].isPositive = (stocks[i].change[0] == '+');
+        int first = topRow * GRID_COLUMNS;
+        for (int i = first; i < first + VISIBLE_ROWS * GRID_COLUMNS && i < stockCount; i++) {
+            netRefresh(stocks[i].subscription);
         }
     }
 }
 
+static void renderTile(StockInfo* stock, float x, float y) {
+    // Glass container
+    drawGlassRectangle(x, y, 290, 100, COLOR_GLASS_MEDIUM);
+    
+    // Stock symbol
+    drawText(x + 10, y + 10, stock->symbol, COLOR_CYAN, 1.5f);
+    
+    // Company name
+    drawText(x + 10, y + 35, stock->name, COLOR_WHITE, 0.8f);
+    
+    // Price
+    drawText(x + 10, y + 60, quotePriceText(&stock->quote), COLOR_WHITE, 1.3f);
+    
+    // Change (colored based on positive/negative)
+    bool up = quoteIsUp(&stock->quote);
+    u32 changeColor = up ? COLOR_GREEN : COLOR_RED;
+    drawText(x + 180, y + 60, quoteChangeText(&stock->quote), changeColor, 1.2f);
+    
+    // Recent history
+    drawSparkline(stock, x + 170, y + 12, 110, 36);
+    
+    // Indicators, once enough quotes have arrived
+    if (stock->trend && stock->trend->indicatorText[0]) {
+        drawText(x + 10, y + 84, stock->trend->indicatorText, COLOR_GRAY, 0.6f);
+    }
+    
+    // Trend indicator
+    if (up) {
+        drawText(x + 250, y + 55, "↑", COLOR_GREEN, 1.5f);
+    } else {
+        drawText(x + 250, y + 55, "↓", COLOR_RED, 1.5f);
+    }
+}
+
 void renderStocks() {
+    if (isStockChartOpen()) {
+        renderStockChart();
+        return;
+    }
+    
     // Draw title
     drawText(230, 30, "Stock Market", COLOR_WHITE, 2.0f);
     
     // Network status indicator
-    if (isNetworkConnected()) {
+    if (isQuoteStreamActive()) {
+        drawCircle(580, 40, 8, COLOR_CYAN);
+        drawText(520, 32, "STREAM", COLOR_CYAN, 0.8f);
+    } else if (isNetworkConnected()) {
         drawCircle(580, 40, 8, COLOR_GREEN);
         drawText(540, 32, "LIVE", COLOR_GREEN, 0.8f);
     } else {
@@ -87,53 +550,46 @@ void renderStocks() {
         drawText(530, 32, "OFFLINE", COLOR_RED, 0.8f);
     }
     
-    // Draw stocks in a grid
-    int row = 0, col = 0;
-    for (int i = 0; i < MAX_STOCKS; i++) {
-        float x = 40 + (col * 310);
-        float y = 80 + (row * 110);
-        
-        // Glass container
-        drawGlassRectangle(x, y, 290, 100, COLOR_GLASS_MEDIUM);
-        
-        // Stock symbol
-        drawText(x + 10, y + 10, stocks[i].symbol, COLOR_CYAN, 1.5f);
-        
-        // Company name
-        drawText(x + 10, y + 35, stocks[i].name, COLOR_WHITE, 0.8f);
-        
-        // Price
-        drawText(x + 10, y + 60, stocks[i].price, COLOR_WHITE, 1.3f);
-        
-        // Change (colored based on positive/negative)
-        u32 changeColor = stocks[i].isPositive ? COLOR_GREEN : COLOR_RED;
-        drawText(x + 180, y + 60, stocks[i].change, changeColor, 1.2f);
-        
-        // Trend indicator
-        if (stocks[i].isPositive) {
-            drawText(x + 250, y + 55, "↑", COLOR_GREEN, 1.5f);
-        } else {
-            drawText(x + 250, y + 55, "↓", COLOR_RED, 1.5f);
-        }
-        
-        col++;
-        if (col >= 2) {
-            col = 0;
-            row++;
-        }
+    // Draw the visible page of the grid
+    int first = topRow * GRID_COLUMNS;
+    for (int slot = 0; slot < VISIBLE_ROWS * GRID_COLUMNS && first + slot < stockCount; slot++) {
+        float x = 40 + (slot % GRID_COLUMNS) * 310;
+        float y = GRID_TOP + (slot / GRID_COLUMNS) * ROW_HEIGHT;
+        renderTile(&stocks[first + slot], x, y);
+    }
+    
+    // Scrollbar when the list is longer than a page
+    int rows = rowCount();
+    if (rows > VISIBLE_ROWS) {
+        float trackHeight = VISIBLE_ROWS * ROW_HEIGHT - 10;
+        float thumbHeight = trackHeight * VISIBLE_ROWS / rows;
+        if (thumbHeight < 12) thumbHeight = 12;
+        float thumbY = GRID_TOP + (trackHeight - thumbHeight) * topRow / (rows - VISIBLE_ROWS);
+        drawRectangle(628, GRID_TOP, 4, trackHeight, COLOR_GLASS_LIGHT);
+        drawRectangle(626, thumbY, 8, thumbHeight, COLOR_CYAN);
+    
+        char position[32];
+        sprintf(position, "%d-%d of %d", first + 1,
+                (first + VISIBLE_ROWS * GRID_COLUMNS < stockCount) ? first + VISIBLE_ROWS * GRID_COLUMNS : stockCount,
+                stockCount);
+        drawText(40, 400, position, COLOR_GRAY, 0.8f);
     }
     
     // Loading indicator
-    if (isLoading) {
+    if (netSceneBusy(SCENE_STOCKS)) {
         drawText(270, 400, "Updating...", COLOR_CYAN, 1.0f);
     }
     
     // Instructions
-    drawText(150, 440, "A: Refresh | B: Back to Dashboard", COLOR_WHITE, 1.0f);
+    drawText(110, 440, "A: Chart/Refresh | Up/Down/+/-: Scroll | B: Back", COLOR_WHITE, 1.0f);
     
     // Update timer
-    int secondsUntilUpdate = (18000 - updateCounter) / 60;
-    char timerStr[32];
-    sprintf(timerStr, "Next update in: %dm %ds", secondsUntilUpdate / 60, secondsUntilUpdate % 60);
-    drawText(380, 400, timerStr, COLOR_GRAY, 0.8f);
+    if (stockCount > 0 && stocks[first].streamed && isQuoteStreamActive()) {
+        drawText(380, 400, "Live ticks streaming", COLOR_GRAY, 0.8f);
+    } else if (stockCount > 0) {
+        int secondsUntilUpdate = netSecondsUntilRefresh(stocks[first].subscription);
+        char timerStr[32];
+        sprintf(timerStr, "Next update in: %dm %ds", secondsUntilUpdate / 60, secondsUntilUpdate % 60);
+        drawText(380, 400, timerStr, COLOR_GRAY, 0.8f);
+    }
 }
@@ -0,0 +1,217 @@
+#include "tls.h"
+#include "config.h"
+#include <network.h>
+#include <errno.h>
+#include <stdint.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/x509v3.h>
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_TLS_SESSIONS 8
+
+static const char* CA_BUNDLE_PATH = "sd:/apps/wii-dashboard/cacert.pem";
+
+typedef struct {
+    char host[128];
+    SSL_SESSION* session;
+} TlsSessionEntry;
+
+static SSL_CTX* context = NULL;
+static BIO_METHOD* socketMethod = NULL;
+static bool verifyPeers = false;
+static TlsSessionEntry sessions[MAX_TLS_SESSIONS];
+static int nextEvict = 0;
+
+// ---------------------------------------------------------------------------
+// BIO over libogc sockets (their descriptors are not POSIX fds)
+// ---------------------------------------------------------------------------
+
+static int bioWrite(BIO* bio, const char* data, int length) {
+    int sock = (int)(intptr_t)BIO_get_data(bio);
+    BIO_clear_retry_flags(bio);
+
+    s32 sent = net_send(sock, data, length, 0);
+    if (sent == -EAGAIN) {
+        BIO_set_retry_write(bio);
+        return -1;
+    }
+    return sent;
+}
+
+static int bioRead(BIO* bio, char* data, int length) {
+    int sock = (int)(intptr_t)BIO_get_data(bio);
+    BIO_clear_retry_flags(bio);
+
+    s32 received = net_recv(sock, data, length, 0);
+    if (received == -EAGAIN) {
+        BIO_set_retry_read(bio);
+        return -1;
+    }
+    return received;
+}
+
+static long bioCtrl(BIO* bio, int cmd, long num, void* ptr) {
+    return (cmd == BIO_CTRL_FLUSH) ? 1 : 0;
+}
+
+static int bioCreate(BIO* bio) {
+    BIO_set_init(bio, 1);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Session cache, keyed by SNI host name
+// ---------------------------------------------------------------------------
+
+static TlsSessionEntry* findSession(const char* host) {
+    for (int i = 0; i < MAX_TLS_SESSIONS; i++) {
+        if (sessions[i].session && strcmp(sessions[i].host, host) == 0) return &sessions[i];
+    }
+    return NULL;
+}
+
+// Called by OpenSSL whenever the server issues a session ID or ticket,
+// including TLS 1.3 tickets that arrive after the handshake
+static int onNewSession(SSL* ssl, SSL_SESSION* session) {
+    const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (!host) return 0;
+
+    TlsSessionEntry* entry = findSession(host);
+    if (!entry) {
+        for (int i = 0; i < MAX_TLS_SESSIONS && !entry; i++) {
+            if (!sessions[i].session) entry = &sessions[i];
+        }
+    }
+    if (!entry) {
+        entry = &sessions[nextEvict];
+        nextEvict = (nextEvict + 1) % MAX_TLS_SESSIONS;
+    }
+
+    if (entry->session) SSL_SESSION_free(entry->session);
+    snprintf(entry->host, sizeof(entry->host), "%s", host);
+    entry->session = session;
+    return 1; // we keep the reference
+}
+
+// The console has no entropy device; mix timebase jitter into the pool
+static void seedRandom() {
+    if (RAND_status() == 1) return;
+
+    for (int i = 0; i < 256 && RAND_status() != 1; i++) {
+        u64 sample[4];
+        for (int j = 0; j < 4; j++) {
+            sample[j] = gettime();
+            for (volatile int spin = 0; spin < (int)(sample[j] & 0xFF); spin++) {
+            }
+        }
+        RAND_add(sample, sizeof(sample), 1.0);
+    }
+}
+
+bool initTls() {
+    if (context) return true;
+
+    seedRandom();
+
+    context = SSL_CTX_new(TLS_client_method());
+    if (!context) {
+        printf("TLS: failed to create context\n");
+        return false;
+    }
+    SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+
+    // Client-side caching only; the cache itself lives in sessions[]
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, onNewSession);
+
+    // Verification needs a CA bundle on SD. Without one every handshake
+    // fails, unless the config explicitly accepts unauthenticated servers.
+    bool haveBundle = SSL_CTX_load_verify_locations(context, CA_BUNDLE_PATH, NULL) == 1;
+    verifyPeers = haveBundle || !getConfig()->tlsAllowUnverified;
+    SSL_CTX_set_verify(context, verifyPeers ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, NULL);
+    if (!haveBundle) {
+        ERR_clear_error();
+        if (verifyPeers) {
+            printf("TLS: no CA bundle at %s, HTTPS requests will fail\n", CA_BUNDLE_PATH);
+        } else {
+            printf("TLS: no CA bundle, servers will NOT be authenticated (tlsAllowUnverified)\n");
+        }
+    }
+
+    socketMethod = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "ogc socket");
+    BIO_meth_set_write(socketMethod, bioWrite);
+    BIO_meth_set_read(socketMethod, bioRead);
+    BIO_meth_set_ctrl(socketMethod, bioCtrl);
+    BIO_meth_set_create(socketMethod, bioCreate);
+
+    memset(sessions, 0, sizeof(sessions));
+    return true;
+}
+
+void cleanupTls() {
+    for (int i = 0; i < MAX_TLS_SESSIONS; i++) {
+        if (sessions[i].session) SSL_SESSION_free(sessions[i].session);
+        sessions[i].session = NULL;
+    }
+    if (socketMethod) BIO_meth_free(socketMethod);
+    if (context) SSL_CTX_free(context);
+    socketMethod = NULL;
+    context = NULL;
+}
+
+SSL* tlsConnect(int sock, const char* host, bool* resumed) {
+    *resumed = false;
+    if (!context && !initTls()) return NULL;
+
+    SSL* ssl = SSL_new(context);
+    if (!ssl) return NULL;
+
+    BIO* bio = BIO_new(socketMethod);
+    BIO_set_data(bio, (void*)(intptr_t)sock);
+    SSL_set_bio(ssl, bio, bio);
+
+    SSL_set_tlsext_host_name(ssl, host);
+    if (verifyPeers) {
+        SSL_set1_host(ssl, host);
+    }
+
+    TlsSessionEntry* cached = findSession(host);
+    if (cached && SSL_SESSION_is_resumable(cached->session)) {
+        SSL_set_session(ssl, cached->session);
+    }
+
+    if (SSL_connect(ssl) != 1) {
+        char error[128];
+        ERR_error_string_n(ERR_get_error(), error, sizeof(error));
+        printf("TLS handshake with %s failed: %s\n", host, error);
+
+        // A rejected session must not be offered again
+        if (cached) {
+            SSL_SESSION_free(cached->session);
+            cached->session = NULL;
+        }
+        SSL_free(ssl);
+        return NULL;
+    }
+
+    *resumed = SSL_session_reused(ssl) == 1;
+    return ssl;
+}
+
+int tlsRead(SSL* ssl, void* buffer, int length) {
+    int result = SSL_read(ssl, buffer, length);
+    if (result > 0) return result;
+    return SSL_get_error(ssl, result) == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+}
+
+int tlsWrite(SSL* ssl, const void* buffer, int length) {
+    int result = SSL_write(ssl, buffer, length);
+    return result > 0 ? result : -1;
+}
+
+void tlsClose(SSL* ssl) {
+    if (!ssl) return;
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+}
@@ -0,0 +1,68 @@
+#include "toast.h"
+#include "graphics.h"
+#include <ogc/lwp_watchdog.h>
+
+#define MAX_TOASTS 4
+#define TOAST_DURATION_MS 5000
+#define TOAST_FADE_MS 500
+
+#define TOAST_X 330
+#define TOAST_Y 70
+#define TOAST_WIDTH 290
+#define TOAST_HEIGHT 30
+
+typedef struct {
+    char text[64];
+    u32 color;
+    u64 shownMs;
+} Toast;
+
+static Toast toasts[MAX_TOASTS]; // oldest first
+static int toastCount = 0;
+
+static u32 fade(u32 color, float alpha) {
+    u32 a = (u32)((color & 0xFF) * alpha);
+    return (color & 0xFFFFFF00) | a;
+}
+
+void showToast(const char* text, u32 color) {
+    if (toastCount == MAX_TOASTS) {
+        memmove(&toasts[0], &toasts[1], (MAX_TOASTS - 1) * sizeof(Toast));
+        toastCount--;
+    }
+
+    Toast* toast = &toasts[toastCount++];
+    snprintf(toast->text, sizeof(toast->text), "%s", text);
+    toast->color = color;
+    toast->shownMs = ticks_to_millisecs(gettime());
+}
+
+void updateToasts() {
+    u64 now = ticks_to_millisecs(gettime());
+
+    int expired = 0;
+    while (expired < toastCount && now - toasts[expired].shownMs >= TOAST_DURATION_MS) {
+        expired++;
+    }
+    if (expired > 0) {
+        memmove(&toasts[0], &toasts[expired], (toastCount - expired) * sizeof(Toast));
+        toastCount -= expired;
+    }
+}
+
+void renderToasts() {
+    u64 now = ticks_to_millisecs(gettime());
+
+    // Newest on top
+    for (int i = 0; i < toastCount; i++) {
+        const Toast* toast = &toasts[toastCount - 1 - i];
+        if (now - toast->shownMs >= TOAST_DURATION_MS) continue;
+        u64 remaining = TOAST_DURATION_MS - (now - toast->shownMs);
+        float alpha = remaining < TOAST_FADE_MS ? (float)remaining / TOAST_FADE_MS : 1.0f;
+        float y = TOAST_Y + i * (TOAST_HEIGHT + 6);
+
+        drawGlassRectangle(TOAST_X, y, TOAST_WIDTH, TOAST_HEIGHT, fade(0x000000C0, alpha));
+        drawRectangle(TOAST_X, y, 4, TOAST_HEIGHT, fade(toast->color, alpha));
+        drawText(TOAST_X + 12, y + 8, toast->text, fade(COLOR_WHITE, alpha), 0.8f);
+    }
+}
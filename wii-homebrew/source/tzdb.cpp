@@ -0,0 +1,339 @@
+#include "tzdb.h"
+
+typedef struct {
+    const char* name;
+    const char* rule; // POSIX TZ string, e.g. "EST5EDT,M3.2.0,M11.1.0"
+} TzEntry;
+
+// Sorted by name so lookups can binary search
+static const TzEntry tzTable[] = {
+#include "tzdata.inc"
+};
+
+#define TZ_COUNT ((int)(sizeof(tzTable) / sizeof(tzTable[0])))
+#define TZ_NAME_SIZE 8
+
+typedef enum {
+    TRANS_MONTH_WEEK_DAY, // Mm.w.d
+    TRANS_JULIAN_NO_LEAP, // Jn, 1..365, Feb 29 never counted
+    TRANS_JULIAN_ZERO     // n, 0..365
+} TransitionType;
+
+typedef struct {
+    u8 type;
+    u8 month;
+    u8 week;
+    u8 weekday;
+    s16 day;
+    s32 time; // seconds after local midnight, may be negative or > 24h
+} TzTransition;
+
+typedef struct {
+    bool parsed;
+    bool hasDst;
+    s32 stdOffset; // seconds east of UTC
+    s32 dstOffset;
+    char stdName[TZ_NAME_SIZE];
+    char dstName[TZ_NAME_SIZE];
+    TzTransition start;
+    TzTransition end;
+
+    // Transitions for one year, so the common case is two compares
+    int cachedYear;
+    time_t yearBegin;
+    time_t yearEnd;
+    time_t dstStart;
+    time_t dstEnd;
+} TzZone;
+
+static TzZone zones[TZ_COUNT];
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+static void civilFromDays(long days, int* y, int* m, int* d) {
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = (unsigned)(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int)(yoe + era * 400) + (*m <= 2);
+}
+
+static bool isLeapYear(int y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static int daysInMonth(int y, int m) {
+    static const int lengths[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (m == 2 && isLeapYear(y)) ? 29 : lengths[m - 1];
+}
+
+static int weekdayFromDays(long days) {
+    int wd = (int)((days + 4) % 7); // 1970-01-01 was a Thursday
+    return wd < 0 ? wd + 7 : wd;
+}
+
+static long floorDiv(long a, long b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// ---------------------------------------------------------------------------
+// POSIX TZ string parsing
+// ---------------------------------------------------------------------------
+
+static bool parseName(const char** p, char* out) {
+    const char* s = *p;
+    int len = 0;
+
+    if (*s == '<') {
+        s++;
+        while (*s && *s != '>') {
+            if (len < TZ_NAME_SIZE - 1) out[len++] = *s;
+            s++;
+        }
+        if (*s != '>') return false;
+        s++;
+    } else {
+        while ((*s >= 'A' && *s <= 'Z') || (*s >= 'a' && *s <= 'z')) {
+            if (len < TZ_NAME_SIZE - 1) out[len++] = *s;
+            s++;
+        }
+        if (len < 3) return false;
+    }
+
+    out[len] = '\0';
+    *p = s;
+    return true;
+}
+
+static int parseNumber(const char** p) {
+    int value = 0;
+    while (**p >= '0' && **p <= '9') {
+        value = value * 10 + (**p - '0');
+        (*p)++;
+    }
+    return value;
+}
+
+// [+-]hh[:mm[:ss]] in seconds
+static bool parseTime(const char** p, s32* out) {
+    int sign = 1;
+    if (**p == '+' || **p == '-') {
+        if (**p == '-') sign = -1;
+        (*p)++;
+    }
+    if (**p < '0' || **p > '9') return false;
+
+    s32 seconds = parseNumber(p) * 3600;
+    if (**p == ':') {
+        (*p)++;
+        seconds += parseNumber(p) * 60;
+        if (**p == ':') {
+            (*p)++;
+            seconds += parseNumber(p);
+        }
+    }
+
+    *out = sign * seconds;
+    return true;
+}
+
+static bool parseTransition(const char** p, TzTransition* t) {
+    if (**p == 'M') {
+        (*p)++;
+        t->type = TRANS_MONTH_WEEK_DAY;
+        t->month = parseNumber(p);
+        if (**p != '.') return false;
+        (*p)++;
+        t->week = parseNumber(p);
+        if (**p != '.') return false;
+        (*p)++;
+        t->weekday = parseNumber(p);
+        if (t->month < 1 || t->month > 12 || t->week < 1 || t->week > 5 || t->weekday > 6) {
+            return false;
+        }
+    } else if (**p == 'J') {
+        (*p)++;
+        t->type = TRANS_JULIAN_NO_LEAP;
+        t->day = parseNumber(p);
+    } else if (**p >= '0' && **p <= '9') {
+        t->type = TRANS_JULIAN_ZERO;
+        t->day = parseNumber(p);
+    } else {
+        return false;
+    }
+
+    t->time = 2 * 3600;
+    if (**p == '/') {
+        (*p)++;
+        if (!parseTime(p, &t->time)) return false;
+    }
+    return true;
+}
+
+static bool parseRule(const char* rule, TzZone* z) {
+    const char* p = rule;
+    s32 posixOffset;
+
+    if (!parseName(&p, z->stdName) || !parseTime(&p, &posixOffset)) return false;
+    z->stdOffset = -posixOffset; // POSIX offsets count hours west of UTC
+    z->hasDst = false;
+
+    if (*p == '\0') return true;
+
+    if (!parseName(&p, z->dstName)) return false;
+    z->dstOffset = z->stdOffset + 3600;
+    if (*p != ',' && *p != '\0') {
+        if (!parseTime(&p, &posixOffset)) return false;
+        z->dstOffset = -posixOffset;
+    }
+
+    // No explicit rule: fall back to the US rules, as POSIX suggests
+    if (*p == '\0') {
+        p = ",M3.2.0,M11.1.0";
+    }
+
+    if (*p++ != ',' || !parseTransition(&p, &z->start)) return false;
+    if (*p++ != ',' || !parseTransition(&p, &z->end)) return false;
+
+    z->hasDst = true;
+    z->cachedYear = -1;
+    return true;
+}
+
+static TzZone* getZone(int zone) {
+    if (zone < 0 || zone >= TZ_COUNT) return NULL;
+
+    TzZone* z = &zones[zone];
+    if (!z->parsed) {
+        z->parsed = true;
+        if (!parseRule(tzTable[zone].rule, z)) {
+            printf("Bad TZ rule for %s: %s\n", tzTable[zone].name, tzTable[zone].rule);
+            strcpy(z->stdName, "UTC");
+            z->stdOffset = 0;
+            z->hasDst = false;
+        }
+    }
+    return z;
+}
+
+// ---------------------------------------------------------------------------
+// Transition computation
+// ---------------------------------------------------------------------------
+
+static long transitionDay(int year, const TzTransition* t) {
+    long jan1 = daysFromCivil(year, 1, 1);
+
+    switch (t->type) {
+        case TRANS_JULIAN_NO_LEAP: {
+            long day = t->day - 1;
+            if (isLeapYear(year) && t->day >= 60) day++;
+            return jan1 + day;
+        }
+        case TRANS_JULIAN_ZERO:
+            return jan1 + t->day;
+        default: {
+            long first = daysFromCivil(year, t->month, 1);
+            int day = (t->weekday - weekdayFromDays(first) + 7) % 7 + (t->week - 1) * 7;
+            int length = daysInMonth(year, t->month);
+            while (day >= length) day -= 7; // week 5 means "last"
+            return first + day;
+        }
+    }
+}
+
+static void cacheYear(TzZone* z, int year) {
+    z->cachedYear = year;
+    z->yearBegin = (time_t)daysFromCivil(year, 1, 1) * 86400 - z->stdOffset;
+    z->yearEnd = (time_t)daysFromCivil(year + 1, 1, 1) * 86400 - z->stdOffset;
+
+    // Start is written in standard time, end in daylight time
+    z->dstStart = (time_t)transitionDay(year, &z->start) * 86400 + z->start.time - z->stdOffset;
+    z->dstEnd = (time_t)transitionDay(year, &z->end) * 86400 + z->end.time - z->dstOffset;
+}
+
+static bool isDstAt(TzZone* z, time_t utc) {
+    if (utc < z->yearBegin || utc >= z->yearEnd || z->cachedYear < 0) {
+        int y, m, d;
+        civilFromDays(floorDiv((long)(utc + z->stdOffset), 86400), &y, &m, &d);
+        cacheYear(z, y);
+    }
+
+    if (z->dstStart < z->dstEnd) {
+        return utc >= z->dstStart && utc < z->dstEnd;
+    }
+    // Southern hemisphere: DST spans the new year
+    return utc >= z->dstStart || utc < z->dstEnd;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+int tzFind(const char* name) {
+    int lo = 0;
+    int hi = TZ_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(name, tzTable[mid].name);
+        if (cmp == 0) return mid;
+        if (cmp < 0) hi = mid - 1;
+        else lo = mid + 1;
+    }
+    return -1;
+}
+
+int tzCount() {
+    return TZ_COUNT;
+}
+
+const char* tzName(int zone) {
+    return (zone >= 0 && zone < TZ_COUNT) ? tzTable[zone].name : NULL;
+}
+
+int tzUtcOffset(int zone, time_t utc, bool* isDst) {
+    TzZone* z = getZone(zone);
+    bool dst = z && z->hasDst && isDstAt(z, utc);
+    if (isDst) *isDst = dst;
+    if (!z) return 0;
+    return dst ? z->dstOffset : z->stdOffset;
+}
+
+void tzLocalTime(int zone, time_t utc, struct tm* out) {
+    bool dst;
+    time_t local = utc + tzUtcOffset(zone, utc, &dst);
+
+    long days = floorDiv((long)local, 86400);
+    long secs = (long)(local - (time_t)days * 86400);
+
+    int y, m, d;
+    civilFromDays(days, &y, &m, &d);
+
+    memset(out, 0, sizeof(*out));
+    out->tm_year = y - 1900;
+    out->tm_mon = m - 1;
+    out->tm_mday = d;
+    out->tm_hour = secs / 3600;
+    out->tm_min = (secs / 60) % 60;
+    out->tm_sec = secs % 60;
+    out->tm_wday = weekdayFromDays(days);
+    out->tm_yday = (int)(days - daysFromCivil(y, 1, 1));
+    out->tm_isdst = dst ? 1 : 0;
+}
+
+const char* tzAbbrev(int zone, time_t utc) {
+    TzZone* z = getZone(zone);
+    if (!z) return "UTC";
+    return (z->hasDst && isDstAt(z, utc)) ? z->dstName : z->stdName;
+}
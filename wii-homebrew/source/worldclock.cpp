@@ -1,7 +1,8 @@
 #include "worldclock.h"
 #include "graphics.h"
 #include "input.h"
-#include "network.h"
+#include "tzdb.h"
+#include "sntp.h"
 #include <time.h>
 
 #define MAX_TIMEZONES 6
@@ -9,27 +10,31 @@
 typedef struct {
     const char* name;
     const char* city;
-    int offset; // Hours from UTC (fallback)
-    const char* apiTimezone; // WorldTimeAPI timezone string
+    const char* tzName; // IANA zone in the embedded tz database
+    int zone;           // Resolved index, -1 if missing (shown as UTC)
 } TimezoneInfo;
 
 static TimezoneInfo timezones[MAX_TIMEZONES] = {
-    {"New York", "USA", -5, "America/New_York"},
-    {"London", "UK", 0, "Europe/London"},
-    {"Tokyo", "Japan", 9, "Asia/Tokyo"},
-    {"Sydney", "Australia", 11, "Australia/Sydney"},
-    {"Dubai", "UAE", 4, "Asia/Dubai"},
-    {"Los Angeles", "USA", -8, "America/Los_Angeles"}
+    {"New York", "USA", "America/New_York", -1},
+    {"London", "UK", "Europe/London", -1},
+    {"Tokyo", "Japan", "Asia/Tokyo", -1},
+    {"Sydney", "Australia", "Australia/Sydney", -1},
+    {"Dubai", "UAE", "Asia/Dubai", -1},
+    {"Los Angeles", "USA", "America/Los_Angeles", -1}
 };
 
 static char timezoneStrings[MAX_TIMEZONES][64];
-static int updateCounter = 0;
-static bool needsFetch = true;
+static char offsetStrings[MAX_TIMEZONES][16];
 
 void initWorldClock() {
-    // Initialize timezone strings
+    // Resolve zones once; conversions afterwards are table lookups
     for (int i = 0; i < MAX_TIMEZONES; i++) {
+        timezones[i].zone = tzFind(timezones[i].tzName);
+        if (timezones[i].zone < 0) {
+            printf("Unknown timezone %s\n", timezones[i].tzName);
+        }
         timezoneStrings[i][0] = '\0';
+        offsetStrings[i][0] = '\0';
     }
 }
 
@@ -46,45 +51,22 @@ void updateWorldClock() {
         return;
     }
     
-    // Update every 60 frames (1 second at 60fps)
-    updateCounter++;
-    if (updateCounter >= 60 || needsFetch) {
-        updateCounter = 0;
-        needsFetch = false;
+    // Local times are computed from UTC every frame, no network needed
+    time_t currentTime = sntpTime();
+    
+    for (int i = 0; i < MAX_TIMEZONES; i++) {
+        struct tm localTime;
+        tzLocalTime(timezones[i].zone, currentTime, &localTime);
+        strftime(timezoneStrings[i], sizeof(timezoneStrings[i]), "%H:%M:%S", &localTime);
         
-        // Update all timezone times
-        for (int i = 0; i < MAX_TIMEZONES; i++) {
-            // Try to fetch real time from API once per minute for network efficiency
-            static int apiUpdateCounter = 0;
-            bool useAPI = (apiUpdateCounter % 60 == 0); // Fetch from API every 60 seconds
-            
-            if (isNetworkConnected() && useAPI) {
-                if (!fetchWorldTime(timezones[i].apiTimezone, timezoneStrings[i])) {
-                    // Fallback to UTC offset calculation if API fails
-                    time_t currentTime;
-                    time(&currentTime);
-                    
-                    struct tm* utcTime = gmtime(&currentTime);
-                    time_t offsetTime = currentTime + (timezones[i].offset * 3600);
-                    struct tm* localTime = gmtime(&offsetTime);
-                    
-                    strftime(timezoneStrings[i], sizeof(timezoneStrings[i]), "%H:%M:%S", localTime);
-                }
-            } else {
-                // Offline mode or between API calls - use UTC offset
-                time_t currentTime;
-                time(&currentTime);
-                
-                struct tm* utcTime = gmtime(&currentTime);
-                time_t offsetTime = currentTime + (timezones[i].offset * 3600);
-                struct tm* localTime = gmtime(&offsetTime);
-                
-                strftime(timezoneStrings[i], sizeof(timezoneStrings[i]), "%H:%M:%S", localTime);
-            }
-            
-            if (i == MAX_TIMEZONES - 1) {
-                apiUpdateCounter++;
-            }
+        // UTC offset label, e.g. "UTC+11" or "UTC+5:30"
+        int offset = tzUtcOffset(timezones[i].zone, currentTime, NULL);
+        int absOffset = offset < 0 ? -offset : offset;
+        if (absOffset % 3600 == 0) {
+            sprintf(offsetStrings[i], "UTC%c%d", offset < 0 ? '-' : '+', absOffset / 3600);
+        } else {
+            sprintf(offsetStrings[i], "UTC%c%d:%02d", offset < 0 ? '-' : '+',
+                    absOffset / 3600, (absOffset / 60) % 60);
         }
     }
 }
@@ -93,6 +75,8 @@ void renderWorldClock() {
     // Draw title
     drawText(220, 30, "World Clock", COLOR_WHITE, 2.0f);
     
+    time_t currentTime = sntpTime();
+    
     // Draw clocks in a grid
     int row = 0, col = 0;
     for (int i = 0; i < MAX_TIMEZONES; i++) {
@@ -109,10 +93,9 @@ void renderWorldClock() {
         // Time
         drawText(x + 30, y + 70, timezoneStrings[i], COLOR_WHITE, 1.5f);
         
-        // UTC offset
-        char offsetStr[16];
-        sprintf(offsetStr, "UTC%+d", timezones[i].offset);
-        drawText(x + 120, y + 30, offsetStr, COLOR_GRAY, 0.7f);
+        // UTC offset and zone abbreviation (DST aware)
+        drawText(x + 120, y + 30, offsetStrings[i], COLOR_GRAY, 0.7f);
+        drawText(x + 120, y + 45, tzAbbrev(timezones[i].zone, currentTime), COLOR_GRAY, 0.7f);
         
         col++;
         if (col >= 3) {
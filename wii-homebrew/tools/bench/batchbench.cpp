@@ -0,0 +1,93 @@
+// A 400-sample plot (the graph width) point by point with exprEvalBound
+// and in one exprEvalBatch pass, precise and fast. Precise batch results
+// must match exprEval exactly.
+
+#include "check.h"
+#include "expr.h"
+#include <math.h>
+
+#define SAMPLES 400
+#define RUNS 2000
+#define FRAME_US 16667.0
+
+static const char* corpus[] = {
+    "x^2",
+    "3x^2+2x+1",
+    "x^4-3x^3+2x-7",
+    "(x+1)^3-(x+1)^2+(x+1)",
+    "sqrt(x^2+1)/(x^2+1)",
+    "e^(-x^2/2)/sqrt(2π)",
+    "sin(x)^2+cos(x)^2",
+    "y*sin(x)+y^2*cos(x)+sqrt(y)",
+    "2^x*ln(2)",
+    "abs(x)*sin(45)+cos(45)*x",
+    "x^2y+3y^2x-xy",
+    "5",
+    "tan(x)/x!",
+    "ln(x)-log(x)",
+};
+
+static ExprProgram prog;
+static double xs[SAMPLES], out[SAMPLES];
+
+static double pointPlotUs(double* vars) {
+    volatile double sink = 0;
+    double start = secondsNow();
+    for (int r = 0; r < RUNS; r++) {
+        for (int i = 0; i < SAMPLES; i++) {
+            vars[EXPR_VAR_X] = xs[i];
+            out[i] = exprEvalBound(&prog, vars);
+        }
+        sink += out[7];
+    }
+    return (secondsNow() - start) * 1e6 / RUNS;
+}
+
+static double batchPlotUs(const double* vars) {
+    volatile double sink = 0;
+    double start = secondsNow();
+    for (int r = 0; r < RUNS; r++) {
+        exprEvalBatch(&prog, vars, EXPR_VAR_X, xs, out, SAMPLES);
+        sink += out[7];
+    }
+    return (secondsNow() - start) * 1e6 / RUNS;
+}
+
+int main() {
+    for (int i = 0; i < SAMPLES; i++) xs[i] = -10 + 20.0 * i / SAMPLES;
+
+    double totalPoint = 0, totalBatch = 0, totalFast = 0;
+    for (size_t c = 0; c < sizeof(corpus) / sizeof(corpus[0]); c++) {
+        const char* source = corpus[c];
+        CHECK(exprCompile(&prog, source, EXPR_DEGREES));
+        exprOptimize(&prog, EXPR_VAR_X);
+        double vars[EXPR_VAR_COUNT] = { 0, 1.7, 0, 0 };
+        exprBind(&prog, vars);
+
+        exprEvalBatch(&prog, vars, EXPR_VAR_X, xs, out, SAMPLES);
+        int mismatches = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            vars[EXPR_VAR_X] = xs[i];
+            double expected = exprEval(&prog, vars);
+            if (!(expected == out[i] || (isnan(expected) && isnan(out[i])))) mismatches++;
+        }
+        CHECK(mismatches == 0);
+
+        double pointUs = pointPlotUs(vars);
+        double batchUs = batchPlotUs(vars);
+        prog.precision = EXPR_FAST;
+        double fastUs = batchPlotUs(vars);
+
+        totalPoint += pointUs;
+        totalBatch += batchUs;
+        totalFast += fastUs;
+        printf("%-30s point %6.2f us  batch %6.2f us (%4.2fx)  fast %6.2f us\n",
+               source, pointUs, batchUs, pointUs / batchUs, fastUs);
+    }
+
+    int n = sizeof(corpus) / sizeof(corpus[0]);
+    printf("average %d-sample plot: point %.2f us, batch %.2f us (%.2fx), fast %.2f us = %.2f%% of a frame\n",
+           SAMPLES, totalPoint / n, totalBatch / n, totalPoint / totalBatch, totalFast / n,
+           totalFast / n / FRAME_US * 100);
+    return checkSummary("batchbench");
+}
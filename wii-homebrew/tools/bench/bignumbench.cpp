@@ -0,0 +1,66 @@
+// Exact mode on the inputs the calculator guide shows: 1000!, 2^4096 and
+// 200 digits of π, timed through exactEvaluate, and the arena taken on
+// first use and given back by cleanupExact.
+
+#include "check.h"
+#include "expr.h"
+#include "exact.h"
+#include <malloc.h>
+#include <string.h>
+
+#define RUNS 20
+
+// Rounded to 200 digits: …49303819|64… is …49303820, shown without the 0
+static const char* PI_200 =
+    "3.14159265358979323846264338327950288419716939937510582097494459230781"
+    "6406286208998628034825342117067982148086513282306647093844609550582231"
+    "725359408128481117450284102701938521105559644622948954930382";
+
+static ExprProgram prog;
+static ExactResult result;
+static char error[64];
+
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static bool evaluate(const char* source, int digits) {
+    return exprCompile(&prog, source, EXPR_DEGREES) &&
+           exactEvaluate(&prog, source, digits, &result, error, sizeof(error));
+}
+
+// Milliseconds per evaluation, compile included
+static double timeEvaluate(const char* source, int digits) {
+    double start = secondsNow();
+    for (int r = 0; r < RUNS; r++) evaluate(source, digits);
+    return (secondsNow() - start) * 1000 / RUNS;
+}
+
+int main() {
+    size_t heapBefore = heapInUse();
+    CHECK(evaluate("1000!", 50));
+    size_t arena = heapInUse() - heapBefore;
+    CHECK(arena >= 2 * 1024 * 1024);
+    CHECK(result.exact && result.integerDigits == 2568);
+    CHECK(strncmp(result.text, "402387260077093773543702433923003985719374864210714632543799910", 63) == 0);
+    printf("1000!    %.3f ms  (%d digits)\n", timeEvaluate("1000!", 50), result.integerDigits);
+
+    CHECK(evaluate("2^4096", 50));
+    CHECK(result.exact && result.integerDigits == 1234);
+    CHECK(strncmp(result.text, "10443888814131525066", 20) == 0);
+    CHECK(strcmp(result.text + 1234 - 8, "54190336") == 0);
+    printf("2^4096   %.3f ms  (%d digits)\n", timeEvaluate("2^4096", 50), result.integerDigits);
+
+    CHECK(evaluate("π", 200));
+    CHECK(!result.exact && strcmp(result.text, PI_200) == 0);
+    printf("π 200    %.3f ms  %.24s...\n", timeEvaluate("π", 200), result.text);
+
+    // The arena goes back with exact mode and returns on the next use
+    cleanupExact();
+    CHECK(heapInUse() - heapBefore < arena);
+    CHECK(evaluate("20!", 50) && strcmp(result.text, "2432902008176640000") == 0);
+    cleanupExact();
+    printf("arena %zu KB, taken on first use\n", arena / 1024);
+    return checkSummary("bignumbench");
+}
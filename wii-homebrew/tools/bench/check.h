@@ -0,0 +1,58 @@
+// Shared helpers for the host tests: CHECK counts failures instead of
+// aborting, and a test server (one of the Python stand-ins) can be run
+// in the background for the length of a test.
+#ifndef BENCH_CHECK_H
+#define BENCH_CHECK_H
+
+#include <stdio.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <time.h>
+
+static int checkCount = 0;
+static int checkFailures = 0;
+
+#define CHECK(cond) checkResult((cond), #cond, __FILE__, __LINE__)
+
+static inline bool checkResult(bool ok, const char* what, const char* file, int line) {
+    checkCount++;
+    if (!ok) {
+        checkFailures++;
+        printf("FAIL %s:%d: %s\n", file, line, what);
+    }
+    return ok;
+}
+
+// Prints the tally; the exit status for main
+static inline int checkSummary(const char* name) {
+    printf("%s: %d checks, %d failed\n", name, checkCount, checkFailures);
+    return checkFailures == 0 ? 0 : 1;
+}
+
+static inline double secondsNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// argv[0] is looked up on PATH; waits a moment for the server to listen
+static inline pid_t startServer(char* const argv[]) {
+    extern char** environ;
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ) != 0) {
+        printf("could not start %s\n", argv[0]);
+        return -1;
+    }
+    usleep(700000);
+    return pid;
+}
+
+static inline void stopServer(pid_t pid) {
+    if (pid <= 0) return;
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+#endif // BENCH_CHECK_H
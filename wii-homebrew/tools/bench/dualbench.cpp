@@ -0,0 +1,136 @@
+// What carrying a derivative costs: a 400-sample plot with exprEval against
+// exprEvalDual, and exprEvalBatch against exprEvalBatchDual. Derivatives
+// are checked against central differences, and the batch form against the
+// scalar one exactly.
+
+#include "check.h"
+#include "expr.h"
+#include <math.h>
+
+#define SAMPLES 400
+#define RUNS 2000
+
+static const char* corpus[] = {
+    "x^2",
+    "3x^2+2x+1",
+    "x^4-3x^3+2x-7",
+    "(x+1)^3-(x+1)^2+(x+1)",
+    "sqrt(x^2+1)/(x^2+1)",
+    "e^(-x^2/2)/sqrt(2π)",
+    "sin(x)^2+cos(x)^2",
+    "y*sin(x)+y^2*cos(x)+sqrt(y)",
+    "2^x*ln(2)",
+    "abs(x)*sin(45)+cos(45)*x",
+    "x^x",
+    "tan(x)",
+    "asin(x/11)+acos(x/12)+atan(x)",
+    "log(x^2+1)",
+    "exp(x/5)",
+    "(x/3)!",
+    "x^2.5",
+    "1/x",
+    "x^(-3)",
+};
+
+static ExprProgram prog;
+static double xs[SAMPLES], out[SAMPLES], derivs[SAMPLES];
+
+static bool same(double a, double b) {
+    return a == b || (isnan(a) && isnan(b));
+}
+
+// Largest relative difference from a central difference, and the number of
+// samples where the scalar and batch forms disagree
+static double checkDerivatives(double* vars, int* mismatches) {
+    exprEvalBatchDual(&prog, vars, EXPR_VAR_X, xs, out, derivs, SAMPLES);
+    double worst = 0;
+    *mismatches = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        double d;
+        vars[EXPR_VAR_X] = xs[i];
+        double f = exprEvalDual(&prog, vars, EXPR_VAR_X, &d);
+        if (!same(f, out[i]) || !same(d, derivs[i])) (*mismatches)++;
+
+        double h = 1e-6 * fmax(1.0, fabs(xs[i]));
+        vars[EXPR_VAR_X] = xs[i] + h;
+        double above = exprEval(&prog, vars);
+        vars[EXPR_VAR_X] = xs[i] - h;
+        double below = exprEval(&prog, vars);
+        double central = (above - below) / (2 * h);
+        if (isfinite(central) && isfinite(d)) {
+            double error = fabs(central - d) / fmax(1.0, fabs(d));
+            if (error > worst) worst = error;
+        }
+    }
+    return worst;
+}
+
+int main() {
+    // Off the integers, so 1/x and x! stay away from their poles
+    for (int i = 0; i < SAMPLES; i++) xs[i] = -10 + 20.0 * i / SAMPLES + 0.013;
+
+    double totals[4] = { 0 };
+    for (size_t c = 0; c < sizeof(corpus) / sizeof(corpus[0]); c++) {
+        const char* source = corpus[c];
+        CHECK(exprCompile(&prog, source, EXPR_RADIANS));
+        exprOptimize(&prog, EXPR_VAR_X);
+        double vars[EXPR_VAR_COUNT] = { 0, 1.7, 0, 0 };
+
+        int mismatches;
+        double worst = checkDerivatives(vars, &mismatches);
+        CHECK(mismatches == 0);
+        CHECK(worst < 1e-4); // the differences themselves, near tan's poles
+
+        volatile double sink = 0;
+        double times[4];
+        double start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            for (int i = 0; i < SAMPLES; i++) {
+                vars[EXPR_VAR_X] = xs[i];
+                sink += exprEval(&prog, vars);
+            }
+        }
+        times[0] = secondsNow() - start;
+
+        start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            for (int i = 0; i < SAMPLES; i++) {
+                double d;
+                vars[EXPR_VAR_X] = xs[i];
+                sink += exprEvalDual(&prog, vars, EXPR_VAR_X, &d) + d;
+            }
+        }
+        times[1] = secondsNow() - start;
+
+        start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            exprEvalBatch(&prog, vars, EXPR_VAR_X, xs, out, SAMPLES);
+            sink += out[5];
+        }
+        times[2] = secondsNow() - start;
+
+        start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            exprEvalBatchDual(&prog, vars, EXPR_VAR_X, xs, out, derivs, SAMPLES);
+            sink += derivs[5];
+        }
+        times[3] = secondsNow() - start;
+
+        for (int k = 0; k < 4; k++) {
+            times[k] *= 1e6 / RUNS;
+            totals[k] += times[k];
+        }
+        printf("%-30s error %.1e  scalar %6.2f -> %6.2f us (%4.2fx)  batch %6.2f -> %6.2f us (%4.2fx)\n",
+               source, worst, times[0], times[1], times[1] / times[0], times[2], times[3], times[3] / times[2]);
+    }
+    printf("corpus, per %d-sample plot: scalar %.1f -> %.1f us (%.2fx), batch %.1f -> %.1f us (%.2fx)\n",
+           SAMPLES, totals[0], totals[1], totals[1] / totals[0], totals[2], totals[3], totals[3] / totals[2]);
+
+    // d/dx x! = x! * digamma(x + 1), which is 6 * (1 + 1/2 + 1/3 - γ) at 3
+    double vars[EXPR_VAR_COUNT] = { 3, 0, 0, 0 };
+    double d;
+    CHECK(exprCompile(&prog, "x!", EXPR_RADIANS));
+    CHECK(exprEvalDual(&prog, vars, EXPR_VAR_X, &d) == 6.0);
+    CHECK(fabs(d - 6 * (1 + 1.0 / 2 + 1.0 / 3 - 0.5772156649015329)) < 1e-12);
+    return checkSummary("dualbench");
+}
@@ -0,0 +1,88 @@
+// The compiled expression engine against the string-splitting evaluator it
+// replaced: answers on inputs the old one got wrong, then evaluation and
+// compile time over a small corpus.
+
+#include "check.h"
+#include "expr.h"
+#include <math.h>
+#include <string.h>
+#include "legacyeval.inc"
+
+#define RUNS 200000
+
+typedef struct {
+    const char* source;
+    double expected;
+} Case;
+
+static const Case cases[] = {
+    { "2*3+4", 10 },
+    { "2+3*4", 14 },
+    { "8-4-2", 2 },
+    { "8/4/2", 1 },
+    { "-2^2", -4 },
+    { "2^3^2", 512 },
+    { "(1+2)*(3+4)", 21 },
+    { "2π", 2 * M_PI },
+    { "ln(e)", 1 },
+    { "cos(60)+sin(30)", 1 },
+    { "√16+1", 5 },
+    { "5!", 120 },
+    { "10−4÷2×3", 4 },
+    { "2^-1", 0.5 },
+    { "1e3/4", 250 },
+};
+
+static const char* corpus[] = {
+    "2*3+4",
+    "(10+5)*2-8",
+    "sqrt(25)+sin(30)",
+    "2^3*5",
+    "1+2+3+4+5+6+7+8",
+    "sin(45)*cos(45)/tan(30)",
+};
+
+static ExprProgram prog;
+
+static bool near(double a, double b) {
+    return fabs(a - b) <= 1e-9 * fmax(1.0, fabs(b));
+}
+
+int main() {
+    double vars[EXPR_VAR_COUNT] = { 0 };
+
+    int legacyWrong = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Case* c = &cases[i];
+        bool compiled = exprCompile(&prog, c->source, EXPR_DEGREES);
+        double value = compiled ? exprEval(&prog, vars) : NAN;
+        double legacy = legacyEvaluate(c->source);
+        CHECK(compiled && near(value, c->expected));
+        if (!near(legacy, c->expected)) legacyWrong++;
+        printf("%-18s = %-12.10g old %.10g%s\n", c->source, value, legacy,
+               near(legacy, c->expected) ? "" : "  (wrong)");
+    }
+    printf("old evaluator wrong on %d of %d\n\n", legacyWrong, (int)(sizeof(cases) / sizeof(cases[0])));
+
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        const char* source = corpus[i];
+        volatile double sink = 0;
+
+        double start = secondsNow();
+        for (int r = 0; r < RUNS; r++) sink += legacyEvaluate(source);
+        double legacyNs = (secondsNow() - start) * 1e9 / RUNS;
+
+        CHECK(exprCompile(&prog, source, EXPR_DEGREES));
+        start = secondsNow();
+        for (int r = 0; r < RUNS; r++) sink += exprEval(&prog, vars);
+        double evalNs = (secondsNow() - start) * 1e9 / RUNS;
+
+        start = secondsNow();
+        for (int r = 0; r < RUNS / 10; r++) exprCompile(&prog, source, EXPR_DEGREES);
+        double compileNs = (secondsNow() - start) * 1e9 / (RUNS / 10);
+
+        printf("%-26s old %7.1f ns  eval %6.1f ns (%5.1fx)  compile %6.1f ns\n",
+               source, legacyNs, evalNs, legacyNs / evalNs, compileNs);
+    }
+    return checkSummary("exprbench");
+}
@@ -0,0 +1,120 @@
+// History files with damage: a bad block mid-file is skipped and the blocks
+// after it kept, while damage running to the end of the file is cut off,
+// and histClose unmaps all of the file after a truncate.
+
+#include "check.h"
+#include "histstore.h"
+#include <sys/stat.h>
+
+#define SYMBOL "DMG"
+#define PATH "sd:/apps/wii-dashboard/history/DMG.phx"
+#define BLOCKS 5
+#define POINTS 100
+
+static s64 nextUs = 1700000000000000LL;
+
+static void appendBlock() {
+    HistWriter writer;
+    histWriterInit(&writer, SYMBOL);
+    for (int i = 0; i < POINTS; i++) {
+        histAppend(&writer, nextUs, 100.0f + (i % 2) * 0.01f);
+        nextUs += 1000000;
+    }
+    CHECK(histFlush(&writer));
+}
+
+static long fileSize() {
+    struct stat info;
+    return stat(PATH, &info) == 0 ? info.st_size : -1;
+}
+
+static void poke(long offset, const void* data, size_t length) {
+    FILE* file = fopen(PATH, "r+b");
+    fseek(file, offset, SEEK_SET);
+    fwrite(data, 1, length, file);
+    fclose(file);
+}
+
+// Whether any of the file is still mapped into the process
+static bool mapped() {
+    FILE* maps = fopen("/proc/self/maps", "r");
+    char line[512];
+    bool found = false;
+    while (maps && fgets(line, sizeof(line), maps)) {
+        if (strstr(line, SYMBOL ".phx")) found = true;
+    }
+    if (maps) fclose(maps);
+    return found;
+}
+
+// Block count, with every indexed block decoding cleanly
+static int openAndRead(HistFile* file) {
+    static PricePoint points[HIST_BLOCK_POINTS];
+    if (!histOpen(file, SYMBOL)) return -1;
+    for (int b = 0; b < file->blockCount; b++) {
+        CHECK(histReadBlock(file, b, points) == POINTS);
+    }
+    return file->blockCount;
+}
+
+int main() {
+    mkdir("sd:", 0755);
+    mkdir("sd:/apps", 0755);
+    mkdir("sd:/apps/wii-dashboard", 0755);
+    initHistStore();
+    remove(PATH);
+
+    for (int i = 0; i < BLOCKS; i++) appendBlock();
+    HistFile file;
+    CHECK(openAndRead(&file) == BLOCKS);
+    u32 offsets[BLOCKS];
+    for (int b = 0; b < BLOCKS; b++) offsets[b] = file.blocks[b].offset;
+    histClose(&file);
+    long size = fileSize();
+
+    // A broken header mid-file: skipped, nothing truncated
+    poke(offsets[1], "XXXX", 4);
+    CHECK(openAndRead(&file) == BLOCKS - 1);
+    CHECK(file.blockCount == BLOCKS - 1 && file.blocks[1].offset == offsets[2]);
+    histClose(&file);
+    CHECK(fileSize() == size);
+
+    // A second one, with a nonsense point count
+    u8 zero[2] = { 0, 0 };
+    poke(offsets[3] + 4, zero, 2);
+    CHECK(openAndRead(&file) == BLOCKS - 2);
+    histClose(&file);
+    CHECK(fileSize() == size);
+
+    // Appends still continue after the damage
+    appendBlock();
+    CHECK(openAndRead(&file) == BLOCKS - 1);
+    histClose(&file);
+    long grown = fileSize();
+    CHECK(grown > size);
+
+    // An interrupted write: a partial block at the end is cut off
+    FILE* tail = fopen(PATH, "ab");
+    fwrite("PHB1\x00\x10", 1, 6, tail);
+    fclose(tail);
+    CHECK(openAndRead(&file) == BLOCKS - 1);
+    histClose(&file);
+    CHECK(fileSize() == grown);
+
+    // A last block failing its CRC goes too, and only it
+    u8 flip = 0xFF;
+    poke(grown - 1, &flip, 1);
+    CHECK(openAndRead(&file) == BLOCKS - 2);
+    histClose(&file);
+    CHECK(fileSize() == size);
+    CHECK(!mapped());
+
+    // A bad file header empties the file, several pages of it
+    while (fileSize() < 4 * 4096) appendBlock();
+    poke(0, "XXXX", 4);
+    CHECK(openAndRead(&file) == 0);
+    histClose(&file);
+    CHECK(fileSize() == 0 && !mapped());
+
+    return checkSummary("histtest");
+}
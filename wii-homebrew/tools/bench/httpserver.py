@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Local HTTP/1.1 server for tlstest, plain or TLS, with keep-alive.
+
+  /host        body is the Host header the client sent
+  /chunked     a 3 KB JSON body in several chunks
+  /badchunk    a chunk whose size line is not hex
+  /close       answers, then closes the connection
+  /short       closes after half the Content-Length it announced
+  /negative    Content-Length: -5
+  /fail        HTTP 500
+  anything     {"ok":true}
+
+Usage: python3 httpserver.py PORT [CERT KEY]
+"""
+import ssl
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def reply(self, status, body, close=False):
+        self.send_response(status)
+        self.send_header("Content-Length", str(len(body)))
+        if close:
+            self.send_header("Connection", "close")
+        self.end_headers()
+        self.wfile.write(body)
+        if close:
+            self.close_connection = True
+
+    def do_GET(self):
+        if self.path == "/host":
+            self.reply(200, self.headers.get("Host", "").encode())
+        elif self.path in ("/chunked", "/badchunk"):
+            self.send_response(200)
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            parts = [b'{"a":', b'1,"b":"', b"x" * 3000, b'"}']
+            for part in parts:
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(part), part))
+                if self.path == "/badchunk":
+                    self.wfile.write(b"zz\r\nnot a chunk\r\n")
+            self.wfile.write(b"0\r\n\r\n")
+        elif self.path == "/close":
+            self.reply(200, b"closing", close=True)
+        elif self.path in ("/short", "/negative"):
+            self.send_response(200)
+            self.send_header("Content-Length", "20" if self.path == "/short" else "-5")
+            self.end_headers()
+            self.wfile.write(b"0123456789")
+            self.close_connection = True
+        elif self.path == "/fail":
+            self.reply(500, b"error")
+        else:
+            self.reply(200, b'{"ok":true}')
+
+    def log_message(self, *args):
+        pass
+
+
+def main():
+    server = ThreadingHTTPServer(("127.0.0.1", int(sys.argv[1])), Handler)
+    server.daemon_threads = True
+    if len(sys.argv) > 3:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(sys.argv[2], sys.argv[3])
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+// Streaming indicators against a naive reference recomputed from the whole
+// series, and a trend restored from the SD history against the live one:
+// both feed price moves only, so they must agree.
+
+#include "check.h"
+#include "indicators.h"
+#include "histstore.h"
+#include <math.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define SAMPLES 3000
+#define BASE_US 1700000000000000LL
+
+static float prices[SAMPLES];
+
+static bool near(double a, double b) {
+    return fabs(a - b) <= 1e-3 * (1.0 + fabs(b));
+}
+
+// Random walk in cents, with long runs of the same price like repeated polls
+static void makeSeries() {
+    srand(7);
+    int cents = 15025;
+    for (int i = 0; i < SAMPLES; i++) {
+        if (rand() % 3 == 0) cents += rand() % 41 - 20;
+        if (cents < 100) cents = 100;
+        prices[i] = cents / 100.0f;
+    }
+}
+
+static void checkAgainstReference(const float* series, int count, const IndicatorValues* values) {
+    CHECK(values->smaValid == (count >= IND_SMA_PERIOD));
+    if (count >= IND_SMA_PERIOD) {
+        double sum = 0, squares = 0;
+        for (int i = count - IND_SMA_PERIOD; i < count; i++) sum += series[i];
+        double mean = sum / IND_SMA_PERIOD;
+        for (int i = count - IND_SMA_PERIOD; i < count; i++) squares += (series[i] - mean) * (series[i] - mean);
+        double stddev = sqrt(squares / IND_SMA_PERIOD);
+        CHECK(near(values->sma, mean));
+        CHECK(near(values->upperBand, mean + IND_BOLLINGER_K * stddev));
+        CHECK(near(values->lowerBand, mean - IND_BOLLINGER_K * stddev));
+    }
+
+    CHECK(values->emaValid == (count >= IND_EMA_PERIOD));
+    if (count >= IND_EMA_PERIOD) {
+        double ema = 0;
+        for (int i = 0; i < IND_EMA_PERIOD; i++) ema += series[i];
+        ema /= IND_EMA_PERIOD;
+        for (int i = IND_EMA_PERIOD; i < count; i++) ema += (series[i] - ema) * 2.0 / (IND_EMA_PERIOD + 1);
+        CHECK(near(values->ema, ema));
+    }
+
+    CHECK(values->rsiValid == (count > IND_RSI_PERIOD));
+    if (count > IND_RSI_PERIOD) {
+        double gain = 0, loss = 0;
+        for (int i = 1; i < count; i++) {
+            double move = series[i] - series[i - 1];
+            double up = move > 0 ? move : 0, down = move < 0 ? -move : 0;
+            if (i <= IND_RSI_PERIOD) {
+                gain += up / IND_RSI_PERIOD;
+                loss += down / IND_RSI_PERIOD;
+            } else {
+                gain = (gain * (IND_RSI_PERIOD - 1) + up) / IND_RSI_PERIOD;
+                loss = (loss * (IND_RSI_PERIOD - 1) + down) / IND_RSI_PERIOD;
+            }
+        }
+        double rsi = gain + loss > 0 ? 100.0 * gain / (gain + loss) : 50.0;
+        CHECK(near(values->rsi, rsi));
+    }
+}
+
+int main() {
+    makeSeries();
+
+    // Every prefix of the raw series
+    IndicatorState state;
+    indicatorsInit(&state);
+    for (int i = 0; i < SAMPLES; i++) {
+        indicatorsAdd(&state, prices[i], prices[i], 0.0f);
+        if (i < 60 || i % 97 == 0) checkAgainstReference(prices, i + 1, indicatorsGet(&state));
+    }
+
+    // The tiles' rule: only moves reach the indicators and the SD history
+    mkdir("sd:", 0755);
+    mkdir("sd:/apps", 0755);
+    mkdir("sd:/apps/wii-dashboard", 0755);
+    initHistStore();
+    remove("sd:/apps/wii-dashboard/history/TEST.phx");
+
+    static float moves[SAMPLES];
+    int moveCount = 0;
+    IndicatorState live;
+    indicatorsInit(&live);
+    HistWriter writer;
+    histWriterInit(&writer, "TEST");
+    histLoadRecent(&writer, NULL, 0);
+    for (int i = 0; i < SAMPLES; i++) {
+        if (moveCount > 0 && moves[moveCount - 1] == prices[i]) continue;
+        moves[moveCount++] = prices[i];
+        indicatorsAdd(&live, prices[i], prices[i], 0.0f);
+        histAppend(&writer, BASE_US + i * 1000000LL, prices[i]);
+    }
+    CHECK(histFlush(&writer));
+    CHECK(moveCount > 1000 && moveCount < SAMPLES * 2 / 3);
+    checkAgainstReference(moves, moveCount, indicatorsGet(&live));
+
+    // What restoreTrend does on the next start
+    static PricePoint stored[512];
+    HistWriter reopened;
+    histWriterInit(&reopened, "TEST");
+    int count = histLoadRecent(&reopened, stored, 512);
+    CHECK(count == 512);
+    CHECK(stored[count - 1].price == moves[moveCount - 1]);
+
+    IndicatorState restored;
+    indicatorsInit(&restored);
+    for (int i = 0; i < count; i++) indicatorsAdd(&restored, stored[i].price, stored[i].price, 0.0f);
+
+    const IndicatorValues* a = indicatorsGet(&live);
+    const IndicatorValues* b = indicatorsGet(&restored);
+    CHECK(a->smaValid && b->smaValid && near(b->sma, a->sma));
+    CHECK(a->emaValid && b->emaValid && near(b->ema, a->ema));
+    CHECK(a->rsiValid && b->rsiValid && near(b->rsi, a->rsi));
+    printf("live SMA %.4f EMA %.4f RSI %.2f, restored SMA %.4f EMA %.4f RSI %.2f\n",
+           a->sma, a->ema, a->rsi, b->sma, b->ema, b->rsi);
+
+    return checkSummary("indicatortest");
+}
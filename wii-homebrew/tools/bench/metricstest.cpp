@@ -0,0 +1,98 @@
+// The metrics endpoint over loopback: answered from its own thread with
+// nothing else polling it, a freshness entry for a full 1000-symbol
+// watchlist in both formats, and nothing listening when left disabled.
+
+#include "check.h"
+#include "metrics.h"
+#include "netstats.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define PORT 19110
+#define WATCHLIST 1000
+
+static char response[128 * 1024];
+
+// Whole response, or -1 if nothing accepted the connection
+static int scrape(const char* path) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+
+    char request[128];
+    int length = snprintf(request, sizeof(request), "GET %s HTTP/1.0\r\nHost: localhost\r\n\r\n", path);
+    send(sock, request, length, 0);
+
+    int total = 0;
+    ssize_t n;
+    while ((n = recv(sock, response + total, sizeof(response) - 1 - total, 0)) > 0) total += n;
+    response[total] = '\0';
+    close(sock);
+    return total;
+}
+
+static bool bodyMatchesLength() {
+    const char* body = strstr(response, "\r\n\r\n");
+    const char* field = strstr(response, "Content-Length: ");
+    return body && field && atoi(field + 16) == (int)strlen(body + 4);
+}
+
+int main() {
+    initNetStats();
+
+    CHECK(!initMetrics(0));
+    CHECK(scrape("/metrics") < 0);
+    cleanupMetrics();
+
+    CHECK(initMetrics(PORT));
+    for (int i = 0; i < 30; i++) {
+        updateMetrics();
+        usleep(1000);
+    }
+    char name[16];
+    for (int i = 0; i < WATCHLIST; i++) {
+        snprintf(name, sizeof(name), "SYM%04d", i);
+        metricsMarkFresh(name);
+    }
+
+    // Nothing pumps the server from here on: its thread answers alone
+    double worst = 0;
+    for (int round = 0; round < 5; round++) {
+        double start = secondsNow();
+        CHECK(scrape("/metrics") > 0);
+        double elapsed = secondsNow() - start;
+        if (elapsed > worst) worst = elapsed;
+
+        CHECK(strncmp(response, "HTTP/1.0 200", 12) == 0);
+        CHECK(bodyMatchesLength());
+        CHECK(strstr(response, "wiidash_frame_seconds_count 29") != NULL);
+        CHECK(strstr(response, "wiidash_data_age_seconds{source=\"SYM0000\"}") != NULL);
+        CHECK(strstr(response, "wiidash_data_age_seconds{source=\"SYM0999\"}") != NULL);
+    }
+
+    CHECK(scrape("/metrics.json") > 0);
+    CHECK(strstr(response, "application/json") != NULL);
+    CHECK(bodyMatchesLength());
+    CHECK(strstr(response, "\"SYM0999\":") != NULL);
+    const char* body = strstr(response, "\r\n\r\n");
+    CHECK(body && strcmp(response + strlen(response) - 3, "}}\n") == 0);
+
+    CHECK(scrape("/nope") > 0);
+    CHECK(strncmp(response, "HTTP/1.0 404", 12) == 0);
+
+    cleanupMetrics();
+    CHECK(scrape("/metrics") < 0);
+
+    printf("metricstest: slowest scrape %.1f ms\n", worst * 1000);
+    CHECK(worst < 0.1);
+    return checkSummary("metricstest");
+}
@@ -0,0 +1,133 @@
+// libogc calls used by the portable modules, on POSIX: sockets return
+// -errno like the IOS ones, LWP threads and mutexes are pthreads, and
+// gettime() counts 60.75 MHz ticks of the monotonic clock.
+
+#include <gccore.h>
+#include <network.h>
+#include <ogc/lwp.h>
+#include <ogc/mutex.h>
+#include <ogc/lwp_watchdog.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define MAX_THREADS 32
+#define MAX_MUTEXES 32
+
+static pthread_t threads[MAX_THREADS];
+static int threadCount = 0;
+static pthread_mutex_t mutexes[MAX_MUTEXES];
+static int mutexCount = 0;
+static char arena[2][1];
+
+static s32 result(int value) {
+    return value < 0 ? -errno : value;
+}
+
+void VIDEO_Init() {}
+
+int stime(const time_t* t) { return 0; }
+
+void* SYS_GetArena1Lo() { return arena[0]; }
+void* SYS_GetArena1Hi() { return arena[0]; }
+void* SYS_GetArena2Lo() { return arena[1]; }
+void* SYS_GetArena2Hi() { return arena[1]; }
+
+u64 gettime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * TB_TIMER_CLOCK * 1000 + (u64)now.tv_nsec * TB_TIMER_CLOCK / 1000000;
+}
+
+// ---- network ----
+
+s32 net_init() { return 0; }
+void net_deinit() {}
+s32 net_get_status() { return 0; }
+u32 net_gethostip() { return htonl(INADDR_LOOPBACK); }
+
+struct hostent* net_gethostbyname(const char* name) {
+    return gethostbyname(name);
+}
+
+s32 net_socket(u32 domain, u32 type, u32 protocol) {
+    return result(socket(domain, type, protocol));
+}
+
+s32 net_close(s32 s) {
+    return result(close(s));
+}
+
+s32 net_setsockopt(s32 s, u32 level, u32 option, const void* value, u32 length) {
+    return result(setsockopt(s, level, option, value, length));
+}
+
+s32 net_fcntl(s32 s, u32 cmd, u32 flags) {
+    if (cmd == F_SETFL && (flags & IOS_O_NONBLOCK)) flags = (flags & ~IOS_O_NONBLOCK) | O_NONBLOCK;
+    return result(fcntl(s, cmd, flags));
+}
+
+s32 net_connect(s32 s, struct sockaddr* addr, socklen_t length) {
+    return result(connect(s, addr, length));
+}
+
+s32 net_bind(s32 s, struct sockaddr* addr, socklen_t length) {
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    return result(bind(s, addr, length));
+}
+
+s32 net_listen(s32 s, u32 backlog) {
+    return result(listen(s, backlog));
+}
+
+s32 net_accept(s32 s, struct sockaddr* addr, socklen_t* length) {
+    return result(accept(s, addr, length));
+}
+
+s32 net_send(s32 s, const void* data, s32 length, u32 flags) {
+    return result(send(s, data, length, flags | MSG_NOSIGNAL));
+}
+
+s32 net_recv(s32 s, void* data, s32 length, u32 flags) {
+    return result(recv(s, data, length, flags));
+}
+
+s32 net_sendto(s32 s, const void* data, s32 length, u32 flags, struct sockaddr* to, socklen_t toLength) {
+    return result(sendto(s, data, length, flags | MSG_NOSIGNAL, to, toLength));
+}
+
+s32 net_recvfrom(s32 s, void* data, s32 length, u32 flags, struct sockaddr* from, socklen_t* fromLength) {
+    return result(recvfrom(s, data, length, flags, from, fromLength));
+}
+
+// ---- threads ----
+
+s32 LWP_CreateThread(lwp_t* thread, void* (*entry)(void*), void* arg,
+                     void* stack, u32 stackSize, u8 priority) {
+    if (threadCount >= MAX_THREADS || pthread_create(&threads[threadCount], NULL, entry, arg) != 0) {
+        return -1;
+    }
+    *thread = threadCount++;
+    return 0;
+}
+
+s32 LWP_JoinThread(lwp_t thread, void** value) {
+    return pthread_join(threads[thread], value);
+}
+
+void LWP_YieldThread() {
+    sched_yield();
+}
+
+s32 LWP_MutexInit(mutex_t* mutex, bool recursive) {
+    if (mutexCount >= MAX_MUTEXES) return -1;
+    pthread_mutex_init(&mutexes[mutexCount], NULL);
+    *mutex = mutexCount++;
+    return 0;
+}
+
+s32 LWP_MutexDestroy(mutex_t mutex) { return 0; }
+s32 LWP_MutexLock(mutex_t mutex) { return pthread_mutex_lock(&mutexes[mutex]); }
+s32 LWP_MutexUnlock(mutex_t mutex) { return pthread_mutex_unlock(&mutexes[mutex]); }
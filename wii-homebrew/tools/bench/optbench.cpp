@@ -0,0 +1,82 @@
+// exprOptimize on a corpus of typical plot inputs: code size and time per
+// evaluation before and after, with x as the loop variable (y bound once),
+// and the largest relative difference from the unoptimized result.
+
+#include "check.h"
+#include "expr.h"
+#include <math.h>
+
+#define SAMPLES 1000
+#define RUNS (400 * 500)
+
+static const char* corpus[] = {
+    "x^2",
+    "sin(30)*x",
+    "3x^2+2x+1",
+    "x^4-3x^3+2x-7",
+    "(x+1)^3-(x+1)^2+(x+1)",
+    "sqrt(x^2+1)/(x^2+1)",
+    "e^(-x^2/2)/sqrt(2π)",
+    "sin(x)^2+cos(x)^2",
+    "y*sin(x)+y^2*cos(x)+sqrt(y)",
+    "2^x*ln(2)",
+    "abs(x)*sin(45)+cos(45)*x",
+    "x^2y+3y^2x-xy",
+};
+
+static ExprProgram plain, optimized;
+
+int main() {
+    double totalPlain = 0, totalOptimized = 0;
+
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        const char* source = corpus[i];
+        CHECK(exprCompile(&plain, source, EXPR_DEGREES));
+        optimized = plain;
+        exprOptimize(&optimized, EXPR_VAR_X);
+
+        double vars[EXPR_VAR_COUNT] = { 0, 1.7, 0, 0 };
+        exprBind(&optimized, vars);
+
+        // Same results, and exprEval on the optimized program agrees too
+        double worst = 0;
+        for (int s = 0; s < SAMPLES; s++) {
+            vars[EXPR_VAR_X] = -10 + 20.0 * s / SAMPLES;
+            double a = exprEval(&plain, vars);
+            double b = exprEvalBound(&optimized, vars);
+            CHECK(b == exprEval(&optimized, vars) || (isnan(b) && isnan(exprEval(&optimized, vars))));
+            if (isfinite(a)) {
+                double error = fabs(a - b) / fmax(1.0, fabs(a));
+                if (error > worst) worst = error;
+            } else {
+                CHECK(!isfinite(b));
+            }
+        }
+        CHECK(worst < 1e-12);
+        CHECK(optimized.codeLength - optimized.bodyStart <= plain.codeLength);
+
+        volatile double sink = 0;
+        double start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            vars[EXPR_VAR_X] = r * 1e-4;
+            sink += exprEval(&plain, vars);
+        }
+        double plainNs = (secondsNow() - start) * 1e9 / RUNS;
+
+        start = secondsNow();
+        for (int r = 0; r < RUNS; r++) {
+            vars[EXPR_VAR_X] = r * 1e-4;
+            sink += exprEvalBound(&optimized, vars);
+        }
+        double optimizedNs = (secondsNow() - start) * 1e9 / RUNS;
+
+        totalPlain += plainNs;
+        totalOptimized += optimizedNs;
+        printf("%-30s %3d -> %3d ops  %6.1f -> %6.1f ns (%4.2fx)  error %.1e\n", source,
+               plain.codeLength, optimized.codeLength - optimized.bodyStart,
+               plainNs, optimizedNs, plainNs / optimizedNs, worst);
+    }
+    printf("corpus: %.1f -> %.1f ns per evaluation of each (%.2fx)\n",
+           totalPlain, totalOptimized, totalPlain / totalOptimized);
+    return checkSummary("optbench");
+}
@@ -0,0 +1,31 @@
+// Drawing, input and scene switching for host builds of the scenes: draws
+// are counted and dropped, and the input state is whatever the test sets.
+
+#include "graphics.h"
+#include "input.h"
+
+Scene currentScene = SCENE_DASHBOARD;
+int drawCalls = 0;
+static InputState input;
+
+void changeScene(Scene newScene) { currentScene = newScene; }
+
+InputState* getInput() { return &input; }
+
+bool isPointInRect(float px, float py, float rx, float ry, float rw, float rh) {
+    return px >= rx && px <= rx + rw && py >= ry && py <= ry + rh;
+}
+
+bool isPointInCircle(float px, float py, float cx, float cy, float radius) {
+    float dx = px - cx, dy = py - cy;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+void clearScreen(u32 color) { drawCalls++; }
+void drawRectangle(float x, float y, float width, float height, u32 color) { drawCalls++; }
+void drawLine(float x1, float y1, float x2, float y2, u32 color) { drawCalls++; }
+void drawCircle(float x, float y, float radius, u32 color) { drawCalls++; }
+void drawGlassRectangle(float x, float y, float width, float height, u32 baseColor) { drawCalls++; }
+void drawGlassCircle(float x, float y, float radius, u32 baseColor) { drawCalls++; }
+void drawText(float x, float y, const char* text, u32 color, float size) { drawCalls++; }
+void drawGradientCircle(float x, float y, float radius, u32 color1, u32 color2) { drawCalls++; }
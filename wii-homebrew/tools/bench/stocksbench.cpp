@@ -0,0 +1,129 @@
+// Stocks scene frame time with a 1000-symbol watchlist: the first 64
+// symbols stream from tools/feedserver.py while the grid pages through the
+// whole list, so trends are taken over and restored from SD all the way.
+// Frames are paced at 60 Hz; the time reported is the scene's own work.
+
+#include "check.h"
+#include "stocks.h"
+#include "input.h"
+#include "config.h"
+#include "network.h"
+#include "metrics.h"
+#include "sntp.h"
+#include "alerts.h"
+#include "histstore.h"
+#include "quotestream.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define PORT "18082"
+#define SYMBOLS 1000
+#define STORED_POINTS 600
+#define FRAME_US 16667
+#define PAGE_EVERY 4 // frames between + presses
+#define MAX_FRAMES 4000
+
+static double frameMs[MAX_FRAMES];
+extern int drawCalls;
+
+// mmapped blocks too; the stocks array and the trend pool are large
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Watchlist, a few alert rules and a stored history for every symbol
+static void prepareCard() {
+    mkdir("sd:", 0755);
+    mkdir("sd:/apps", 0755);
+    mkdir("sd:/apps/wii-dashboard", 0755);
+    initHistStore();
+
+    FILE* list = fopen("sd:/apps/wii-dashboard/watchlist.txt", "w");
+    char symbol[16];
+    double start = secondsNow();
+    for (int i = 0; i < SYMBOLS; i++) {
+        snprintf(symbol, sizeof(symbol), "S%04d", i);
+        fprintf(list, "%s, Company %d\n", symbol, i);
+
+        char path[64];
+        snprintf(path, sizeof(path), "sd:/apps/wii-dashboard/history/%s.phx", symbol);
+        remove(path);
+        HistWriter writer;
+        histWriterInit(&writer, symbol);
+        for (int p = 0; p < STORED_POINTS; p++) {
+            histAppend(&writer, 1700000000000000LL + p * 60000000LL, 100.0f + (p * 37 % 200) / 100.0f);
+        }
+        histFlush(&writer);
+    }
+    fclose(list);
+
+    FILE* alerts = fopen("sd:/apps/wii-dashboard/alerts.txt", "w");
+    fprintf(alerts, "S0500 above 10000\nS0750 ema-cross-up\nS0999 below 1\n");
+    fclose(alerts);
+    printf("wrote %d histories of %d points in %.2f s\n", SYMBOLS, STORED_POINTS, secondsNow() - start);
+}
+
+int main() {
+    char* server[] = { (char*)"python3", (char*)"../../feedserver.py", (char*)"--port", (char*)PORT,
+                       (char*)"--interval", (char*)"0.002", NULL };
+    prepareCard();
+    pid_t pid = startServer(server);
+    if (pid < 0) return 1;
+
+    initConfig();
+    snprintf(getConfig()->quoteStreamUrl, sizeof(getConfig()->quoteStreamUrl),
+             "http://localhost:%s/quotes", PORT);
+    initNetwork();
+    initMetrics(0);
+    initSntp(NULL);
+    initAlerts();
+
+    size_t heapBefore = heapInUse();
+    double start = secondsNow();
+    initStocks();
+    printf("initStocks: %.1f ms, %zu KB of heap\n", (secondsNow() - start) * 1000,
+           (heapInUse() - heapBefore) / 1024);
+
+    InputState* input = getInput();
+    int frames = 0;
+    for (; frames < MAX_FRAMES; frames++) {
+        double frameStart = secondsNow();
+        input->plusButton = frames % PAGE_EVERY == 0 && frames < SYMBOLS / 6 * PAGE_EVERY;
+
+        updateQuoteStream();
+        serviceStocks();
+        updateStocks();
+        renderStocks();
+
+        double work = secondsNow() - frameStart;
+        frameMs[frames] = work * 1000;
+        if (work * 1e6 < FRAME_US) usleep(FRAME_US - (int)(work * 1e6));
+        if (frames > SYMBOLS / 6 * PAGE_EVERY + 120) break;
+    }
+    printf("heap in use after paging through %d symbols: %zu KB\n", SYMBOLS,
+           (heapInUse() - heapBefore) / 1024);
+
+    // The last page's sparklines came back from SD (47 segments a tile)
+    drawCalls = 0;
+    renderStocks();
+    CHECK(drawCalls > 6 * 47);
+
+    qsort(frameMs, frames, sizeof(double), compareDouble);
+    double sum = 0;
+    for (int i = 0; i < frames; i++) sum += frameMs[i];
+    printf("stocksbench: %d frames, avg %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms (stream %s)\n",
+           frames, sum / frames, frameMs[frames / 2], frameMs[frames * 99 / 100], frameMs[frames - 1],
+           isQuoteStreamActive() ? "up" : "down");
+
+    cleanupStocks();
+    cleanupNetwork();
+    stopServer(pid);
+    return checkSummary("stocksbench");
+}
@@ -0,0 +1,75 @@
+// Quote stream against tools/feedserver.py: a full 64-symbol request with
+// symbols that need encoding, reconnects after the server drops the
+// connection, and a frame pump that never blocks, DNS included.
+
+#include "check.h"
+#include "quotestream.h"
+#include "network.h"
+#include <ogc/lwp_watchdog.h>
+
+#define PORT "18080"
+#define RUN_SECONDS 8.0
+
+static char lastSymbol[16];
+static int ticks = 0;
+static int indexTicks = 0, classTicks = 0, lastTicks = 0;
+
+static void onTick(const char* symbol, float price, float prevClose) {
+    ticks++;
+    if (strcmp(symbol, "^GSPC") == 0) indexTicks++;
+    if (strcmp(symbol, "BRK.B") == 0) classTicks++;
+    if (strcmp(symbol, lastSymbol) == 0) lastTicks++;
+    CHECK(price > 0.0f && prevClose > 0.0f);
+}
+
+int main() {
+    char* server[] = { (char*)"python3", (char*)"../../feedserver.py", (char*)"--port", (char*)PORT,
+                       (char*)"--interval", (char*)"0.005", (char*)"--drop-after", (char*)"100", NULL };
+    pid_t pid = startServer(server);
+    if (pid < 0) return 1;
+
+    initNetwork();
+    CHECK(initQuoteStream("http://localhost:" PORT "/quotes", onTick));
+
+    // Two symbols that must be encoded, then the longest names allowed
+    CHECK(quoteStreamSubscribe("^GSPC"));
+    CHECK(quoteStreamSubscribe("BRK.B"));
+    char symbol[16];
+    for (int i = 2; i < 64; i++) {
+        snprintf(symbol, sizeof(symbol), "LONGSYMBOL%05d", i);
+        CHECK(quoteStreamSubscribe(symbol));
+    }
+    snprintf(lastSymbol, sizeof(lastSymbol), "%s", symbol);
+    CHECK(quoteStreamSubscribe("^GSPC")); // already in
+    CHECK(!quoteStreamSubscribe("OVERFLOW")); // 65th
+    CHECK(!quoteStreamSubscribe("SIXTEEN_CHARS_XX"));
+
+    // Each connection ends after 100 ticks, so more means a reconnect
+    double start = secondsNow(), worstFrame = 0.0;
+    bool wasActive = false;
+    int connects = 0;
+    while (secondsNow() - start < RUN_SECONDS && ticks < 250) {
+        double frameStart = secondsNow();
+        updateQuoteStream();
+        double frame = secondsNow() - frameStart;
+        if (frame > worstFrame) worstFrame = frame;
+
+        bool active = isQuoteStreamActive();
+        if (active && !wasActive) connects++;
+        wasActive = active;
+        usleep(2000);
+    }
+
+    printf("%d ticks over %d connections in %.1f s, slowest pump %.2f ms\n",
+           ticks, connects, secondsNow() - start, worstFrame * 1000.0);
+    CHECK(indexTicks > 0);
+    CHECK(classTicks > 0);
+    CHECK(lastTicks > 0);
+    CHECK(ticks > 100 && connects >= 2);
+    CHECK(worstFrame < 0.005);
+
+    cleanupQuoteStream();
+    cleanupNetwork();
+    stopServer(pid);
+    return checkSummary("streamtest");
+}
@@ -0,0 +1,6 @@
+#ifndef STUB_FAT_H
+#define STUB_FAT_H
+
+bool fatInitDefault();
+
+#endif // STUB_FAT_H
@@ -0,0 +1,32 @@
+// Host stand-in for libogc's gccore.h: the types and the few system calls
+// the portable modules use. Implemented over POSIX in ../ogcstub.cpp.
+#ifndef STUB_GCCORE_H
+#define STUB_GCCORE_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef float f32;
+typedef double f64;
+
+void VIDEO_Init();
+
+// newlib's, missing from glibc; the host clock is left alone
+int stime(const time_t* t);
+
+// Free memory is reported as the span of these arenas
+void* SYS_GetArena1Lo();
+void* SYS_GetArena1Hi();
+void* SYS_GetArena2Lo();
+void* SYS_GetArena2Hi();
+
+#endif // STUB_GCCORE_H
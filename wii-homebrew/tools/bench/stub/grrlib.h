@@ -0,0 +1,6 @@
+#ifndef STUB_GRRLIB_H
+#define STUB_GRRLIB_H
+
+#include <gccore.h>
+
+#endif // STUB_GRRLIB_H
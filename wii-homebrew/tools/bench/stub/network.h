@@ -0,0 +1,33 @@
+// Host stand-in for libogc's network.h. Like the real calls, these return
+// a negative errno on failure instead of setting errno.
+#ifndef STUB_NETWORK_H
+#define STUB_NETWORK_H
+
+#include <gccore.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+
+#define IOS_O_NONBLOCK 0x04
+
+s32 net_init();
+void net_deinit();
+s32 net_get_status();
+struct hostent* net_gethostbyname(const char* name);
+u32 net_gethostip();
+
+s32 net_socket(u32 domain, u32 type, u32 protocol);
+s32 net_close(s32 s);
+s32 net_setsockopt(s32 s, u32 level, u32 option, const void* value, u32 length);
+s32 net_fcntl(s32 s, u32 cmd, u32 flags);
+s32 net_connect(s32 s, struct sockaddr* addr, socklen_t length);
+s32 net_bind(s32 s, struct sockaddr* addr, socklen_t length);
+s32 net_listen(s32 s, u32 backlog);
+s32 net_accept(s32 s, struct sockaddr* addr, socklen_t* length);
+s32 net_send(s32 s, const void* data, s32 length, u32 flags);
+s32 net_recv(s32 s, void* data, s32 length, u32 flags);
+s32 net_sendto(s32 s, const void* data, s32 length, u32 flags, struct sockaddr* to, socklen_t toLength);
+s32 net_recvfrom(s32 s, void* data, s32 length, u32 flags, struct sockaddr* from, socklen_t* fromLength);
+
+#endif // STUB_NETWORK_H
@@ -0,0 +1,14 @@
+#ifndef STUB_OGC_LWP_H
+#define STUB_OGC_LWP_H
+
+#include <gccore.h>
+
+typedef u32 lwp_t;
+#define LWP_THREAD_NULL 0xffffffff
+
+s32 LWP_CreateThread(lwp_t* thread, void* (*entry)(void*), void* arg,
+                     void* stack, u32 stackSize, u8 priority);
+s32 LWP_JoinThread(lwp_t thread, void** result);
+void LWP_YieldThread();
+
+#endif // STUB_OGC_LWP_H
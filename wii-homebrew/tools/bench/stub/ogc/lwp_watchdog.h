@@ -0,0 +1,14 @@
+// The Wii timebase runs at 60.75 MHz; the host clock is scaled to match
+#ifndef STUB_OGC_LWP_WATCHDOG_H
+#define STUB_OGC_LWP_WATCHDOG_H
+
+#include <gccore.h>
+
+#define TB_TIMER_CLOCK 60750ULL // ticks per millisecond
+
+u64 gettime();
+
+#define ticks_to_millisecs(ticks) ((u64)(ticks) / TB_TIMER_CLOCK)
+#define ticks_to_microsecs(ticks) ((u64)(ticks) * 1000 / TB_TIMER_CLOCK)
+
+#endif // STUB_OGC_LWP_WATCHDOG_H
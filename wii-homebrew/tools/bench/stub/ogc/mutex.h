@@ -0,0 +1,14 @@
+#ifndef STUB_OGC_MUTEX_H
+#define STUB_OGC_MUTEX_H
+
+#include <gccore.h>
+
+typedef u32 mutex_t;
+#define LWP_MUTEX_NULL 0xffffffff
+
+s32 LWP_MutexInit(mutex_t* mutex, bool recursive);
+s32 LWP_MutexDestroy(mutex_t mutex);
+s32 LWP_MutexLock(mutex_t mutex);
+s32 LWP_MutexUnlock(mutex_t mutex);
+
+#endif // STUB_OGC_MUTEX_H
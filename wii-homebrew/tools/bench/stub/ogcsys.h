@@ -0,0 +1,6 @@
+#ifndef STUB_OGCSYS_H
+#define STUB_OGCSYS_H
+
+#include <gccore.h>
+
+#endif // STUB_OGCSYS_H
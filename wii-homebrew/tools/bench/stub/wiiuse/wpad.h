@@ -0,0 +1,34 @@
+#ifndef STUB_WIIUSE_WPAD_H
+#define STUB_WIIUSE_WPAD_H
+
+#include <gccore.h>
+
+typedef struct {
+    int valid;
+    float x, y;
+} ir_t;
+
+#define WPAD_CHAN_0 0
+#define WPAD_FMT_BTNS_ACC_IR 2
+
+#define WPAD_BUTTON_2     0x0001
+#define WPAD_BUTTON_1     0x0002
+#define WPAD_BUTTON_B     0x0004
+#define WPAD_BUTTON_A     0x0008
+#define WPAD_BUTTON_MINUS 0x0010
+#define WPAD_BUTTON_HOME  0x0080
+#define WPAD_BUTTON_LEFT  0x0100
+#define WPAD_BUTTON_RIGHT 0x0200
+#define WPAD_BUTTON_DOWN  0x0400
+#define WPAD_BUTTON_UP    0x0800
+#define WPAD_BUTTON_PLUS  0x1000
+
+s32 WPAD_Init();
+s32 WPAD_SetDataFormat(s32 channel, s32 format);
+s32 WPAD_ScanPads();
+u32 WPAD_ButtonsDown(s32 channel);
+u32 WPAD_ButtonsHeld(s32 channel);
+u32 WPAD_ButtonsUp(s32 channel);
+void WPAD_IR(s32 channel, ir_t* ir);
+
+#endif // STUB_WIIUSE_WPAD_H
@@ -0,0 +1,125 @@
+// httpGet() against local plain and TLS servers (httpserver.py): keep-alive
+// reuse, session resumption with full/resumed handshake counts and times,
+// the Host header, chunked bodies, Content-Length that is short or negative,
+// and certificate checks that fail closed.
+// Runs in build/, where the Makefile puts cert.pem and key.pem.
+
+#include "check.h"
+#include "network.h"
+#include "netstats.h"
+#include "config.h"
+#include <sys/stat.h>
+
+#define TLS_PORT "18443"
+#define PLAIN_PORT "18081"
+
+static const char* BUNDLE_DIR = "sd:/apps/wii-dashboard";
+static const char* BUNDLE_PATH = "sd:/apps/wii-dashboard/cacert.pem";
+
+static bool fetchEquals(const char* url, const char* expected) {
+    const char* body = httpGet(url);
+    return body && strcmp(body, expected) == 0;
+}
+
+static void installBundle(bool present) {
+    remove(BUNDLE_PATH);
+    if (!present) return;
+    mkdir("sd:", 0755);
+    mkdir("sd:/apps", 0755);
+    mkdir(BUNDLE_DIR, 0755);
+
+    FILE* in = fopen("cert.pem", "rb");
+    FILE* out = fopen(BUNDLE_PATH, "wb");
+    char buffer[4096];
+    size_t n;
+    while (in && out && (n = fread(buffer, 1, sizeof(buffer), in)) > 0) fwrite(buffer, 1, n, out);
+    if (in) fclose(in);
+    if (out) fclose(out);
+}
+
+static const NetHostStats* hostStats(const char* host) {
+    static NetHostStats stats;
+    for (int i = 0; i < netStatsHostCount(); i++) {
+        if (netStatsGetHost(i, &stats) && strcmp(stats.host, host) == 0) return &stats;
+    }
+    return NULL;
+}
+
+int main() {
+    char* tlsServer[] = { (char*)"python3", (char*)"../httpserver.py", (char*)TLS_PORT,
+                          (char*)"cert.pem", (char*)"key.pem", NULL };
+    char* plainServer[] = { (char*)"python3", (char*)"../httpserver.py", (char*)PLAIN_PORT, NULL };
+    pid_t tlsPid = startServer(tlsServer);
+    pid_t plainPid = startServer(plainServer);
+    initConfig();
+    initNetStats();
+
+    // No CA bundle and no opt-in: HTTPS fails rather than trusting anyone
+    installBundle(false);
+    initNetwork();
+    CHECK(httpGet("https://localhost:" TLS_PORT "/") == NULL);
+    cleanupNetwork();
+
+    // The explicit opt-in connects without authenticating the server
+    getConfig()->tlsAllowUnverified = true;
+    initNetwork();
+    CHECK(fetchEquals("https://localhost:" TLS_PORT "/", "{\"ok\":true}"));
+    cleanupNetwork();
+    getConfig()->tlsAllowUnverified = false;
+
+    // With the bundle, the certificate and its host name are checked
+    installBundle(true);
+    initNetwork();
+    CHECK(httpGet("https://127.0.0.1:" TLS_PORT "/") == NULL); // cert is for localhost
+
+    const char* tlsBase = "https://localhost:" TLS_PORT;
+    char url[128];
+    snprintf(url, sizeof(url), "%s/host", tlsBase);
+    CHECK(fetchEquals(url, "localhost:" TLS_PORT));
+    snprintf(url, sizeof(url), "%s/", tlsBase);
+    CHECK(fetchEquals(url, "{\"ok\":true}")); // reused
+
+    // Each /close forces the next request onto a new, resumed connection
+    for (int i = 0; i < 5; i++) {
+        snprintf(url, sizeof(url), "%s/close", tlsBase);
+        CHECK(fetchEquals(url, "closing"));
+        snprintf(url, sizeof(url), "%s/", tlsBase);
+        CHECK(fetchEquals(url, "{\"ok\":true}"));
+    }
+
+    snprintf(url, sizeof(url), "%s/chunked", tlsBase);
+    const char* body = httpGet(url);
+    CHECK(body && strlen(body) == 3014 && strncmp(body, "{\"a\":1,\"b\":\"xxx", 15) == 0 &&
+          strcmp(body + 3011, "x\"}") == 0);
+    snprintf(url, sizeof(url), "%s/badchunk", tlsBase);
+    CHECK(httpGet(url) == NULL);
+    snprintf(url, sizeof(url), "%s/fail", tlsBase);
+    CHECK(httpGet(url) == NULL);
+
+    // Plain HTTP on a non-default port keeps the port in Host
+    CHECK(fetchEquals("http://127.0.0.1:" PLAIN_PORT "/host", "127.0.0.1:" PLAIN_PORT));
+    CHECK(fetchEquals("http://127.0.0.1:" PLAIN_PORT "/", "{\"ok\":true}"));
+
+    // A body cut short of its Content-Length, or a negative one, is no body
+    CHECK(httpGet("http://127.0.0.1:" PLAIN_PORT "/short") == NULL);
+    CHECK(httpGet("http://127.0.0.1:" PLAIN_PORT "/negative") == NULL);
+    CHECK(fetchEquals("http://127.0.0.1:" PLAIN_PORT "/", "{\"ok\":true}"));
+    cleanupNetwork();
+
+    const NetHostStats* stats = hostStats("localhost");
+    CHECK(stats != NULL);
+    if (stats) {
+        printf("localhost: %u requests, %u on reused connections\n"
+               "  %u full handshakes, avg %u us\n  %u resumed handshakes, avg %u us\n",
+               stats->requests, stats->reusedConnections,
+               stats->fullHandshakes, stats->fullHandshakeAvgUs,
+               stats->resumedHandshakes, stats->resumedHandshakeAvgUs);
+        CHECK(stats->resumedHandshakes >= 5);
+        CHECK(stats->reusedConnections >= 5);
+    }
+
+    installBundle(false);
+    stopServer(tlsPid);
+    stopServer(plainPid);
+    return checkSummary("tlstest");
+}
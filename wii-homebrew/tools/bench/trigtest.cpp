@@ -0,0 +1,111 @@
+// Degree trig through the expression engine: sin(180), cos(90) and tan(90)
+// are 0, 0 and undefined on every path a displayed result or a plot can
+// take (plain, folded, bound, batch, dual and interval), not 1e-16.
+
+#include "check.h"
+#include "expr.h"
+#include "fastmath.h"
+#include <math.h>
+
+#define DEG (M_PI / 180.0)
+
+static ExprProgram prog;
+
+static double eval(const char* source, ExprAngleMode angles) {
+    double vars[EXPR_VAR_COUNT] = { 0 };
+    if (!exprCompile(&prog, source, angles)) return -999;
+    return exprEval(&prog, vars);
+}
+
+// The same after constant folding
+static double folded(const char* source) {
+    double vars[EXPR_VAR_COUNT] = { 0 };
+    if (!exprCompile(&prog, source, EXPR_DEGREES)) return -999;
+    exprOptimize(&prog, EXPR_VAR_X);
+    exprBind(&prog, vars);
+    return exprEvalBound(&prog, vars);
+}
+
+int main() {
+    // The display path
+    CHECK(eval("sin(180)", EXPR_DEGREES) == 0.0);
+    CHECK(!signbit(eval("sin(180)", EXPR_DEGREES)));
+    CHECK(eval("cos(90)", EXPR_DEGREES) == 0.0);
+    CHECK(eval("cos(270)", EXPR_DEGREES) == 0.0);
+    CHECK(eval("sin(-360)", EXPR_DEGREES) == 0.0);
+    CHECK(eval("sin(90)", EXPR_DEGREES) == 1.0);
+    CHECK(eval("cos(180)", EXPR_DEGREES) == -1.0);
+    CHECK(eval("tan(45)", EXPR_DEGREES) == 1.0 || fabs(eval("tan(45)", EXPR_DEGREES) - 1.0) < 1e-15);
+    CHECK(isnan(eval("tan(90)", EXPR_DEGREES)));
+    CHECK(isnan(eval("tan(-270)", EXPR_DEGREES)));
+    CHECK(eval("tan(180)", EXPR_DEGREES) == 0.0);
+    CHECK(eval("sin(1e9*180)", EXPR_DEGREES) == 0.0);
+    CHECK(fabs(eval("sin(30)", EXPR_DEGREES) - 0.5) < 1e-15);
+    CHECK(eval("2sin(90)+cos(0)", EXPR_DEGREES) == 3.0);
+
+    // Radians are untouched
+    CHECK(eval("sin(π)", EXPR_RADIANS) == sin(M_PI));
+    CHECK(eval("sin(1)", EXPR_RADIANS) == sin(1.0));
+
+    // Folded and bound
+    CHECK(folded("sin(180)") == 0.0);
+    CHECK(folded("cos(90)+1") == 1.0);
+    CHECK(isnan(folded("tan(90)")));
+    CHECK(folded("sin(2*90)") == 0.0);
+    CHECK(folded("x+sin(180)") == 0.0);
+
+    // A variable argument: bound, batch and fast
+    double vars[EXPR_VAR_COUNT] = { 0, 0, 0, 0 };
+    double xs[5] = { 0, 90, 180, 270, 360 };
+    double out[5], derivs[5];
+    CHECK(exprCompile(&prog, "sin(x)", EXPR_DEGREES));
+    exprEvalBatch(&prog, vars, EXPR_VAR_X, xs, out, 5);
+    CHECK(out[0] == 0.0 && out[1] == 1.0 && out[2] == 0.0 && out[3] == -1.0 && out[4] == 0.0);
+
+    exprEvalBatchDual(&prog, vars, EXPR_VAR_X, xs, out, derivs, 5);
+    CHECK(out[2] == 0.0);
+    CHECK(fabs(derivs[0] - DEG) < 1e-18 && fabs(derivs[2] + DEG) < 1e-18 && derivs[1] == 0.0);
+    vars[EXPR_VAR_X] = 180;
+    double d;
+    CHECK(exprEvalDual(&prog, vars, EXPR_VAR_X, &d) == 0.0 && fabs(d + DEG) < 1e-18);
+
+    exprOptimize(&prog, EXPR_VAR_X);
+    exprBind(&prog, vars);
+    CHECK(exprEvalBound(&prog, vars) == 0.0);
+
+    CHECK(exprCompile(&prog, "cos(x)*y", EXPR_DEGREES));
+    exprOptimize(&prog, EXPR_VAR_X);
+    vars[EXPR_VAR_Y] = 2;
+    exprBind(&prog, vars);
+    vars[EXPR_VAR_X] = 90;
+    CHECK(exprEvalBound(&prog, vars) == 0.0);
+
+    prog.precision = EXPR_FAST;
+    exprEvalBatch(&prog, vars, EXPR_VAR_X, xs, out, 5);
+    CHECK(fabs(out[0] - 2.0) < 1e-6 && fabs(out[1]) < 1e-6 && fabs(out[2] + 2.0) < 1e-6);
+    CHECK(fabs(exprEvalBound(&prog, vars)) < 1e-6);
+
+    // Interval bounds see the degree argument
+    double lo, hi;
+    CHECK(exprCompile(&prog, "sin(x)", EXPR_DEGREES));
+    CHECK(exprEvalInterval(&prog, vars, EXPR_VAR_X, 10, 170, &lo, &hi));
+    CHECK(lo > 0.17 && lo < 0.18 && hi == 1.0);
+    CHECK(exprCompile(&prog, "tan(x)", EXPR_DEGREES));
+    CHECK(!exprEvalInterval(&prog, vars, EXPR_VAR_X, 80, 100, &lo, &hi));
+    CHECK(exprEvalInterval(&prog, vars, EXPR_VAR_X, 0, 60, &lo, &hi));
+
+    // The kernels themselves
+    CHECK(sinDeg(180) == 0.0 && cosDeg(90) == 0.0 && isnan(tanDeg(90)));
+    CHECK(sinDeg(-90) == -1.0 && cosDeg(-180) == -1.0);
+    CHECK(isnan(sinDeg(INFINITY)) && isnan(cosDeg(NAN)));
+    // Against long double, since sin(degrees * DEG) has the rounding of DEG
+    // in it: about 1e-15 by 700 degrees
+    for (int degrees = -720; degrees <= 720; degrees++) {
+        long double r = degrees * (3.14159265358979323846264338327950288L / 180);
+        if (fabsl(sinDeg(degrees) - sinl(r)) > 3e-16L || fabsl(cosDeg(degrees) - cosl(r)) > 3e-16L) {
+            CHECK(!"sinDeg/cosDeg within an ulp of long double");
+            break;
+        }
+    }
+    return checkSummary("trigtest");
+}
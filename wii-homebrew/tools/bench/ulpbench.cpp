@@ -0,0 +1,139 @@
+// Error of the float kernels in fastmath.h against double libm, in units in
+// the last place of the float result: every float input with a step of 1
+// ("ulpbench 1", a few minutes a kernel), every step-th one otherwise. pow
+// is sampled over random pairs with x^y kept mostly in range. The bounds
+// checked are the ones recorded in fastmath.h.
+
+#include "check.h"
+#include "fastmath.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_STEP 257
+#define DEFAULT_PAIRS 4000000
+
+typedef struct {
+    const char* name;
+    float (*fast)(float);
+    double (*exact)(double);
+    double bound; // ULP
+} Kernel;
+
+static double sqrtDouble(double x) {
+    return sqrt(x);
+}
+
+static const Kernel kernels[] = {
+    { "sin", fastSin, sin, 0.504 },
+    { "cos", fastCos, cos, 0.504 },
+    { "tan", fastTan, tan, 0.505 },
+    { "asin", fastAsin, asin, 0.501 },
+    { "acos", fastAcos, acos, 0.501 },
+    { "atan", fastAtan, atan, 0.501 },
+    { "sqrt", fastSqrt, sqrtDouble, 0.500 },
+    { "exp", fastExp, exp, 0.500 },
+    { "log", fastLog, log, 0.501 },
+    { "log10", fastLog10, log10, 0.501 },
+};
+#define POW_BOUND 0.53
+
+// One ULP of the float nearest ref
+static double ulpOf(double ref) {
+    float f = (float)fabs(ref);
+    if (isinf(f)) f = 3.4028235e38f;
+    if (f < 1.17549435e-38f) return ldexp(1.0, -149);
+    int e;
+    frexp(f, &e);
+    return ldexp(1.0, e - 24);
+}
+
+// Error in ULP; -1 where the two disagree on a NaN or an infinity
+static double ulpError(float value, double ref) {
+    if (isnan(ref) || isinf((float)ref)) {
+        return (isnan(ref) && isnan(value)) || (float)ref == value ? 0.0 : -1.0;
+    }
+    if (isnan(value) || isinf(value)) return -1.0;
+    return fabs(value - ref) / ulpOf(ref);
+}
+
+static u64 rngState = 0x9E3779B97F4A7C15ULL;
+
+static u64 nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+static double uniform(double lo, double hi) {
+    return lo + (hi - lo) * (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void measure(const Kernel* k, u32 step) {
+    double start = secondsNow();
+    double worst = 0;
+    float worstAt = 0;
+    long inputs = 0, special = 0;
+
+    for (u64 bits = 0; bits < 0x100000000ULL; bits += step) {
+        u32 u = (u32)bits;
+        float x;
+        memcpy(&x, &u, sizeof(x));
+        if (isnan(x)) continue;
+        inputs++;
+
+        double error = ulpError(k->fast(x), k->exact(x));
+        if (error < 0) {
+            if (special++ < 3) printf("  %s(%a) = %a, libm %a\n", k->name, x, k->fast(x), k->exact(x));
+        } else if (error > worst) {
+            worst = error;
+            worstAt = x;
+        }
+    }
+    CHECK(special == 0);
+    CHECK(worst <= k->bound);
+    printf("%-6s %10ld inputs  max %.4f ULP at %a  (%.1f s)\n", k->name, inputs, worst, worstAt,
+           secondsNow() - start);
+}
+
+static void measurePow(long pairs) {
+    double start = secondsNow();
+    double worst = 0;
+    float worstX = 0, worstY = 0;
+    long special = 0;
+
+    for (long i = 0; i < pairs; i++) {
+        u32 u = (u32)nextRandom() & 0x7FFFFFFF;
+        float x;
+        memcpy(&x, &u, sizeof(x));
+        double lx = log((double)x);
+        if (!isfinite(lx) || lx == 0) continue;
+
+        float y = (float)(uniform(-1, 1) * 88.0 / fabs(lx) * ((nextRandom() & 1) ? 1 : 0.5));
+        if (i % 4 == 0) y = (float)(int)y; // integer powers too
+
+        double error = ulpError(fastPow(x, y), pow((double)x, (double)y));
+        if (error < 0) {
+            special++;
+        } else if (error > worst) {
+            worst = error;
+            worstX = x;
+            worstY = y;
+        }
+    }
+    CHECK(special == 0);
+    CHECK(worst <= POW_BOUND);
+    printf("%-6s %10ld pairs   max %.4f ULP at (%a, %a)  (%.1f s)\n", "pow", pairs, worst, worstX, worstY,
+           secondsNow() - start);
+}
+
+int main(int argc, char** argv) {
+    u32 step = argc > 1 ? (u32)strtoul(argv[1], NULL, 0) : DEFAULT_STEP;
+    long pairs = argc > 2 ? atol(argv[2]) : DEFAULT_PAIRS;
+    if (step == 0) step = 1;
+
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) measure(&kernels[i], step);
+    measurePow(pairs);
+    return checkSummary("ulpbench");
+}
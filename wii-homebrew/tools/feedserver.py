@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Stand-in quote feed for the Stocks scene's server-sent events stream.
+
+Serves GET <any path>?symbols=A,B,C as text/event-stream, one tick per
+symbol in turn, each a small random walk around a price derived from the
+symbol name:
+
+    data: {"symbol":"AAPL","price":189.32,"previousClose":187.10}
+
+plus a ": heartbeat" comment every few seconds. Point AppConfig's
+quoteStreamUrl at http://<this machine>:8080/quotes to use it from a Wii,
+or run it under tools/bench/streamtest.
+
+Usage: python3 tools/feedserver.py [--port 8080] [--interval 0.2]
+                                   [--drop-after N] [--log]
+
+--drop-after closes each connection after N ticks, to exercise the
+client's reconnect and backoff.
+"""
+import argparse
+import json
+import random
+import time
+import urllib.parse
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+HEARTBEAT_SECONDS = 5.0
+
+
+def base_price(symbol):
+    return 20.0 + zlib.crc32(symbol.encode()) % 48000 / 100.0
+
+
+class FeedHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"
+
+    def do_GET(self):
+        query = urllib.parse.urlparse(self.path).query
+        values = urllib.parse.parse_qs(query).get("symbols", [""])
+        symbols = [s for s in values[0].split(",") if s]
+        if self.server.log:
+            print("%s: %d symbols %s" % (self.client_address[0], len(symbols),
+                                         ",".join(symbols)), flush=True)
+        if not symbols:
+            self.send_error(400, "no symbols")
+            return
+
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Cache-Control", "no-cache")
+        self.end_headers()
+
+        closes = {s: base_price(s) for s in symbols}
+        prices = dict(closes)
+        sent = 0
+        last_beat = time.monotonic()
+        try:
+            while self.server.drop_after == 0 or sent < self.server.drop_after:
+                symbol = symbols[sent % len(symbols)]
+                prices[symbol] = round(prices[symbol] * (1 + random.gauss(0, 0.002)), 2)
+                tick = {"symbol": symbol, "price": prices[symbol],
+                        "previousClose": closes[symbol]}
+                self.wfile.write(b"data: %s\n\n" % json.dumps(tick, separators=(",", ":")).encode())
+                sent += 1
+
+                if time.monotonic() - last_beat > HEARTBEAT_SECONDS:
+                    self.wfile.write(b": heartbeat\n\n")
+                    last_beat = time.monotonic()
+                self.wfile.flush()
+                time.sleep(self.server.interval)
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+
+    def log_message(self, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in SSE quote feed")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--interval", type=float, default=0.2,
+                        help="seconds between ticks")
+    parser.add_argument("--drop-after", type=int, default=0,
+                        help="close each connection after this many ticks")
+    parser.add_argument("--log", action="store_true",
+                        help="print each subscription")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer(("", args.port), FeedHandler)
+    server.daemon_threads = True
+    server.interval = args.interval
+    server.drop_after = args.drop_after
+    server.log = args.log
+    print("feed server on port %d" % args.port, flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
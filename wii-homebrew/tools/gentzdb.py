@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Generate source/tzdata.inc from the system tzdata.
+
+Every TZif (v2+) file ends with a POSIX TZ string describing the rules
+currently in force, e.g. "AEST-10AEDT,M10.1.0,M4.1.0/3". That string is
+all the dashboard needs to compute present-day local time, so the table
+is just (zone name, rule string) pairs, parsed once at runtime by tzdb.cpp.
+
+Zones whose near-term transitions are scheduled one by one rather than by
+rule (e.g. Africa/Casablanca around Ramadan) are only approximated.
+
+Usage: python3 tools/gentzdb.py [zoneinfo dir] > source/tzdata.inc
+"""
+import os
+import sys
+
+ZONEINFO = sys.argv[1] if len(sys.argv) > 1 else "/usr/share/zoneinfo"
+EXTRA_ZONES = ["Etc/UTC"]
+
+
+def zone_names():
+    names = set(EXTRA_ZONES)
+    with open(os.path.join(ZONEINFO, "zone.tab")) as tab:
+        for line in tab:
+            if line.startswith("#") or not line.strip():
+                continue
+            names.add(line.split("\t")[2].strip())
+    return sorted(names)
+
+
+def footer(name):
+    with open(os.path.join(ZONEINFO, name), "rb") as f:
+        data = f.read()
+    if not data.startswith(b"TZif") or data[4:5] < b"2":
+        return None
+    lines = data.rstrip(b"\n").rsplit(b"\n", 1)
+    if len(lines) != 2:
+        return None
+    return lines[1].decode("ascii")
+
+
+def main():
+    out = sys.stdout
+    out.write("// Generated by tools/gentzdb.py from %s - do not edit by hand.\n" % ZONEINFO)
+    out.write("// { IANA zone name, POSIX TZ rule }\n")
+    count = 0
+    for name in zone_names():
+        rule = footer(name)
+        if not rule:
+            sys.stderr.write("skipping %s (no POSIX footer)\n" % name)
+            continue
+        out.write('{"%s", "%s"},\n' % (name, rule))
+        count += 1
+    sys.stderr.write("%d zones\n" % count)
+
+
+if __name__ == "__main__":
+    main()